@@ -0,0 +1,646 @@
+#include "System/System.h"
+#include "Core/Asset/AssetImporter.h"
+#include "Core/Asset/MeshArchive.h"
+#include "Core/Asset/AssetResidency.h"
+#include "Core/World/WorldArchive.h"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+// Cooks meshes into .asset files and textures into mip-complete .dds files without a GPU device, so they can be built
+// ahead of time.
+//
+// Windows only: the System layer (files, threads, the thread pool) is Win32, assets carry RHI members, DDS files go
+// through DirectXTex, BMP/GIF/TIFF through WIC and FBX through assimp. Build machines without Windows cannot run it.
+//
+//	AssetCooker <World.json | Directory> [options]
+//	AssetCooker --replay-trace <Trace.json>
+//
+//	-o <Directory>		Output directory, defaults to the runtime cache next to the executable
+//	-j <Jobs>			Number of files cooked at the same time, meshes of a file are processed on the thread pool
+//	--meshlets			The import options below apply to the files of a directory, a world carries its own
+//	--optimize
+//	--overdraw
+//	--compress-vertices
+//	--compress-indices
+//	--lods <NumLods>
+//	--weld-epsilon <Epsilon>
+//	--cluster <Triangles>
+//	--compress-textures	The texture options below apply to the textures of a directory, a world carries its own
+//	--texture-usage <color | normal | mask>
+//	--texture-quality <fast | normal | high>
+//	--mip-filter <box | kaiser>
+//	--cubemap			Converts latitude-longitude HDR sky lights to prefiltered cubemaps
+//	--benchmark-obj		Reads the OBJ files with the native parser and with assimp and logs both, nothing is cooked
+//	--benchmark-weld	Welds the meshes of every file with VertexWelder and with assimp and logs both, fails if they differ
+//	--benchmark-culling	Cooks every file even if it is up to date and logs how much meshlet and cluster culling rejects
+//	--benchmark-textures	Loads every texture from its source and from its cooked file and logs both
+//	--benchmark-decode	Decodes every texture and generates its mips with WIC/DirectXTex and with the portable decoders and logs both
+//	--test-sky <Samples>	Loads every texture and tests its sky light sampling tables with this many samples
+//
+//	--replay-trace replays a trace of asset usage against the residency policy and logs its hits, loads and evictions,
+//	nothing is cooked. The trace is a JSON object:
+//
+//	{
+//		"Budget": { "CpuSizeInBytes": 0, "GpuSizeInBytes": 268435456, "MinIdleFrames": 3 },
+//		"Assets": [ { "CpuSizeInBytes": 1024, "GpuSizeInBytes": 1048576 }, ... ],
+//		"Frames": [ [ 0, 1 ], [ 1, 2 ], ... ]
+//	}
+//
+//	Frames lists the indices into Assets of the assets used in every frame
+
+DECLARE_LOG_CATEGORY(Cooker);
+DEFINE_LOG_CATEGORY(Cooker);
+
+using json = nlohmann::ordered_json;
+
+enum class CookStatus
+{
+	Cooked,
+	UpToDate,
+	Failed
+};
+
+struct CookResult
+{
+	Asset::MeshImportOptions Options;
+	u64						 Key		 = 0;
+	std::filesystem::path	 BinaryPath;
+	CookStatus				 Status		 = CookStatus::Failed;
+	u64						 NumMeshes	 = 0;
+	u64						 SizeInBytes = 0;
+	i64						 Milliseconds = 0;
+};
+
+static const char* ToString(CookStatus Status)
+{
+	switch (Status)
+	{
+	case CookStatus::Cooked:
+		return "Cooked";
+	case CookStatus::UpToDate:
+		return "UpToDate";
+	case CookStatus::Failed:
+		return "Failed";
+	}
+	return "";
+}
+
+static bool IsUpToDate(const std::filesystem::path& BinaryPath, u64& NumMeshes)
+{
+	Asset::MeshArchive Archive(std::make_shared<MemoryMappedFile>(BinaryPath));
+	NumMeshes = Archive.IsValid() ? Archive.GetNumMeshes() : 0;
+	return Archive.IsValid();
+}
+
+static void Cook(Asset::MeshImporter& Importer, Asset::AssetCache& Cache, CookResult& Result)
+{
+	ScopedTimer Timer(
+		[&](i64 Milliseconds)
+		{
+			Result.Milliseconds = Milliseconds;
+		});
+
+	// Culling is only benchmarked while cooking
+	if (Cache.Lookup(Result.Key, Asset::MeshImporter::CookedExtension, Result.BinaryPath) && !Result.Options.BenchmarkCulling && IsUpToDate(Result.BinaryPath, Result.NumMeshes))
+	{
+		Result.Status	   = CookStatus::UpToDate;
+		Result.SizeInBytes = file_size(Result.BinaryPath);
+		return;
+	}
+
+	Asset::ImportReport Report;
+	Report.Source = Result.Options.Path;
+
+	// Meshes only live until the file is written
+	std::vector<std::unique_ptr<Asset::Mesh>> Meshes;
+	auto									  Cooked = Importer.Cook(
+		 Result.Options,
+		 Result.BinaryPath,
+		 [&]
+		 {
+			 return Meshes.emplace_back(std::make_unique<Asset::Mesh>()).get();
+		 },
+		 &Report);
+	if (Cooked.empty())
+	{
+		Result.Status = CookStatus::Failed;
+		return;
+	}
+
+	// Next to the cooked files, every cook appends to it so throughput can be compared across runs
+	Report.Log();
+	Report.Append(Cache.GetDirectory() / Asset::ImportReport::FileName);
+
+	Result.Status	   = CookStatus::Cooked;
+	Result.NumMeshes   = Cooked.size();
+	Result.SizeInBytes = file_size(Result.BinaryPath);
+}
+
+// Compression of every block compression format, summed over the textures that were cooked to it
+struct CompressionSummary
+{
+	u64 NumTextures			  = 0;
+	u64 SizeInBytes			  = 0;
+	u64 CompressedSizeInBytes = 0;
+	i64 Ticks				  = 0;
+	f64 Psnr				  = 0.0; // Summed, divided by NumTextures when logged
+};
+
+// Textures are cooked by dedicated threads like meshes, block compression of each texture runs on the pool. Returns the
+// number of textures that failed
+static size_t CookTextures(Asset::TextureImporter& Importer, Asset::AssetCache& Cache, std::vector<Asset::TextureImportOptions> Textures, u32 NumJobs)
+{
+	// Keys hash the source files, a texture referenced twice with the same options is only cooked once
+	std::vector<u64> Keys(Textures.size());
+	ParallelFor(
+		Process::GetThreadPool(),
+		Textures.size(),
+		[&](size_t i)
+		{
+			u64 Key = Asset::TextureImporter::GetCacheKey(Cache, Textures[i]);
+			Keys[i] = Key != Asset::AssetCache::NoKey ? Key : i;
+		});
+	std::set<u64> Seen;
+	for (size_t i = 0; i < Textures.size(); ++i)
+	{
+		if (!Seen.insert(Keys[i]).second)
+		{
+			Textures[i].Path.clear();
+		}
+	}
+	std::erase_if(
+		Textures,
+		[](const Asset::TextureImportOptions& Options)
+		{
+			return Options.Path.empty();
+		});
+
+	std::atomic<size_t> NumCooked = 0;
+	std::atomic<size_t> NumFailed = 0;
+	ScopedTimer			Timer(
+		[&](i64 Milliseconds)
+		{
+			KAGUYA_LOG(
+				Cooker,
+				Info,
+				"{} textures in {}ms: {} cooked, {} up to date, {} failed",
+				Textures.size(),
+				Milliseconds,
+				NumCooked.load(),
+				Textures.size() - NumCooked - NumFailed,
+				NumFailed.load());
+		});
+
+	std::mutex								  Mutex;
+	std::map<DXGI_FORMAT, CompressionSummary> Summaries;
+	std::atomic<size_t>						  Next = 0;
+	{
+		std::vector<std::jthread> Workers;
+		for (u32 i = 0; i < std::min<size_t>(NumJobs, Textures.size()); ++i)
+		{
+			Workers.emplace_back(
+				[&]
+				{
+					for (size_t j = Next++; j < Textures.size(); j = Next++)
+					{
+						Asset::Texture		Texture;
+						Asset::ImportReport Report;
+						if (!Importer.Load(Cache, Textures[j], &Texture, &Report))
+						{
+							KAGUYA_LOG(Cooker, Error, "Failed {}", Textures[j].Path.string());
+							NumFailed++;
+							continue;
+						}
+						if (!Report.Cooked)
+						{
+							continue;
+						}
+
+						Report.Log();
+						Report.Append(Cache.GetDirectory() / Asset::ImportReport::FileName);
+						NumCooked++;
+
+						if (const Asset::TextureCompressionStats& Stats = Texture.CompressionStats; Stats.Format != DXGI_FORMAT_UNKNOWN)
+						{
+							std::scoped_lock	Lock(Mutex);
+							CompressionSummary& Summary = Summaries[Stats.Format];
+							Summary.NumTextures++;
+							Summary.SizeInBytes += Stats.SizeInBytes;
+							Summary.CompressedSizeInBytes += Stats.CompressedSizeInBytes;
+							Summary.Ticks += Stats.Ticks;
+							Summary.Psnr += Stats.Psnr;
+						}
+					}
+				});
+		}
+	}
+
+	for (const auto& [Format, Summary] : Summaries)
+	{
+		KAGUYA_LOG(
+			Cooker,
+			Info,
+			"{}: {} textures, {} MiB -> {} MiB at {:.0f} MB/s, mean PSNR {:.2f} dB",
+			Asset::TextureCompressor::GetFormatName(Format),
+			Summary.NumTextures,
+			Summary.SizeInBytes >> 20,
+			Summary.CompressedSizeInBytes >> 20,
+			static_cast<f64>(Summary.SizeInBytes) / 1e6 * static_cast<f64>(Stopwatch::Frequency) / static_cast<f64>(std::max<i64>(Summary.Ticks, 1)),
+			Summary.Psnr / static_cast<f64>(Summary.NumTextures));
+	}
+	return NumFailed;
+}
+
+// Returns the exit code
+static int ReplayTrace(const std::filesystem::path& Path)
+{
+	std::ifstream ifs(Path);
+	if (!ifs)
+	{
+		KAGUYA_LOG(Cooker, Error, "Failed to open {}", Path.string());
+		return 1;
+	}
+
+	Asset::AssetBudget				   Budget;
+	std::vector<Asset::AssetFootprint> Footprints;
+	std::vector<std::vector<u32>>	   Frames;
+	u64								   NumUses = 0;
+	try
+	{
+		json Json = json::parse(ifs);
+
+		const json& JsonBudget = Json.at("Budget");
+		Budget.CpuSizeInBytes  = JsonBudget.value("CpuSizeInBytes", Budget.CpuSizeInBytes);
+		Budget.GpuSizeInBytes  = JsonBudget.value("GpuSizeInBytes", Budget.GpuSizeInBytes);
+		Budget.MinIdleFrames   = JsonBudget.value("MinIdleFrames", Budget.MinIdleFrames);
+		for (const json& JsonAsset : Json.at("Assets"))
+		{
+			Footprints.push_back({
+				.CpuSizeInBytes = JsonAsset.value("CpuSizeInBytes", u64(0)),
+				.GpuSizeInBytes = JsonAsset.value("GpuSizeInBytes", u64(0)),
+			});
+		}
+		for (const json& JsonFrame : Json.at("Frames"))
+		{
+			std::vector<u32>& Frame = Frames.emplace_back(JsonFrame.get<std::vector<u32>>());
+			if (std::ranges::any_of(
+					Frame,
+					[&](u32 Index)
+					{
+						return Index >= Footprints.size();
+					}))
+			{
+				KAGUYA_LOG(Cooker, Error, "{}: frame {} uses an asset that is not in Assets", Path.string(), Frames.size() - 1);
+				return 1;
+			}
+			NumUses += Frame.size();
+		}
+	}
+	catch (const json::exception& Exception)
+	{
+		KAGUYA_LOG(Cooker, Error, "{} is not a valid trace: {}", Path.string(), Exception.what());
+		return 1;
+	}
+
+	Asset::ResidencyStats Stats = Asset::AssetResidency::Replay(Budget, Footprints, Frames);
+	KAGUYA_LOG(
+		Cooker,
+		Info,
+		"Replayed {} frames over {} assets: {} uses, {} hits ({:.2f}%), {} loads, {} evictions ({} MiB CPU, {} MiB GPU), {} frames over budget",
+		Frames.size(),
+		Footprints.size(),
+		NumUses,
+		NumUses - Stats.NumLoads,
+		NumUses > 0 ? 100.0 * static_cast<f64>(NumUses - Stats.NumLoads) / static_cast<f64>(NumUses) : 0.0,
+		Stats.NumLoads,
+		Stats.NumEvictions,
+		Stats.EvictedCpuSizeInBytes >> 20,
+		Stats.EvictedGpuSizeInBytes >> 20,
+		Stats.NumFramesOverBudget);
+	return 0;
+}
+
+static void WriteManifest(const std::filesystem::path& Path, const std::vector<CookResult>& Results)
+{
+	json Json;
+	Json["Version"] = Asset::MeshArchive::Version;
+
+	auto& JsonAssets = Json["Assets"];
+	for (const auto& Result : Results)
+	{
+		json JsonAsset;
+		JsonAsset["Source"]		  = Result.Options.Path.string();
+		JsonAsset["Key"]		  = std::format("{:016x}", Result.Key);
+		JsonAsset["Asset"]		  = Result.BinaryPath.filename().string();
+		JsonAsset["Status"]		  = ToString(Result.Status);
+		JsonAsset["NumMeshes"]	  = Result.NumMeshes;
+		JsonAsset["SizeInBytes"]  = Result.SizeInBytes;
+		JsonAsset["Milliseconds"] = Result.Milliseconds;
+		JsonAssets.push_back(std::move(JsonAsset));
+	}
+
+	std::ofstream ofs(Path);
+	ofs << std::setw(2) << Json << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		KAGUYA_LOG(Cooker, Error, "Usage: AssetCooker <World.json | Directory> [-o Directory] [-j Jobs] [--meshlets] [--optimize] [--overdraw] [--compress-vertices] [--compress-indices] [--lods NumLods] [--weld-epsilon Epsilon] [--cluster Triangles] [--compress-textures] [--texture-usage color|normal|mask] [--texture-quality fast|normal|high] [--mip-filter box|kaiser] [--cubemap] [--benchmark-obj] [--benchmark-weld] [--benchmark-culling] [--benchmark-textures] [--benchmark-decode] [--test-sky Samples]");
+		KAGUYA_LOG(Cooker, Error, "Usage: AssetCooker --replay-trace Trace.json");
+		return 1;
+	}
+	if (std::string_view(argv[1]) == "--replay-trace")
+	{
+		return ReplayTrace(argc > 2 ? argv[2] : "");
+	}
+
+	std::filesystem::path		Input			  = argv[1];
+	std::filesystem::path		Output			  = Process::ExecutableDirectory / "Cache";
+	u32							NumJobs			  = std::max(std::thread::hardware_concurrency() / 2, 1u);
+	Asset::MeshImportOptions	Defaults		  = {};
+	Asset::TextureImportOptions TextureDefaults	  = {};
+	bool						BenchmarkObj	  = false;
+	bool						BenchmarkWeld	  = false;
+	bool						BenchmarkCulling  = false;
+	bool						BenchmarkTextures = false;
+	bool						BenchmarkDecode	  = false;
+	u32							NumSkySamples	  = 0;
+	for (int i = 2; i < argc; ++i)
+	{
+		std::string_view Argument = argv[i];
+		bool			 HasValue = i + 1 < argc;
+		if (Argument == "-o" && HasValue)
+		{
+			Output = argv[++i];
+		}
+		else if (Argument == "-j" && HasValue)
+		{
+			NumJobs = std::max(std::stoul(argv[++i]), 1ul);
+		}
+		else if (Argument == "--meshlets")
+		{
+			Defaults.GenerateMeshlets = true;
+		}
+		else if (Argument == "--optimize")
+		{
+			Defaults.OptimizeVertexCache = true;
+		}
+		else if (Argument == "--overdraw")
+		{
+			Defaults.OptimizeVertexCache = true;
+			Defaults.OptimizeOverdraw	 = true;
+		}
+		else if (Argument == "--compress-vertices")
+		{
+			Defaults.CompressVertices = true;
+		}
+		else if (Argument == "--compress-indices")
+		{
+			Defaults.CompressIndices = true;
+		}
+		else if (Argument == "--lods" && HasValue)
+		{
+			Defaults.NumLods = std::stoul(argv[++i]);
+		}
+		else if (Argument == "--weld-epsilon" && HasValue)
+		{
+			Defaults.WeldEpsilon = std::stof(argv[++i]);
+		}
+		else if (Argument == "--cluster" && HasValue)
+		{
+			Defaults.ClusterTriangles = std::stoul(argv[++i]);
+		}
+		else if (Argument == "--compress-textures")
+		{
+			TextureDefaults.Compress = true;
+		}
+		else if (Argument == "--texture-usage" && HasValue)
+		{
+			std::string_view Usage = argv[++i];
+			TextureDefaults.Usage  = Usage == "normal" ? Asset::TextureUsage::Normal : (Usage == "mask" ? Asset::TextureUsage::Mask : Asset::TextureUsage::Color);
+		}
+		else if (Argument == "--texture-quality" && HasValue)
+		{
+			std::string_view Quality = argv[++i];
+			TextureDefaults.Quality	 = Quality == "fast" ? Asset::TextureQuality::Fast : (Quality == "high" ? Asset::TextureQuality::High : Asset::TextureQuality::Normal);
+		}
+		else if (Argument == "--mip-filter" && HasValue)
+		{
+			TextureDefaults.Filter = std::string_view(argv[++i]) == "kaiser" ? Asset::MipFilter::Kaiser : Asset::MipFilter::Box;
+		}
+		else if (Argument == "--cubemap")
+		{
+			TextureDefaults.ConvertToCubemap = true;
+		}
+		else if (Argument == "--benchmark-obj")
+		{
+			BenchmarkObj = true;
+		}
+		else if (Argument == "--benchmark-weld")
+		{
+			BenchmarkWeld = true;
+		}
+		else if (Argument == "--benchmark-culling")
+		{
+			BenchmarkCulling = true;
+		}
+		else if (Argument == "--benchmark-textures")
+		{
+			BenchmarkTextures = true;
+		}
+		else if (Argument == "--benchmark-decode")
+		{
+			BenchmarkDecode = true;
+		}
+		else if (Argument == "--test-sky" && HasValue)
+		{
+			NumSkySamples = std::max(std::stoul(argv[++i]), 1ul);
+		}
+		else
+		{
+			KAGUYA_LOG(Cooker, Error, "Unknown argument {}", Argument);
+			return 1;
+		}
+	}
+
+	Asset::MeshImporter	   Importer;
+	Asset::TextureImporter TextureImporter;
+	Asset::AssetCache	   Cache(Output);
+
+	// Textures of a directory are cooked with the texture options of the command line
+	std::vector<CookResult>					 Results;
+	std::vector<Asset::TextureImportOptions> Textures;
+	if (is_directory(Input))
+	{
+		for (const auto& Entry : std::filesystem::recursive_directory_iterator(Input))
+		{
+			if (Entry.is_regular_file() && Importer.SupportsExtension(Entry.path()))
+			{
+				CookResult& Result	 = Results.emplace_back();
+				Result.Options		 = Defaults;
+				Result.Options.Path	 = Entry.path();
+			}
+			else if (Entry.is_regular_file() && TextureImporter.SupportsExtension(Entry.path()))
+			{
+				Asset::TextureImportOptions& Options = Textures.emplace_back(TextureDefaults);
+				Options.Path						 = Entry.path();
+			}
+		}
+	}
+	else
+	{
+		for (const auto& Options : WorldArchive::GetMeshImportOptions(Input))
+		{
+			Results.emplace_back().Options = Options;
+		}
+		Textures = WorldArchive::GetTextureImportOptions(Input);
+	}
+	std::ranges::sort(Textures, {}, &Asset::TextureImportOptions::Path);
+	for (auto& Result : Results)
+	{
+		Result.Options.BenchmarkCulling = BenchmarkCulling;
+	}
+
+	// WIC decodes BMP/GIF/TIFF (and everything else for --benchmark-decode) through COM, on any thread of the process
+	if (!Textures.empty() && FAILED(CoInitializeEx(nullptr, COINIT_MULTITHREADED)))
+	{
+		KAGUYA_LOG(Cooker, Error, "CoInitializeEx failed, textures cannot be decoded");
+		return 1;
+	}
+
+	if (BenchmarkDecode)
+	{
+		for (const auto& Options : Textures)
+		{
+			Asset::TextureImporter::BenchmarkDecode(Options);
+		}
+		return 0;
+	}
+
+	if (NumSkySamples > 0)
+	{
+		for (const auto& Options : Textures)
+		{
+			TextureImporter.TestSkySampler(Cache, Options, NumSkySamples);
+		}
+		return 0;
+	}
+
+	if (BenchmarkTextures)
+	{
+		for (const auto& Options : Textures)
+		{
+			TextureImporter.Benchmark(Cache, Options);
+		}
+		return 0;
+	}
+	std::ranges::sort(
+		Results,
+		[](const CookResult& a, const CookResult& b)
+		{
+			return a.Options.Path < b.Options.Path;
+		});
+
+	if (BenchmarkObj)
+	{
+		for (const auto& Result : Results)
+		{
+			if (Result.Options.Path.extension() == L".obj")
+			{
+				Asset::MeshImporter::BenchmarkObj(Result.Options.Path);
+			}
+		}
+		return 0;
+	}
+
+	if (BenchmarkWeld)
+	{
+		bool Matched = true;
+		for (const auto& Result : Results)
+		{
+			Matched &= Asset::MeshImporter::BenchmarkWeld(Result.Options.Path, Result.Options.WeldEpsilon);
+		}
+		return Matched ? 0 : 1;
+	}
+
+	ScopedTimer Timer(
+		[&](i64 Milliseconds)
+		{
+			size_t NumCooked = std::ranges::count(Results, CookStatus::Cooked, &CookResult::Status);
+			size_t NumFailed = std::ranges::count(Results, CookStatus::Failed, &CookResult::Status);
+			KAGUYA_LOG(
+				Cooker,
+				Info,
+				"{} files in {}ms with {} jobs: {} cooked, {} up to date, {} failed, peak working set {} MiB",
+				Results.size(),
+				Milliseconds,
+				NumJobs,
+				NumCooked,
+				Results.size() - NumCooked - NumFailed,
+				NumFailed,
+				Process::GetPeakWorkingSetSizeInBytes() >> 20);
+		});
+
+	// Keys hash the source files, a file referenced twice with the same options is only cooked once
+	ParallelFor(
+		Process::GetThreadPool(),
+		Results.size(),
+		[&](size_t i)
+		{
+			Results[i].Key = Asset::MeshImporter::GetCacheKey(Cache, Results[i].Options);
+		});
+	std::erase_if(
+		Results,
+		[Seen = std::set<u64>()](const CookResult& Result) mutable
+		{
+			// Unreadable sources all have NoKey, each of them fails on its own
+			return Result.Key != Asset::AssetCache::NoKey && !Seen.insert(Result.Key).second;
+		});
+
+	// Files are cooked by dedicated threads so that each file's own ParallelFor over its meshes can use the whole pool
+	std::atomic<size_t> Next = 0;
+	{
+		std::vector<std::jthread> Workers;
+		for (u32 i = 0; i < std::min<size_t>(NumJobs, Results.size()); ++i)
+		{
+			Workers.emplace_back(
+				[&]
+				{
+					for (size_t j = Next++; j < Results.size(); j = Next++)
+					{
+						CookResult& Result = Results[j];
+						Cook(Importer, Cache, Result);
+						KAGUYA_LOG(
+							Cooker,
+							Info,
+							"{} {} -> {} ({} meshes, {} KiB) in {}ms",
+							ToString(Result.Status),
+							Result.Options.Path.string(),
+							Result.BinaryPath.filename().string(),
+							Result.NumMeshes,
+							Result.SizeInBytes >> 10,
+							Result.Milliseconds);
+					}
+				});
+		}
+	}
+
+	size_t NumFailedTextures = CookTextures(TextureImporter, Cache, Textures, NumJobs);
+
+	WriteManifest(Output / "Manifest.json", Results);
+
+	bool Failed = std::ranges::any_of(
+		Results,
+		[](const CookResult& Result)
+		{
+			return Result.Status == CookStatus::Failed;
+		});
+	return Failed || NumFailedTextures > 0 ? 1 : 0;
+}
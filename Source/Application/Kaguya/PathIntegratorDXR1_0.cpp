@@ -26,7 +26,7 @@ PathIntegratorDXR1_0::PathIntegratorDXR1_0(
 
 	LocalHitGroupRS = Device->CreateRootSignature(
 		RHI::RootSignatureDesc()
-			.Add32BitConstants(0, 1, 1)
+			.Add32BitConstants(0, 1, 2)
 			.AddShaderResourceView(0, 1)
 			.AddShaderResourceView(1, 1)
 			.AsLocalRootSignature());
@@ -118,7 +118,7 @@ void PathIntegratorDXR1_0::Render(World* World, WorldRenderView* WorldRenderView
 					RHI::D3D12RaytracingShaderTable<RootArgument>::Record Record = {};
 					Record.ShaderIdentifier										 = g_DefaultSID;
 					Record.RootArguments.MaterialIndex							 = static_cast<UINT>(i);
-					Record.RootArguments.Padding								 = 0xDEADBEEF;
+					Record.RootArguments.IndexStride							 = Instance.Geometry->GetIndexFormatAt(j) == DXGI_FORMAT_R16_UINT ? 2 : 4;
 					Record.RootArguments.VertexBuffer							 = Instance.Geometry->GetVertexBufferAt(j);
 					Record.RootArguments.IndexBuffer							 = Instance.Geometry->GetIndexBufferAt(j);
 
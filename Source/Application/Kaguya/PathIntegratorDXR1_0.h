@@ -39,7 +39,7 @@ private:
 	struct RootArgument
 	{
 		UINT64					  MaterialIndex : 32;
-		UINT64					  Padding		: 32;
+		UINT64					  IndexStride	: 32;
 		D3D12_GPU_VIRTUAL_ADDRESS VertexBuffer;
 		D3D12_GPU_VIRTUAL_ADDRESS IndexBuffer;
 	};
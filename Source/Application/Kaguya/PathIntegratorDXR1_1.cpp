@@ -61,6 +61,7 @@ void PathIntegratorDXR1_1::RenderOptions()
 void PathIntegratorDXR1_1::Render(World* World, WorldRenderView* WorldRenderView, RHI::D3D12CommandContext& Context)
 {
 	WorldRenderView->Update(World, &RTScene);
+	World->AcquireAssets(*World->ActiveSkyLight);
 	if (World->WorldState & EWorldState::EWorldState_Update)
 	{
 		World->WorldState = EWorldState_Render;
@@ -17,6 +17,7 @@
 cbuffer RootConstants : register(b0, space1)
 {
 	uint MaterialIndex;
+	uint IndexStride; // 2 or 4 bytes
 };
 
 StructuredBuffer<Vertex> VertexBuffer : register(t0, space1);
@@ -30,12 +31,18 @@ struct VertexAttributes
 	float2 uv;
 };
 
+uint FetchIndex(uint i)
+{
+	// 16-bit indices are packed two per element
+	return IndexStride == 2 ? (IndexBuffer[i >> 1] >> ((i & 1) * 16)) & 0xffff : IndexBuffer[i];
+}
+
 VertexAttributes GetVertexAttributes(BuiltInTriangleIntersectionAttributes Attributes)
 {
 	// Fetch indices
-	uint idx0 = IndexBuffer[PrimitiveIndex() * 3 + 0];
-	uint idx1 = IndexBuffer[PrimitiveIndex() * 3 + 1];
-	uint idx2 = IndexBuffer[PrimitiveIndex() * 3 + 2];
+	uint idx0 = FetchIndex(PrimitiveIndex() * 3 + 0);
+	uint idx1 = FetchIndex(PrimitiveIndex() * 3 + 1);
+	uint idx2 = FetchIndex(PrimitiveIndex() * 3 + 2);
 
 	// Fetch vertices
 	Vertex vtx0 = VertexBuffer[idx0];
@@ -64,13 +64,25 @@ struct VertexAttributes
 	float2 uv;
 };
 
+uint3 LoadIndices(ByteAddressBuffer IndexBuffer, uint IndexStride, uint PrimitiveIndex)
+{
+	if (IndexStride == 2)
+	{
+		// Loads must be 4 byte aligned, a triangle of 16-bit indices starts at either half of a dword
+		uint  Offset = PrimitiveIndex * 6;
+		uint2 Words	 = IndexBuffer.Load2(Offset & ~3);
+		return (Offset & 2) ? uint3(Words.x >> 16, Words.y & 0xffff, Words.y >> 16) : uint3(Words.x & 0xffff, Words.x >> 16, Words.y & 0xffff);
+	}
+	return IndexBuffer.Load<uint3>(PrimitiveIndex * sizeof(uint3));
+}
+
 VertexAttributes GetVertexAttributes(Mesh Mesh, RaytracingAttributes Attributes)
 {
 	ByteAddressBuffer IndexBuffer = HLSL_BYTEADDRESSBUFFER(Mesh.IndexView);
 	ByteAddressBuffer VertexBuffer = HLSL_BYTEADDRESSBUFFER(Mesh.VertexView);
 
 	// Fetch indices
-	uint3 indices = IndexBuffer.Load<uint3>(Attributes.PrimitiveIndex * sizeof(uint3));
+	uint3 indices = LoadIndices(IndexBuffer, Mesh.IndexStride, Attributes.PrimitiveIndex);
 	uint  idx0	  = indices[0];
 	uint  idx1	  = indices[1];
 	uint  idx2	  = indices[2];
@@ -77,7 +77,7 @@ struct Mesh
 	unsigned int NumMeshlets;
 	unsigned int VertexView;
 	unsigned int IndexView;
-	unsigned int DEADBEEF2;
+	unsigned int IndexStride; // 2 or 4 bytes
 };
 
 // ==================== Camera ====================
@@ -37,6 +37,15 @@ void AssetWindow::OnRender()
 			if (ImGui::BeginPopupModal("Mesh Options", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
 			{
 				ImGui::Checkbox("Generate Meshlets", &MeshOptions.GenerateMeshlets);
+				ImGui::InputFloat("Weld Epsilon", &MeshOptions.WeldEpsilon, 0.0f, 0.0f, "%.6f");
+				ImGui::InputScalar("Cluster Triangles", ImGuiDataType_U32, &MeshOptions.ClusterTriangles);
+				ImGui::Checkbox("Optimize Vertex Cache", &MeshOptions.OptimizeVertexCache);
+				ImGui::Checkbox("Optimize Overdraw", &MeshOptions.OptimizeOverdraw);
+				ImGui::Checkbox("Compress Vertices", &MeshOptions.CompressVertices);
+				ImGui::Checkbox("Compress Indices", &MeshOptions.CompressIndices);
+				ImGui::SliderInt("LODs", reinterpret_cast<int*>(&MeshOptions.NumLods), 0, Asset::MeshSimplifier::MaxLods);
+				ImGui::SliderFloat("LOD Ratio", &MeshOptions.LodRatio, 0.05f, 0.95f);
+				ImGui::SliderFloat("LOD Max Error", &MeshOptions.LodMaxError, 0.0f, 0.1f, "%.4f");
 
 				ImGui::InputFloat3("Translation", MeshOptions.Translation.data());
 				ImGui::InputFloat3("Rotation", MeshOptions.Rotation.data());
@@ -57,7 +66,7 @@ void AssetWindow::OnRender()
 					MeshOptions.Path = FileSystem::OpenDialog(ComDlgFS);
 					if (!MeshOptions.Path.empty())
 					{
-						Kaguya::AssetManager->LoadMesh(MeshOptions);
+						Kaguya::AssetManager->LoadMeshAsync(MeshOptions);
 					}
 
 					MeshOptions = {};
@@ -84,6 +93,15 @@ void AssetWindow::OnRender()
 			if (ImGui::BeginPopupModal("Meshes Options", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
 			{
 				ImGui::Checkbox("Generate Meshlets", &MeshOptions.GenerateMeshlets);
+				ImGui::InputFloat("Weld Epsilon", &MeshOptions.WeldEpsilon, 0.0f, 0.0f, "%.6f");
+				ImGui::InputScalar("Cluster Triangles", ImGuiDataType_U32, &MeshOptions.ClusterTriangles);
+				ImGui::Checkbox("Optimize Vertex Cache", &MeshOptions.OptimizeVertexCache);
+				ImGui::Checkbox("Optimize Overdraw", &MeshOptions.OptimizeOverdraw);
+				ImGui::Checkbox("Compress Vertices", &MeshOptions.CompressVertices);
+				ImGui::Checkbox("Compress Indices", &MeshOptions.CompressIndices);
+				ImGui::SliderInt("LODs", reinterpret_cast<int*>(&MeshOptions.NumLods), 0, Asset::MeshSimplifier::MaxLods);
+				ImGui::SliderFloat("LOD Ratio", &MeshOptions.LodRatio, 0.05f, 0.95f);
+				ImGui::SliderFloat("LOD Max Error", &MeshOptions.LodMaxError, 0.0f, 0.1f, "%.4f");
 
 				ImGui::InputFloat3("Translation", MeshOptions.Translation.data());
 				ImGui::InputFloat3("Rotation", MeshOptions.Rotation.data());
@@ -107,7 +125,7 @@ void AssetWindow::OnRender()
 						MeshOptions.Path = Path;
 						if (!MeshOptions.Path.empty())
 						{
-							Kaguya::AssetManager->LoadMesh(MeshOptions);
+							Kaguya::AssetManager->LoadMeshAsync(MeshOptions);
 						}
 					}
 					MeshOptions = {};
@@ -136,6 +154,21 @@ void AssetWindow::OnRender()
 			{
 				ImGui::Checkbox("sRGB", &TextureOptions.sRGB);
 				ImGui::Checkbox("Generate Mips", &TextureOptions.GenerateMips);
+				ImGui::Checkbox("Compress", &TextureOptions.Compress);
+				ImGui::Checkbox("Convert To Cubemap", &TextureOptions.ConvertToCubemap);
+
+				const char* Filters[]	= { "Box", "Kaiser" };
+				const char* Usages[]	= { "Color", "Normal", "Mask" };
+				const char* Qualities[] = { "Fast", "Normal", "High" };
+				int			Filter		= static_cast<int>(TextureOptions.Filter);
+				int			Usage		= static_cast<int>(TextureOptions.Usage);
+				int			Quality		= static_cast<int>(TextureOptions.Quality);
+				ImGui::Combo("Mip Filter", &Filter, Filters, ARRAYSIZE(Filters));
+				ImGui::Combo("Usage", &Usage, Usages, ARRAYSIZE(Usages));
+				ImGui::Combo("Quality", &Quality, Qualities, ARRAYSIZE(Qualities));
+				TextureOptions.Filter  = static_cast<Asset::MipFilter>(Filter);
+				TextureOptions.Usage   = static_cast<Asset::TextureUsage>(Usage);
+				TextureOptions.Quality = static_cast<Asset::TextureQuality>(Quality);
 
 				if (ImGui::Button("Browse...", ImVec2(120, 0)))
 				{
@@ -146,7 +179,7 @@ void AssetWindow::OnRender()
 					TextureOptions.Path = FileSystem::OpenDialog(ComDlgFS);
 					if (!TextureOptions.Path.empty())
 					{
-						Kaguya::AssetManager->LoadTexture(TextureOptions);
+						Kaguya::AssetManager->LoadTextureAsync(TextureOptions);
 					}
 
 					TextureOptions = {};
@@ -174,6 +207,37 @@ void AssetWindow::OnRender()
 										   ImGuiTableFlags_Hideable | ImGuiTableFlags_RowBg |
 										   ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
 
+	if (size_t NumPendingLoads = Kaguya::AssetManager->GetNumPendingLoads(); NumPendingLoads > 0)
+	{
+		ImGui::Text("Loading %zu files...", NumPendingLoads);
+	}
+
+	if (ImGui::TreeNode("Budget"))
+	{
+		// In MiB, 0 is unlimited
+		const Asset::AssetResidency& Residency = Kaguya::AssetManager->GetResidency();
+		Asset::AssetBudget			 Budget	   = Residency.Budget;
+		int							 CpuBudget = static_cast<int>(Budget.CpuSizeInBytes >> 20);
+		int							 GpuBudget = static_cast<int>(Budget.GpuSizeInBytes >> 20);
+		bool						 Changed   = ImGui::InputInt("CPU (MiB)", &CpuBudget);
+		Changed |= ImGui::InputInt("GPU (MiB)", &GpuBudget);
+		if (Changed)
+		{
+			Budget.CpuSizeInBytes = static_cast<u64>(std::max(CpuBudget, 0)) << 20;
+			Budget.GpuSizeInBytes = static_cast<u64>(std::max(GpuBudget, 0)) << 20;
+			Kaguya::AssetManager->SetBudget(Budget);
+		}
+
+		const Asset::AssetFootprint& Footprint = Residency.GetFootprint();
+		ImGui::Text(
+			"%zu resident: %.2f MiB CPU, %.2f MiB GPU, %llu evictions",
+			Residency.GetNumResident(),
+			static_cast<double>(Footprint.CpuSizeInBytes) / (1024.0 * 1024.0),
+			static_cast<double>(Footprint.GpuSizeInBytes) / (1024.0 * 1024.0),
+			Residency.GetStats().NumEvictions);
+		ImGui::TreePop();
+	}
+
 	ImGui::Text("Textures");
 	if (ImGui::BeginTable("TextureRegistry", AssetTextureColumnCount, TableFlags))
 	{
@@ -204,6 +204,7 @@ void InspectorWindow::OnRender()
 				{
 					IM_ASSERT(Payload->DataSize == sizeof(Asset::AssetHandle));
 					Component.Handle = *static_cast<Asset::AssetHandle*>(Payload->Data);
+					Component.Bounds.reset();
 
 					IsEdited = true;
 				}
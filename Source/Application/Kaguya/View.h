@@ -67,7 +67,7 @@ namespace Hlsl
 		unsigned int NumMeshlets;
 		unsigned int VertexView;
 		unsigned int IndexView;
-		unsigned int DEADBEEF2 = 0xDEADBEEF;
+		unsigned int IndexStride; // 2 or 4 bytes
 	};
 	static_assert(sizeof(Mesh) == 256);
 
@@ -204,6 +204,19 @@ inline Hlsl::Camera GetHLSLCameraDesc(const CameraComponent& Camera)
 	return HlslCamera;
 }
 
+inline Math::BoundingBox GetWorldBox(const Math::BoundingBox& Bounds, const Math::Transform& Transform)
+{
+	DirectX::BoundingBox Box(
+		{ Bounds.Center.x, Bounds.Center.y, Bounds.Center.z },
+		{ Bounds.Extents.x, Bounds.Extents.y, Bounds.Extents.z });
+	Box.Transform(Box, Transform.Matrix());
+
+	Math::BoundingBox WorldBox;
+	WorldBox.Center	 = Math::Vec3f(Box.Center.x, Box.Center.y, Box.Center.z);
+	WorldBox.Extents = Math::Vec3f(Box.Extents.x, Box.Extents.y, Box.Extents.z);
+	return WorldBox;
+}
+
 struct View
 {
 	unsigned int Width, Height;
@@ -234,9 +247,24 @@ struct WorldRenderView
 			{
 				pLights[NumLights++] = GetHLSLLightDesc(Core.Transform, Light);
 			});
+
+		// Rasterization skips meshes outside of the view frustum, their assets are not acquired and age out of the residency
+		// budget. Rays are traced from everywhere, acceleration structures hold every mesh
+		std::optional<Math::Frustum> Frustum;
+		if (Camera && !RaytracingAccelerationStructure)
+		{
+			Frustum = Math::Frustum(Camera->ViewProjection);
+		}
 		World->Registry.view<CoreComponent, StaticMeshComponent>().each(
 			[&](CoreComponent& Core, StaticMeshComponent& StaticMesh)
 			{
+				if (Frustum && StaticMesh.Bounds &&
+					Frustum->Contains(GetWorldBox(*StaticMesh.Bounds, Core.Transform)) == ContainmentType::Disjoint)
+				{
+					return;
+				}
+
+				World->AcquireAssets(StaticMesh);
 				if (StaticMesh.Mesh)
 				{
 					RHI::D3D12Buffer& VertexBuffer = StaticMesh.Mesh->VertexResource;
@@ -249,9 +277,27 @@ struct WorldRenderView
 					DrawIndexedArguments.BaseVertexLocation			  = 0;
 					DrawIndexedArguments.StartInstanceLocation		  = 0;
 
+					// Rasterization draws the selected level of detail, acceleration structures always hold LOD 0
+					if (Camera && !StaticMesh.Mesh->Lods.empty())
+					{
+						const DirectX::XMFLOAT3& Scale = Core.Transform.Scale;
+						u32						 Lod   = StaticMesh.Mesh->SelectLod(
+							*Camera,
+							GetWorldBox(StaticMesh.Mesh->BoundingBox, Core.Transform),
+							static_cast<float>(View.Height),
+							LodPixelError,
+							std::max({ Scale.x, Scale.y, Scale.z }));
+						if (Lod > 0)
+						{
+							const Asset::MeshLod& Level				   = StaticMesh.Mesh->Lods[Lod - 1];
+							DrawIndexedArguments.IndexCountPerInstance = Level.NumIndices;
+							DrawIndexedArguments.StartIndexLocation	   = StaticMesh.Mesh->NumIndices + Level.IndexOffset;
+						}
+					}
+
 					Hlsl::Mesh Mesh	  = GetHLSLMeshDesc(Core.Transform);
 					Mesh.VertexBuffer = VertexBuffer.GetVertexBufferView();
-					Mesh.IndexBuffer  = IndexBuffer.GetIndexBufferView();
+					Mesh.IndexBuffer  = IndexBuffer.GetIndexBufferView(StaticMesh.Mesh->IndexFormat);
 					if (StaticMesh.Mesh->Options.GenerateMeshlets)
 					{
 						Mesh.Meshlets			 = StaticMesh.Mesh->MeshletResource.GetGpuVirtualAddress();
@@ -264,6 +310,7 @@ struct WorldRenderView
 					Mesh.NumMeshlets		  = StaticMesh.Mesh->NumMeshlets;
 					Mesh.VertexView			  = StaticMesh.Mesh->VertexView.GetIndex();
 					Mesh.IndexView			  = StaticMesh.Mesh->IndexView.GetIndex();
+					Mesh.IndexStride		  = StaticMesh.Mesh->IndexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4;
 
 					pMaterial[NumMaterials] = GetHLSLMaterialDesc(StaticMesh.Material);
 					pMeshes[NumMeshes]		= Mesh;
@@ -295,4 +342,7 @@ struct WorldRenderView
 	// Set explicitly
 	View			 View	= {};
 	CameraComponent* Camera = nullptr;
+
+	// Largest screen space error, in pixels, of the level of detail meshes are drawn with
+	float LodPixelError = 1.0f;
 };
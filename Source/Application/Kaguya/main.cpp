@@ -127,6 +127,7 @@ public:
 		RHI::D3D12CommandContext& Context = Kaguya::Device->GetLinkedDevice()->GetGraphicsContext();
 
 		Kaguya::Device->OnBeginFrame();
+		Kaguya::AssetManager->Update();
 		Context.Open();
 		Stopwatch.Signal();
 		DeltaTime = static_cast<float>(Stopwatch.GetDeltaTime());
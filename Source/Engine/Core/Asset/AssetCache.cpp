@@ -0,0 +1,90 @@
+#include "AssetCache.h"
+#include "AssetImporter.h"
+#include <fstream>
+
+namespace Asset
+{
+	AssetCache::AssetCache(std::filesystem::path Directory)
+		: Directory(std::move(Directory))
+	{
+		std::filesystem::create_directories(this->Directory);
+	}
+
+	AssetCache::~AssetCache()
+	{
+		KAGUYA_LOG(Asset, Info, "Asset cache {}: {} hits, {} misses", Directory.string(), NumHits.load(), NumMisses.load());
+	}
+
+	u64 AssetCache::HashFile(const std::filesystem::path& Path)
+	{
+		MemoryMappedFile File(Path);
+		return Hash::Hash64(File.GetBaseAddress(), File.GetSizeInBytes());
+	}
+
+	u64 AssetCache::HashSource(const std::filesystem::path& Path) const
+	{
+		// Written as is next to the cooked files, one per source
+		struct SourceStamp
+		{
+			u64 SizeInBytes;
+			i64 WriteTime;
+			u64 Hash;
+		};
+
+		std::error_code Error;
+		SourceStamp		Current = {};
+		Current.SizeInBytes		= file_size(Path, Error);
+		if (Error)
+		{
+			return NoKey;
+		}
+		Current.WriteTime = last_write_time(Path, Error).time_since_epoch().count();
+		if (Error)
+		{
+			return NoKey;
+		}
+
+		std::wstring		  Source	= absolute(Path, Error).wstring();
+		std::filesystem::path StampPath = Directory / std::format("{:016x}.stamp", Hash::Hash64(Source.data(), Source.size() * sizeof(wchar_t)));
+
+		// A stamp that is being written by another thread fails to read and is written again
+		SourceStamp Stamp = {};
+		if (std::ifstream Stream(StampPath, std::ios::binary);
+			Stream.read(reinterpret_cast<char*>(&Stamp), sizeof(Stamp)) && Stamp.SizeInBytes == Current.SizeInBytes && Stamp.WriteTime == Current.WriteTime)
+		{
+			return Stamp.Hash;
+		}
+
+		try
+		{
+			Current.Hash = HashFile(Path);
+		}
+		catch (const ExceptionIO&)
+		{
+			return NoKey;
+		}
+		std::ofstream(StampPath, std::ios::binary).write(reinterpret_cast<const char*>(&Current), sizeof(Current));
+		return Current.Hash;
+	}
+
+	std::filesystem::path AssetCache::GetPath(u64 Key, std::string_view Extension) const
+	{
+		return Directory / std::format("{:016x}{}", Key, Extension);
+	}
+
+	bool AssetCache::Lookup(u64 Key, std::string_view Extension, std::filesystem::path& Path)
+	{
+		Path		= GetPath(Key, Extension);
+		bool Exists = exists(Path);
+		(Exists ? NumHits : NumMisses)++;
+		return Exists;
+	}
+
+	void AssetCache::Invalidate(const std::filesystem::path& Path)
+	{
+		--NumHits;
+		++NumMisses;
+		std::error_code Error;
+		std::filesystem::remove(Path, Error);
+	}
+} // namespace Asset
@@ -0,0 +1,43 @@
+#pragma once
+#include "System/System.h"
+
+namespace Asset
+{
+	// Cooked assets keyed on a hash of everything that produced them (source contents, import options, format version).
+	// Entries are never overwritten in place, a changed input produces a new key
+	class AssetCache
+	{
+	public:
+		explicit AssetCache(std::filesystem::path Directory);
+		~AssetCache();
+
+		// Key of a source that has no content hash, e.g. because it does not exist. Never found in the cache
+		static constexpr u64 NoKey = 0;
+
+		// Hashes the contents of a file
+		[[nodiscard]] static u64 HashFile(const std::filesystem::path& Path);
+
+		// Content hash of a source file, or NoKey if it cannot be read. The hash is stored in the cache along with the size
+		// and write time of the file, it is only computed again once either of them changes
+		[[nodiscard]] u64 HashSource(const std::filesystem::path& Path) const;
+
+		[[nodiscard]] const std::filesystem::path& GetDirectory() const noexcept { return Directory; }
+
+		[[nodiscard]] std::filesystem::path GetPath(u64 Key, std::string_view Extension) const;
+
+		// Returns the path of the entry for Key and whether it exists, counting the lookup as a hit or a miss
+		[[nodiscard]] bool Lookup(u64 Key, std::string_view Extension, std::filesystem::path& Path);
+
+		// An entry that was found but could not be used (corrupt, stale format) turns a hit into a miss
+		void Invalidate(const std::filesystem::path& Path);
+
+		[[nodiscard]] u64 GetNumHits() const noexcept { return NumHits; }
+		[[nodiscard]] u64 GetNumMisses() const noexcept { return NumMisses; }
+
+	private:
+		std::filesystem::path Directory;
+
+		std::atomic<u64> NumHits   = 0;
+		std::atomic<u64> NumMisses = 0;
+	};
+} // namespace Asset
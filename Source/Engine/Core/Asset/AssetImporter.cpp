@@ -1,5 +1,10 @@
 #include "AssetImporter.h"
 #include "AssetManager.h"
+#include "IndexCodec.h"
+#include "ObjParser.h"
+#include "GltfParser.h"
+#include "VertexWelder.h"
+#include "MeshClusterer.h"
 
 #ifdef min
 #undef min
@@ -12,303 +17,2064 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <fstream>
+#include <numeric>
+#include <nlohmann/json.hpp>
+
 DEFINE_LOG_CATEGORY(Asset);
 
 namespace Asset
 {
-	static constexpr char AssetExtension[] = ".asset";
-
 	MeshImporter::MeshImporter()
 	{
 		SupportedExtensions.insert(L".fbx");
 		SupportedExtensions.insert(L".obj");
+		SupportedExtensions.insert(L".gltf");
+		SupportedExtensions.insert(L".glb");
 	}
 
-	std::vector<AssetHandle> MeshImporter::Import(AssetManager* AssetManager, const MeshImportOptions& Options)
+	// Matches SupportsExtension, which is case sensitive as well
+	static bool IsObjFile(const std::filesystem::path& Path)
+	{
+		return Path.extension() == L".obj";
+	}
+
+	static bool IsGltfFile(const std::filesystem::path& Path)
 	{
-		std::filesystem::path BinaryPath = Options.Path;
-		BinaryPath.replace_extension(AssetExtension);
+		return Path.extension() == L".gltf" || Path.extension() == L".glb";
+	}
 
-		std::vector<Mesh*> Meshes;
-		if (exists(BinaryPath))
+	// Which reader cooks Path, versioned so a change to one only invalidates its own files
+	static u8 GetParserVersion(const std::filesystem::path& Path)
+	{
+		if (IsObjFile(Path))
 		{
-			Meshes = ImportExisting(AssetManager, BinaryPath, Options);
+			return ObjParser::Version;
 		}
-		else
+		if (IsGltfFile(Path))
 		{
-			const auto Path = Options.Path.string();
+			return GltfParser::Version;
+		}
+		return 0;
+	}
 
-			Assimp::Importer   Importer;
-			constexpr uint32_t ImporterFlags =
-				aiProcess_ConvertToLeftHanded |
-				aiProcess_JoinIdenticalVertices |
-				aiProcess_Triangulate |
-				aiProcess_SortByPType |
-				aiProcess_GenNormals |
-				aiProcess_GenUVCoords |
-				aiProcess_OptimizeMeshes |
-				aiProcess_ValidateDataStructure;
-			const aiScene* paiScene = Importer.ReadFile(Path.data(), ImporterFlags);
+	// Everything in MeshImportOptions that affects the cooked output, Translation/Rotation/UniformScale are folded into Matrix.
+	// The file name is included because unnamed meshes are named after it
+	static u64 HashImportOptions(const MeshImportOptions& Options)
+	{
+		struct
+		{
+			u32					Version;
+			u8					GenerateMeshlets;
+			u8					OptimizeVertexCache;
+			u8					OptimizeOverdraw;
+			u8					CompressVertices;
+			u8					CompressIndices;
+			u8					Parser; // Version of the native reader, 0 for assimp
+			u8					Padding[2];
+			u32					NumLods;
+			f32					LodRatio;
+			f32					LodMaxError;
+			f32					WeldEpsilon;
+			u32					ClusterTriangles;
+			DirectX::XMFLOAT4X4 Matrix;
+		} Key = {
+			.Version			 = MeshArchive::Version,
+			.GenerateMeshlets	 = Options.GenerateMeshlets,
+			.OptimizeVertexCache = Options.OptimizeVertexCache,
+			.OptimizeOverdraw	 = Options.OptimizeOverdraw,
+			.CompressVertices	 = Options.CompressVertices,
+			.CompressIndices	 = Options.CompressIndices,
+			.Parser				 = GetParserVersion(Options.Path),
+			.Padding			 = {},
+			.NumLods			 = Options.NumLods,
+			.LodRatio			 = Options.NumLods > 0 ? Options.LodRatio : 0.0f,
+			.LodMaxError		 = Options.NumLods > 0 ? Options.LodMaxError : 0.0f,
+			.WeldEpsilon		 = std::max(Options.WeldEpsilon, 0.0f),
+			.ClusterTriangles	 = Options.ClusterTriangles,
+			.Matrix				 = Options.Matrix,
+		};
 
-			if (!paiScene || !paiScene->HasMeshes())
+		std::string FileName = Options.Path.filename().string();
+		return Hash::Combine(Hash::Hash64(&Key, sizeof(Key)), Hash::Hash64(FileName.data(), FileName.size()));
+	}
+
+	u64 MeshImporter::GetCacheKey(const AssetCache& Cache, const MeshImportOptions& Options)
+	{
+		u64 SourceHash = Cache.HashSource(Options.Path);
+		if (SourceHash == AssetCache::NoKey)
+		{
+			return AssetCache::NoKey;
+		}
+		u64 Key = Hash::Combine(SourceHash, HashImportOptions(Options));
+
+		// A .gltf may keep its buffers and images in other files, missing ones hash to NoKey
+		if (IsGltfFile(Options.Path))
+		{
+			for (const auto& Dependency : GltfParser::GetDependencies(Options.Path))
 			{
-				KAGUYA_LOG(Asset, Error, "{} error: {}", __FUNCTION__, Importer.GetErrorString());
-				__debugbreak();
-				return {};
+				Key = Hash::Combine(Key, Cache.HashSource(Dependency));
 			}
+		}
+		return Key;
+	}
 
-			Meshes.reserve(paiScene->mNumMeshes);
-			for (unsigned m = 0; m < paiScene->mNumMeshes; ++m)
-			{
-				// Assimp object
-				const aiMesh* paiMesh = paiScene->mMeshes[m];
+	static i64 TicksToMilliseconds(i64 Ticks)
+	{
+		return Ticks * 1000 / Stopwatch::Frequency;
+	}
 
-				// Parse vertex data
-				std::vector<Vertex> Vertices;
-				Vertices.reserve(paiMesh->mNumVertices);
-				for (unsigned int v = 0; v < paiMesh->mNumVertices; ++v)
-				{
-					Vertex& vertex = Vertices.emplace_back();
-					// Position
-					vertex.Position = { paiMesh->mVertices[v].x, paiMesh->mVertices[v].y, paiMesh->mVertices[v].z };
+	static f64 GetMegabytesPerSecond(u64 SizeInBytes, i64 Ticks)
+	{
+		return static_cast<f64>(SizeInBytes) / 1e6 * static_cast<f64>(Stopwatch::Frequency) / static_cast<f64>(std::max<i64>(Ticks, 1));
+	}
 
-					// Texture coords
-					if (paiMesh->HasTextureCoords(0))
-					{
-						vertex.TextureCoord = { paiMesh->mTextureCoords[0][v].x, paiMesh->mTextureCoords[0][v].y };
-					}
+	constexpr u32 ImporterFlags =
+		aiProcess_ConvertToLeftHanded |
+		aiProcess_Triangulate |
+		aiProcess_SortByPType |
+		aiProcess_GenNormals |
+		aiProcess_GenUVCoords |
+		aiProcess_OptimizeMeshes |
+		aiProcess_ValidateDataStructure;
 
-					// Normal
-					if (paiMesh->HasNormals())
-					{
-						vertex.Normal = { paiMesh->mNormals[v].x, paiMesh->mNormals[v].y, paiMesh->mNormals[v].z };
-					}
-				}
+	// Accumulated thread time of the per-mesh stages, these run concurrently so they can exceed the wall time
+	struct MeshImportStageTimes
+	{
+		std::atomic<i64> Convert   = 0;
+		std::atomic<i64> Weld	   = 0;
+		std::atomic<i64> Transform = 0;
+		std::atomic<i64> Optimize  = 0;
+		std::atomic<i64> Meshlets  = 0;
+		std::atomic<i64> Compress  = 0;
+		std::atomic<i64> Lods	   = 0;
 
-				DirectX::XMMATRIX Matrix = XMLoadFloat4x4(&Options.Matrix);
-				XMVector3TransformCoordStream(
-					&Vertices[0].Position,
-					sizeof(Vertex),
-					&Vertices[0].Position,
-					sizeof(Vertex),
-					Vertices.size(),
-					Matrix);
-
-				XMVector3TransformNormalStream(
-					&Vertices[0].Normal,
-					sizeof(Vertex),
-					&Vertices[0].Normal,
-					sizeof(Vertex),
-					Vertices.size(),
-					Matrix);
-
-				// Parse index data
-				std::vector<u32> Indices;
-				Indices.reserve(static_cast<size_t>(paiMesh->mNumFaces) * 3);
-				std::span Faces = { paiMesh->mFaces, paiMesh->mNumFaces };
-				for (const auto& Face : Faces)
-				{
-					Indices.push_back(Face.mIndices[0]);
-					Indices.push_back(Face.mIndices[1]);
-					Indices.push_back(Face.mIndices[2]);
-				}
+		// Meshlet culling benchmark
+		std::atomic<u64> NumMeshlets	  = 0;
+		std::atomic<u64> NumFrustumCulled = 0;
+		std::atomic<u64> NumConeCulled	  = 0;
+		std::atomic<i64> Cull			  = 0;
 
-				Mesh* Asset	   = Meshes.emplace_back(AssetManager->CreateAsset<Mesh>());
-				Asset->Options = Options;
-				if (paiMesh->mName.length == 0)
-				{
-					Asset->Name = Options.Path.filename().string();
-				}
-				else
-				{
-					Asset->Name = paiMesh->mName.C_Str();
-				}
+		// Simplification time of every level
+		std::atomic<i64> LodTimes[MeshSimplifier::MaxLods] = {};
 
-				Asset->Vertices = std::move(Vertices);
-				Asset->Indices	= std::move(Indices);
+		// Index codec, decode is timed on the verification pass when cooking and on load otherwise. Compress only times the
+		// vertices
+		std::atomic<u64> IndexBytes		   = 0;
+		std::atomic<u64> EncodedIndexBytes = 0;
+		std::atomic<i64> EncodeIndices	   = 0;
+		std::atomic<i64> DecodeIndices	   = 0;
 
-				if (Options.GenerateMeshlets)
-				{
-					std::vector<DirectX::XMFLOAT3> Positions;
-					Positions.reserve(Asset->Vertices.size());
-					for (const auto& Vertex : Asset->Vertices)
-					{
-						Positions.emplace_back(Vertex.Position);
-					}
+		// Vertex welding, meshes are welded one after another
+		u64 NumVerticesBeforeWeld = 0;
+		u64 NumVerticesAfterWeld  = 0;
 
-					ComputeMeshlets(
-						Asset->Indices.data(),
-						Asset->Indices.size() / 3,
-						Positions.data(),
-						Positions.size(),
-						nullptr,
-						Asset->Meshlets,
-						Asset->UniqueVertexIndices,
-						Asset->PrimitiveIndices);
-				}
+		// Clustering of oversized meshes, which are split one after another as well
+		MeshClusterStats	 Clusters;
+		MeshClusterCullStats ClusterCulling;
+	};
+
+	// Only cooks time the encoder, loads report the decoder alone
+	static void LogIndexCompression(const std::filesystem::path& Path, const MeshImportStageTimes& StageTimes)
+	{
+		const f64 DecodeSeconds = static_cast<f64>(std::max<i64>(StageTimes.DecodeIndices, 1)) / static_cast<f64>(Stopwatch::Frequency);
+		const f64 EncodeSeconds = static_cast<f64>(std::max<i64>(StageTimes.EncodeIndices, 1)) / static_cast<f64>(Stopwatch::Frequency);
+
+		std::string Encode;
+		if (StageTimes.EncodeIndices > 0)
+		{
+			Encode = std::format(", encode {:.1f} MB/s per thread", static_cast<f64>(StageTimes.IndexBytes) / EncodeSeconds / 1e6);
+		}
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} index compression: {} KiB -> {} KiB ({:.2f} bits/triangle){}, decode {:.2f} GB/s per thread",
+			Path.filename().string(),
+			StageTimes.IndexBytes >> 10,
+			StageTimes.EncodedIndexBytes >> 10,
+			static_cast<f64>(StageTimes.EncodedIndexBytes * 8) / static_cast<f64>(std::max<u64>(StageTimes.IndexBytes / (3 * sizeof(u32)), 1)),
+			Encode,
+			static_cast<f64>(StageTimes.IndexBytes) / DecodeSeconds / 1e9);
+	}
+
+	// Whether Decoded holds the triangles of Indices in the same order, the index codec may rotate a triangle but keeps its
+	// winding
+	static bool IsSameTriangleList(Span<const u32> Indices, Span<const u32> Decoded)
+	{
+		if (Indices.size() != Decoded.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i + 2 < Indices.size(); i += 3)
+		{
+			u32 a = Indices[i + 0], b = Indices[i + 1], c = Indices[i + 2];
+			u32 x = Decoded[i + 0], y = Decoded[i + 1], z = Decoded[i + 2];
+			if (!(a == x && b == y && c == z) && !(a == y && b == z && c == x) && !(a == z && b == x && c == y))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static void BenchmarkMeshletCulling(const Mesh* Asset, MeshImportStageTimes& StageTimes)
+	{
+		MeshletCullStats Stats = MeshletCulling::Benchmark(Asset->MeshletCullData, Asset->BoundingBox);
+		StageTimes.NumMeshlets += Stats.NumMeshlets;
+		StageTimes.NumFrustumCulled += Stats.NumFrustumCulled;
+		StageTimes.NumConeCulled += Stats.NumConeCulled;
+		StageTimes.Cull += Stats.Ticks;
+	}
+
+	static void LogMeshletCulling(const std::filesystem::path& Path, const MeshImportStageTimes& StageTimes)
+	{
+		const f64 NumMeshlets = static_cast<f64>(std::max<u64>(StageTimes.NumMeshlets, 1));
+		const f64 Seconds	  = static_cast<f64>(std::max<i64>(StageTimes.Cull, 1)) / static_cast<f64>(Stopwatch::Frequency);
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} meshlet culling over 6 views: {} meshlets tested, {:.1f}% frustum culled, {:.1f}% cone culled, {:.1f}M meshlets/s per thread",
+			Path.filename().string(),
+			StageTimes.NumMeshlets.load(),
+			100.0 * static_cast<f64>(StageTimes.NumFrustumCulled) / NumMeshlets,
+			100.0 * static_cast<f64>(StageTimes.NumConeCulled) / NumMeshlets,
+			static_cast<f64>(StageTimes.NumMeshlets) / Seconds / 1e6);
+	}
+
+	// Every level is simplified from the previous one, errors are summed so they stay a maximum against LOD 0
+	static void GenerateLods(const MeshImportOptions& Options, Mesh* Asset, MeshImportStageTimes& StageTimes)
+	{
+		const u32 NumLods  = std::min(Options.NumLods, MeshSimplifier::MaxLods);
+		const f32 MaxError = Options.LodMaxError * 2.0f * Math::length(Asset->BoundingBox.Extents);
+
+		std::vector<MeshLod> Lods;
+		std::vector<u32>	 LodIndices;
+		std::vector<u32>	 Previous = Asset->Indices;
+		f32					 Error	  = 0.0f;
+		for (u32 Lod = 0; Lod < NumLods; ++Lod)
+		{
+			i64 Start = Stopwatch::GetTimestamp();
+
+			const size_t	 TargetNumIndices = static_cast<size_t>(static_cast<f32>(Previous.size() / 3) * Options.LodRatio) * 3;
+			std::vector<u32> Simplified;
+			f32				 LevelError = MeshSimplifier::Simplify(Asset->Vertices, Previous, TargetNumIndices, MaxError - Error, Simplified);
+
+			// Stop once the error budget (or locked seams and borders) keep a level from getting meaningfully coarser
+			if (Simplified.empty() || Simplified.size() * 20 > Previous.size() * 19)
+			{
+				StageTimes.Lods += Stopwatch::GetTimestamp() - Start;
+				break;
+			}
+			if (Options.OptimizeVertexCache)
+			{
+				MeshOptimizer::OptimizeFaces(Simplified);
 			}
 
-			Export(BinaryPath, Meshes);
+			Error += LevelError;
+			Lods.push_back({
+				.IndexOffset = static_cast<u32>(LodIndices.size()),
+				.NumIndices	 = static_cast<u32>(Simplified.size()),
+				.Error		 = Error,
+			});
+			LodIndices.insert(LodIndices.end(), Simplified.begin(), Simplified.end());
+			Previous = std::move(Simplified);
+
+			i64 Elapsed = Stopwatch::GetTimestamp() - Start;
+			StageTimes.Lods += Elapsed;
+			StageTimes.LodTimes[Lod] += Elapsed;
 		}
 
-		std::vector<AssetHandle> Handles;
-		Handles.reserve(Meshes.size());
+		Asset->SetLods(std::move(Lods), std::move(LodIndices));
+	}
+
+	// Triangles kept, largest error and time of every level over all meshes of a file
+	static void LogLods(const std::filesystem::path& Path, const std::vector<Mesh*>& Meshes, const MeshImportStageTimes& StageTimes)
+	{
+		u64 NumTriangles = 0;
 		for (auto Mesh : Meshes)
 		{
-			Handles.push_back(Mesh->Handle);
-			Mesh->UpdateInfo();
-			Mesh->ComputeBoundingBox();
-			AssetManager->RequestUpload(Mesh);
+			NumTriangles += Mesh->GetIndices().size() / 3;
+		}
+
+		for (u32 Lod = 0; Lod < MeshSimplifier::MaxLods; ++Lod)
+		{
+			u64 NumLodTriangles = 0, NumMeshes = 0;
+			f32 Error = 0.0f, RelativeError = 0.0f;
+			for (auto Mesh : Meshes)
+			{
+				if (Lod < Mesh->Lods.size())
+				{
+					NumLodTriangles += Mesh->Lods[Lod].NumIndices / 3;
+					NumMeshes++;
+					Error		  = std::max(Error, Mesh->Lods[Lod].Error);
+					RelativeError = std::max(RelativeError, Mesh->Lods[Lod].Error / (2.0f * Math::length(Mesh->BoundingBox.Extents)));
+				}
+			}
+			if (NumMeshes == 0)
+			{
+				break;
+			}
+
+			KAGUYA_LOG(
+				Asset,
+				Info,
+				"{} LOD {}: {} meshes, {} triangles ({:.1f}% of LOD 0), max error {} ({:.3f}% of diagonal), {}ms across threads",
+				Path.filename().string(),
+				Lod + 1,
+				NumMeshes,
+				NumLodTriangles,
+				100.0 * static_cast<f64>(NumLodTriangles) / static_cast<f64>(std::max<u64>(NumTriangles, 1)),
+				Error,
+				100.0f * RelativeError,
+				TicksToMilliseconds(StageTimes.LodTimes[Lod]));
 		}
-		return Handles;
 	}
 
-	void MeshImporter::Export(const std::filesystem::path& BinaryPath, const std::vector<Mesh*>& Meshes)
+	// Everything after reading the source: transforms the vertices and optimizes, builds meshlets, LODs and compresses
+	static void ProcessMesh(
+		std::vector<Vertex>		 Vertices,
+		std::vector<u32>		 Indices,
+		std::string_view		 Name,
+		const MeshImportOptions& Options,
+		Mesh*					 Asset,
+		MeshImportStageTimes&	 StageTimes,
+		VertexCompressionError&	 CompressionError)
 	{
-		FileStream	 Stream(BinaryPath, FileMode::Create, FileAccess::Write);
-		BinaryWriter Writer(Stream);
+		i64 Start = Stopwatch::GetTimestamp();
+
+		DirectX::XMMATRIX Matrix = XMLoadFloat4x4(&Options.Matrix);
+		XMVector3TransformCoordStream(
+			&Vertices[0].Position,
+			sizeof(Vertex),
+			&Vertices[0].Position,
+			sizeof(Vertex),
+			Vertices.size(),
+			Matrix);
+
+		XMVector3TransformNormalStream(
+			&Vertices[0].Normal,
+			sizeof(Vertex),
+			&Vertices[0].Normal,
+			sizeof(Vertex),
+			Vertices.size(),
+			Matrix);
+
+		Asset->Options = Options;
+		if (Name.empty())
+		{
+			Asset->Name = Options.Path.filename().string();
+		}
+		else
+		{
+			Asset->Name = Name;
+		}
+
+		i64 End = Stopwatch::GetTimestamp();
+		StageTimes.Transform += End - Start;
+		Start = End;
+
+		// Meshlets are built from the optimized order
+		if (Options.OptimizeVertexCache)
+		{
+			Asset->OptimizationStats = MeshOptimizer::Optimize(Vertices, Indices, Options.OptimizeOverdraw);
+
+			End = Stopwatch::GetTimestamp();
+			StageTimes.Optimize += End - Start;
+			Start = End;
+		}
 
+		Asset->Vertices = std::move(Vertices);
+		Asset->Indices	= std::move(Indices);
+
+		if (Options.GenerateMeshlets)
+		{
+			std::vector<DirectX::XMFLOAT3> Positions;
+			Positions.reserve(Asset->Vertices.size());
+			for (const auto& Vertex : Asset->Vertices)
+			{
+				Positions.emplace_back(Vertex.Position);
+			}
+
+			ComputeMeshlets(
+				Asset->Indices.data(),
+				Asset->Indices.size() / 3,
+				Positions.data(),
+				Positions.size(),
+				nullptr,
+				Asset->Meshlets,
+				Asset->UniqueVertexIndices,
+				Asset->PrimitiveIndices);
+
+			Asset->MeshletCullData.resize(Asset->Meshlets.size());
+			ComputeCullData(
+				Positions.data(),
+				Positions.size(),
+				Asset->Meshlets.data(),
+				Asset->Meshlets.size(),
+				reinterpret_cast<const u32*>(Asset->UniqueVertexIndices.data()),
+				Asset->UniqueVertexIndices.size() / sizeof(u32),
+				Asset->PrimitiveIndices.data(),
+				Asset->PrimitiveIndices.size(),
+				Asset->MeshletCullData.data());
+
+			End = Stopwatch::GetTimestamp();
+			StageTimes.Meshlets += End - Start;
+			Start = End;
+		}
+
+		Asset->ComputeBoundingBox();
+
+		if (Options.GenerateMeshlets && Options.BenchmarkCulling)
 		{
-			ExportHeader Header = {};
-			Header.NumMeshes	= Meshes.size();
+			BenchmarkMeshletCulling(Asset, StageTimes);
+		}
 
-			Writer.Write<ExportHeader>(Header);
+		if (Options.NumLods > 0)
+		{
+			GenerateLods(Options, Asset, StageTimes);
 		}
-		for (const auto& Mesh : Meshes)
+
+		if (Options.CompressVertices)
 		{
-			Writer.Write<size_t>(Mesh->Name.size());
-			Writer.Write(Mesh->Name);
+			Start = Stopwatch::GetTimestamp();
+			VertexCompression::Encode(Asset->Vertices, Asset->BoundingBox, Asset->CompressedVertices);
+			StageTimes.Compress += Stopwatch::GetTimestamp() - Start;
+
+			CompressionError = VertexCompression::Measure(Asset->Vertices, Asset->CompressedVertices, Asset->BoundingBox);
+		}
 
-			MeshHeader Header			  = {};
-			Header.NumVertices			  = Mesh->Vertices.size();
-			Header.NumIndices			  = Mesh->Indices.size();
-			Header.NumMeshlets			  = Mesh->Meshlets.size();
-			Header.NumUniqueVertexIndices = Mesh->UniqueVertexIndices.size();
-			Header.NumPrimitiveIndices	  = Mesh->PrimitiveIndices.size();
+		if (Options.CompressIndices)
+		{
+			Start = Stopwatch::GetTimestamp();
+			IndexCodec::Encode(Asset->Indices, Asset->CompressedIndices);
+			End = Stopwatch::GetTimestamp();
+			StageTimes.EncodeIndices += End - Start;
 
-			Writer.Write<MeshHeader>(Header);
-			Writer.Write(Mesh->Vertices.data(), Mesh->Vertices.size() * sizeof(Vertex));
-			Writer.Write(Mesh->Indices.data(), Mesh->Indices.size() * sizeof(u32));
-			Writer.Write(Mesh->Meshlets.data(), Mesh->Meshlets.size() * sizeof(DirectX::Meshlet));
-			Writer.Write(Mesh->UniqueVertexIndices.data(), Mesh->UniqueVertexIndices.size() * sizeof(u8));
-			Writer.Write(Mesh->PrimitiveIndices.data(), Mesh->PrimitiveIndices.size() * sizeof(DirectX::MeshletTriangle));
+			// Round trip once, the codec is lossless up to the rotation of each triangle. A mesh that does not come back the
+			// same is exported with its indices uncompressed
+			std::vector<u32> Decoded(Asset->Indices.size());
+			bool			 Valid = IndexCodec::Decode(Asset->CompressedIndices, Decoded.data(), Decoded.size());
+			StageTimes.DecodeIndices += Stopwatch::GetTimestamp() - End;
+			if (Valid && IsSameTriangleList(Asset->Indices, Decoded))
+			{
+				StageTimes.IndexBytes += Asset->Indices.size() * sizeof(u32);
+				StageTimes.EncodedIndexBytes += Asset->CompressedIndices.size();
+			}
+			else
+			{
+				KAGUYA_LOG(Asset, Error, "Mesh {} does not round trip through the index codec, its indices are not compressed", Asset->Name);
+				decltype(Asset->CompressedIndices)().swap(Asset->CompressedIndices);
+			}
 		}
 	}
 
-	std::vector<Mesh*> MeshImporter::ImportExisting(AssetManager* AssetManager, const std::filesystem::path& BinaryPath, const MeshImportOptions& Options)
+	// A mesh as read from the source file, before welding and processing
+	struct SourceMesh
 	{
-		std::vector<Mesh*> Meshes;
+		std::string			Name;
+		std::vector<Vertex> Vertices;
+		std::vector<u32>	Indices;
+	};
+
+	template<typename T>
+	static std::vector<SourceMesh> ToSourceMeshes(std::vector<T>& Meshes)
+	{
+		std::vector<SourceMesh> Sources(Meshes.size());
+		for (size_t m = 0; m < Meshes.size(); ++m)
+		{
+			Sources[m].Name		= std::move(Meshes[m].Name);
+			Sources[m].Vertices = std::move(Meshes[m].Vertices);
+			Sources[m].Indices	= std::move(Meshes[m].Indices);
+		}
+		return Sources;
+	}
 
-		FileStream	 Stream(BinaryPath, FileMode::Open, FileAccess::Read);
-		BinaryReader Reader(Stream);
+	static void ConvertMesh(const aiMesh* paiMesh, SourceMesh& Source)
+	{
+		Source.Name = std::string(paiMesh->mName.C_Str(), paiMesh->mName.length);
 
+		// Parse vertex data
+		std::vector<Vertex>& Vertices = Source.Vertices;
+		Vertices.reserve(paiMesh->mNumVertices);
+		for (unsigned int v = 0; v < paiMesh->mNumVertices; ++v)
 		{
-			auto Header = Reader.Read<ExportHeader>();
-			Meshes.resize(Header.NumMeshes);
+			Vertex& vertex = Vertices.emplace_back();
+			// Position
+			vertex.Position = { paiMesh->mVertices[v].x, paiMesh->mVertices[v].y, paiMesh->mVertices[v].z };
+
+			// Texture coords
+			if (paiMesh->HasTextureCoords(0))
+			{
+				vertex.TextureCoord = { paiMesh->mTextureCoords[0][v].x, paiMesh->mTextureCoords[0][v].y };
+			}
+
+			// Normal
+			if (paiMesh->HasNormals())
+			{
+				vertex.Normal = { paiMesh->mNormals[v].x, paiMesh->mNormals[v].y, paiMesh->mNormals[v].z };
+			}
 		}
-		for (auto& Asset : Meshes)
+
+		// Parse index data
+		std::vector<u32>& Indices = Source.Indices;
+		Indices.reserve(static_cast<size_t>(paiMesh->mNumFaces) * 3);
+		std::span Faces = { paiMesh->mFaces, paiMesh->mNumFaces };
+		for (const auto& Face : Faces)
 		{
-			size_t		Length = Reader.Read<size_t>();
-			std::string string;
-			string.resize(Length);
-			Reader.Read(string.data(), string.size() * sizeof(char));
-
-			auto								  Header = Reader.Read<MeshHeader>();
-			std::vector<Vertex>					  Vertices(Header.NumVertices);
-			std::vector<u32>					  Indices(Header.NumIndices);
-			std::vector<DirectX::Meshlet>		  Meshlets(Header.NumMeshlets);
-			std::vector<u8>						  UniqueVertexIndices(Header.NumUniqueVertexIndices);
-			std::vector<DirectX::MeshletTriangle> PrimitiveIndices(Header.NumPrimitiveIndices);
-
-			Reader.Read(Vertices.data(), Vertices.size() * sizeof(Vertex));
-			Reader.Read(Indices.data(), Indices.size() * sizeof(u32));
-			Reader.Read(Meshlets.data(), Meshlets.size() * sizeof(DirectX::Meshlet));
-			Reader.Read(UniqueVertexIndices.data(), UniqueVertexIndices.size() * sizeof(u8));
-			Reader.Read(PrimitiveIndices.data(), PrimitiveIndices.size() * sizeof(DirectX::MeshletTriangle));
-
-			Asset		   = AssetManager->CreateAsset<Mesh>();
-			Asset->Options = Options;
-			Asset->Name	   = string;
-
-			Asset->SetVertices(std::move(Vertices));
-			Asset->SetIndices(std::move(Indices));
-			Asset->SetMeshlets(std::move(Meshlets));
-			Asset->SetUniqueVertexIndices(std::move(UniqueVertexIndices));
-			Asset->SetPrimitiveIndices(std::move(PrimitiveIndices));
+			Indices.push_back(Face.mIndices[0]);
+			Indices.push_back(Face.mIndices[1]);
+			Indices.push_back(Face.mIndices[2]);
 		}
-		return Meshes;
 	}
 
-	TextureImporter::TextureImporter()
+	static void LogWeld(const std::filesystem::path& Path, f32 Epsilon, const MeshImportStageTimes& StageTimes)
 	{
-		SupportedExtensions.insert(L".dds");
-		SupportedExtensions.insert(L".hdr");
-		SupportedExtensions.insert(L".tga");
-		SupportedExtensions.insert(L".bmp");
-		SupportedExtensions.insert(L".png");
-		SupportedExtensions.insert(L".gif");
-		SupportedExtensions.insert(L".tiff");
-		SupportedExtensions.insert(L".jpeg");
+		const f64 Seconds = static_cast<f64>(std::max<i64>(StageTimes.Weld, 1)) / static_cast<f64>(Stopwatch::Frequency);
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} welding (epsilon {}): {} -> {} vertices ({:.1f}% fewer), {}ms, {:.1f} M vertices/s",
+			Path.filename().string(),
+			Epsilon,
+			StageTimes.NumVerticesBeforeWeld,
+			StageTimes.NumVerticesAfterWeld,
+			100.0 * VertexWeldStats{ StageTimes.NumVerticesBeforeWeld, StageTimes.NumVerticesAfterWeld }.GetReductionRatio(),
+			TicksToMilliseconds(StageTimes.Weld),
+			static_cast<f64>(StageTimes.NumVerticesBeforeWeld) / Seconds / 1e6);
 	}
 
-	AssetHandle TextureImporter::Import(AssetManager* AssetManager, const TextureImportOptions& Options)
+	static void LogClusters(const std::filesystem::path& Path, const MeshImportStageTimes& StageTimes)
+	{
+		const MeshClusterStats& Stats	= StageTimes.Clusters;
+		const f64				Seconds = static_cast<f64>(std::max<i64>(Stats.Ticks, 1)) / static_cast<f64>(Stopwatch::Frequency);
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} clustering: {} triangles split into {} clusters of {} to {} triangles, {}ms at {:.1f} M triangles/s",
+			Path.filename().string(),
+			Stats.NumTriangles,
+			Stats.NumClusters,
+			Stats.MinClusterTriangles,
+			Stats.MaxClusterTriangles,
+			TicksToMilliseconds(Stats.Ticks),
+			static_cast<f64>(Stats.NumTriangles) / Seconds / 1e6);
+	}
+
+	static void LogClusterCulling(const std::filesystem::path& Path, const MeshImportStageTimes& StageTimes)
 	{
-		const auto& Path	  = Options.Path;
-		const auto	Extension = Path.extension().string();
+		const MeshClusterCullStats& Culling = StageTimes.ClusterCulling;
+		const f64					Views	= static_cast<f64>(std::max<u64>(Culling.NumTriangles, 1));
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} cluster culling: frustum culling of the clusters rejects {:.1f}% of the triangles from inside and {:.1f}% from "
+			"outside (0% for the whole meshes)",
+			Path.filename().string(),
+			100.0 * static_cast<f64>(Culling.NumCulledInside) / Views,
+			100.0 * static_cast<f64>(Culling.NumCulledOutside) / Views);
+	}
 
-		DirectX::TexMetadata  TexMetadata = {};
-		DirectX::ScratchImage OutImage	  = {};
-		if (Extension == ".dds")
+	static std::filesystem::path GetImageListPath(const std::filesystem::path& BinaryPath)
+	{
+		return std::filesystem::path(BinaryPath).replace_extension(".images.json");
+	}
+
+	// Writes the embedded images next to the cooked file and lists every image of the source, embedded or not
+	static void ExportImages(const std::filesystem::path& BinaryPath, const std::vector<GltfImage>& Images)
+	{
+		nlohmann::json Json = nlohmann::json::array();
+		for (size_t i = 0; i < Images.size(); ++i)
 		{
-			LoadFromDDSFile(Path.c_str(), DirectX::DDS_FLAGS::DDS_FLAGS_FORCE_RGB, &TexMetadata, OutImage);
+			const GltfImage&	  Image = Images[i];
+			std::filesystem::path Path	= Image.Path;
+			if (Path.empty())
+			{
+				Path = std::filesystem::path(BinaryPath).replace_extension(std::format(".image{}{}", i, Image.Extension));
+				std::ofstream Stream(Path, std::ios::binary);
+				Stream.write(reinterpret_cast<const char*>(Image.Data.data()), static_cast<std::streamsize>(Image.Data.size()));
+			}
+			Json.push_back({ { "Path", Path.string() }, { "sRGB", Image.sRGB } });
 		}
-		else if (Extension == ".tga")
+
+		std::ofstream Stream(GetImageListPath(BinaryPath));
+		Stream << Json.dump(2);
+	}
+
+	std::vector<Mesh*> MeshImporter::Load(
+		AssetCache&						   Cache,
+		const MeshImportOptions&		   Options,
+		const std::function<Mesh*()>&	   CreateMesh,
+		Span<const u64>					   MeshIndices /*= {}*/,
+		std::vector<TextureImportOptions>* Images /*= nullptr*/,
+		ImportReport*					   Report /*= nullptr*/)
+	{
+		if (Report)
 		{
-			if (Options.GenerateMips)
+			Report->Source = Options.Path;
+		}
+
+		u64 Key = AssetCache::NoKey;
+		{
+			// The source is only hashed for its cache key if it changed since it was last hashed
+			ImportReport::ScopedStage Stage(Report, "Hash", exists(Options.Path) ? file_size(Options.Path) : 0);
+			Key = GetCacheKey(Cache, Options);
+		}
+		if (Key == AssetCache::NoKey)
+		{
+			KAGUYA_LOG(Asset, Error, "{} cannot be read", Options.Path.string());
+			return {};
+		}
+
+		std::filesystem::path BinaryPath;
+		std::vector<Mesh*>	  Meshes;
+		if (Cache.Lookup(Key, CookedExtension, BinaryPath))
+		{
+			ScopedTimer Timer(
+				[&](i64 Milliseconds)
+				{
+					KAGUYA_LOG(
+						Asset,
+						Info,
+						"Mapped {} ({} meshes, {} MiB) in {}ms, peak working set {} MiB",
+						BinaryPath.filename().string(),
+						Meshes.size(),
+						file_size(BinaryPath) >> 20,
+						Milliseconds,
+						Process::GetPeakWorkingSetSizeInBytes() >> 20);
+				});
 			{
-				DirectX::ScratchImage BaseImage;
-				LoadFromTGAFile(Path.c_str(), &TexMetadata, BaseImage);
-				GenerateMipMaps(*BaseImage.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, OutImage, false);
+				ImportReport::ScopedStage Stage(Report, "Map", file_size(BinaryPath));
+				Meshes = ImportExisting(BinaryPath, Options, CreateMesh, MeshIndices);
 			}
-			else
+			if (Meshes.empty())
 			{
-				LoadFromTGAFile(Path.c_str(), &TexMetadata, OutImage);
+				Cache.Invalidate(BinaryPath);
 			}
 		}
-		else if (Extension == ".hdr")
+		if (Meshes.empty() && MeshIndices.empty())
 		{
-			if (Options.GenerateMips)
+			Meshes = Cook(Options, BinaryPath, CreateMesh, Report);
+			for (size_t i = 0; i < Meshes.size(); ++i)
 			{
-				DirectX::ScratchImage BaseImage;
-				LoadFromHDRFile(Path.c_str(), &TexMetadata, BaseImage);
-				GenerateMipMaps(*BaseImage.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, OutImage, false);
+				Meshes[i]->ArchiveIndex = static_cast<u32>(i);
 			}
-			else
+		}
+
+		for (auto Mesh : Meshes)
+		{
+			Mesh->UpdateInfo();
+		}
+		if (Report && !Report->Cooked)
+		{
+			u64 NumVertices = 0, NumTriangles = 0;
+			for (auto Mesh : Meshes)
+			{
+				NumVertices += Mesh->NumVertices;
+				NumTriangles += Mesh->NumIndices / 3;
+			}
+			Report->SetCounter("meshes", Meshes.size());
+			Report->SetCounter("vertices", NumVertices);
+			Report->SetCounter("triangles", NumTriangles);
+		}
+		if (Images && !Meshes.empty())
+		{
+			*Images = GetImages(BinaryPath);
+		}
+		return Meshes;
+	}
+
+	std::vector<AssetHandle> MeshImporter::Import(AssetManager* AssetManager, const MeshImportOptions& Options)
+	{
+		ImportReport					  Report;
+		std::vector<TextureImportOptions> Images;
+		std::vector<Mesh*>				  Meshes = Load(
+			 AssetManager->GetCache(),
+			 Options,
+			 [&]
+			 {
+				 return AssetManager->CreateAsset<Mesh>();
+			 },
+			 {},
+			 &Images,
+			 &Report);
+		if (Meshes.empty())
+		{
+			__debugbreak();
+			return {};
+		}
+
+		for (const auto& Image : Images)
+		{
+			AssetManager->LoadTexture(Image);
+		}
+
+		std::vector<AssetHandle> Handles;
+		Handles.reserve(Meshes.size());
+		for (auto Mesh : Meshes)
+		{
+			Handles.push_back(Mesh->Handle);
+		}
+
+		{
+			u64 SizeInBytes = 0;
+			for (auto Mesh : Meshes)
 			{
-				LoadFromHDRFile(Path.c_str(), &TexMetadata, OutImage);
+				SizeInBytes += Mesh->GetSizeInBytes();
 			}
+			ImportReport::ScopedStage Stage(&Report, "Upload", SizeInBytes);
+			AssetManager->RequestUpload(Meshes);
+		}
+		Report.Log();
+		Report.Append(AssetManager->GetCache().GetDirectory() / ImportReport::FileName);
+		return Handles;
+	}
+
+	std::vector<Mesh*> MeshImporter::Cook(
+		const MeshImportOptions&	  Options,
+		const std::filesystem::path&  BinaryPath,
+		const std::function<Mesh*()>& CreateMesh,
+		ImportReport*				  Report /*= nullptr*/)
+	{
+		const auto Path = Options.Path.string();
+
+		MeshImportStageTimes				StageTimes;
+		std::vector<VertexCompressionError> CompressionErrors;
+		i64									ReadFileTime, ProcessTime, ExportTime;
+		i64									Start = Stopwatch::GetTimestamp();
+
+		// OBJ and glTF files are read natively, assimp remains the fallback for anything the parsers reject
+		std::vector<ObjMesh>   ObjMeshes;
+		ObjParseStats		   ObjStats;
+		std::vector<GltfMesh>  GltfMeshes;
+		std::vector<GltfImage> GltfImages;
+		GltfParseStats		   GltfStats;
+		Assimp::Importer	   Importer;
+		const aiScene*		   paiScene = nullptr;
+		if (IsGltfFile(Options.Path) && GltfParser::Parse(Options.Path, GltfMeshes, GltfImages, &GltfStats))
+		{
+			KAGUYA_LOG(
+				Asset,
+				Info,
+				"Parsed {} natively: {} MiB at {:.0f} MB/s ({} primitives, {} vertices, {} triangles, {} images), Read {}ms, Convert {}ms",
+				Options.Path.filename().string(),
+				GltfStats.SizeInBytes >> 20,
+				GetMegabytesPerSecond(GltfStats.SizeInBytes, GltfStats.ReadTicks + GltfStats.ConvertTicks),
+				GltfStats.NumPrimitives,
+				GltfStats.NumVertices,
+				GltfStats.NumTriangles,
+				GltfStats.NumImages,
+				TicksToMilliseconds(GltfStats.ReadTicks),
+				TicksToMilliseconds(GltfStats.ConvertTicks));
+		}
+		else if (IsObjFile(Options.Path) && ObjParser::Parse(Options.Path, ObjMeshes, &ObjStats))
+		{
+			KAGUYA_LOG(
+				Asset,
+				Info,
+				"Parsed {} natively: {} MiB in {} chunks at {:.0f} MB/s ({} positions, {} triangles, {} vertices after welding), "
+				"Parse {}ms, Merge {}ms, Weld {}ms",
+				Options.Path.filename().string(),
+				ObjStats.SizeInBytes >> 20,
+				ObjStats.NumChunks,
+				GetMegabytesPerSecond(ObjStats.SizeInBytes, ObjStats.ParseTicks + ObjStats.MergeTicks + ObjStats.WeldTicks),
+				ObjStats.NumPositions,
+				ObjStats.NumTriangles,
+				ObjStats.NumVertices,
+				TicksToMilliseconds(ObjStats.ParseTicks),
+				TicksToMilliseconds(ObjStats.MergeTicks),
+				TicksToMilliseconds(ObjStats.WeldTicks));
 		}
 		else
 		{
-			if (Options.GenerateMips)
+			if (IsObjFile(Options.Path) || IsGltfFile(Options.Path))
 			{
-				DirectX::ScratchImage BaseImage;
-				LoadFromWICFile(Path.c_str(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_RGB, &TexMetadata, BaseImage);
-				GenerateMipMaps(*BaseImage.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, OutImage, false);
+				KAGUYA_LOG(Asset, Warn, "{} could not be parsed natively, falling back to assimp", Options.Path.filename().string());
 			}
-			else
+
+			paiScene = Importer.ReadFile(Path.data(), ImporterFlags);
+			if (!paiScene || !paiScene->HasMeshes())
 			{
-				LoadFromWICFile(Path.c_str(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_RGB, &TexMetadata, OutImage);
+				KAGUYA_LOG(Asset, Error, "{} error: {}", __FUNCTION__, Importer.GetErrorString());
+				return {};
 			}
 		}
 
-		Texture* Asset	 = AssetManager->CreateAsset<Texture>();
-		Asset->Options	 = Options;
-		Asset->Extent	 = Math::Vec2i(static_cast<int>(TexMetadata.width), static_cast<int>(TexMetadata.height));
-		Asset->IsCubemap = TexMetadata.IsCubemap();
-		Asset->Name		 = Path.filename().string();
-		Asset->TexImage	 = std::move(OutImage);
-		AssetManager->RequestUpload(Asset);
-		return Asset->Handle;
+		ReadFileTime = Stopwatch::GetTimestamp() - Start;
+		Start += ReadFileTime;
+
+		// Every reader ends up with the same source meshes, assimp's are converted in parallel
+		std::vector<SourceMesh> Sources;
+		if (paiScene)
+		{
+			i64 ConvertStart = Stopwatch::GetTimestamp();
+			Sources.resize(paiScene->mNumMeshes);
+			ParallelFor(
+				Process::GetThreadPool(),
+				Sources.size(),
+				[&](size_t m)
+				{
+					ConvertMesh(paiScene->mMeshes[m], Sources[m]);
+				});
+			StageTimes.Convert += Stopwatch::GetTimestamp() - ConvertStart;
+		}
+		else
+		{
+			Sources = !ObjMeshes.empty() ? ToSourceMeshes(ObjMeshes) : ToSourceMeshes(GltfMeshes);
+		}
+
+		// The welder runs in parallel itself, so meshes are welded one at a time before processing them in parallel
+		for (SourceMesh& Source : Sources)
+		{
+			VertexWeldStats WeldStats = VertexWelder::Weld(Source.Vertices, Source.Indices, Options.WeldEpsilon);
+			StageTimes.Weld += WeldStats.Ticks;
+			StageTimes.NumVerticesBeforeWeld += WeldStats.NumVerticesBefore;
+			StageTimes.NumVerticesAfterWeld += WeldStats.NumVerticesAfter;
+		}
+
+		// Oversized meshes are replaced by their clusters in place, ClusterRanges remembers which meshes came from one source
+		struct ClusterRange
+		{
+			size_t First;
+			size_t Count;
+		};
+		std::vector<ClusterRange> ClusterRanges;
+		if (Options.ClusterTriangles > 0)
+		{
+			std::vector<SourceMesh> Clustered;
+			Clustered.reserve(Sources.size());
+			for (SourceMesh& Source : Sources)
+			{
+				MeshClusterStats		 ClusterStats;
+				std::vector<MeshCluster> Clusters = MeshClusterer::Split(Source.Vertices, Source.Indices, Options.ClusterTriangles, &ClusterStats);
+				if (Clusters.empty())
+				{
+					Clustered.push_back(std::move(Source));
+					continue;
+				}
+
+				StageTimes.Clusters += ClusterStats;
+				ClusterRanges.push_back({ Clustered.size(), Clusters.size() });
+
+				const std::string Name = Source.Name.empty() ? Options.Path.filename().string() : Source.Name;
+				for (size_t c = 0; c < Clusters.size(); ++c)
+				{
+					Clustered.push_back({ std::format("{}_{}", Name, c), std::move(Clusters[c].Vertices), std::move(Clusters[c].Indices) });
+				}
+			}
+			Sources = std::move(Clustered);
+		}
+
+		// Assets are created up front in scene order so handles and the exported file do not depend on scheduling
+		std::vector<Mesh*> Meshes(Sources.size());
+		CompressionErrors.resize(Sources.size());
+		for (auto& Asset : Meshes)
+		{
+			Asset = CreateMesh();
+		}
+
+		ParallelFor(
+			Process::GetThreadPool(),
+			Meshes.size(),
+			[&](size_t m)
+			{
+				SourceMesh& Source = Sources[m];
+				ProcessMesh(std::move(Source.Vertices), std::move(Source.Indices), Source.Name, Options, Meshes[m], StageTimes, CompressionErrors[m]);
+			});
+
+		// The bounding boxes are those of the transformed clusters
+		if (Options.BenchmarkCulling)
+		{
+			for (const ClusterRange& Range : ClusterRanges)
+			{
+				std::vector<Math::BoundingBox> Boxes;
+				std::vector<u64>			   NumTriangles;
+				for (size_t m = Range.First; m < Range.First + Range.Count; ++m)
+				{
+					Boxes.push_back(Meshes[m]->BoundingBox);
+					NumTriangles.push_back(Meshes[m]->Indices.size() / 3);
+				}
+				StageTimes.ClusterCulling += MeshClusterer::Benchmark(Boxes, NumTriangles);
+			}
+		}
+
+		ProcessTime = Stopwatch::GetTimestamp() - Start;
+		Start += ProcessTime;
+
+		Export(BinaryPath, Meshes);
+		if (!GltfImages.empty())
+		{
+			ExportImages(BinaryPath, GltfImages);
+		}
+		for (auto Mesh : Meshes)
+		{
+			decltype(Mesh->CompressedVertices)().swap(Mesh->CompressedVertices);
+			decltype(Mesh->CompressedIndices)().swap(Mesh->CompressedIndices);
+		}
+
+		ExportTime = Stopwatch::GetTimestamp() - Start;
+
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"Imported {} ({} meshes): ReadFile {}ms, Process {}ms (Convert {}ms, Weld {}ms, Cluster {}ms, then across threads Transform {}ms, "
+			"Optimize {}ms, Meshlets {}ms, Lods {}ms, Compress {}ms, EncodeIndices {}ms), Export {}ms",
+			Options.Path.filename().string(),
+			Meshes.size(),
+			TicksToMilliseconds(ReadFileTime),
+			TicksToMilliseconds(ProcessTime),
+			TicksToMilliseconds(StageTimes.Convert),
+			TicksToMilliseconds(StageTimes.Weld),
+			TicksToMilliseconds(StageTimes.Clusters.Ticks),
+			TicksToMilliseconds(StageTimes.Transform),
+			TicksToMilliseconds(StageTimes.Optimize),
+			TicksToMilliseconds(StageTimes.Meshlets),
+			TicksToMilliseconds(StageTimes.Lods),
+			TicksToMilliseconds(StageTimes.Compress),
+			TicksToMilliseconds(StageTimes.EncodeIndices),
+			TicksToMilliseconds(ExportTime));
+
+		if (Report)
+		{
+			u64 SourceSizeInBytes = ObjStats.SizeInBytes + GltfStats.SizeInBytes;
+			if (paiScene)
+			{
+				SourceSizeInBytes = file_size(Options.Path);
+			}
+
+			u64 VertexBytes = 0, IndexBytes = 0, NumTriangles = 0;
+			for (auto Mesh : Meshes)
+			{
+				VertexBytes += Mesh->Vertices.size() * sizeof(Vertex);
+				IndexBytes += Mesh->Indices.size() * sizeof(u32);
+				NumTriangles += Mesh->Indices.size() / 3;
+			}
+
+			// Convert, Weld and Cluster run between reading and processing the meshes in parallel, the stages of the
+			// meshes overlap on the thread pool
+			Report->Cooked = true;
+			Report->AddStage("Read", ReadFileTime, SourceSizeInBytes);
+			if (paiScene)
+			{
+				Report->AddStage("Convert", StageTimes.Convert, StageTimes.NumVerticesBeforeWeld * sizeof(Vertex));
+			}
+			Report->AddStage("Weld", StageTimes.Weld, StageTimes.NumVerticesBeforeWeld * sizeof(Vertex));
+			if (!ClusterRanges.empty())
+			{
+				Report->AddStage("Cluster", StageTimes.Clusters.Ticks, StageTimes.Clusters.NumTriangles * 3 * sizeof(u32));
+			}
+			Report->AddStage(
+				"Process",
+				ProcessTime - StageTimes.Convert - StageTimes.Weld - StageTimes.Clusters.Ticks,
+				VertexBytes + IndexBytes);
+			Report->AddStage("Transform", StageTimes.Transform, VertexBytes, true);
+			if (Options.OptimizeVertexCache)
+			{
+				Report->AddStage("Optimize", StageTimes.Optimize, VertexBytes + IndexBytes, true);
+			}
+			if (Options.GenerateMeshlets)
+			{
+				Report->AddStage("Meshlets", StageTimes.Meshlets, VertexBytes + IndexBytes, true);
+			}
+			if (Options.NumLods > 0)
+			{
+				Report->AddStage("Lods", StageTimes.Lods, VertexBytes + IndexBytes, true);
+			}
+			if (Options.CompressVertices)
+			{
+				Report->AddStage("Compress", StageTimes.Compress, VertexBytes, true);
+			}
+			if (Options.CompressIndices)
+			{
+				Report->AddStage("EncodeIndices", StageTimes.EncodeIndices, IndexBytes, true);
+			}
+			Report->AddStage("Export", ExportTime, file_size(BinaryPath));
+			Report->SetCounter("meshes", Meshes.size());
+			Report->SetCounter("vertices", VertexBytes / sizeof(Vertex));
+			Report->SetCounter("triangles", NumTriangles);
+		}
+
+		LogWeld(Options.Path, Options.WeldEpsilon, StageTimes);
+
+		if (!ClusterRanges.empty())
+		{
+			LogClusters(Options.Path, StageTimes);
+			if (Options.BenchmarkCulling)
+			{
+				LogClusterCulling(Options.Path, StageTimes);
+			}
+		}
+
+		if (Options.GenerateMeshlets && Options.BenchmarkCulling)
+		{
+			LogMeshletCulling(Options.Path, StageTimes);
+		}
+
+		if (Options.NumLods > 0)
+		{
+			LogLods(Options.Path, Meshes, StageTimes);
+		}
+
+		if (Options.CompressIndices)
+		{
+			LogIndexCompression(Options.Path, StageTimes);
+		}
+
+		if (Options.CompressVertices)
+		{
+			u64					   NumVertices = 0;
+			VertexCompressionError Error, Bound;
+			for (size_t m = 0; m < Meshes.size(); ++m)
+			{
+				VertexCompressionError MeshBound = VertexCompression::GetErrorBound(Meshes[m]->BoundingBox);
+
+				NumVertices += Meshes[m]->Vertices.size();
+				Error.Position	   = std::max(Error.Position, CompressionErrors[m].Position);
+				Error.Normal	   = std::max(Error.Normal, CompressionErrors[m].Normal);
+				Error.TextureCoord = std::max(Error.TextureCoord, CompressionErrors[m].TextureCoord);
+				Bound.Position	   = std::max(Bound.Position, MeshBound.Position);
+				Bound.Normal	   = MeshBound.Normal;
+				Bound.TextureCoord = MeshBound.TextureCoord;
+			}
+
+			const f64 Seconds = static_cast<f64>(std::max<i64>(StageTimes.Compress, 1)) / static_cast<f64>(Stopwatch::Frequency);
+			KAGUYA_LOG(
+				Asset,
+				Info,
+				"{} vertex compression: {} KiB -> {} KiB, encode {:.1f} MB/s per thread, max error position {} (bound {}), normal {} deg (bound {}), uv {} (bound {})",
+				Options.Path.filename().string(),
+				NumVertices * sizeof(Vertex) >> 10,
+				NumVertices * sizeof(CompressedVertex) >> 10,
+				static_cast<f64>(NumVertices * sizeof(Vertex)) / Seconds / 1e6,
+				Error.Position,
+				Bound.Position,
+				Error.Normal,
+				Bound.Normal,
+				Error.TextureCoord,
+				Bound.TextureCoord);
+		}
+
+		if (Options.OptimizeVertexCache)
+		{
+			// Triangle/vertex weighted averages over the whole file
+			f64 Faces = 0.0, VerticesBefore = 0.0, VerticesAfter = 0.0;
+			f64 MissesBefore = 0.0, MissesAfter = 0.0;
+			for (auto Mesh : Meshes)
+			{
+				const MeshOptimizationStats& Stats = Mesh->OptimizationStats;
+				f64							 Count = static_cast<f64>(Mesh->Indices.size() / 3);
+				Faces += Count;
+				MissesBefore += Stats.AcmrBefore * Count;
+				MissesAfter += Stats.AcmrAfter * Count;
+				VerticesBefore += Stats.AcmrBefore > 0.0f ? Stats.AcmrBefore * Count / Stats.AtvrBefore : 0.0;
+				VerticesAfter += static_cast<f64>(Mesh->Vertices.size());
+			}
+			KAGUYA_LOG(
+				Asset,
+				Info,
+				"{} vertex cache ({} entries): ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+				Options.Path.filename().string(),
+				MeshOptimizer::CacheSize,
+				MissesBefore / std::max(Faces, 1.0),
+				MissesAfter / std::max(Faces, 1.0),
+				MissesBefore / std::max(VerticesBefore, 1.0),
+				MissesAfter / std::max(VerticesAfter, 1.0));
+		}
+
+		return Meshes;
+	}
+
+	std::vector<TextureImportOptions> MeshImporter::GetImages(const std::filesystem::path& BinaryPath)
+	{
+		std::ifstream Stream(GetImageListPath(BinaryPath));
+		if (!Stream)
+		{
+			return {};
+		}
+
+		nlohmann::json Json = nlohmann::json::parse(Stream, nullptr, false);
+		if (!Json.is_array())
+		{
+			return {};
+		}
+
+		std::vector<TextureImportOptions> Images;
+		for (const auto& JsonImage : Json)
+		{
+			TextureImportOptions& Image = Images.emplace_back();
+			Image.Path					= JsonImage.value("Path", std::string());
+			Image.sRGB					= JsonImage.value("sRGB", false);
+		}
+		return Images;
+	}
+
+	void MeshImporter::BenchmarkObj(const std::filesystem::path& Path)
+	{
+		i64					 Start = Stopwatch::GetTimestamp();
+		std::vector<ObjMesh> ObjMeshes;
+		bool				 Parsed		 = ObjParser::Parse(Path, ObjMeshes);
+		i64					 NativeTicks = Stopwatch::GetTimestamp() - Start;
+
+		u64 NumNativeMeshes = ObjMeshes.size(), NumNativeVertices = 0, NumNativeTriangles = 0;
+		for (const ObjMesh& Mesh : ObjMeshes)
+		{
+			NumNativeVertices += Mesh.Vertices.size();
+			NumNativeTriangles += Mesh.Indices.size() / 3;
+		}
+		decltype(ObjMeshes)().swap(ObjMeshes);
+
+		Start = Stopwatch::GetTimestamp();
+		Assimp::Importer Importer;
+		const aiScene*	 paiScene	 = Importer.ReadFile(Path.string().data(), ImporterFlags);
+		i64				 AssimpTicks = Stopwatch::GetTimestamp() - Start;
+
+		u64 NumAssimpMeshes = 0, NumAssimpVertices = 0, NumAssimpTriangles = 0;
+		if (paiScene)
+		{
+			NumAssimpMeshes = paiScene->mNumMeshes;
+			for (const aiMesh* paiMesh : std::span(paiScene->mMeshes, paiScene->mNumMeshes))
+			{
+				NumAssimpVertices += paiMesh->mNumVertices;
+				NumAssimpTriangles += paiMesh->mNumFaces;
+			}
+		}
+
+		const u64 SizeInBytes = file_size(Path);
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} ({} MiB): native {} at {:.0f} MB/s ({} meshes, {} vertices, {} triangles), assimp {} at {:.0f} MB/s ({} meshes, "
+			"{} vertices, {} triangles), {:.1f}x",
+			Path.filename().string(),
+			SizeInBytes >> 20,
+			Parsed ? "succeeded" : "failed",
+			GetMegabytesPerSecond(SizeInBytes, NativeTicks),
+			NumNativeMeshes,
+			NumNativeVertices,
+			NumNativeTriangles,
+			paiScene ? "succeeded" : "failed",
+			GetMegabytesPerSecond(SizeInBytes, AssimpTicks),
+			NumAssimpMeshes,
+			NumAssimpVertices,
+			NumAssimpTriangles,
+			static_cast<f64>(AssimpTicks) / static_cast<f64>(std::max<i64>(NativeTicks, 1)));
+	}
+
+	bool MeshImporter::BenchmarkWeld(const std::filesystem::path& Path, f32 Epsilon)
+	{
+		Assimp::Importer Importer;
+		const aiScene*	 paiScene = Importer.ReadFile(Path.string().data(), ImporterFlags);
+		if (!paiScene || !paiScene->HasMeshes())
+		{
+			KAGUYA_LOG(Asset, Error, "{} error: {}", __FUNCTION__, Importer.GetErrorString());
+			return false;
+		}
+
+		std::vector<SourceMesh> Sources(paiScene->mNumMeshes);
+		for (size_t m = 0; m < Sources.size(); ++m)
+		{
+			ConvertMesh(paiScene->mMeshes[m], Sources[m]);
+		}
+
+		// Both weld the same unwelded meshes, assimp's step is applied to the scene that was just read
+		i64 Start		= Stopwatch::GetTimestamp();
+		paiScene		= Importer.ApplyPostProcessing(aiProcess_JoinIdenticalVertices);
+		i64 AssimpTicks = Stopwatch::GetTimestamp() - Start;
+		if (!paiScene || paiScene->mNumMeshes != Sources.size())
+		{
+			KAGUYA_LOG(Asset, Error, "{} error: {}", __FUNCTION__, Importer.GetErrorString());
+			return false;
+		}
+
+		u64 NumAssimpVertices = 0;
+		for (const aiMesh* paiMesh : std::span(paiScene->mMeshes, paiScene->mNumMeshes))
+		{
+			NumAssimpVertices += paiMesh->mNumVertices;
+		}
+
+		// JoinIdenticalVertices itself merges attributes that are this close
+		constexpr f32 AssimpEpsilon = 1e-5f;
+		const f32	  Tolerance		= Epsilon + AssimpEpsilon;
+
+		VertexWeldStats Total;
+		u64				NumMismatches	 = 0;
+		bool			IndexCountsMatch = true;
+		for (size_t m = 0; m < Sources.size(); ++m)
+		{
+			std::vector<Vertex> Vertices = Sources[m].Vertices;
+			std::vector<u32>	Indices	 = Sources[m].Indices;
+			VertexWeldStats		Stats	 = VertexWelder::Weld(Vertices, Indices, Epsilon);
+			Total.NumVerticesBefore += Stats.NumVerticesBefore;
+			Total.NumVerticesAfter += Stats.NumVerticesAfter;
+			Total.Ticks += Stats.Ticks;
+
+			// Both keep the faces in order, triangle i of either weld comes from source triangle i
+			SourceMesh Joined;
+			ConvertMesh(paiScene->mMeshes[m], Joined);
+			if (Joined.Indices.size() != Indices.size())
+			{
+				KAGUYA_LOG(
+					Asset,
+					Error,
+					"{} mesh {}: VertexWelder kept {} indices, JoinIdenticalVertices {}",
+					Path.filename().string(),
+					m,
+					Indices.size(),
+					Joined.Indices.size());
+				IndexCountsMatch = false;
+				continue;
+			}
+
+			// Every corner's position, normal and texture coordinate has to match assimp's up to Epsilon
+			for (size_t i = 0; i < Indices.size(); i += 3)
+			{
+				bool Match = true;
+				for (size_t c = i; c < i + 3; ++c)
+				{
+					const Vertex& Welded	= Vertices[Indices[c]];
+					const Vertex& Reference = Joined.Vertices[Joined.Indices[c]];
+					const f32	  Values[][2] = {
+						{ Welded.Position.x, Reference.Position.x },		 { Welded.Position.y, Reference.Position.y },
+						{ Welded.Position.z, Reference.Position.z },		 { Welded.TextureCoord.x, Reference.TextureCoord.x },
+						{ Welded.TextureCoord.y, Reference.TextureCoord.y }, { Welded.Normal.x, Reference.Normal.x },
+						{ Welded.Normal.y, Reference.Normal.y },			 { Welded.Normal.z, Reference.Normal.z },
+					};
+					Match &= std::ranges::none_of(
+						Values,
+						[&](const f32(&Pair)[2])
+						{
+							return !(std::abs(Pair[0] - Pair[1]) <= Tolerance);
+						});
+				}
+				NumMismatches += !Match;
+			}
+		}
+
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} ({} meshes, {} vertices): VertexWelder {} vertices ({:.1f}% fewer) in {}ms at {:.1f} M vertices/s, "
+			"JoinIdenticalVertices {} vertices ({:.1f}% fewer) in {}ms, {:.1f}x, {} mismatched triangles",
+			Path.filename().string(),
+			Sources.size(),
+			Total.NumVerticesBefore,
+			Total.NumVerticesAfter,
+			100.0 * Total.GetReductionRatio(),
+			TicksToMilliseconds(Total.Ticks),
+			static_cast<f64>(Total.NumVerticesBefore) * static_cast<f64>(Stopwatch::Frequency) / static_cast<f64>(std::max<i64>(Total.Ticks, 1)) / 1e6,
+			NumAssimpVertices,
+			100.0 * VertexWeldStats{ Total.NumVerticesBefore, NumAssimpVertices }.GetReductionRatio(),
+			TicksToMilliseconds(AssimpTicks),
+			static_cast<f64>(AssimpTicks) / static_cast<f64>(std::max<i64>(Total.Ticks, 1)),
+			NumMismatches);
+
+		if (!IndexCountsMatch || NumMismatches > 0)
+		{
+			KAGUYA_LOG(Asset, Error, "{}: VertexWelder does not match JoinIdenticalVertices", Path.filename().string());
+			return false;
+		}
+		return true;
+	}
+
+	void MeshImporter::Export(const std::filesystem::path& BinaryPath, const std::vector<Mesh*>& Meshes)
+	{
+		MeshArchive::Write(BinaryPath, Meshes);
+	}
+
+	std::vector<Mesh*> MeshImporter::ImportExisting(
+		const std::filesystem::path&  BinaryPath,
+		const MeshImportOptions&	  Options,
+		const std::function<Mesh*()>& CreateMesh,
+		Span<const u64>				  MeshIndices /*= {}*/)
+	{
+		// Every mesh of the file shares the mapping, it is unmapped once the last of them has been uploaded
+		MeshArchive Archive(std::make_shared<MemoryMappedFile>(BinaryPath));
+		if (!Archive.IsValid())
+		{
+			KAGUYA_LOG(Asset, Warn, "{} is not a valid mesh archive (version {} expected)", BinaryPath.filename().string(), MeshArchive::Version);
+			return {};
+		}
+
+		std::vector<u64> Indices(MeshIndices.begin(), MeshIndices.end());
+		if (Indices.empty())
+		{
+			Indices.resize(Archive.GetNumMeshes());
+			std::iota(Indices.begin(), Indices.end(), 0);
+		}
+
+		// Verify the payload of every requested mesh before creating any asset, meshes are independent chunks. Compressed
+		// indices are decoded here as well, a malformed stream fails the archive like a checksum mismatch does
+		MeshImportStageTimes		  StageTimes;
+		std::vector<std::vector<u32>> DecodedIndices(Indices.size());
+		std::atomic<bool>			  Valid = true;
+		ParallelFor(
+			Process::GetThreadPool(),
+			Indices.size(),
+			[&](size_t i)
+			{
+				u64 Index = Indices[i];
+				if (Index >= Archive.GetNumMeshes() || !Archive.ValidateMesh(Index))
+				{
+					KAGUYA_LOG(Asset, Warn, "{} mesh {} failed validation", BinaryPath.filename().string(), Index);
+					Valid = false;
+					return;
+				}
+
+				auto CompressedIndices = Archive.GetStream<u8>(Index, MeshStream::CompressedIndices);
+				if (!CompressedIndices.empty())
+				{
+					i64 Start = Stopwatch::GetTimestamp();
+					DecodedIndices[i].resize(IndexCodec::GetNumIndices(CompressedIndices));
+					if (!IndexCodec::Decode(CompressedIndices, DecodedIndices[i].data(), DecodedIndices[i].size()))
+					{
+						KAGUYA_LOG(Asset, Warn, "{} mesh {} has malformed compressed indices", BinaryPath.filename().string(), Index);
+						Valid = false;
+						return;
+					}
+					StageTimes.DecodeIndices += Stopwatch::GetTimestamp() - Start;
+					StageTimes.IndexBytes += DecodedIndices[i].size() * sizeof(u32);
+					StageTimes.EncodedIndexBytes += CompressedIndices.size();
+				}
+			});
+		if (!Valid)
+		{
+			return {};
+		}
+
+		std::vector<Mesh*> Meshes;
+		Meshes.reserve(Indices.size());
+		for (size_t i = 0; i < Indices.size(); ++i)
+		{
+			Meshes.push_back(CreateMesh());
+		}
+
+		ParallelFor(
+			Process::GetThreadPool(),
+			Indices.size(),
+			[&](size_t i)
+			{
+				u64	  Index = Indices[i];
+				Mesh* Asset = Meshes[i];
+
+				Asset->Options			 = Options;
+				Asset->Name				 = Archive.GetName(Index);
+				Asset->ArchiveIndex		 = static_cast<u32>(Index);
+				Asset->OptimizationStats = Archive.GetOptimizationStats(Index);
+				Asset->BoundingBox		 = Archive.GetBoundingBox(Index);
+
+				Span<const MeshLod> Lods = Archive.GetStream<MeshLod>(Index, MeshStream::Lods);
+				Asset->Lods.assign(Lods.begin(), Lods.end());
+
+				Span<const DirectX::CullData> MeshletCullData = Archive.GetStream<DirectX::CullData>(Index, MeshStream::MeshletCullData);
+				Asset->MeshletCullData.assign(MeshletCullData.begin(), MeshletCullData.end());
+
+				// Compressed streams are the only ones that are not used in place
+				Span<const Vertex> Vertices			  = Archive.GetStream<Vertex>(Index, MeshStream::Vertices);
+				auto			   CompressedVertices = Archive.GetStream<CompressedVertex>(Index, MeshStream::CompressedVertices);
+				if (!CompressedVertices.empty())
+				{
+					Asset->Vertices.resize(CompressedVertices.size());
+					VertexCompression::Decode(CompressedVertices, Asset->BoundingBox, Asset->Vertices.data());
+					Vertices = Asset->Vertices;
+				}
+
+				Span<const u32> Indices = Archive.GetStream<u32>(Index, MeshStream::Indices);
+				if (!Archive.GetStream<u8>(Index, MeshStream::CompressedIndices).empty())
+				{
+					Asset->Indices = std::move(DecodedIndices[i]);
+					Indices		   = Asset->Indices;
+				}
+
+				Asset->SetMappedStreams(
+					Archive.GetFile(),
+					Vertices,
+					Indices,
+					Archive.GetStream<DirectX::Meshlet>(Index, MeshStream::Meshlets),
+					Archive.GetStream<u8>(Index, MeshStream::UniqueVertexIndices),
+					Archive.GetStream<DirectX::MeshletTriangle>(Index, MeshStream::PrimitiveIndices),
+					Archive.GetStream<u32>(Index, MeshStream::LodIndices));
+			});
+
+		if (StageTimes.IndexBytes > 0)
+		{
+			LogIndexCompression(BinaryPath, StageTimes);
+		}
+		return Meshes;
+	}
+
+	TextureImporter::TextureImporter()
+	{
+		SupportedExtensions.insert(L".dds");
+		SupportedExtensions.insert(L".hdr");
+		SupportedExtensions.insert(L".tga");
+		SupportedExtensions.insert(L".bmp");
+		SupportedExtensions.insert(L".png");
+		SupportedExtensions.insert(L".gif");
+		SupportedExtensions.insert(L".tiff");
+		SupportedExtensions.insert(L".jpg");
+		SupportedExtensions.insert(L".jpeg");
+	}
+
+	// Everything in TextureImportOptions that affects the cooked output
+	static u64 HashTextureImportOptions(const TextureImportOptions& Options)
+	{
+		struct
+		{
+			u32 Version;
+			u8	sRGB;
+			u8	GenerateMips;
+			u8	Compress;
+			u8	Usage;
+			u8	Quality;
+			u8	Filter;
+			u8	ConvertToCubemap;
+			u8	Padding[1];
+		} Key = {
+			.Version		  = TextureImporter::Version,
+			.sRGB			  = Options.sRGB,
+			.GenerateMips	  = Options.GenerateMips,
+			.Compress		  = Options.Compress,
+			.Usage			  = static_cast<u8>(Options.Usage),
+			.Quality		  = static_cast<u8>(Options.Quality),
+			.Filter			  = static_cast<u8>(Options.Filter),
+			.ConvertToCubemap = Options.ConvertToCubemap,
+			.Padding		  = {},
+		};
+		return Hash::Hash64(&Key, sizeof(Key));
+	}
+
+	u64 TextureImporter::GetCacheKey(const AssetCache& Cache, const TextureImportOptions& Options)
+	{
+		u64 SourceHash = Cache.HashSource(Options.Path);
+		return SourceHash != AssetCache::NoKey ? Hash::Combine(SourceHash, HashTextureImportOptions(Options)) : AssetCache::NoKey;
+	}
+
+	AssetHandle TextureImporter::Import(AssetManager* AssetManager, const TextureImportOptions& Options)
+	{
+		ImportReport Report;
+		Texture*	 Asset = AssetManager->CreateAsset<Texture>();
+		Load(AssetManager->GetCache(), Options, Asset, &Report);
+		{
+			ImportReport::ScopedStage Stage(&Report, "Upload", Asset->GetSizeInBytes());
+			AssetManager->RequestUpload(Asset);
+		}
+		Report.Log();
+		Report.Append(AssetManager->GetCache().GetDirectory() / ImportReport::FileName);
+		return Asset->Handle;
+	}
+
+	static std::filesystem::path GetSkySamplerPath(const std::filesystem::path& BinaryPath)
+	{
+		return std::filesystem::path(BinaryPath).replace_extension(SkyLightSampler::CookedExtension);
+	}
+
+	static std::filesystem::path GetIrradiancePath(const std::filesystem::path& BinaryPath)
+	{
+		return std::filesystem::path(BinaryPath).replace_extension(".irradiance.json");
+	}
+
+	static void WriteIrradiance(const std::filesystem::path& Path, const SkyIrradiance& Irradiance)
+	{
+		nlohmann::json Json = nlohmann::json::array();
+		for (const Math::Vec3f& Coefficient : Irradiance.Coefficients)
+		{
+			Json.push_back({ Coefficient.x, Coefficient.y, Coefficient.z });
+		}
+
+		std::ofstream Stream(Path);
+		Stream << Json.dump(2);
+	}
+
+	// Empty if the file is missing or not a list of every coefficient
+	static std::optional<SkyIrradiance> ReadIrradiance(const std::filesystem::path& Path)
+	{
+		std::ifstream Stream(Path);
+		if (!Stream)
+		{
+			return std::nullopt;
+		}
+		const nlohmann::json Json = nlohmann::json::parse(Stream, nullptr, false);
+		if (!Json.is_array() || Json.size() != SkyIrradiance::NumCoefficients)
+		{
+			return std::nullopt;
+		}
+
+		SkyIrradiance Irradiance;
+		for (size_t i = 0; i < SkyIrradiance::NumCoefficients; ++i)
+		{
+			const nlohmann::json& Coefficient = Json[i];
+			if (!Coefficient.is_array() || Coefficient.size() != 3 || !Coefficient[0].is_number() || !Coefficient[1].is_number() ||
+				!Coefficient[2].is_number())
+			{
+				return std::nullopt;
+			}
+			Irradiance.Coefficients[i] = Math::Vec3f(Coefficient[0].get<f32>(), Coefficient[1].get<f32>(), Coefficient[2].get<f32>());
+		}
+		return Irradiance;
+	}
+
+	// The level of a sky light image no wider than MaxWidth, or the base level if there is none, as RGBA32F. Null for
+	// textures that are not sky light images: uncompressed float 2D images twice as wide as they are high
+	static const DirectX::Image* GetSkyLightImage(const Texture* Asset, size_t MaxWidth, DirectX::ScratchImage& Converted)
+	{
+		const DirectX::ScratchImage& Image	  = Asset->TexImage;
+		const DirectX::TexMetadata&	 Metadata = Image.GetMetadata();
+		if (Image.GetImageCount() == 0 || Asset->IsCubemap || Metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D ||
+			Metadata.arraySize != 1 || Metadata.width != Metadata.height * 2 || DirectX::IsCompressed(Metadata.format) ||
+			DirectX::FormatDataType(Metadata.format) != DirectX::FORMAT_TYPE_FLOAT)
+		{
+			return nullptr;
+		}
+
+		size_t Level = 0;
+		while (Level + 1 < Metadata.mipLevels && (Metadata.width >> Level) > MaxWidth)
+		{
+			Level++;
+		}
+		const DirectX::Image* Source = Image.GetImage(Level, 0, 0);
+		if (Source->format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+		{
+			return Source;
+		}
+		if (FAILED(Convert(*Source, DXGI_FORMAT_R32G32B32A32_FLOAT, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, Converted)))
+		{
+			return nullptr;
+		}
+		return Converted.GetImage(0, 0, 0);
+	}
+
+	bool TextureImporter::Load(AssetCache& Cache, const TextureImportOptions& Options, Texture* Asset, ImportReport* Report /*= nullptr*/)
+	{
+		if (Report)
+		{
+			Report->Source = Options.Path;
+		}
+
+		// A DDS source already is what cooking would produce
+		if (Options.Path.extension() == L".dds" || !exists(Options.Path))
+		{
+			Decode(Options, Asset, Report);
+			BuildSkySampler(Asset, Report);
+			if (Options.ConvertToCubemap)
+			{
+				ConvertToCubemap(Asset, Report);
+			}
+			return Asset->TexImage.GetImageCount() > 0;
+		}
+
+		u64 Key = AssetCache::NoKey;
+		{
+			// The source is only hashed for its cache key if it changed since it was last hashed
+			ImportReport::ScopedStage Stage(Report, "Hash", file_size(Options.Path));
+			Key = GetCacheKey(Cache, Options);
+		}
+		if (Key == AssetCache::NoKey)
+		{
+			KAGUYA_LOG(Asset, Error, "{} cannot be read", Options.Path.string());
+			return false;
+		}
+
+		std::filesystem::path BinaryPath;
+		if (Cache.Lookup(Key, CookedExtension, BinaryPath))
+		{
+			ImportReport::ScopedStage Stage(Report, "Read", file_size(BinaryPath));
+
+			DirectX::TexMetadata  TexMetadata = {};
+			DirectX::ScratchImage Image		  = {};
+			if (SUCCEEDED(LoadFromDDSFile(BinaryPath.c_str(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, &TexMetadata, Image)))
+			{
+				Asset->Options	 = Options;
+				Asset->Extent	 = Math::Vec2i(static_cast<int>(TexMetadata.width), static_cast<int>(TexMetadata.height));
+				Asset->IsCubemap = TexMetadata.IsCubemap();
+				Asset->Name		 = Options.Path.filename().string();
+				Asset->TexImage	 = std::move(Image);
+
+				// Sky light tables missing from the cache (or of an older version) are rebuilt rather than the whole texture.
+				// Sky lights converted to cubemaps no longer have the image their tables and irradiance came from, without
+				// them they are cooked again
+				if (Options.ConvertToCubemap && Asset->IsCubemap)
+				{
+					Asset->Irradiance = ReadIrradiance(GetIrradiancePath(BinaryPath));
+					if (Asset->SkySampler.Load(GetSkySamplerPath(BinaryPath)) && Asset->Irradiance)
+					{
+						return true;
+					}
+				}
+				else
+				{
+					if (!Asset->SkySampler.Load(GetSkySamplerPath(BinaryPath)))
+					{
+						BuildSkySampler(Asset, Report);
+						if (Asset->SkySampler.IsValid())
+						{
+							Asset->SkySampler.Save(GetSkySamplerPath(BinaryPath));
+						}
+					}
+					return true;
+				}
+			}
+			else
+			{
+				Cache.Invalidate(BinaryPath);
+			}
+		}
+
+		Decode(Options, Asset, Report);
+		if (Asset->TexImage.GetImageCount() == 0)
+		{
+			return false;
+		}
+		if (Options.Compress)
+		{
+			Compress(Asset, Report);
+		}
+		BuildSkySampler(Asset, Report);
+		if (Options.ConvertToCubemap)
+		{
+			ConvertToCubemap(Asset, Report);
+		}
+
+		if (Report)
+		{
+			Report->Cooked = true;
+		}
+		ImportReport::ScopedStage Stage(Report, "Export");
+		if (Export(BinaryPath, Asset))
+		{
+			Stage.SetSizeInBytes(file_size(BinaryPath));
+		}
+		return true;
+	}
+
+	// The path textures took before ImageDecoder, still used for DDS, BMP, GIF and TIFF
+	static void LoadWithDirectXTex(const std::filesystem::path& Path, DirectX::TexMetadata& TexMetadata, DirectX::ScratchImage& Image)
+	{
+		const auto Extension = Path.extension().string();
+		if (Extension == ".dds")
+		{
+			LoadFromDDSFile(Path.c_str(), DirectX::DDS_FLAGS::DDS_FLAGS_FORCE_RGB, &TexMetadata, Image);
+		}
+		else if (Extension == ".tga")
+		{
+			LoadFromTGAFile(Path.c_str(), &TexMetadata, Image);
+		}
+		else if (Extension == ".hdr")
+		{
+			LoadFromHDRFile(Path.c_str(), &TexMetadata, Image);
+		}
+		else
+		{
+			LoadFromWICFile(Path.c_str(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_RGB, &TexMetadata, Image);
+		}
+	}
+
+	// Into an image of the same size and format
+	static void CopyPixels(const DecodedImage& Source, const DirectX::Image& Destination)
+	{
+		for (u32 y = 0; y < Source.Height; ++y)
+		{
+			std::memcpy(Destination.pixels + y * Destination.rowPitch, &Source.Pixels[y * Source.GetRowPitch()], Source.GetRowPitch());
+		}
+	}
+
+	// A decoded image and its mips as one texture, RGBA8 (UNORM, the sRGB view is made when it is uploaded) or RGBA32F
+	static bool CopyToScratchImage(const DecodedImage& Base, const std::vector<DecodedImage>& Mips, DirectX::ScratchImage& Image)
+	{
+		const DXGI_FORMAT Format = Base.IsFloat ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+		if (FAILED(Image.Initialize2D(Format, Base.Width, Base.Height, 1, Mips.size() + 1)))
+		{
+			return false;
+		}
+
+		for (size_t Level = 0; Level <= Mips.size(); ++Level)
+		{
+			CopyPixels(Level == 0 ? Base : Mips[Level - 1], *Image.GetImage(Level, 0, 0));
+		}
+		return true;
+	}
+
+	void TextureImporter::Decode(const TextureImportOptions& Options, Texture* Asset, ImportReport* Report /*= nullptr*/)
+	{
+		const auto& Path = Options.Path;
+
+		DirectX::ScratchImage OutImage = {};
+		if (ImageDecoder::SupportsExtension(Path))
+		{
+			DecodedImage Base;
+			std::string	 Error;
+			{
+				ImportReport::ScopedStage Stage(Report, "Decode", exists(Path) ? file_size(Path) : 0);
+				if (!ImageDecoder::Decode(Path, Base, &Error))
+				{
+					KAGUYA_LOG(Asset, Error, "Failed to decode {}: {}", Path.string(), Error);
+				}
+			}
+
+			std::vector<DecodedImage> Mips;
+			if (Options.GenerateMips && !Base.Pixels.empty())
+			{
+				ImportReport::ScopedStage Stage(Report, "Mips", Base.Pixels.size());
+				MipGenerator::Generate(Base, Options.sRGB, Options.Filter, Mips);
+			}
+			if (!Base.Pixels.empty())
+			{
+				CopyToScratchImage(Base, Mips, OutImage);
+			}
+		}
+		else
+		{
+			DirectX::TexMetadata  TexMetadata = {};
+			DirectX::ScratchImage BaseImage	  = {};
+			{
+				ImportReport::ScopedStage Stage(Report, "Decode", exists(Path) ? file_size(Path) : 0);
+				LoadWithDirectXTex(Path, TexMetadata, BaseImage);
+			}
+
+			// DDS files come with the mips they have
+			if (Options.GenerateMips && Path.extension() != L".dds" && BaseImage.GetImageCount() > 0)
+			{
+				ImportReport::ScopedStage Stage(Report, "Mips", BaseImage.GetPixelsSize());
+				GenerateMipMaps(*BaseImage.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, OutImage, false);
+			}
+			else
+			{
+				OutImage = std::move(BaseImage);
+			}
+		}
+
+		const DirectX::TexMetadata& TexMetadata = OutImage.GetMetadata();
+
+		Asset->Options	 = Options;
+		Asset->Extent	 = Math::Vec2i(static_cast<int>(TexMetadata.width), static_cast<int>(TexMetadata.height));
+		Asset->IsCubemap = TexMetadata.IsCubemap();
+		Asset->Name		 = Path.filename().string();
+		Asset->TexImage	 = std::move(OutImage);
+	}
+
+	void TextureImporter::Compress(Texture* Asset, ImportReport* Report /*= nullptr*/)
+	{
+		const auto& Options = Asset->Options;
+
+		DirectX::ScratchImage	Compressed;
+		TextureCompressionStats Stats;
+		if (!TextureCompressor::Compress(Asset->TexImage, Options.Usage, Options.Quality, Compressed, &Stats))
+		{
+			KAGUYA_LOG(Asset, Info, "{} is left uncompressed, it is a float image or not made of whole 4x4 blocks", Asset->Name);
+			return;
+		}
+
+		if (Report)
+		{
+			Report->AddStage("Compress", Stats.Ticks, Stats.SizeInBytes);
+		}
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} to {}: {} KiB -> {} KiB in {:.2f}ms ({:.0f} MB/s), PSNR {:.2f} dB",
+			Asset->Name,
+			TextureCompressor::GetFormatName(Stats.Format),
+			Stats.SizeInBytes >> 10,
+			Stats.CompressedSizeInBytes >> 10,
+			static_cast<f64>(Stats.Ticks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			static_cast<f64>(Stats.SizeInBytes) / 1e6 * static_cast<f64>(Stopwatch::Frequency) / static_cast<f64>(std::max<i64>(Stats.Ticks, 1)),
+			Stats.Psnr);
+
+		Asset->TexImage			= std::move(Compressed);
+		Asset->CompressionStats = Stats;
+	}
+
+	void TextureImporter::BuildSkySampler(Texture* Asset, ImportReport* Report /*= nullptr*/)
+	{
+		Asset->SkySampler = {};
+
+		DirectX::ScratchImage Converted;
+		const DirectX::Image* Image = GetSkyLightImage(Asset, SkyLightSampler::MaxWidth, Converted);
+		if (!Image)
+		{
+			return;
+		}
+
+		ImportReport::ScopedStage Stage(Report, "SkySampler", Image->slicePitch);
+		const i64				  Start = Stopwatch::GetTimestamp();
+		Asset->SkySampler.Build(Image->pixels, static_cast<u32>(Image->width), static_cast<u32>(Image->height), Image->rowPitch);
+		const i64 Ticks = Stopwatch::GetTimestamp() - Start;
+
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} sky light sampling tables: {}x{}, {} KiB in {:.2f}ms ({:.0f} MB/s)",
+			Asset->Name,
+			Asset->SkySampler.GetWidth(),
+			Asset->SkySampler.GetHeight(),
+			Asset->SkySampler.GetSizeInBytes() >> 10,
+			static_cast<f64>(Ticks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			GetMegabytesPerSecond(Image->slicePitch, Ticks));
+	}
+
+	void TextureImporter::ConvertToCubemap(Texture* Asset, ImportReport* Report /*= nullptr*/)
+	{
+		Asset->Irradiance.reset();
+
+		// Faces of at most MaxFaceSize keep the resolution of images up to 4 times as wide
+		DirectX::ScratchImage Converted;
+		const DirectX::Image* Image = GetSkyLightImage(Asset, 4 * SkyLightPrefilter::MaxFaceSize, Converted);
+		if (!Image)
+		{
+			KAGUYA_LOG(Asset, Info, "{} is not converted to a cubemap, it is not a float image twice as wide as it is high", Asset->Name);
+			return;
+		}
+
+		const u32 Width		= static_cast<u32>(Image->width);
+		const u32 Height	= static_cast<u32>(Image->height);
+		const u32 FaceSize	= SkyLightPrefilter::GetFaceSize(Width);
+		const u32 NumLevels = Asset->Options.GenerateMips ? MipGenerator::GetNumLevels(FaceSize, FaceSize) : 1;
+
+		i64													  Start = Stopwatch::GetTimestamp();
+		std::array<DecodedImage, SkyLightPrefilter::NumFaces> Faces;
+		SkyLightPrefilter::ConvertToCubemap(Image->pixels, Width, Height, Image->rowPitch, FaceSize, Faces);
+		const i64 ConvertTicks = Stopwatch::GetTimestamp() - Start;
+
+		Start = Stopwatch::GetTimestamp();
+		std::array<std::vector<DecodedImage>, SkyLightPrefilter::NumFaces> Mips;
+		SkyLightPrefilter::Prefilter(Faces, NumLevels, Mips);
+		const i64 PrefilterTicks = Stopwatch::GetTimestamp() - Start;
+
+		Start								= Stopwatch::GetTimestamp();
+		const SkyIrradiance Irradiance		= SkyLightPrefilter::ProjectIrradiance(Image->pixels, Width, Height, Image->rowPitch);
+		const i64			IrradianceTicks = Stopwatch::GetTimestamp() - Start;
+
+		DirectX::ScratchImage Cubemap;
+		if (FAILED(Cubemap.InitializeCube(DXGI_FORMAT_R32G32B32A32_FLOAT, FaceSize, FaceSize, 1, NumLevels)))
+		{
+			KAGUYA_LOG(Asset, Error, "Could not create the cubemap of {}", Asset->Name);
+			return;
+		}
+		for (u32 Face = 0; Face < SkyLightPrefilter::NumFaces; ++Face)
+		{
+			for (u32 Level = 0; Level < NumLevels; ++Level)
+			{
+				CopyPixels(Level == 0 ? Faces[Face] : Mips[Face][Level - 1], *Cubemap.GetImage(Level, Face, 0));
+			}
+		}
+
+		if (Report)
+		{
+			Report->AddStage("Cubemap", ConvertTicks, Image->slicePitch);
+			Report->AddStage("Prefilter", PrefilterTicks, Cubemap.GetPixelsSize());
+			Report->AddStage("Irradiance", IrradianceTicks, Image->slicePitch);
+		}
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} to a cubemap of {}x{} faces with {} GGX prefiltered levels ({} samples per texel): convert {:.2f}ms, prefilter "
+			"{:.2f}ms, SH irradiance {:.2f}ms ({:.0f} MB/s)",
+			Asset->Name,
+			FaceSize,
+			FaceSize,
+			NumLevels - 1,
+			SkyLightPrefilter::NumSamples,
+			static_cast<f64>(ConvertTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			static_cast<f64>(PrefilterTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			static_cast<f64>(IrradianceTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			GetMegabytesPerSecond(Image->slicePitch, IrradianceTicks));
+
+		Asset->Extent	  = Math::Vec2i(static_cast<int>(FaceSize), static_cast<int>(FaceSize));
+		Asset->IsCubemap  = true;
+		Asset->TexImage	  = std::move(Cubemap);
+		Asset->Irradiance = Irradiance;
+	}
+
+	bool TextureImporter::Export(const std::filesystem::path& BinaryPath, const Texture* Asset)
+	{
+		const DirectX::ScratchImage& Image = Asset->TexImage;
+		if (FAILED(SaveToDDSFile(Image.GetImages(), Image.GetImageCount(), Image.GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, BinaryPath.c_str())))
+		{
+			KAGUYA_LOG(Asset, Warn, "Could not write {}", BinaryPath.string());
+			std::error_code Error;
+			std::filesystem::remove(BinaryPath, Error);
+			return false;
+		}
+		if (Asset->SkySampler.IsValid() && !Asset->SkySampler.Save(GetSkySamplerPath(BinaryPath)))
+		{
+			KAGUYA_LOG(Asset, Warn, "Could not write {}", GetSkySamplerPath(BinaryPath).string());
+		}
+		if (Asset->Irradiance)
+		{
+			WriteIrradiance(GetIrradiancePath(BinaryPath), *Asset->Irradiance);
+		}
+		return true;
+	}
+
+	void TextureImporter::Benchmark(AssetCache& Cache, const TextureImportOptions& Options)
+	{
+		// Cooks the texture unless it already is
+		Texture Cooked;
+		if (!Load(Cache, Options, &Cooked))
+		{
+			KAGUYA_LOG(Asset, Error, "Failed to load {}", Options.Path.string());
+			return;
+		}
+
+		i64		Start = Stopwatch::GetTimestamp();
+		Texture FromSource;
+		Decode(Options, &FromSource);
+		i64 SourceTicks = Stopwatch::GetTimestamp() - Start;
+
+		Start = Stopwatch::GetTimestamp();
+		Texture FromCache;
+		Load(Cache, Options, &FromCache);
+		i64 CacheTicks = Stopwatch::GetTimestamp() - Start;
+
+		const DirectX::TexMetadata& Metadata = FromCache.TexImage.GetMetadata();
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} ({}x{}, {} mips, {} KiB): source {:.2f}ms, cooked {:.2f}ms (including hashing the source), {:.1f}x",
+			Options.Path.filename().string(),
+			Metadata.width,
+			Metadata.height,
+			Metadata.mipLevels,
+			FromCache.TexImage.GetPixelsSize() >> 10,
+			static_cast<f64>(SourceTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			static_cast<f64>(CacheTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			static_cast<f64>(SourceTicks) / static_cast<f64>(std::max<i64>(CacheTicks, 1)));
+	}
+
+	void TextureImporter::BenchmarkDecode(const TextureImportOptions& Options)
+	{
+		const auto& Path = Options.Path;
+		if (!ImageDecoder::SupportsExtension(Path))
+		{
+			KAGUYA_LOG(Asset, Info, "{} is only decoded by WIC/DirectXTex", Path.filename().string());
+			return;
+		}
+
+		i64					  Start		  = Stopwatch::GetTimestamp();
+		DirectX::TexMetadata  TexMetadata = {};
+		DirectX::ScratchImage LegacyImage;
+		LoadWithDirectXTex(Path, TexMetadata, LegacyImage);
+		i64 LegacyDecodeTicks = Stopwatch::GetTimestamp() - Start;
+
+		Start = Stopwatch::GetTimestamp();
+		DirectX::ScratchImage LegacyMips;
+		if (LegacyImage.GetImageCount() > 0)
+		{
+			GenerateMipMaps(*LegacyImage.GetImage(0, 0, 0), DirectX::TEX_FILTER_DEFAULT, 0, LegacyMips, false);
+		}
+		i64 LegacyMipsTicks = Stopwatch::GetTimestamp() - Start;
+
+		Start = Stopwatch::GetTimestamp();
+		DecodedImage Base;
+		std::string	 Error;
+		if (!ImageDecoder::Decode(Path, Base, &Error))
+		{
+			KAGUYA_LOG(Asset, Error, "Failed to decode {}: {}", Path.string(), Error);
+			return;
+		}
+		i64 DecodeTicks = Stopwatch::GetTimestamp() - Start;
+
+		Start = Stopwatch::GetTimestamp();
+		std::vector<DecodedImage> Mips;
+		MipGenerator::Generate(Base, Options.sRGB, Options.Filter, Mips);
+		i64 MipsTicks = Stopwatch::GetTimestamp() - Start;
+
+		// The base levels in the format of Base, WIC may have tagged the image as sRGB which is only a view of the same bytes
+		f64 MaxDifference = -1.0;
+		if (LegacyImage.GetImageCount() > 0 && TexMetadata.width == Base.Width && TexMetadata.height == Base.Height)
+		{
+			DirectX::Image Legacy = *LegacyImage.GetImage(0, 0, 0);
+			Legacy.format		  = DirectX::MakeLinear(Legacy.format);
+
+			const DXGI_FORMAT	  Format = Base.IsFloat ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+			DirectX::ScratchImage Converted;
+			if (Legacy.format == Format || SUCCEEDED(Convert(Legacy, Format, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, Converted)))
+			{
+				const DirectX::Image& Image = Legacy.format == Format ? Legacy : *Converted.GetImage(0, 0, 0);
+				MaxDifference				= 0.0;
+				for (u32 y = 0; y < Base.Height; ++y)
+				{
+					const u8* Row	= &Base.Pixels[y * Base.GetRowPitch()];
+					const u8* Other = Image.pixels + y * Image.rowPitch;
+					for (size_t i = 0; i < Base.Width * 4; ++i)
+					{
+						const f64 a = Base.IsFloat ? reinterpret_cast<const f32*>(Row)[i] : Row[i];
+						const f64 b = Base.IsFloat ? reinterpret_cast<const f32*>(Other)[i] : Other[i];
+						MaxDifference = std::max(MaxDifference, std::abs(a - b));
+					}
+				}
+			}
+		}
+
+		const u64 SizeInBytes = Base.Pixels.size();
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} ({}x{}): decode WIC/DirectXTex {:.2f}ms, ImageDecoder {:.2f}ms ({:.0f} MB/s, {:.1f}x); mips DirectXTex {:.2f}ms, "
+			"MipGenerator {} {:.2f}ms ({:.0f} MB/s, {:.1f}x); largest base level difference {}",
+			Path.filename().string(),
+			Base.Width,
+			Base.Height,
+			static_cast<f64>(LegacyDecodeTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			static_cast<f64>(DecodeTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			GetMegabytesPerSecond(SizeInBytes, DecodeTicks),
+			static_cast<f64>(LegacyDecodeTicks) / static_cast<f64>(std::max<i64>(DecodeTicks, 1)),
+			static_cast<f64>(LegacyMipsTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			Options.Filter == MipFilter::Kaiser ? "Kaiser" : "box",
+			static_cast<f64>(MipsTicks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			GetMegabytesPerSecond(SizeInBytes, MipsTicks),
+			static_cast<f64>(LegacyMipsTicks) / static_cast<f64>(std::max<i64>(MipsTicks, 1)),
+			MaxDifference < 0.0 ? std::string("n/a") : std::format("{:g}", MaxDifference));
+	}
+
+	void TextureImporter::TestSkySampler(AssetCache& Cache, const TextureImportOptions& Options, u32 NumSamples)
+	{
+		Texture Asset;
+		if (!Load(Cache, Options, &Asset))
+		{
+			KAGUYA_LOG(Asset, Error, "Failed to load {}", Options.Path.string());
+			return;
+		}
+
+		// The image the tables were built from, sky lights converted to cubemaps no longer have it
+		Texture Source;
+		Decode(Options, &Source);
+		DirectX::ScratchImage Converted;
+		const DirectX::Image* Image = GetSkyLightImage(&Source, SkyLightSampler::MaxWidth, Converted);
+		if (!Image || !Asset.SkySampler.IsValid())
+		{
+			KAGUYA_LOG(Asset, Info, "{} is not a sky light image", Options.Path.filename().string());
+			return;
+		}
+
+		// The tables may have been read from the cache, they have to match the level they are tested against
+		if (Image->width != Asset.SkySampler.GetWidth() || Image->height != Asset.SkySampler.GetHeight())
+		{
+			KAGUYA_LOG(Asset, Error, "{} sky light sampling tables do not match the image", Options.Path.filename().string());
+			return;
+		}
+
+		const i64				   Start = Stopwatch::GetTimestamp();
+		const SkyLightSamplerStats Stats = Asset.SkySampler.Test(Image->pixels, Image->rowPitch, NumSamples);
+		const i64				   Ticks = Stopwatch::GetTimestamp() - Start;
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"{} sky light sampling ({}x{}, {} samples in {:.2f}ms): PDF integral {:.4f}, {} PDF mismatches, chi-square {:.1f} "
+			"with {} degrees of freedom (p = {:.3f}), {:.1f}x less variance than uniform sampling",
+			Options.Path.filename().string(),
+			Asset.SkySampler.GetWidth(),
+			Asset.SkySampler.GetHeight(),
+			Stats.NumSamples,
+			static_cast<f64>(Ticks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency),
+			Stats.PdfIntegral,
+			Stats.NumPdfMismatches,
+			Stats.ChiSquare,
+			Stats.DegreesOfFreedom,
+			Stats.PValue,
+			Stats.VarianceReduction);
+		// The PDF integral is too noisy to test against, uniform directions rarely find a small bright sun
+		if (Stats.PValue < 0.001)
+		{
+			KAGUYA_LOG(Asset, Warn, "{} samples do not follow the PDF of the sky light sampling tables", Options.Path.filename().string());
+		}
 	}
 } // namespace Asset
@@ -1,8 +1,17 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <queue>
 #include <set>
+#include <unordered_map>
+#include <functional>
 #include "System/System.h"
 #include "Texture.h"
 #include "Mesh.h"
+#include "MeshArchive.h"
+#include "AssetCache.h"
+#include "ImportReport.h"
 
 DECLARE_LOG_CATEGORY(Asset);
 
@@ -10,6 +19,11 @@ namespace Asset
 {
 	class AssetManager;
 
+	// Generational slot map. Lookups and enumeration never lock, a handle only resolves while its version matches the
+	// slot's, so handles to a destroyed asset stay invalid after the slot is reused. Writers are serialized by a mutex and
+	// publish with release stores, slots live in chunks that never move once allocated. A lookup may still return an asset
+	// that is destroyed right after, so destroyed assets are retired instead of deleted (see TakeRetired).
+	// Handles can share another handle's asset (see Share), an asset is reference counted by the slots that draw with it
 	template<typename T>
 	class AssetRegistry
 	{
@@ -18,149 +32,377 @@ namespace Asset
 
 		static constexpr AssetType Enum = AssetTypeTraits<T>::Enum;
 
+		static constexpr u32 ChunkSize	= 4096;
+		static constexpr u32 MaxChunks	= 1024;
+		static constexpr u64 MaxVersion = (1 << 15) - 1;
+
+		class Iterator
+		{
+		public:
+			Iterator(const AssetRegistry* Registry, u32 Index)
+				: Registry(Registry)
+				, Index(Index)
+			{
+			}
+
+			AssetHandle operator*() const noexcept { return Registry->LoadHandle(Index); }
+			Iterator&	operator++() noexcept
+			{
+				++Index;
+				return *this;
+			}
+			bool operator!=(const Iterator& Other) const noexcept { return Index != Other.Index; }
+
+		private:
+			const AssetRegistry* Registry;
+			u32					 Index;
+		};
+
 		AssetRegistry()
 		{
 		}
 
+		~AssetRegistry()
+		{
+			DestroyAll();
+			for (T* Asset : Retired)
+			{
+				delete Asset;
+			}
+			for (auto& Chunk : Chunks)
+			{
+				delete Chunk.load(std::memory_order_relaxed);
+			}
+		}
+
+		AssetRegistry(const AssetRegistry&) = delete;
+		AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+		// Every handle from before stays invalid, versions carry on. Ids start over at 0 and are handed out in order again,
+		// handles that were saved by id (e.g. in a world) take their version from GetSlotVersion once recreated
 		void DestroyAll()
 		{
-			// Destroy in opposite order
-			RwLockWriteGuard Guard(Lock);
-			Assets.clear();
-			CachedHandles.clear();
-			Index = 0;
-			decltype(IndexQueue)().swap(IndexQueue);
+			MutexGuard Guard(Lock);
+
+			decltype(FreeIds)().swap(FreeIds);
+			u32 Count = Size.load(std::memory_order_relaxed);
+			for (u32 Id = 0; Id < Count; ++Id)
+			{
+				// Destroyed slots already hold their next version
+				Slot&		Slot	= GetSlot(Id);
+				AssetHandle Current = LoadHandle(Id);
+				if (Current.IsValid())
+				{
+					AssetHandle Destroyed = {};
+					Destroyed.Version	  = (Current.Version + 1) & MaxVersion;
+					Slot.Handle.store(Pack(Destroyed), std::memory_order_release);
+				}
+				Slot.Shared.store(nullptr, std::memory_order_release);
+				if (T* Asset = Slot.Asset.exchange(nullptr, std::memory_order_acq_rel))
+				{
+					Retired.push_back(Asset);
+				}
+				FreeIds.push(Id);
+			}
+			for (auto& [Asset, Shared] : References)
+			{
+				if (Shared.Orphaned)
+				{
+					Retired.push_back(Asset);
+				}
+			}
+			References.clear();
 		}
 
-		auto begin() noexcept { return CachedHandles.begin(); }
-		auto end() noexcept { return CachedHandles.end(); }
+		// Wait-free, every slot that was published when end() was called is visited once, destroyed ones as invalid handles
+		Iterator begin() const noexcept { return Iterator(this, 0); }
+		Iterator end() const noexcept { return Iterator(this, Size.load(std::memory_order_acquire)); }
+
+		size_t size() const noexcept { return Size.load(std::memory_order_acquire); }
 
-		size_t size() const noexcept { return CachedHandles.size(); }
+		bool ValidateHandle(AssetHandle Handle) const noexcept
+		{
+			return Handle.IsValid() && Handle.Type == Enum && Handle.Id < Size.load(std::memory_order_acquire);
+		}
 
-		bool ValidateHandle(AssetHandle Handle) noexcept
+		// Version of the asset in slot Id, or of the next one created in it
+		u16 GetSlotVersion(u32 Id) const noexcept
 		{
-			return Handle.IsValid() && Handle.Type == Enum && Handle.Id < Assets.size();
+			return Id < Size.load(std::memory_order_acquire) ? static_cast<u16>(LoadHandle(Id).Version) : 0;
 		}
 
 		template<typename... TArgs>
 		AssetHandle Create(TArgs&&... Args)
 		{
-			RwLockWriteGuard Guard(Lock);
+			return Add(std::make_unique<T>(std::forward<TArgs>(Args)...));
+		}
 
-			u32 Index = GetAssetIndex();
+		// Takes over an asset that was created outside of the registry, e.g. decoded on a loader thread
+		AssetHandle Add(std::unique_ptr<T> NewAsset)
+		{
+			MutexGuard Guard(Lock);
 
 			AssetHandle Handle = {};
 			Handle.Type		   = Enum;
 			Handle.State	   = false;
-			Handle.Version	   = 0;
-			Handle.Id		   = Index;
 
-			auto& Asset	  = Assets[Index];
-			Asset		  = std::make_unique<T>(std::forward<TArgs>(Args)...);
-			Asset->Handle = Handle;
+			bool Grow = FreeIds.empty();
+			if (!Grow)
+			{
+				// Destroy left the next version in the slot
+				Handle.Id = FreeIds.front();
+				FreeIds.pop();
+				Handle.Version = LoadHandle(static_cast<u32>(Handle.Id)).Version;
+			}
+			else
+			{
+				u32 Id = Size.load(std::memory_order_relaxed);
+				assert(Id < ChunkSize * MaxChunks);
+				if (!Chunks[Id / ChunkSize].load(std::memory_order_relaxed))
+				{
+					Chunks[Id / ChunkSize].store(new Chunk(), std::memory_order_release);
+				}
+				Handle.Version = 0;
+				Handle.Id	   = Id;
+			}
+
+			NewAsset->Handle = Handle;
 
-			CachedHandles[Index] = Handle;
+			Slot& Slot = GetSlot(static_cast<u32>(Handle.Id));
+			// Released so that a lookup which loads the asset also sees the version of the destroy before it (see GetAsset)
+			Slot.Asset.store(NewAsset.release(), std::memory_order_release);
+			Slot.Handle.store(Pack(Handle), std::memory_order_release);
+			if (Grow)
+			{
+				Size.store(static_cast<u32>(Handle.Id) + 1, std::memory_order_release);
+			}
 			return Handle;
 		}
 
-		T* GetAsset(AssetHandle Handle)
+		// Null if Handle is stale, regardless of its state
+		T* GetAsset(AssetHandle Handle) const noexcept
 		{
-			return Assets[Handle.Id].get();
+			if (Resolve(Handle).IsValid())
+			{
+				// The slot may have been destroyed and reused in between, the asset is Handle's if the version still matches
+				T* Asset = GetSlot(static_cast<u32>(Handle.Id)).Asset.load(std::memory_order_acquire);
+				if (Resolve(Handle).IsValid())
+				{
+					return Asset;
+				}
+			}
+			return nullptr;
 		}
 
-		T* GetValidAsset(AssetHandle& Handle)
+		// The asset to draw Handle with, the shared one if Handle shares another handle's asset
+		T* GetValidAsset(AssetHandle& Handle) const noexcept
 		{
-			if (ValidateHandle(Handle))
+			AssetHandle Current = Resolve(Handle);
+			if (Current.IsValid() && Current.State)
 			{
-				RwLockReadGuard Guard(Lock);
+				Handle.State = true;
 
-				bool State = CachedHandles[Handle.Id].State;
-				if (State)
+				const Slot& Slot   = GetSlot(static_cast<u32>(Handle.Id));
+				T*			Shared = Slot.Shared.load(std::memory_order_acquire);
+				T*			Asset  = Shared ? Shared : Slot.Asset.load(std::memory_order_acquire);
+				if (Resolve(Handle).IsValid())
 				{
-					Handle.State = State;
-					return Assets[Handle.Id].get();
+					return Asset;
 				}
 			}
 
 			return nullptr;
 		}
 
+		// Makes Handle draw with Source's asset (or the one Source shares). GetAsset and EnumerateAsset keep returning Handle's
+		// own asset, which only carries its name and options from then on. The shared asset outlives Source if Source is
+		// destroyed first. Handle's state is left as is, it must not turn valid before Source's does
+		bool Share(AssetHandle Handle, AssetHandle Source)
+		{
+			MutexGuard Guard(Lock);
+
+			if (!Resolve(Handle).IsValid() || !Resolve(Source).IsValid() || Handle.Id == Source.Id)
+			{
+				return false;
+			}
+
+			const Slot& SourceSlot = GetSlot(static_cast<u32>(Source.Id));
+			T*			Asset	   = SourceSlot.Shared.load(std::memory_order_relaxed);
+			Asset				   = Asset ? Asset : SourceSlot.Asset.load(std::memory_order_relaxed);
+
+			Slot& Slot = GetSlot(static_cast<u32>(Handle.Id));
+			Release(Slot.Shared.exchange(Asset, std::memory_order_acq_rel));
+			References[Asset].Count++;
+			return true;
+		}
+
+		// Whether other handles draw with Handle's asset
+		bool IsShared(AssetHandle Handle) const
+		{
+			MutexGuard Guard(Lock);
+
+			return Resolve(Handle).IsValid() && References.contains(GetSlot(static_cast<u32>(Handle.Id)).Asset.load(std::memory_order_relaxed));
+		}
+
 		void Destroy(AssetHandle Handle)
 		{
-			if (ValidateHandle(Handle))
+			MutexGuard Guard(Lock);
+
+			if (Resolve(Handle).IsValid())
 			{
-				RwLockWriteGuard Guard(Lock);
+				// Bumping the version invalidates every copy of the handle
+				AssetHandle Destroyed = {};
+				Destroyed.Version	  = (Handle.Version + 1) & MaxVersion;
 
-				ReleaseAsset(Handle.Id);
-				CachedHandles[Handle.Id].Invalidate();
-				Assets[Handle.Id].reset();
+				Slot& Slot = GetSlot(static_cast<u32>(Handle.Id));
+				Slot.Handle.store(Pack(Destroyed), std::memory_order_release);
+				Release(Slot.Shared.exchange(nullptr, std::memory_order_acq_rel));
+
+				// Other handles may still draw with it
+				T* Asset = Slot.Asset.exchange(nullptr, std::memory_order_acq_rel);
+				if (auto Iterator = References.find(Asset); Iterator != References.end())
+				{
+					Iterator->second.Orphaned = true;
+				}
+				else
+				{
+					Retired.push_back(Asset);
+				}
+				FreeIds.push(static_cast<u32>(Handle.Id));
 			}
 		}
 
 		void UpdateHandleState(AssetHandle Handle)
 		{
-			if (ValidateHandle(Handle))
+			if (!ValidateHandle(Handle))
+			{
+				return;
+			}
+
+			// Lock-free, fails once the slot was destroyed or reused
+			auto& Packed   = GetSlot(static_cast<u32>(Handle.Id)).Handle;
+			u64	  Expected = Packed.load(std::memory_order_relaxed);
+			while (true)
 			{
-				RwLockWriteGuard Guard(Lock);
+				AssetHandle Current = Unpack(Expected);
+				if (!Current.IsValid() || Current.Version != Handle.Version)
+				{
+					return;
+				}
 
-				CachedHandles[Handle.Id].State = Handle.State;
+				Current.State = Handle.State;
+				if (Packed.compare_exchange_weak(Expected, Pack(Current), std::memory_order_release, std::memory_order_relaxed))
+				{
+					return;
+				}
 			}
 		}
 
-		template<typename Functor>
-		void EnumerateAsset(Functor F)
+		// Assets destroyed since the last call. Lookups that raced with the destroy may still use them, the caller deletes them
+		// once nothing that was recorded before can read them anymore
+		std::vector<std::unique_ptr<T>> TakeRetired()
 		{
-			RwLockReadGuard Guard(Lock);
+			MutexGuard Guard(Lock);
 
-			auto begin = CachedHandles.begin();
-			auto end   = CachedHandles.end();
-			while (begin != end)
+			std::vector<std::unique_ptr<T>> Assets;
+			Assets.reserve(Retired.size());
+			for (T* Asset : Retired)
 			{
-				auto current = begin++;
+				Assets.emplace_back(Asset);
+			}
+			Retired.clear();
+			return Assets;
+		}
 
-				if constexpr (std::is_invocable_v<Functor, AssetHandle, T*>)
+		// Wait-free, assets created during the enumeration may or may not be visited
+		template<typename Functor>
+		void EnumerateAsset(Functor F) const
+		{
+			u32 Count = Size.load(std::memory_order_acquire);
+			for (u32 First = 0; First < Count; First += ChunkSize)
+			{
+				const Chunk& Chunk = *Chunks[First / ChunkSize].load(std::memory_order_acquire);
+				for (u32 i = 0; i < std::min(ChunkSize, Count - First); ++i)
 				{
-					if (current->IsValid())
+					if constexpr (std::is_invocable_v<Functor, AssetHandle, T*>)
 					{
-						F(*current, Assets[current->Id].get());
+						AssetHandle Handle = Unpack(Chunk[i].Handle.load(std::memory_order_acquire));
+						T*			Asset  = Chunk[i].Asset.load(std::memory_order_acquire);
+						// Skipped if the slot was destroyed and reused in between, see GetAsset
+						if (Handle.IsValid() && Asset && Unpack(Chunk[i].Handle.load(std::memory_order_acquire)).Version == Handle.Version)
+						{
+							F(Handle, Asset);
+						}
 					}
 				}
 			}
 		}
 
 	private:
-		u32 GetAssetIndex()
+		struct Slot
 		{
-			u32 NewIndex;
-			if (!IndexQueue.empty())
-			{
-				NewIndex = IndexQueue.front();
-				IndexQueue.pop();
-			}
-			else
+			std::atomic<u64> Handle = Pack(AssetHandle());
+			std::atomic<T*>	 Asset	= nullptr;
+			std::atomic<T*>	 Shared = nullptr; // Drawn with instead of Asset
+		};
+
+		// Of an asset shared by other slots
+		struct Reference
+		{
+			u32	 Count	  = 0;
+			bool Orphaned = false; // Its own slot was destroyed
+		};
+
+		using Chunk = std::array<Slot, ChunkSize>;
+
+		static u64		   Pack(AssetHandle Handle) noexcept { return std::bit_cast<u64>(Handle); }
+		static AssetHandle Unpack(u64 Packed) noexcept { return std::bit_cast<AssetHandle>(Packed); }
+
+		Slot& GetSlot(u32 Id) const noexcept
+		{
+			return (*Chunks[Id / ChunkSize].load(std::memory_order_acquire))[Id % ChunkSize];
+		}
+
+		// Drops one slot's reference to a shared asset
+		void Release(T* Shared)
+		{
+			if (auto Iterator = References.find(Shared); Iterator != References.end() && --Iterator->second.Count == 0)
 			{
-				CachedHandles.emplace_back();
-				Assets.emplace_back();
-				NewIndex = Index++;
+				if (Iterator->second.Orphaned)
+				{
+					Retired.push_back(Shared);
+				}
+				References.erase(Iterator);
 			}
-			return NewIndex;
 		}
 
-		void ReleaseAsset(u32 Index)
+		AssetHandle LoadHandle(u32 Id) const noexcept
 		{
-			IndexQueue.push(Index);
-			Assets[Index] = nullptr;
+			return Unpack(GetSlot(Id).Handle.load(std::memory_order_acquire));
 		}
 
-	private:
-		mutable RwLock Lock;
+		// The slot's handle if Handle refers to what is in it now, an invalid handle otherwise
+		AssetHandle Resolve(AssetHandle Handle) const noexcept
+		{
+			if (ValidateHandle(Handle))
+			{
+				AssetHandle Current = LoadHandle(static_cast<u32>(Handle.Id));
+				if (Current.IsValid() && Current.Version == Handle.Version)
+				{
+					return Current;
+				}
+			}
+			return {};
+		}
 
-		std::queue<u32> IndexQueue;
-		u32				Index = 0;
+	private:
+		mutable Mutex Lock;
 
-		// CachedHandles are use to update any external handle's states
-		std::vector<AssetHandle>		CachedHandles;
-		std::vector<std::unique_ptr<T>> Assets;
+		std::array<std::atomic<Chunk*>, MaxChunks> Chunks = {};
+		std::atomic<u32>						   Size	  = 0; // Slots published to readers
+		std::queue<u32>							   FreeIds;
+		std::unordered_map<T*, Reference>		   References;
+		std::vector<T*>							   Retired; // Destroyed, not deleted yet
 	};
 
 	class AssetImporter
@@ -184,33 +426,113 @@ namespace Asset
 	class MeshImporter : public AssetImporter
 	{
 	public:
-		MeshImporter();
+		static constexpr std::string_view CookedExtension = ".asset";
 
-		std::vector<AssetHandle> Import(AssetManager* AssetManager, const MeshImportOptions& Options);
+		MeshImporter();
 
-		void			   Export(const std::filesystem::path& BinaryPath, const std::vector<Mesh*>& Meshes);
-		std::vector<Mesh*> ImportExisting(AssetManager* AssetManager, const std::filesystem::path& BinaryPath, const MeshImportOptions& Options);
+		// Key of the cooked file of Options in Cache, covers the source contents and every option that affects the output.
+		// AssetCache::NoKey if the source cannot be read
+		[[nodiscard]] static u64 GetCacheKey(const AssetCache& Cache, const MeshImportOptions& Options);
+
+		// Maps the cooked file of Options from Cache, or cooks Options.Path if there is none. CreateMesh is called once for
+		// every mesh, nothing is uploaded. MeshIndices optionally selects meshes of the cooked file, nothing is cooked then.
+		// Images optionally receives the images of the source (see GetImages), Report the time and size of every stage.
+		// Returns an empty vector if neither worked
+		std::vector<Mesh*> Load(
+			AssetCache&						   Cache,
+			const MeshImportOptions&		   Options,
+			const std::function<Mesh*()>&	   CreateMesh,
+			Span<const u64>					   MeshIndices = {},
+			std::vector<TextureImportOptions>* Images	   = nullptr,
+			ImportReport*					   Report	   = nullptr);
 
-		struct ExportHeader
-		{
-			size_t NumMeshes;
-		};
+		std::vector<AssetHandle> Import(AssetManager* AssetManager, const MeshImportOptions& Options);
 
-		struct MeshHeader
-		{
-			size_t NumVertices;
-			size_t NumIndices;
-			size_t NumMeshlets;
-			size_t NumUniqueVertexIndices;
-			size_t NumPrimitiveIndices;
-		};
+		// Reads and processes Options.Path and exports the cooked file to BinaryPath, nothing is uploaded. CreateMesh is called
+		// once for every mesh of the source, serially and in order. Returns an empty vector if the source could not be read
+		std::vector<Mesh*> Cook(
+			const MeshImportOptions&	  Options,
+			const std::filesystem::path&  BinaryPath,
+			const std::function<Mesh*()>& CreateMesh,
+			ImportReport*				  Report = nullptr);
+
+		void Export(const std::filesystem::path& BinaryPath, const std::vector<Mesh*>& Meshes);
+
+		// Images that came with the source of the cooked file at BinaryPath, ready for TextureImporter. Cook extracts the
+		// embedded images of glTF files next to the cooked file, images the source references are imported from where they are
+		static std::vector<TextureImportOptions> GetImages(const std::filesystem::path& BinaryPath);
+
+		// Reads an OBJ file with ObjParser and with assimp (using Cook's flags) and logs the throughput of both
+		static void BenchmarkObj(const std::filesystem::path& Path);
+
+		// Welds the meshes of a file with VertexWelder and with aiProcess_JoinIdenticalVertices and logs the vertex counts and
+		// throughput of both. Returns false unless both keep the same number of indices and every welded triangle matches
+		// assimp's in position, normal and texture coordinate up to Epsilon
+		static bool BenchmarkWeld(const std::filesystem::path& Path, f32 Epsilon);
+
+		// Creates meshes from a cooked archive, MeshIndices optionally selects a subset of the archive's meshes.
+		// Returns an empty vector if the archive is invalid (or of an older version) or fails validation, which includes
+		// compressed indices that do not decode
+		std::vector<Mesh*> ImportExisting(
+			const std::filesystem::path&  BinaryPath,
+			const MeshImportOptions&	  Options,
+			const std::function<Mesh*()>& CreateMesh,
+			Span<const u64>				  MeshIndices = {});
 	};
 
 	class TextureImporter : public AssetImporter
 	{
 	public:
+		// Decoded images with their mip chain, read back without decoding or filtering
+		static constexpr std::string_view CookedExtension = ".dds";
+
+		// Part of the cache key of cooked textures, bump it whenever the output changes
+		static constexpr u32 Version = 5;
+
 		TextureImporter();
 
+		// Key of the cooked file of Options in Cache, covers the source contents and every option that affects the output.
+		// AssetCache::NoKey if the source cannot be read
+		[[nodiscard]] static u64 GetCacheKey(const AssetCache& Cache, const TextureImportOptions& Options);
+
 		AssetHandle Import(AssetManager* AssetManager, const TextureImportOptions& Options);
+
+		// Reads the cooked file of Options from Cache into Asset's image, or decodes (and compresses) Options.Path and cooks
+		// it into Cache if there is none. DDS sources are read as they are. Sky light sampling tables and the irradiance of
+		// sky lights converted to cubemaps are cooked alongside the image. Nothing is uploaded. Returns false if the source
+		// could not be read
+		bool Load(AssetCache& Cache, const TextureImportOptions& Options, Texture* Asset, ImportReport* Report = nullptr);
+
+		// Reads Options.Path into Asset's image and generates its mips if Options asks for them, nothing is cached or uploaded.
+		// PNG, JPEG, TGA and HDR files are decoded by ImageDecoder and filtered by MipGenerator, other formats by WIC and
+		// DirectXTex
+		void Decode(const TextureImportOptions& Options, Texture* Asset, ImportReport* Report = nullptr);
+
+		// Block compresses the image of Asset as its options ask for (see TextureCompressor), logs the format, throughput
+		// and PSNR. Leaves images that cannot be compressed as they are
+		void Compress(Texture* Asset, ImportReport* Report = nullptr);
+
+		// Builds the sky light sampling tables of Asset (see SkyLightSampler) if it is an uncompressed float image twice as
+		// wide as it is high, the layout of latitude-longitude HDRIs. Leaves them empty for other textures
+		void BuildSkySampler(Texture* Asset, ImportReport* Report = nullptr);
+
+		// Replaces the image of Asset with a cubemap with GGX prefiltered mips (if Options asks for mips) and projects its
+		// irradiance, if it is an image BuildSkySampler would build tables for. Logs the time of every step
+		void ConvertToCubemap(Texture* Asset, ImportReport* Report = nullptr);
+
+		// Writes the image of Asset with its mips to BinaryPath, and its sky light sampling tables and irradiance next to it
+		// if it has any
+		static bool Export(const std::filesystem::path& BinaryPath, const Texture* Asset);
+
+		// Loads Options.Path from its source and from its cooked file (cooking it first if needed) and logs the time of both
+		void Benchmark(AssetCache& Cache, const TextureImportOptions& Options);
+
+		// Decodes Options.Path and generates its mips with WIC/DirectXTex and with ImageDecoder/MipGenerator, logs the time
+		// and throughput of both and the largest difference between their base levels
+		static void BenchmarkDecode(const TextureImportOptions& Options);
+
+		// Loads Options.Path like Load and logs the statistical checks of its sky light sampling tables against the image
+		// they were built from (SkyLightSampler::Test)
+		void TestSkySampler(AssetCache& Cache, const TextureImportOptions& Options, u32 NumSamples);
 	};
 } // namespace Asset
@@ -4,13 +4,43 @@ using namespace DirectX;
 
 namespace Asset
 {
+	// Resident meshes only keep what culling and LOD selection need on the CPU, their streams live on the GPU
+	static AssetFootprint GetFootprint(const Mesh& Asset)
+	{
+		return {
+			.CpuSizeInBytes = Asset.MeshletCullData.size() * sizeof(DirectX::CullData) + Asset.Lods.size() * sizeof(MeshLod),
+			.GpuSizeInBytes = Asset.GetSizeInBytes(),
+		};
+	}
+
+	static AssetFootprint GetFootprint(const Texture& Asset)
+	{
+		return { .CpuSizeInBytes = 0, .GpuSizeInBytes = Asset.GetSizeInBytes() };
+	}
+
 	AssetManager::AssetManager(RHI::D3D12Device* Device)
-		: Device(Device)
+		: AssetManager(std::make_unique<D3D12AssetUploader>(Device))
 	{
 	}
 
+	AssetManager::AssetManager(std::unique_ptr<IAssetUploader> Uploader)
+		: Cache(Process::ExecutableDirectory / "Cache")
+		, Uploader(std::move(Uploader))
+	{
+		for (u32 i = 0; i < NumLoaderThreads; ++i)
+		{
+			LoaderThreads.emplace_back(
+				[this](std::stop_token StopToken)
+				{
+					RunLoader(StopToken);
+				});
+		}
+	}
+
 	AssetManager::~AssetManager()
 	{
+		// A loader thread may still be decoding into a request
+		LoaderThreads.clear();
 	}
 
 	AssetType AssetManager::GetAssetTypeFromExtension(const std::filesystem::path& Path)
@@ -27,116 +57,600 @@ namespace Asset
 		return AssetType::Unknown;
 	}
 
-	void AssetManager::UploadTexture(Texture* AssetTexture, RHI::D3D12LinkedDevice* Device)
+	AssetHandle AssetManager::LoadTextureAsync(const TextureImportOptions& Options)
+	{
+		// Options and name are known up front, the world can be saved while the texture is still loading
+		Texture* Asset = CreateAsset<Texture>();
+		Asset->Options = Options;
+		Asset->Name	   = Options.Path.filename().string();
+
+		auto Load			 = std::make_shared<AsyncLoad>();
+		Load->Type			 = AssetType::Texture;
+		Load->TextureOptions = Options;
+		Load->Handles.push_back(Asset->Handle);
+		Enqueue(std::move(Load));
+		return Asset->Handle;
+	}
+
+	void AssetManager::LoadMeshAsync(const MeshImportOptions& Options)
+	{
+		auto Load		  = std::make_shared<AsyncLoad>();
+		Load->Type		  = AssetType::Mesh;
+		Load->MeshOptions = Options;
+		Enqueue(std::move(Load));
+	}
+
+	void AssetManager::Enqueue(std::shared_ptr<AsyncLoad> Load)
 	{
-		const auto& Metadata = AssetTexture->TexImage.GetMetadata();
+		Load->RequestTimestamp = Stopwatch::GetTimestamp();
+		if (PendingLoads.empty())
+		{
+			Stats				 = {};
+			Stats.StartTimestamp = Load->RequestTimestamp;
+		}
+		Stats.NumRequests++;
 
-		DXGI_FORMAT Format = Metadata.format;
-		if (AssetTexture->Options.sRGB)
+		PendingLoads.push_back(Load);
+		Stats.MaxQueueDepth = std::max<u64>(Stats.MaxQueueDepth, PendingLoads.size());
 		{
-			Format = DirectX::MakeSRGB(Format);
+			std::scoped_lock _(Mutex);
+			DecodeQueue.push_back(std::move(Load));
 		}
+		ConditionVariable.notify_one();
+	}
 
-		D3D12_RESOURCE_DESC ResourceDesc = {};
-		switch (Metadata.dimension)
+	void AssetManager::RunLoader(std::stop_token StopToken)
+	{
+		while (!StopToken.stop_requested())
 		{
-		case TEX_DIMENSION_TEXTURE1D:
-			ResourceDesc = CD3DX12_RESOURCE_DESC::Tex1D(
-				Format,
-				static_cast<UINT64>(Metadata.width),
-				static_cast<UINT16>(Metadata.arraySize));
-			break;
+			std::shared_ptr<AsyncLoad> Load;
+			{
+				std::unique_lock Lock(Mutex);
+				if (!ConditionVariable.wait(
+						Lock,
+						StopToken,
+						[this]
+						{
+							return !DecodeQueue.empty();
+						}))
+				{
+					break;
+				}
+				Load = std::move(DecodeQueue.front());
+				DecodeQueue.pop_front();
+			}
+			Decode(*Load);
+		}
+	}
 
-		case TEX_DIMENSION_TEXTURE2D:
-			ResourceDesc = CD3DX12_RESOURCE_DESC::Tex2D(
-				Format,
-				static_cast<UINT64>(Metadata.width),
-				static_cast<UINT>(Metadata.height),
-				static_cast<UINT16>(Metadata.arraySize),
-				static_cast<UINT16>(Metadata.mipLevels));
-			break;
+	void AssetManager::Decode(AsyncLoad& Load)
+	{
+		i64 Start = Stopwatch::GetTimestamp();
+
+		// Missing or unreadable files throw, the load fails like any other instead of ending the loader thread
+		try
+		{
+			if (Load.Type == AssetType::Mesh)
+			{
+				auto CreateMesh = [&]
+				{
+					return Load.DecodedMeshes.emplace_back(std::make_unique<Mesh>()).get();
+				};
+				std::vector<Mesh*> Meshes = MeshImporter.Load(
+					Cache,
+					Load.MeshOptions,
+					CreateMesh,
+					Load.MeshIndices,
+					Load.Reload ? nullptr : &Load.Images,
+					&Load.Report);
+				if (Meshes.empty() && Load.Reload)
+				{
+					// The cooked file is gone or stale, the source is cooked again and the evicted mesh picked out of it
+					KAGUYA_LOG(Asset, Warn, "Failed to reload mesh {} of {}, cooking it again", Load.MeshIndices[0], Load.MeshOptions.Path.string());
+					Load.DecodedMeshes.clear();
+					Meshes = MeshImporter.Load(Cache, Load.MeshOptions, CreateMesh, {}, nullptr, &Load.Report);
 
-		case TEX_DIMENSION_TEXTURE3D:
-			ResourceDesc = CD3DX12_RESOURCE_DESC::Tex3D(
-				Format,
-				static_cast<UINT64>(Metadata.width),
-				static_cast<UINT>(Metadata.height),
-				static_cast<UINT16>(Metadata.depth));
-			break;
+					Mesh* Reloaded = Load.MeshIndices[0] < Meshes.size() ? Meshes[Load.MeshIndices[0]] : nullptr;
+					std::erase_if(
+						Load.DecodedMeshes,
+						[&](const std::unique_ptr<Mesh>& DecodedMesh)
+						{
+							return DecodedMesh.get() != Reloaded;
+						});
+					Meshes = Reloaded ? std::vector<Mesh*>{ Reloaded } : std::vector<Mesh*>{};
+				}
+				if (Meshes.empty())
+				{
+					KAGUYA_LOG(Asset, Error, "Failed to load {}", Load.MeshOptions.Path.string());
+					Load.DecodedMeshes.clear();
+				}
+			}
+			else if (Load.Type == AssetType::Texture)
+			{
+				Load.DecodedTexture = std::make_unique<Texture>();
+				if (!TextureImporter.Load(Cache, Load.TextureOptions, Load.DecodedTexture.get(), &Load.Report))
+				{
+					KAGUYA_LOG(Asset, Error, "Failed to load {}", Load.TextureOptions.Path.string());
+					Load.DecodedTexture.reset();
+				}
+			}
 		}
+		catch (const ExceptionIO& Exception)
+		{
+			const auto& Path = Load.Type == AssetType::Mesh ? Load.MeshOptions.Path : Load.TextureOptions.Path;
+			KAGUYA_LOG(Asset, Error, "Failed to load {}: {}", Path.string(), Exception.what());
+			Load.DecodedMeshes.clear();
+			Load.DecodedTexture.reset();
+		}
+		Load.DecodeTicks = Stopwatch::GetTimestamp() - Start;
+		Load.Decoded	 = true;
+	}
 
-		AssetTexture->DxTexture = RHI::D3D12Texture(Device, ResourceDesc, std::nullopt, AssetTexture->IsCubemap);
-		AssetTexture->Srv		= RHI::D3D12ShaderResourceView(Device, &AssetTexture->DxTexture, false);
+	void AssetManager::Update()
+	{
+		Frame++;
 
-		std::vector<D3D12_SUBRESOURCE_DATA> Subresources(AssetTexture->TexImage.GetImageCount());
-		const auto							pImages = AssetTexture->TexImage.GetImages();
-		for (size_t i = 0; i < AssetTexture->TexImage.GetImageCount(); ++i)
+		// Decoded requests are registered in request order so mesh handles do not depend on decoding order, a request that
+		// is still decoding holds back the ones after it
+		std::vector<Mesh*>				  Meshes;
+		std::vector<Mesh*>				  Shared; // Deduplicated, nothing to upload
+		std::vector<Texture*>			  Textures;
+		std::vector<AsyncLoad*>			  Submitted;
+		std::vector<TextureImportOptions> Images; // That came with meshes, requested after the loop over PendingLoads
+		for (const auto& Load : PendingLoads)
 		{
-			Subresources[i].RowPitch   = pImages[i].rowPitch;
-			Subresources[i].SlicePitch = pImages[i].slicePitch;
-			Subresources[i].pData	   = pImages[i].pixels;
+			if (Load->Submitted)
+			{
+				continue;
+			}
+			if (!Load->Decoded)
+			{
+				break;
+			}
+
+			bool Loaded = false;
+			if (Load->Type == AssetType::Mesh && Load->Reload)
+			{
+				// Back into the evicted mesh, its handle stays the same
+				Mesh* Asset = Load->DecodedMeshes.size() == 1 ? MeshRegistry.GetAsset(Load->Handles[0]) : nullptr;
+				if (Asset)
+				{
+					AssetHandle Handle = Asset->Handle;
+					*Asset			   = std::move(*Load->DecodedMeshes[0]);
+					Asset->Handle	   = Handle;
+					Meshes.push_back(Asset);
+					Load->Report.AddStage("Upload", 0, Asset->GetSizeInBytes());
+					Loaded = true;
+				}
+				Load->DecodedMeshes.clear();
+			}
+			else if (Load->Type == AssetType::Mesh)
+			{
+				for (auto& DecodedMesh : Load->DecodedMeshes)
+				{
+					AssetHandle Handle = MeshRegistry.Add(std::move(DecodedMesh));
+					Mesh*		Asset  = MeshRegistry.GetAsset(Handle);
+					Load->Handles.push_back(Handle);
+					if (Deduplicate(MeshRegistry, MeshContents, Asset, true))
+					{
+						Shared.push_back(Asset);
+					}
+					else
+					{
+						Meshes.push_back(Asset);
+						Load->Report.AddStage("Upload", 0, Asset->GetSizeInBytes());
+					}
+				}
+				Load->DecodedMeshes.clear();
+				Loaded = !Load->Handles.empty();
+				Images.insert(Images.end(), Load->Images.begin(), Load->Images.end());
+			}
+			else if (Load->Type == AssetType::Texture && Load->DecodedTexture)
+			{
+				// The reserved texture is gone if it was destroyed in the meantime, its handle is stale then
+				if (Texture* Asset = TextureRegistry.GetAsset(Load->Handles[0]))
+				{
+					Asset->Extent	  = Load->DecodedTexture->Extent;
+					Asset->IsCubemap  = Load->DecodedTexture->IsCubemap;
+					Asset->TexImage	  = std::move(Load->DecodedTexture->TexImage);
+					Asset->SkySampler = std::move(Load->DecodedTexture->SkySampler);
+					Asset->Irradiance = Load->DecodedTexture->Irradiance;
+					if (Deduplicate(TextureRegistry, TextureContents, Asset, true))
+					{
+						Asset->Release();
+					}
+					else
+					{
+						Textures.push_back(Asset);
+						Load->Report.AddStage("Upload", 0, Asset->GetSizeInBytes());
+					}
+					Loaded = true;
+				}
+				Load->DecodedTexture.reset();
+			}
+
+			if (Load->Reload)
+			{
+				AssetHandle Handle = Load->Handles[0];
+				bool		Exists = Load->Type == AssetType::Mesh ? MeshRegistry.GetAsset(Handle) != nullptr
+																   : TextureRegistry.GetAsset(Handle) != nullptr;
+				if (auto Iterator = Evicted.find(Handle); Iterator != Evicted.end())
+				{
+					if (Loaded || !Exists)
+					{
+						Evicted.erase(Iterator);
+					}
+					else
+					{
+						// A failed reload stays evicted, Acquire requests it again once the backoff has passed instead of cooking
+						// the source again every frame
+						EvictedAsset& Entry	  = Iterator->second;
+						u64			  Backoff = std::min(MinReloadBackoff << std::min(Entry.NumFailures, 8u), MaxReloadBackoff);
+						Entry.Reloading		  = false;
+						Entry.NumFailures++;
+						Entry.RetryFrame = Frame + Backoff;
+
+						const auto& Path = Load->Type == AssetType::Mesh ? Load->MeshOptions.Path : Load->TextureOptions.Path;
+						KAGUYA_LOG(Asset, Warn, "Failed to reload {} ({} times), retrying in {} frames", Path.string(), Entry.NumFailures, Backoff);
+					}
+				}
+			}
+			if (!Loaded)
+			{
+				Stats.NumFailed++;
+				Load->Handles.clear();
+			}
+			Load->Submitted = true;
+			Submitted.push_back(Load.get());
 		}
 
-		Device->Upload(Subresources, AssetTexture->DxTexture.GetResource());
+		if (!Submitted.empty())
+		{
+			u64 Fence = 0;
+			if (!Meshes.empty() || !Textures.empty())
+			{
+				Fence = Uploader->Upload(Meshes, Textures);
+			}
+
+			for (auto Mesh : Meshes)
+			{
+				Residency.Add(Mesh->Handle, GetFootprint(*Mesh), Frame);
+			}
+			for (auto Texture : Textures)
+			{
+				Residency.Add(Texture->Handle, GetFootprint(*Texture), Frame);
+			}
+
+			// The upload heap holds its own copy, the CPU side is not needed anymore
+			for (auto Mesh : Meshes)
+			{
+				Mesh->Release();
+			}
+			for (auto Mesh : Shared)
+			{
+				Mesh->Release();
+			}
+			for (auto Texture : Textures)
+			{
+				Texture->Release();
+			}
+
+			i64 Timestamp = Stopwatch::GetTimestamp();
+			for (auto Load : Submitted)
+			{
+				Load->Fence			  = Fence;
+				Load->SubmitTimestamp = Timestamp;
+			}
+		}
+
+		for (const auto& Image : Images)
+		{
+			LoadTextureAsync(Image);
+		}
+
+		// Uploads complete in submission order
+		while (!PendingLoads.empty() && PendingLoads.front()->Submitted && Uploader->IsComplete(PendingLoads.front()->Fence))
+		{
+			std::shared_ptr<AsyncLoad> Load = std::move(PendingLoads.front());
+			PendingLoads.pop_front();
+
+			auto MakeLive = [](auto& Registry, AssetHandle Handle)
+			{
+				if (auto Asset = Registry.GetAsset(Handle))
+				{
+					Asset->Handle.State = true;
+					Registry.UpdateHandleState(Asset->Handle);
+				}
+			};
+			for (AssetHandle Handle : Load->Handles)
+			{
+				if (Load->Type == AssetType::Mesh)
+				{
+					MakeLive(MeshRegistry, Handle);
+				}
+				else
+				{
+					MakeLive(TextureRegistry, Handle);
+				}
+			}
+
+			i64 Timestamp = Stopwatch::GetTimestamp();
+			i64 Latency	  = Timestamp - Load->RequestTimestamp;
+			Stats.NumAssets += Load->Handles.size();
+			Stats.DecodeTicks += Load->DecodeTicks;
+			Stats.UploadTicks += Timestamp - Load->SubmitTimestamp;
+			Stats.LatencyTicks += Latency;
+			Stats.MaxLatencyTicks = std::max(Stats.MaxLatencyTicks, Latency);
+			if (!Load->Handles.empty())
+			{
+				Load->Report.AddStage("Upload", Timestamp - Load->SubmitTimestamp);
+				Load->Report.Log();
+				Load->Report.Append(Cache.GetDirectory() / ImportReport::FileName);
+			}
+			if (PendingLoads.empty())
+			{
+				LogAsyncLoads();
+			}
+		}
+
+		EvictOverBudget();
+		DeleteRetired();
 	}
 
-	void AssetManager::UploadMesh(Mesh* AssetMesh, RHI::D3D12LinkedDevice* Device)
+	void AssetManager::WaitForAsyncLoads()
 	{
-		UINT64 VertexBufferSizeInBytes = AssetMesh->Vertices.size() * sizeof(Vertex);
-		UINT64 IndexBufferSizeInBytes  = AssetMesh->Indices.size() * sizeof(uint32_t);
+		while (!PendingLoads.empty())
+		{
+			Update();
+			if (!PendingLoads.empty())
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
 
-		AssetMesh->VertexResource = RHI::D3D12Buffer(Device, VertexBufferSizeInBytes, sizeof(Vertex), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
-		AssetMesh->IndexResource  = RHI::D3D12Buffer(Device, IndexBufferSizeInBytes, sizeof(uint32_t), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+	void AssetManager::DestroyAll()
+	{
+		// Requests still in flight would land in the cleared registries
+		WaitForAsyncLoads();
+		TextureRegistry.DestroyAll();
+		MeshRegistry.DestroyAll();
 
-		Device->Upload(AssetMesh->Vertices.data(), VertexBufferSizeInBytes, AssetMesh->VertexResource.GetResource());
-		Device->Upload(AssetMesh->Indices.data(), IndexBufferSizeInBytes, AssetMesh->IndexResource.GetResource());
+		MeshContents.clear();
+		TextureContents.clear();
+		DedupStats = {};
 
-		if (AssetMesh->Options.GenerateMeshlets)
+		Residency.Clear();
+		Evicted.clear();
+	}
+
+	Mesh* AssetManager::AcquireMesh(AssetHandle& Handle)
+	{
+		return Acquire(MeshRegistry, Handle);
+	}
+
+	Texture* AssetManager::AcquireTexture(AssetHandle& Handle)
+	{
+		return Acquire(TextureRegistry, Handle);
+	}
+
+	template<typename T>
+	T* AssetManager::Acquire(AssetRegistry<T>& Registry, AssetHandle& Handle)
+	{
+		T* Asset = Registry.GetValidAsset(Handle);
+		if (Asset)
 		{
-			UINT64 MeshletBufferSizeInBytes			  = AssetMesh->Meshlets.size() * sizeof(Meshlet);
-			UINT64 UniqueVertexIndexBufferSizeInBytes = AssetMesh->UniqueVertexIndices.size() * sizeof(uint8_t);
-			UINT64 PrimitiveIndexBufferSizeInBytes	  = AssetMesh->PrimitiveIndices.size() * sizeof(MeshletTriangle);
+			// A shared asset is tracked under the handle that owns it
+			Residency.Touch(Asset->Handle, Frame);
+			return Asset;
+		}
 
-			AssetMesh->MeshletResource			 = RHI::D3D12Buffer(Device, MeshletBufferSizeInBytes, sizeof(Meshlet), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
-			AssetMesh->UniqueVertexIndexResource = RHI::D3D12Buffer(Device, UniqueVertexIndexBufferSizeInBytes, sizeof(uint8_t), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
-			AssetMesh->PrimitiveIndexResource	 = RHI::D3D12Buffer(Device, PrimitiveIndexBufferSizeInBytes, sizeof(MeshletTriangle), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+		AssetHandle Key = Handle;
+		Key.State		= false;
+		if (auto Iterator = Evicted.find(Key);
+			Iterator != Evicted.end() && !Iterator->second.Reloading && Frame >= Iterator->second.RetryFrame)
+		{
+			Iterator->second.Reloading = true;
+			Reload(Key);
+		}
+		return nullptr;
+	}
 
-			Device->Upload(AssetMesh->Meshlets.data(), MeshletBufferSizeInBytes, AssetMesh->MeshletResource.GetResource());
-			Device->Upload(AssetMesh->UniqueVertexIndices.data(), UniqueVertexIndexBufferSizeInBytes, AssetMesh->UniqueVertexIndexResource.GetResource());
-			Device->Upload(AssetMesh->PrimitiveIndices.data(), PrimitiveIndexBufferSizeInBytes, AssetMesh->PrimitiveIndexResource.GetResource());
+	void AssetManager::Reload(AssetHandle Handle)
+	{
+		auto Load	 = std::make_shared<AsyncLoad>();
+		Load->Type	 = Handle.Type;
+		Load->Reload = true;
+		Load->Handles.push_back(Handle);
+		if (Handle.Type == AssetType::Mesh)
+		{
+			Mesh* Asset = MeshRegistry.GetAsset(Handle);
+			if (!Asset)
+			{
+				Evicted.erase(Handle);
+				return;
+			}
+			Load->MeshOptions = Asset->Options;
+			Load->MeshIndices = { Asset->ArchiveIndex };
 		}
+		else
+		{
+			Texture* Asset = TextureRegistry.GetAsset(Handle);
+			if (!Asset)
+			{
+				Evicted.erase(Handle);
+				return;
+			}
+			Load->TextureOptions = Asset->Options;
+		}
+		Enqueue(std::move(Load));
+	}
 
-		D3D12_GPU_VIRTUAL_ADDRESS IndexAddress	= AssetMesh->IndexResource.GetGpuVirtualAddress();
-		D3D12_GPU_VIRTUAL_ADDRESS VertexAddress = AssetMesh->VertexResource.GetGpuVirtualAddress();
+	bool AssetManager::IsEvicted(AssetHandle Handle) const
+	{
+		Handle.State = false;
+		return Evicted.contains(Handle);
+	}
+
+	void AssetManager::DeleteRetired()
+	{
+		RetiredAssets Assets = { .Meshes = MeshRegistry.TakeRetired(), .Textures = TextureRegistry.TakeRetired() };
+		if (!Assets.Meshes.empty() || !Assets.Textures.empty())
+		{
+			Assets.Fence = Uploader->Retire();
+			Retired.push_back(std::move(Assets));
+		}
+
+		// Retire fences complete in order
+		while (!Retired.empty() && Uploader->IsRetired(Retired.front().Fence))
+		{
+			Retired.pop_front();
+		}
+	}
+
+	void AssetManager::EvictOverBudget()
+	{
+		std::vector<AssetHandle> Handles = Residency.Evict(
+			Frame,
+			[this](AssetHandle Handle)
+			{
+				// Handles that share an asset would be left drawing with released resources
+				return Handle.Type == AssetType::Mesh ? !MeshRegistry.IsShared(Handle) : !TextureRegistry.IsShared(Handle);
+			});
+		if (Handles.empty())
+		{
+			return;
+		}
 
-		const D3D12_RAYTRACING_GEOMETRY_DESC RaytracingGeometryDesc = {
-			.Type	   = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES,
-			.Flags	   = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE,
-			.Triangles = {
-				.Transform3x4 = NULL,
-				.IndexFormat  = DXGI_FORMAT_R32_UINT,
-				.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT,
-				.IndexCount	  = static_cast<UINT>(AssetMesh->Indices.size()),
-				.VertexCount  = static_cast<UINT>(AssetMesh->Vertices.size()),
-				.IndexBuffer  = IndexAddress,
-				.VertexBuffer = {
-					.StartAddress  = VertexAddress,
-					.StrideInBytes = sizeof(Vertex),
-				},
+		// Frames in flight may still draw with the released resources, they are retired like destroyed assets
+		RetiredAssets Released;
+		for (AssetHandle Handle : Handles)
+		{
+			auto Evict = [&](auto& Registry, auto& ReleasedAssets)
+			{
+				if (auto Asset = Registry.GetAsset(Handle))
+				{
+					using T = std::remove_pointer_t<decltype(Asset)>;
+					Asset->ReleaseResources(*ReleasedAssets.emplace_back(std::make_unique<T>()));
+					Asset->Handle.State = false;
+					Registry.UpdateHandleState(Asset->Handle);
+					Evicted.try_emplace(Asset->Handle);
+				}
+			};
+			if (Handle.Type == AssetType::Mesh)
+			{
+				Evict(MeshRegistry, Released.Meshes);
+			}
+			else
+			{
+				Evict(TextureRegistry, Released.Textures);
 			}
+		}
+		Released.Fence = Uploader->Retire();
+		Retired.push_back(std::move(Released));
+
+		constexpr f64		  MiB		= 1024.0 * 1024.0;
+		const AssetFootprint& Footprint = Residency.GetFootprint();
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"Frame {}: evicted {} assets, {} resident using {:.2f}MiB CPU and {:.2f}MiB GPU (budget {:.2f}MiB CPU, {:.2f}MiB GPU)",
+			Frame,
+			Handles.size(),
+			Residency.GetNumResident(),
+			static_cast<f64>(Footprint.CpuSizeInBytes) / MiB,
+			static_cast<f64>(Footprint.GpuSizeInBytes) / MiB,
+			static_cast<f64>(Residency.Budget.CpuSizeInBytes) / MiB,
+			static_cast<f64>(Residency.Budget.GpuSizeInBytes) / MiB);
+	}
+
+	template<typename T>
+	bool AssetManager::Deduplicate(AssetRegistry<T>& Registry, std::unordered_map<u64, AssetHandle>& Contents, T* Asset, bool AllowPending)
+	{
+		i64 Start		= Stopwatch::GetTimestamp();
+		u64 ContentHash = Asset->HashContent();
+		DedupStats.HashTicks += Stopwatch::GetTimestamp() - Start;
+
+		auto [Iterator, Inserted] = Contents.try_emplace(ContentHash, Asset->Handle);
+		if (Inserted)
+		{
+			return false;
+		}
+
+		// The first one is gone or its resources are released, this one takes its place
+		AssetHandle Source = Iterator->second;
+		if (!Registry.GetAsset(Source) || IsEvicted(Source))
+		{
+			Iterator->second = Asset->Handle;
+			return false;
+		}
+		if (!AllowPending && !Registry.GetValidAsset(Source))
+		{
+			return false;
+		}
+		if (!Registry.Share(Asset->Handle, Source))
+		{
+			return false;
+		}
+
+		if constexpr (std::is_same_v<T, Mesh>)
+		{
+			DedupStats.NumMeshes++;
+			DedupStats.MeshSizeInBytes += Asset->GetSizeInBytes();
+		}
+		else
+		{
+			DedupStats.NumTextures++;
+			DedupStats.TextureSizeInBytes += Asset->GetSizeInBytes();
+		}
+		return true;
+	}
+
+	void AssetManager::LogAsyncLoads()
+	{
+		auto Milliseconds = [](i64 Ticks)
+		{
+			return static_cast<f64>(Ticks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency);
 		};
-		AssetMesh->Blas.AddGeometry(RaytracingGeometryDesc);
 
-		AssetMesh->VertexView = RHI::D3D12ShaderResourceView(Device, &AssetMesh->VertexResource, true, 0, static_cast<UINT>(VertexBufferSizeInBytes));
-		AssetMesh->IndexView  = RHI::D3D12ShaderResourceView(Device, &AssetMesh->IndexResource, true, 0, static_cast<UINT>(IndexBufferSizeInBytes));
+		const f64 NumRequests = static_cast<f64>(Stats.NumRequests);
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"Async loaded {} assets from {} requests ({} failed) in {:.1f}ms, max queue depth {}, latency avg {:.1f}ms max {:.1f}ms, decode avg {:.1f}ms, upload avg {:.1f}ms",
+			Stats.NumAssets,
+			Stats.NumRequests,
+			Stats.NumFailed,
+			Milliseconds(Stopwatch::GetTimestamp() - Stats.StartTimestamp),
+			Stats.MaxQueueDepth,
+			Milliseconds(Stats.LatencyTicks) / NumRequests,
+			Milliseconds(Stats.MaxLatencyTicks),
+			Milliseconds(Stats.DecodeTicks) / NumRequests,
+			Milliseconds(Stats.UploadTicks) / NumRequests);
+
+		if (DedupStats.NumMeshes > 0 || DedupStats.NumTextures > 0)
+		{
+			constexpr f64 MiB = 1024.0 * 1024.0;
+			KAGUYA_LOG(
+				Asset,
+				Info,
+				"Deduplicated {} meshes ({:.2f}MiB) and {} textures ({:.2f}MiB), {:.2f}MiB of GPU memory saved, hashing took {:.1f}ms",
+				DedupStats.NumMeshes,
+				static_cast<f64>(DedupStats.MeshSizeInBytes) / MiB,
+				DedupStats.NumTextures,
+				static_cast<f64>(DedupStats.TextureSizeInBytes) / MiB,
+				static_cast<f64>(DedupStats.MeshSizeInBytes + DedupStats.TextureSizeInBytes) / MiB,
+				Milliseconds(DedupStats.HashTicks));
+		}
 	}
 
 	void AssetManager::RequestUpload(Texture* Texture)
 	{
-		RHI::D3D12LinkedDevice* LinkedDevice = Device->GetLinkedDevice();
-		LinkedDevice->BeginResourceUpload();
-		UploadTexture(Texture, LinkedDevice);
-		LinkedDevice->EndResourceUpload(true);
+		if (!Deduplicate(TextureRegistry, TextureContents, Texture, false))
+		{
+			Uploader->Wait(Uploader->Upload({}, Span<Asset::Texture* const>(&Texture, 1)));
+			Residency.Add(Texture->Handle, GetFootprint(*Texture), Frame);
+		}
 
 		// Release memory
 		Texture->Release();
@@ -144,16 +658,31 @@ namespace Asset
 		TextureRegistry.UpdateHandleState(Texture->Handle);
 	}
 
-	void AssetManager::RequestUpload(Mesh* Mesh)
+	void AssetManager::RequestUpload(Span<Mesh* const> Meshes)
 	{
-		RHI::D3D12LinkedDevice* LinkedDevice = Device->GetLinkedDevice();
-		LinkedDevice->BeginResourceUpload();
-		UploadMesh(Mesh, LinkedDevice);
-		LinkedDevice->EndResourceUpload(true);
+		std::vector<Mesh*> Unique;
+		for (auto Mesh : Meshes)
+		{
+			if (!Deduplicate(MeshRegistry, MeshContents, Mesh, false))
+			{
+				Unique.push_back(Mesh);
+			}
+		}
+		if (!Unique.empty())
+		{
+			Uploader->Wait(Uploader->Upload(Unique, {}));
+		}
+		for (auto Mesh : Unique)
+		{
+			Residency.Add(Mesh->Handle, GetFootprint(*Mesh), Frame);
+		}
 
-		// Release memory
-		Mesh->Release();
-		Mesh->Handle.State = true;
-		MeshRegistry.UpdateHandleState(Mesh->Handle);
+		for (auto Mesh : Meshes)
+		{
+			// Release memory
+			Mesh->Release();
+			Mesh->Handle.State = true;
+			MeshRegistry.UpdateHandleState(Mesh->Handle);
+		}
 	}
 } // namespace Asset
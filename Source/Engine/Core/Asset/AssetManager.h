@@ -1,12 +1,49 @@
 #pragma once
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 #include "AssetImporter.h"
+#include "AssetUploader.h"
+#include "AssetResidency.h"
 
 namespace Asset
 {
+	// Asynchronous loads since the queue was last empty, times are in Stopwatch ticks and summed over requests
+	struct AsyncLoadStats
+	{
+		u64 NumRequests	   = 0;
+		u64 NumFailed	   = 0;
+		u64 NumAssets	   = 0;
+		u64 MaxQueueDepth  = 0; // Requests that were not live yet
+		i64 StartTimestamp = 0;
+
+		i64 DecodeTicks		= 0;
+		i64 UploadTicks		= 0; // Submission of the upload until its fence completed
+		i64 LatencyTicks	= 0; // Request until live
+		i64 MaxLatencyTicks = 0;
+	};
+
+	// Assets drawn with the GPU resources of an earlier one with identical content instead of their own, since the
+	// registries were last cleared. Sizes are of the resources that were not created
+	struct DeduplicationStats
+	{
+		u64 NumMeshes		   = 0;
+		u64 NumTextures		   = 0;
+		u64 MeshSizeInBytes	   = 0;
+		u64 TextureSizeInBytes = 0;
+		i64 HashTicks		   = 0; // Hashing the content of every imported asset
+	};
+
 	class AssetManager
 	{
 	public:
-		AssetManager(RHI::D3D12Device* Device);
+		static constexpr u32 NumLoaderThreads = 2;
+
+		explicit AssetManager(RHI::D3D12Device* Device);
+		// Without a device, Uploader receives the decoded assets instead (e.g. NullAssetUploader)
+		explicit AssetManager(std::unique_ptr<IAssetUploader> Uploader);
 		~AssetManager();
 
 		template<typename T, typename... TArgs>
@@ -26,6 +63,7 @@ namespace Asset
 			return nullptr;
 		}
 
+		AssetCache&				GetCache() { return Cache; }
 		AssetRegistry<Mesh>&	GetMeshRegistry() { return MeshRegistry; }
 		AssetRegistry<Texture>& GetTextureRegistry() { return TextureRegistry; }
 
@@ -40,15 +78,99 @@ namespace Asset
 			return MeshImporter.Import(this, Options);
 		}
 
+		// Return immediately, the source is decoded on a loader thread and uploaded by Update. A texture's handle is
+		// created right away and turns valid once uploaded. The number of meshes of a file is only known once it has
+		// been decoded, so mesh handles are created by Update in request order, the same ones a synchronous load creates
+		AssetHandle LoadTextureAsync(const TextureImportOptions& Options);
+		void		LoadMeshAsync(const MeshImportOptions& Options);
+
+		// Called once per frame by the thread that owns the device, after the previous frame was submitted. Registers decoded
+		// assets, submits their uploads, flips the state of the handles whose uploads have completed and deletes destroyed
+		// assets once the GPU is done with them
+		void Update();
+
+		// Blocks until every asynchronous load is either live or has failed
+		void WaitForAsyncLoads();
+
+		// Waits for asynchronous loads and destroys every asset, e.g. before loading another world
+		void DestroyAll();
+
+		// Resolve Handle to draw with this frame. Marks its asset as used, or requests a reload from the cooked file if it was
+		// evicted, Handle turns valid again once that is live
+		Mesh*	 AcquireMesh(AssetHandle& Handle);
+		Texture* AcquireTexture(AssetHandle& Handle);
+
+		// Update evicts the least recently acquired assets while the resident ones exceed Budget
+		void								SetBudget(const AssetBudget& Budget) { Residency.Budget = Budget; }
+		[[nodiscard]] const AssetResidency& GetResidency() const noexcept { return Residency; }
+
+		[[nodiscard]] size_t				GetNumPendingLoads() const noexcept { return PendingLoads.size(); }
+		[[nodiscard]] const AsyncLoadStats& GetAsyncLoadStats() const noexcept { return Stats; }
+
+		[[nodiscard]] const DeduplicationStats& GetDeduplicationStats() const noexcept { return DedupStats; }
+
 		void RequestUpload(Texture* Texture);
-		void RequestUpload(Mesh* Mesh);
+		// All meshes of a file are staged together
+		void RequestUpload(Span<Mesh* const> Meshes);
 
 	private:
-		void UploadTexture(Texture* AssetTexture, RHI::D3D12LinkedDevice* Device);
-		void UploadMesh(Mesh* AssetMesh, RHI::D3D12LinkedDevice* Device);
+		struct AsyncLoad
+		{
+			AssetType			 Type = AssetType::Unknown;
+			MeshImportOptions	 MeshOptions;
+			TextureImportOptions TextureOptions;
+
+			// Decoded on a loader thread, owned by the request until Update registers them
+			std::vector<std::unique_ptr<Mesh>> DecodedMeshes;
+			std::unique_ptr<Texture>		   DecodedTexture;
+			std::atomic<bool>				   Decoded = false;
+
+			// Images that came with the meshes, Update loads them once the meshes are registered
+			std::vector<TextureImportOptions> Images;
+
+			// Of an evicted asset, Handles holds it from the start and MeshIndices selects the mesh in the cooked file
+			bool			 Reload = false;
+			std::vector<u64> MeshIndices;
+
+			// The texture reserved by LoadTextureAsync, or the meshes registered by Update
+			std::vector<AssetHandle> Handles;
+			bool					 Submitted = false;
+			u64						 Fence	   = 0;
+
+			i64 RequestTimestamp = 0;
+			i64 DecodeTicks		 = 0;
+			i64 SubmitTimestamp	 = 0;
+
+			// Completed with the upload once the request is live
+			ImportReport Report;
+		};
+
+		void Enqueue(std::shared_ptr<AsyncLoad> Load);
+		void Decode(AsyncLoad& Load);
+		void RunLoader(std::stop_token StopToken);
+
+		// Makes Asset share the resources of the first asset imported with the same content, in which case Asset must not be
+		// uploaded. Imports that are uploaded synchronously only share with live assets, the uploads of asynchronous loads
+		// complete in request order so they may share with assets whose upload is still in flight (AllowPending)
+		template<typename T>
+		bool Deduplicate(AssetRegistry<T>& Registry, std::unordered_map<u64, AssetHandle>& Contents, T* Asset, bool AllowPending);
+
+		template<typename T>
+		T* Acquire(AssetRegistry<T>& Registry, AssetHandle& Handle);
+
+		void Reload(AssetHandle Handle);
+		void EvictOverBudget();
+
+		// Whether the resources of the asset are released, also while its reload is in flight
+		[[nodiscard]] bool IsEvicted(AssetHandle Handle) const;
+
+		// Moves the assets the registries destroyed since the last call behind a fence and deletes the retired ones
+		void DeleteRetired();
+
+		void LogAsyncLoads();
 
 	private:
-		RHI::D3D12Device* Device = nullptr;
+		AssetCache Cache;
 
 		MeshImporter	MeshImporter;
 		TextureImporter TextureImporter;
@@ -56,6 +178,49 @@ namespace Asset
 		AssetRegistry<Mesh>	   MeshRegistry;
 		AssetRegistry<Texture> TextureRegistry;
 
+		// First asset imported with a content hash
+		std::unordered_map<u64, AssetHandle> MeshContents;
+		std::unordered_map<u64, AssetHandle> TextureContents;
+		DeduplicationStats					 DedupStats;
+
+		// Counted by Update, assets are used in frames and evicted by their last one
+		u64			   Frame = 0;
+		AssetResidency Residency;
+
+		// Not resident, reloaded once acquired. An asset stays evicted until its reload is submitted, a failed reload is
+		// requested again after a number of frames that doubles with every failure
+		struct EvictedAsset
+		{
+			bool Reloading	 = false;
+			u32	 NumFailures = 0;
+			u64	 RetryFrame	 = 0;
+		};
+		static constexpr u64				MinReloadBackoff = 16;
+		static constexpr u64				MaxReloadBackoff = 4096;
+		std::map<AssetHandle, EvictedAsset> Evicted;
+
+		// Destroyed before the registries, it waits for the copies into their resources
+		std::unique_ptr<IAssetUploader> Uploader;
+
+		// Destroyed assets waiting for the GPU in retirement order, deleted before the uploader
+		struct RetiredAssets
+		{
+			u64									  Fence = 0;
+			std::vector<std::unique_ptr<Mesh>>	  Meshes;
+			std::vector<std::unique_ptr<Texture>> Textures;
+		};
+		std::deque<RetiredAssets> Retired;
+
+		// Every request in request order, only touched by the thread that calls Update
+		std::deque<std::shared_ptr<AsyncLoad>> PendingLoads;
+		AsyncLoadStats						   Stats;
+
+		// Requests waiting for a loader thread
+		std::mutex							   Mutex;
+		std::condition_variable_any			   ConditionVariable;
+		std::deque<std::shared_ptr<AsyncLoad>> DecodeQueue;
+		std::vector<std::jthread>			   LoaderThreads;
+
 		friend class AssetWindow;
 	};
 } // namespace Asset
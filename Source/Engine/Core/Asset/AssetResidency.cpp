@@ -0,0 +1,136 @@
+#include "AssetResidency.h"
+#include <bit>
+
+namespace Asset
+{
+	void AssetResidency::Add(AssetHandle Handle, const AssetFootprint& Footprint, u64 Frame)
+	{
+		Remove(Handle);
+
+		auto Iterator = Entries.insert(Entries.end(), { Handle, Footprint, Frame });
+		Lookup.emplace(GetKey(Handle), Iterator);
+		Account(*Iterator, true);
+		Stats.NumLoads++;
+	}
+
+	void AssetResidency::Remove(AssetHandle Handle)
+	{
+		if (auto Iterator = Lookup.find(GetKey(Handle)); Iterator != Lookup.end())
+		{
+			Account(*Iterator->second, false);
+			Entries.erase(Iterator->second);
+			Lookup.erase(Iterator);
+		}
+	}
+
+	void AssetResidency::Clear()
+	{
+		Entries.clear();
+		Lookup.clear();
+		Total = {};
+		std::fill(std::begin(TotalByType), std::end(TotalByType), AssetFootprint{});
+	}
+
+	void AssetResidency::Touch(AssetHandle Handle, u64 Frame)
+	{
+		if (auto Iterator = Lookup.find(GetKey(Handle)); Iterator != Lookup.end())
+		{
+			Iterator->second->LastUsedFrame = Frame;
+			Entries.splice(Entries.end(), Entries, Iterator->second);
+		}
+	}
+
+	bool AssetResidency::Contains(AssetHandle Handle) const
+	{
+		return Lookup.contains(GetKey(Handle));
+	}
+
+	std::vector<AssetHandle> AssetResidency::Evict(u64 Frame, const std::function<bool(AssetHandle)>& CanEvict /*= {}*/)
+	{
+		std::vector<AssetHandle> Evicted;
+		for (auto Iterator = Entries.begin(); Iterator != Entries.end() && IsOverBudget();)
+		{
+			// Entries are ordered by last use, every later one has been used at least as recently
+			if (Iterator->LastUsedFrame + Budget.MinIdleFrames > Frame)
+			{
+				break;
+			}
+			if (CanEvict && !CanEvict(Iterator->Handle))
+			{
+				++Iterator;
+				continue;
+			}
+
+			Stats.NumEvictions++;
+			Stats.EvictedCpuSizeInBytes += Iterator->Footprint.CpuSizeInBytes;
+			Stats.EvictedGpuSizeInBytes += Iterator->Footprint.GpuSizeInBytes;
+			Account(*Iterator, false);
+			Evicted.push_back(Iterator->Handle);
+			Lookup.erase(GetKey(Iterator->Handle));
+			Iterator = Entries.erase(Iterator);
+		}
+
+		if (IsOverBudget())
+		{
+			Stats.NumFramesOverBudget++;
+		}
+		return Evicted;
+	}
+
+	ResidencyStats AssetResidency::Replay(const AssetBudget& Budget, Span<const AssetFootprint> Footprints, Span<const std::vector<u32>> Frames)
+	{
+		AssetResidency Residency;
+		Residency.Budget = Budget;
+
+		for (u64 Frame = 0; Frame < Frames.size(); ++Frame)
+		{
+			for (u32 Index : Frames[Frame])
+			{
+				AssetHandle Handle = {};
+				Handle.Type		   = AssetType::Mesh;
+				Handle.Id		   = Index;
+				if (Residency.Contains(Handle))
+				{
+					Residency.Touch(Handle, Frame);
+				}
+				else
+				{
+					Residency.Add(Handle, Footprints[Index], Frame);
+				}
+			}
+			Residency.Evict(Frame);
+		}
+		return Residency.GetStats();
+	}
+
+	u64 AssetResidency::GetKey(AssetHandle Handle) noexcept
+	{
+		// The state changes while an asset is resident
+		Handle.State = false;
+		return std::bit_cast<u64>(Handle);
+	}
+
+	bool AssetResidency::IsOverBudget() const noexcept
+	{
+		return (Budget.CpuSizeInBytes > 0 && Total.CpuSizeInBytes > Budget.CpuSizeInBytes) ||
+			   (Budget.GpuSizeInBytes > 0 && Total.GpuSizeInBytes > Budget.GpuSizeInBytes);
+	}
+
+	void AssetResidency::Account(const Entry& Entry, bool Add)
+	{
+		AssetFootprint& ByType = TotalByType[static_cast<size_t>(Entry.Handle.Type)];
+		for (AssetFootprint* Footprint : { &Total, &ByType })
+		{
+			if (Add)
+			{
+				Footprint->CpuSizeInBytes += Entry.Footprint.CpuSizeInBytes;
+				Footprint->GpuSizeInBytes += Entry.Footprint.GpuSizeInBytes;
+			}
+			else
+			{
+				Footprint->CpuSizeInBytes -= Entry.Footprint.CpuSizeInBytes;
+				Footprint->GpuSizeInBytes -= Entry.Footprint.GpuSizeInBytes;
+			}
+		}
+	}
+} // namespace Asset
@@ -0,0 +1,91 @@
+#pragma once
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include "System/System.h"
+#include "IAsset.h"
+
+namespace Asset
+{
+	struct AssetFootprint
+	{
+		u64 CpuSizeInBytes = 0;
+		u64 GpuSizeInBytes = 0;
+	};
+
+	struct AssetBudget
+	{
+		// 0 disables a limit
+		u64 CpuSizeInBytes = 0;
+		u64 GpuSizeInBytes = 0;
+
+		// Assets used within this many frames are never evicted, frames in flight may still reference their resources
+		u32 MinIdleFrames = 3;
+	};
+
+	struct ResidencyStats
+	{
+		u64 NumLoads			  = 0; // Made resident, including reloads after an eviction
+		u64 NumEvictions		  = 0;
+		u64 EvictedCpuSizeInBytes = 0;
+		u64 EvictedGpuSizeInBytes = 0;
+		u64 NumFramesOverBudget	  = 0; // Evict could not get back within the budget
+	};
+
+	// Which assets are resident and when they were last used. Knows nothing about the registries or the GPU, AssetManager
+	// makes it reflect the assets that are uploaded and carries out the evictions it picks
+	class AssetResidency
+	{
+	public:
+		// Resident from Frame on, replaces Handle's footprint if it is resident already
+		void Add(AssetHandle Handle, const AssetFootprint& Footprint, u64 Frame);
+
+		void Clear();
+
+		// Marks Handle as used in Frame, frames never go backwards
+		void Touch(AssetHandle Handle, u64 Frame);
+
+		[[nodiscard]] bool Contains(AssetHandle Handle) const;
+
+		// Removes least recently used assets that have been idle for at least Budget.MinIdleFrames and that CanEvict allows,
+		// until both totals are within the budget. Returns them in eviction order
+		std::vector<AssetHandle> Evict(u64 Frame, const std::function<bool(AssetHandle)>& CanEvict = {});
+
+		[[nodiscard]] const AssetFootprint& GetFootprint() const noexcept { return Total; }
+		[[nodiscard]] const AssetFootprint& GetFootprint(AssetType Type) const noexcept { return TotalByType[static_cast<size_t>(Type)]; }
+		[[nodiscard]] size_t				GetNumResident() const noexcept { return Entries.size(); }
+		[[nodiscard]] const ResidencyStats& GetStats() const noexcept { return Stats; }
+
+		// Replays a trace against a fresh residency, so the policy can be measured without a device (AssetCooker --replay-trace).
+		// Frames[i] lists the assets (indices into Footprints, all meshes) used in frame i, an asset is loaded when it is used
+		// and not resident
+		static ResidencyStats Replay(const AssetBudget& Budget, Span<const AssetFootprint> Footprints, Span<const std::vector<u32>> Frames);
+
+		AssetBudget Budget;
+
+	private:
+		struct Entry
+		{
+			AssetHandle	   Handle;
+			AssetFootprint Footprint;
+			u64			   LastUsedFrame;
+		};
+
+		[[nodiscard]] static u64 GetKey(AssetHandle Handle) noexcept;
+
+		void Remove(AssetHandle Handle);
+
+		[[nodiscard]] bool IsOverBudget() const noexcept;
+
+		void Account(const Entry& Entry, bool Add);
+
+	private:
+		// Least recently used first
+		std::list<Entry>										Entries;
+		std::unordered_map<u64, std::list<Entry>::iterator> Lookup;
+
+		AssetFootprint Total;
+		AssetFootprint TotalByType[3];
+		ResidencyStats Stats;
+	};
+} // namespace Asset
@@ -0,0 +1,340 @@
+#include "AssetUploader.h"
+
+using namespace DirectX;
+
+namespace Asset
+{
+	static f64 ToMilliseconds(i64 Ticks)
+	{
+		return static_cast<f64>(Ticks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency);
+	}
+
+	void IAssetUploader::LogUpload(const UploadPlan& Plan, size_t NumMeshes, size_t NumTextures, i64 RecordTicks)
+	{
+		Stats.NumUploads++;
+		Stats.NumBatches += Plan.Batches.size();
+		Stats.NumPages += Plan.PageSizes.size();
+		Stats.SizeInBytes += Plan.SizeInBytes;
+		Stats.StagingSizeInBytes += Plan.StagingSizeInBytes;
+		Stats.RecordTicks += RecordTicks;
+
+		const f64 MiB = 1.0 / (1024.0 * 1024.0);
+		KAGUYA_LOG(
+			Asset,
+			Info,
+			"Uploaded {} meshes and {} textures: {:.2f} MiB in {} batches ({:.2f} MiB per batch), {} staging pages ({:.2f}% padding), recorded in {:.2f}ms",
+			NumMeshes,
+			NumTextures,
+			static_cast<f64>(Plan.SizeInBytes) * MiB,
+			Plan.Batches.size(),
+			static_cast<f64>(Plan.SizeInBytes) * MiB / static_cast<f64>(std::max<size_t>(Plan.Batches.size(), 1)),
+			Plan.PageSizes.size(),
+			Plan.StagingSizeInBytes > 0 ? 100.0 * static_cast<f64>(Plan.StagingSizeInBytes - Plan.SizeInBytes) / static_cast<f64>(Plan.StagingSizeInBytes) : 0.0,
+			ToMilliseconds(RecordTicks));
+	}
+
+	D3D12AssetUploader::D3D12AssetUploader(RHI::D3D12Device* Device)
+		: Device(Device)
+	{
+	}
+
+	D3D12AssetUploader::~D3D12AssetUploader()
+	{
+		if (!Batches.empty())
+		{
+			Wait(Batches.back().Fence);
+		}
+	}
+
+	u64 D3D12AssetUploader::Upload(Span<Mesh* const> Meshes, Span<Texture* const> Textures)
+	{
+		i64 Start = Stopwatch::GetTimestamp();
+
+		RHI::D3D12LinkedDevice* LinkedDevice = Device->GetLinkedDevice();
+		std::vector<StagedCopy> Copies;
+		for (auto Texture : Textures)
+		{
+			CreateTexture(Texture, LinkedDevice, Copies);
+		}
+		for (auto Mesh : Meshes)
+		{
+			CreateMesh(Mesh, LinkedDevice, Copies);
+		}
+
+		std::vector<UploadRequest> Requests(Copies.size());
+		for (size_t i = 0; i < Copies.size(); ++i)
+		{
+			Requests[i] = {
+				.SizeInBytes = GetRequiredIntermediateSize(Copies[i].Resource, 0, static_cast<UINT>(Copies[i].Subresources.size())),
+				.Alignment	 = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT,
+			};
+		}
+		UploadPlan Plan = UploadPlanner::Plan(Requests, PlannerOptions);
+
+		// One copy queue submission per batch, its pages live until it has completed
+		for (const UploadBatch& PlannedBatch : Plan.Batches)
+		{
+			Batch& Batch = Batches.emplace_back();
+			Batch.Fence	 = ++NumBatches;
+			for (u32 Page = PlannedBatch.FirstPage; Page < PlannedBatch.FirstPage + PlannedBatch.NumPages; ++Page)
+			{
+				Batch.Pages.push_back(LinkedDevice->CreateUploadBuffer(Plan.PageSizes[Page]));
+			}
+
+			LinkedDevice->BeginResourceUpload();
+			for (u32 i = PlannedBatch.FirstRequest; i < PlannedBatch.FirstRequest + PlannedBatch.NumRequests; ++i)
+			{
+				const UploadPlacement& Placement = Plan.Placements[i];
+				LinkedDevice->Upload(
+					Copies[i].Subresources,
+					Copies[i].Resource,
+					Batch.Pages[Placement.Page - PlannedBatch.FirstPage].Get(),
+					Placement.Offset);
+			}
+			Batch.SyncHandle = LinkedDevice->EndResourceUpload(false);
+		}
+
+		LogUpload(Plan, Meshes.size(), Textures.size(), Stopwatch::GetTimestamp() - Start);
+		return NumBatches;
+	}
+
+	bool D3D12AssetUploader::IsComplete(u64 Fence)
+	{
+		while (!Batches.empty() && Batches.front().SyncHandle.IsComplete())
+		{
+			Batches.pop_front();
+		}
+		return Batches.empty() || Batches.front().Fence > Fence;
+	}
+
+	void D3D12AssetUploader::Wait(u64 Fence)
+	{
+		if (IsComplete(Fence))
+		{
+			return;
+		}
+
+		i64 Start = Stopwatch::GetTimestamp();
+		for (const Batch& Batch : Batches)
+		{
+			if (Batch.Fence == Fence)
+			{
+				Batch.SyncHandle.WaitForCompletion();
+				break;
+			}
+		}
+		IsComplete(Fence);
+
+		i64 StallTicks = Stopwatch::GetTimestamp() - Start;
+		Stats.StallTicks += StallTicks;
+		KAGUYA_LOG(Asset, Info, "Stalled {:.2f}ms on upload batch {} ({:.2f}ms in total)", ToMilliseconds(StallTicks), Fence, ToMilliseconds(Stats.StallTicks));
+	}
+
+	u64 D3D12AssetUploader::Retire()
+	{
+		RHI::D3D12LinkedDevice* LinkedDevice = Device->GetLinkedDevice();
+		Retirements.push_back({
+			.Fence				= ++NumRetirements,
+			.GraphicsSyncHandle = LinkedDevice->GetGraphicsQueue()->GetSyncHandle(),
+			.ComputeSyncHandle	= LinkedDevice->GetAsyncComputeQueue()->GetSyncHandle(),
+			.CopySyncHandle		= LinkedDevice->GetCopyQueue()->GetSyncHandle(),
+		});
+		return NumRetirements;
+	}
+
+	bool D3D12AssetUploader::IsRetired(u64 Fence)
+	{
+		while (!Retirements.empty() &&
+			   Retirements.front().GraphicsSyncHandle.IsComplete() &&
+			   Retirements.front().ComputeSyncHandle.IsComplete() &&
+			   Retirements.front().CopySyncHandle.IsComplete())
+		{
+			Retirements.pop_front();
+		}
+		return Retirements.empty() || Retirements.front().Fence > Fence;
+	}
+
+	void D3D12AssetUploader::CreateTexture(Texture* AssetTexture, RHI::D3D12LinkedDevice* Device, std::vector<StagedCopy>& Copies)
+	{
+		const auto& Metadata = AssetTexture->TexImage.GetMetadata();
+
+		DXGI_FORMAT Format = Metadata.format;
+		if (AssetTexture->Options.sRGB)
+		{
+			Format = DirectX::MakeSRGB(Format);
+		}
+
+		D3D12_RESOURCE_DESC ResourceDesc = {};
+		switch (Metadata.dimension)
+		{
+		case TEX_DIMENSION_TEXTURE1D:
+			ResourceDesc = CD3DX12_RESOURCE_DESC::Tex1D(
+				Format,
+				static_cast<UINT64>(Metadata.width),
+				static_cast<UINT16>(Metadata.arraySize));
+			break;
+
+		case TEX_DIMENSION_TEXTURE2D:
+			ResourceDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+				Format,
+				static_cast<UINT64>(Metadata.width),
+				static_cast<UINT>(Metadata.height),
+				static_cast<UINT16>(Metadata.arraySize),
+				static_cast<UINT16>(Metadata.mipLevels));
+			break;
+
+		case TEX_DIMENSION_TEXTURE3D:
+			ResourceDesc = CD3DX12_RESOURCE_DESC::Tex3D(
+				Format,
+				static_cast<UINT64>(Metadata.width),
+				static_cast<UINT>(Metadata.height),
+				static_cast<UINT16>(Metadata.depth));
+			break;
+		}
+
+		AssetTexture->DxTexture = RHI::D3D12Texture(Device, ResourceDesc, std::nullopt, AssetTexture->IsCubemap);
+		AssetTexture->Srv		= RHI::D3D12ShaderResourceView(Device, &AssetTexture->DxTexture, false);
+
+		StagedCopy& Copy = Copies.emplace_back();
+		Copy.Resource	 = AssetTexture->DxTexture.GetResource();
+		Copy.Subresources.resize(AssetTexture->TexImage.GetImageCount());
+		const auto pImages = AssetTexture->TexImage.GetImages();
+		for (size_t i = 0; i < AssetTexture->TexImage.GetImageCount(); ++i)
+		{
+			Copy.Subresources[i].RowPitch	= pImages[i].rowPitch;
+			Copy.Subresources[i].SlicePitch = pImages[i].slicePitch;
+			Copy.Subresources[i].pData		= pImages[i].pixels;
+		}
+	}
+
+	void D3D12AssetUploader::CreateMesh(Mesh* AssetMesh, RHI::D3D12LinkedDevice* Device, std::vector<StagedCopy>& Copies)
+	{
+		Span<const Vertex> Vertices	  = AssetMesh->GetVertices();
+		Span<const u32>	   Indices	  = AssetMesh->GetIndices();
+		Span<const u32>	   LodIndices = AssetMesh->GetLodIndices();
+
+		auto AddCopy = [&](RHI::D3D12Buffer& Buffer, const void* Data, UINT64 SizeInBytes) -> StagedCopy&
+		{
+			StagedCopy& Copy = Copies.emplace_back();
+			Copy.Resource	 = Buffer.GetResource();
+			Copy.Subresources.push_back({
+				.pData		= Data,
+				.RowPitch	= static_cast<LONG_PTR>(SizeInBytes),
+				.SlicePitch = static_cast<LONG_PTR>(SizeInBytes),
+			});
+			return Copy;
+		};
+
+		// Coarser levels are drawn from the same index buffer, right after LOD 0.
+		// 16-bit indices are narrowed here, the raw SRV over the index buffer needs a multiple of 4 bytes
+		const bool	 Is16Bit		  = AssetMesh->IndexFormat == DXGI_FORMAT_R16_UINT;
+		const UINT64 IndexSize		  = Is16Bit ? sizeof(uint16_t) : sizeof(uint32_t);
+		const size_t NumBufferIndices = Indices.size() + LodIndices.size();
+
+		UINT64 VertexBufferSizeInBytes = Vertices.size() * sizeof(Vertex);
+		UINT64 IndexBufferSizeInBytes  = Is16Bit ? AlignUp<size_t>(NumBufferIndices, 2) * sizeof(uint16_t) : NumBufferIndices * sizeof(uint32_t);
+
+		AssetMesh->VertexResource = RHI::D3D12Buffer(Device, VertexBufferSizeInBytes, sizeof(Vertex), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+		AssetMesh->IndexResource  = RHI::D3D12Buffer(Device, IndexBufferSizeInBytes, IndexSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+
+		AddCopy(AssetMesh->VertexResource, Vertices.data(), VertexBufferSizeInBytes);
+		if (!Is16Bit && LodIndices.empty())
+		{
+			AddCopy(AssetMesh->IndexResource, Indices.data(), IndexBufferSizeInBytes);
+		}
+		else
+		{
+			std::vector<u8> IndexData(IndexBufferSizeInBytes);
+			if (Is16Bit)
+			{
+				u16* Indices16 = reinterpret_cast<u16*>(IndexData.data());
+				auto Narrow	   = [](u32 Index)
+				{
+					return static_cast<u16>(Index);
+				};
+				std::ranges::transform(Indices, Indices16, Narrow);
+				std::ranges::transform(LodIndices, Indices16 + Indices.size(), Narrow);
+			}
+			else
+			{
+				std::memcpy(IndexData.data(), Indices.data(), Indices.size() * sizeof(u32));
+				std::memcpy(IndexData.data() + Indices.size() * sizeof(u32), LodIndices.data(), LodIndices.size() * sizeof(u32));
+			}
+			AddCopy(AssetMesh->IndexResource, IndexData.data(), IndexBufferSizeInBytes).Scratch = std::move(IndexData);
+		}
+
+		if (AssetMesh->Options.GenerateMeshlets)
+		{
+			Span<const Meshlet>			Meshlets			= AssetMesh->GetMeshlets();
+			Span<const u8>				UniqueVertexIndices = AssetMesh->GetUniqueVertexIndices();
+			Span<const MeshletTriangle> PrimitiveIndices	= AssetMesh->GetPrimitiveIndices();
+
+			UINT64 MeshletBufferSizeInBytes			  = Meshlets.size() * sizeof(Meshlet);
+			UINT64 UniqueVertexIndexBufferSizeInBytes = UniqueVertexIndices.size() * sizeof(uint8_t);
+			UINT64 PrimitiveIndexBufferSizeInBytes	  = PrimitiveIndices.size() * sizeof(MeshletTriangle);
+
+			AssetMesh->MeshletResource			 = RHI::D3D12Buffer(Device, MeshletBufferSizeInBytes, sizeof(Meshlet), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+			AssetMesh->UniqueVertexIndexResource = RHI::D3D12Buffer(Device, UniqueVertexIndexBufferSizeInBytes, sizeof(uint8_t), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+			AssetMesh->PrimitiveIndexResource	 = RHI::D3D12Buffer(Device, PrimitiveIndexBufferSizeInBytes, sizeof(MeshletTriangle), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_FLAG_NONE);
+
+			AddCopy(AssetMesh->MeshletResource, Meshlets.data(), MeshletBufferSizeInBytes);
+			AddCopy(AssetMesh->UniqueVertexIndexResource, UniqueVertexIndices.data(), UniqueVertexIndexBufferSizeInBytes);
+			AddCopy(AssetMesh->PrimitiveIndexResource, PrimitiveIndices.data(), PrimitiveIndexBufferSizeInBytes);
+		}
+
+		D3D12_GPU_VIRTUAL_ADDRESS IndexAddress	= AssetMesh->IndexResource.GetGpuVirtualAddress();
+		D3D12_GPU_VIRTUAL_ADDRESS VertexAddress = AssetMesh->VertexResource.GetGpuVirtualAddress();
+
+		const D3D12_RAYTRACING_GEOMETRY_DESC RaytracingGeometryDesc = {
+			.Type	   = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES,
+			.Flags	   = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE,
+			.Triangles = {
+				.Transform3x4 = NULL,
+				.IndexFormat  = AssetMesh->IndexFormat,
+				.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT,
+				.IndexCount	  = static_cast<UINT>(Indices.size()),
+				.VertexCount  = static_cast<UINT>(Vertices.size()),
+				.IndexBuffer  = IndexAddress,
+				.VertexBuffer = {
+					.StartAddress  = VertexAddress,
+					.StrideInBytes = sizeof(Vertex),
+				},
+			}
+		};
+		AssetMesh->Blas.AddGeometry(RaytracingGeometryDesc);
+
+		AssetMesh->VertexView = RHI::D3D12ShaderResourceView(Device, &AssetMesh->VertexResource, true, 0, static_cast<UINT>(VertexBufferSizeInBytes));
+		AssetMesh->IndexView  = RHI::D3D12ShaderResourceView(Device, &AssetMesh->IndexResource, true, 0, static_cast<UINT>(IndexBufferSizeInBytes));
+	}
+
+	u64 NullAssetUploader::Upload(Span<Mesh* const> Meshes, Span<Texture* const> Textures)
+	{
+		i64 Start = Stopwatch::GetTimestamp();
+
+		// The sizes the D3D12 uploader would stage, without the row pitch padding of textures
+		std::vector<UploadRequest> Requests;
+		auto					   AddRequest = [&](u64 SizeInBytes)
+		{
+			Requests.push_back({ .SizeInBytes = SizeInBytes, .Alignment = 512 });
+		};
+		for (auto Texture : Textures)
+		{
+			AddRequest(Texture->TexImage.GetPixelsSize());
+		}
+		for (auto Mesh : Meshes)
+		{
+			AddRequest(Mesh->GetVertices().size() * sizeof(Vertex));
+			AddRequest((Mesh->GetIndices().size() + Mesh->GetLodIndices().size()) * sizeof(u32));
+			if (Mesh->Options.GenerateMeshlets)
+			{
+				AddRequest(Mesh->GetMeshlets().size() * sizeof(Meshlet));
+				AddRequest(Mesh->GetUniqueVertexIndices().size() * sizeof(u8));
+				AddRequest(Mesh->GetPrimitiveIndices().size() * sizeof(MeshletTriangle));
+			}
+		}
+		UploadPlan Plan = UploadPlanner::Plan(Requests, PlannerOptions);
+
+		LogUpload(Plan, Meshes.size(), Textures.size(), Stopwatch::GetTimestamp() - Start);
+		return Stats.NumBatches;
+	}
+} // namespace Asset
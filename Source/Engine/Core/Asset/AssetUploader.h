@@ -0,0 +1,123 @@
+#pragma once
+#include <deque>
+#include "System/System.h"
+#include "Texture.h"
+#include "Mesh.h"
+#include "UploadPlanner.h"
+
+namespace Asset
+{
+	// Totals over the lifetime of an uploader, times are in Stopwatch ticks
+	struct UploadStats
+	{
+		u64 NumUploads		   = 0;
+		u64 NumBatches		   = 0;
+		u64 NumPages		   = 0;
+		u64 SizeInBytes		   = 0;
+		u64 StagingSizeInBytes = 0;
+		i64 RecordTicks		   = 0; // Staging and recording the copies
+		i64 StallTicks		   = 0; // Blocked in Wait
+	};
+
+	// Creates the GPU resources of decoded assets and copies their streams. Upload records one or more batches and returns
+	// the fence of the last, the CPU side can be released right away but it must not be rendered from until the fence is
+	// complete. Only ever called from the thread that drives AssetManager::Update
+	class IAssetUploader
+	{
+	public:
+		virtual ~IAssetUploader() = default;
+
+		virtual u64 Upload(Span<Mesh* const> Meshes, Span<Texture* const> Textures) = 0;
+
+		[[nodiscard]] virtual bool IsComplete(u64 Fence) = 0;
+
+		virtual void Wait(u64 Fence) = 0;
+
+		// Fence of all work submitted to the device so far, frames as well as uploads. Assets destroyed before are no longer
+		// read by the GPU once it is retired
+		virtual u64 Retire() = 0;
+
+		[[nodiscard]] virtual bool IsRetired(u64 Fence) = 0;
+
+		[[nodiscard]] const UploadStats& GetStats() const noexcept { return Stats; }
+
+		UploadPlannerOptions PlannerOptions;
+
+	protected:
+		void LogUpload(const UploadPlan& Plan, size_t NumMeshes, size_t NumTextures, i64 RecordTicks);
+
+	protected:
+		UploadStats Stats;
+	};
+
+	class D3D12AssetUploader : public IAssetUploader
+	{
+	public:
+		explicit D3D12AssetUploader(RHI::D3D12Device* Device);
+		~D3D12AssetUploader() override;
+
+		u64 Upload(Span<Mesh* const> Meshes, Span<Texture* const> Textures) override;
+
+		[[nodiscard]] bool IsComplete(u64 Fence) override;
+
+		void Wait(u64 Fence) override;
+
+		u64 Retire() override;
+
+		[[nodiscard]] bool IsRetired(u64 Fence) override;
+
+	private:
+		// A copy into one GPU resource, Scratch owns data that only exists for the upload (e.g. narrowed indices)
+		struct StagedCopy
+		{
+			ID3D12Resource*						Resource = nullptr;
+			std::vector<D3D12_SUBRESOURCE_DATA> Subresources;
+			std::vector<u8>						Scratch;
+		};
+
+		static void CreateTexture(Texture* AssetTexture, RHI::D3D12LinkedDevice* Device, std::vector<StagedCopy>& Copies);
+		static void CreateMesh(Mesh* AssetMesh, RHI::D3D12LinkedDevice* Device, std::vector<StagedCopy>& Copies);
+
+		struct Batch
+		{
+			u64								 Fence;
+			RHI::D3D12SyncHandle			 SyncHandle;
+			std::vector<Arc<ID3D12Resource>> Pages; // Released once the batch has completed
+		};
+
+		struct Retirement
+		{
+			u64					 Fence;
+			RHI::D3D12SyncHandle GraphicsSyncHandle;
+			RHI::D3D12SyncHandle ComputeSyncHandle;
+			RHI::D3D12SyncHandle CopySyncHandle;
+		};
+
+	private:
+		RHI::D3D12Device* Device = nullptr;
+
+		// Batches in submission order, completed ones are popped from the front
+		u64				  NumBatches = 0;
+		std::deque<Batch> Batches;
+
+		// Retirements in order, completed ones are popped from the front
+		u64					   NumRetirements = 0;
+		std::deque<Retirement> Retirements;
+	};
+
+	// Completes every batch immediately without a device. Still plans the staging of each upload, so the loading pipeline
+	// and the packing can be run and measured headless
+	class NullAssetUploader : public IAssetUploader
+	{
+	public:
+		u64 Upload(Span<Mesh* const> Meshes, Span<Texture* const> Textures) override;
+
+		[[nodiscard]] bool IsComplete(u64 Fence) override { return true; }
+
+		void Wait(u64 Fence) override {}
+
+		u64 Retire() override { return 0; }
+
+		[[nodiscard]] bool IsRetired(u64 Fence) override { return true; }
+	};
+} // namespace Asset
@@ -0,0 +1,800 @@
+#include "GltfParser.h"
+#include "AssetImporter.h"
+#include <array>
+#include <cctype>
+#include <numeric>
+#include <nlohmann/json.hpp>
+
+namespace Asset
+{
+	using json = nlohmann::json;
+
+	namespace Gltf
+	{
+		constexpr u32 Magic		= 0x46546C67; // "glTF"
+		constexpr u32 ChunkJson = 0x4E4F534A;
+		constexpr u32 ChunkBin	= 0x004E4942;
+
+		constexpr u32 Byte			= 5120;
+		constexpr u32 UnsignedByte	= 5121;
+		constexpr u32 Short			= 5122;
+		constexpr u32 UnsignedShort = 5123;
+		constexpr u32 UnsignedInt	= 5125;
+		constexpr u32 Float			= 5126;
+
+		constexpr u32 Triangles		= 4;
+		constexpr u32 TriangleStrip = 5;
+		constexpr u32 TriangleFan	= 6;
+	} // namespace Gltf
+
+	// The JSON and every buffer of a file, buffers point into mapped files or decoded data URIs
+	struct GltfDocument
+	{
+		MemoryMappedFile							   File;
+		std::vector<std::unique_ptr<MemoryMappedFile>> External;
+		std::vector<std::vector<u8>>				   Decoded;
+		json										   Json;
+		std::vector<Span<const u8>>					   Buffers;
+		u64											   SizeInBytes = 0;
+	};
+
+	// Elements of an accessor, Stride is of the buffer view (or the element size if it is tightly packed). Data is null if
+	// the accessor has no buffer view, all of its elements are zero then
+	struct GltfAccessor
+	{
+		const u8* Data			= nullptr;
+		size_t	  Count			= 0;
+		size_t	  Stride		= 0;
+		u32		  ComponentType = 0;
+		u32		  NumComponents = 0;
+		bool	  Normalized	= false;
+	};
+
+	struct GltfPrimitive
+	{
+		const json* Primitive;
+		size_t		Mesh;
+	};
+
+	// json::value returns a copy, arrays and objects are looked up in place
+	static const json& GetArray(const json& Json, const char* Key)
+	{
+		static const json Empty = json::array();
+		auto			  Iterator = Json.find(Key);
+		return Iterator != Json.end() && Iterator->is_array() ? *Iterator : Empty;
+	}
+
+	static const json& GetObject(const json& Json, const char* Key)
+	{
+		static const json Empty = json::object();
+		auto			  Iterator = Json.find(Key);
+		return Iterator != Json.end() && Iterator->is_object() ? *Iterator : Empty;
+	}
+
+	// Index stored under Key, SIZE_MAX if it is missing or not an index
+	static size_t GetIndex(const json& Json, const char* Key)
+	{
+		auto Iterator = Json.find(Key);
+		return Iterator != Json.end() && Iterator->is_number_unsigned() ? Iterator->get<size_t>() : SIZE_MAX;
+	}
+
+	static u32 GetComponentSize(u32 ComponentType) noexcept
+	{
+		switch (ComponentType)
+		{
+		case Gltf::Byte:
+		case Gltf::UnsignedByte:
+			return 1;
+		case Gltf::Short:
+		case Gltf::UnsignedShort:
+			return 2;
+		case Gltf::UnsignedInt:
+		case Gltf::Float:
+			return 4;
+		}
+		return 0;
+	}
+
+	static u32 GetNumComponents(std::string_view Type) noexcept
+	{
+		if (Type == "SCALAR")
+		{
+			return 1;
+		}
+		if (Type == "VEC2")
+		{
+			return 2;
+		}
+		if (Type == "VEC3")
+		{
+			return 3;
+		}
+		if (Type == "VEC4")
+		{
+			return 4;
+		}
+		return 0;
+	}
+
+	static bool DecodeBase64(std::string_view Text, std::vector<u8>& Data)
+	{
+		static constexpr auto Table = []
+		{
+			std::array<i32, 256> Table = {};
+			Table.fill(-1);
+			constexpr std::string_view Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			for (size_t i = 0; i < Alphabet.size(); ++i)
+			{
+				Table[static_cast<u8>(Alphabet[i])] = static_cast<i32>(i);
+			}
+			return Table;
+		}();
+
+		Data.clear();
+		Data.reserve(Text.size() / 4 * 3);
+		u32 Bits = 0, NumBits = 0;
+		for (char c : Text)
+		{
+			if (c == '=')
+			{
+				break;
+			}
+			i32 Value = Table[static_cast<u8>(c)];
+			if (Value < 0)
+			{
+				return false;
+			}
+			Bits = (Bits << 6) | static_cast<u32>(Value);
+			NumBits += 6;
+			if (NumBits >= 8)
+			{
+				NumBits -= 8;
+				Data.push_back(static_cast<u8>(Bits >> NumBits));
+			}
+		}
+		return true;
+	}
+
+	// Returns the payload of a base64 data URI, or an empty view if Uri is not one
+	static std::string_view GetDataUri(std::string_view Uri) noexcept
+	{
+		constexpr std::string_view Base64 = ";base64,";
+		if (!Uri.starts_with("data:"))
+		{
+			return {};
+		}
+		size_t Offset = Uri.find(Base64);
+		return Offset == std::string_view::npos ? std::string_view() : Uri.substr(Offset + Base64.size());
+	}
+
+	// URIs of external files are relative to the file and may be percent encoded
+	static std::filesystem::path ResolveUri(const std::filesystem::path& Path, std::string_view Uri)
+	{
+		std::string Decoded;
+		Decoded.reserve(Uri.size());
+		for (size_t i = 0; i < Uri.size(); ++i)
+		{
+			if (Uri[i] == '%' && i + 2 < Uri.size() && std::isxdigit(static_cast<u8>(Uri[i + 1])) && std::isxdigit(static_cast<u8>(Uri[i + 2])))
+			{
+				Decoded.push_back(static_cast<char>(std::stoi(std::string(Uri.substr(i + 1, 2)), nullptr, 16)));
+				i += 2;
+			}
+			else
+			{
+				Decoded.push_back(Uri[i]);
+			}
+		}
+		return Path.parent_path() / std::u8string(reinterpret_cast<const char8_t*>(Decoded.data()), Decoded.size());
+	}
+
+	// Parses the JSON of a .gltf, or of a .glb along with its binary chunk
+	static bool ReadJson(const MemoryMappedFile& File, json& Json, Span<const u8>& BinChunk)
+	{
+		const u8* Data = File.GetBaseAddress();
+		const u64 Size = File.GetSizeInBytes();
+		if (!File.IsValid())
+		{
+			return false;
+		}
+
+		u32 Header[3] = {};
+		if (Size >= sizeof(Header))
+		{
+			memcpy(Header, Data, sizeof(Header));
+		}
+		if (Header[0] != Gltf::Magic)
+		{
+			Json = json::parse(Data, Data + Size, nullptr, false);
+			return !Json.is_discarded();
+		}
+
+		// 12 byte header, then chunks of {Length, Type, Data} aligned to 4 bytes, JSON first
+		if (Header[1] != 2 || Header[2] > Size)
+		{
+			return false;
+		}
+		Span<const u8> JsonChunk;
+		for (u64 Offset = sizeof(Header); Offset + 8 <= Header[2];)
+		{
+			u32 Chunk[2];
+			memcpy(Chunk, Data + Offset, sizeof(Chunk));
+			Offset += sizeof(Chunk);
+			if (Offset + Chunk[0] > Header[2])
+			{
+				return false;
+			}
+			if (Chunk[1] == Gltf::ChunkJson && JsonChunk.empty())
+			{
+				JsonChunk = Span<const u8>(Data + Offset, Chunk[0]);
+			}
+			else if (Chunk[1] == Gltf::ChunkBin && BinChunk.empty())
+			{
+				BinChunk = Span<const u8>(Data + Offset, Chunk[0]);
+			}
+			Offset += (Chunk[0] + 3) & ~3u;
+		}
+
+		Json = json::parse(JsonChunk.begin(), JsonChunk.end(), nullptr, false);
+		return !Json.is_discarded() && Json.is_object();
+	}
+
+	static bool ReadDocument(const std::filesystem::path& Path, GltfDocument& Document)
+	{
+		Document.File = MemoryMappedFile(Path);
+
+		Span<const u8> BinChunk;
+		if (!ReadJson(Document.File, Document.Json, BinChunk))
+		{
+			return false;
+		}
+		Document.SizeInBytes = Document.File.GetSizeInBytes();
+
+		const json& Buffers = GetArray(Document.Json, "buffers");
+		for (size_t i = 0; i < Buffers.size(); ++i)
+		{
+			const json& Buffer	= Buffers[i];
+			const u64	Length	= Buffer.value("byteLength", u64(0));
+			std::string Uri		= Buffer.value("uri", std::string());
+			Span<const u8> Data;
+			if (Uri.empty())
+			{
+				// Only the first buffer of a .glb may be the binary chunk
+				if (i != 0)
+				{
+					return false;
+				}
+				Data = BinChunk;
+			}
+			else if (std::string_view Base64 = GetDataUri(Uri); !Base64.empty())
+			{
+				auto& Decoded = Document.Decoded.emplace_back();
+				if (!DecodeBase64(Base64, Decoded))
+				{
+					return false;
+				}
+				Data = Span<const u8>(Decoded.data(), Decoded.size());
+			}
+			else
+			{
+				// Mapping a missing file throws
+				std::filesystem::path BufferPath = ResolveUri(Path, Uri);
+				if (!exists(BufferPath))
+				{
+					return false;
+				}
+				auto& File = Document.External.emplace_back(std::make_unique<MemoryMappedFile>(BufferPath));
+				if (!File->IsValid())
+				{
+					return false;
+				}
+				Data = Span<const u8>(File->GetBaseAddress(), File->GetSizeInBytes());
+				Document.SizeInBytes += File->GetSizeInBytes();
+			}
+
+			// The binary chunk may be padded past byteLength
+			if (Data.size() < Length)
+			{
+				return false;
+			}
+			Document.Buffers.push_back(Span<const u8>(Data.data(), Length));
+		}
+		return true;
+	}
+
+	static bool GetBufferView(const GltfDocument& Document, size_t Index, Span<const u8>& View, size_t& Stride)
+	{
+		const json& BufferViews = GetArray(Document.Json, "bufferViews");
+		if (Index >= BufferViews.size())
+		{
+			return false;
+		}
+
+		const json&	 BufferView = BufferViews[Index];
+		const size_t Buffer		= BufferView.value("buffer", size_t(SIZE_MAX));
+		const size_t Offset		= BufferView.value("byteOffset", size_t(0));
+		const size_t Length		= BufferView.value("byteLength", size_t(0));
+		Stride					= BufferView.value("byteStride", size_t(0));
+		if (Buffer >= Document.Buffers.size() || Offset > Document.Buffers[Buffer].size() || Length > Document.Buffers[Buffer].size() - Offset)
+		{
+			return false;
+		}
+		View = Span<const u8>(Document.Buffers[Buffer].data() + Offset, Length);
+		return true;
+	}
+
+	static bool GetAccessor(const GltfDocument& Document, size_t Index, GltfAccessor& Accessor)
+	{
+		const json& Accessors = GetArray(Document.Json, "accessors");
+		if (Index >= Accessors.size() || Accessors[Index].contains("sparse"))
+		{
+			return false;
+		}
+
+		const json& Json		= Accessors[Index];
+		Accessor.Count			= Json.value("count", size_t(0));
+		Accessor.ComponentType	= Json.value("componentType", u32(0));
+		Accessor.NumComponents	= GetNumComponents(Json.value("type", std::string()));
+		Accessor.Normalized		= Json.value("normalized", false);
+		const size_t ElementSize = static_cast<size_t>(GetComponentSize(Accessor.ComponentType)) * Accessor.NumComponents;
+		if (ElementSize == 0)
+		{
+			return false;
+		}
+		if (!Json.contains("bufferView"))
+		{
+			return true;
+		}
+
+		Span<const u8> View;
+		size_t		   Stride = 0;
+		if (!GetBufferView(Document, GetIndex(Json, "bufferView"), View, Stride))
+		{
+			return false;
+		}
+		Accessor.Stride		= Stride ? Stride : ElementSize;
+		const size_t Offset = Json.value("byteOffset", size_t(0));
+		if (Accessor.Count > 0 && (Offset > View.size() || (Accessor.Count - 1) * Accessor.Stride + ElementSize > View.size() - Offset))
+		{
+			return false;
+		}
+		Accessor.Data = View.data() + Offset;
+		return true;
+	}
+
+	// Reads component c of element i as a float, normalized integers are mapped to [0, 1] or [-1, 1]
+	static f32 ReadComponent(const GltfAccessor& Accessor, size_t i, u32 c) noexcept
+	{
+		if (!Accessor.Data)
+		{
+			return 0.0f;
+		}
+
+		const u8* Element = Accessor.Data + i * Accessor.Stride;
+		switch (Accessor.ComponentType)
+		{
+		case Gltf::Float:
+		{
+			f32 Value;
+			memcpy(&Value, Element + c * 4, 4);
+			return Value;
+		}
+		case Gltf::UnsignedByte:
+		{
+			f32 Value = Element[c];
+			return Accessor.Normalized ? Value / 255.0f : Value;
+		}
+		case Gltf::Byte:
+		{
+			f32 Value = static_cast<i8>(Element[c]);
+			return Accessor.Normalized ? std::max(Value / 127.0f, -1.0f) : Value;
+		}
+		case Gltf::UnsignedShort:
+		{
+			u16 Value;
+			memcpy(&Value, Element + c * 2, 2);
+			return Accessor.Normalized ? Value / 65535.0f : Value;
+		}
+		case Gltf::Short:
+		{
+			i16 Value;
+			memcpy(&Value, Element + c * 2, 2);
+			return Accessor.Normalized ? std::max(Value / 32767.0f, -1.0f) : Value;
+		}
+		}
+		return 0.0f;
+	}
+
+	// Copies the first N components of every element into the member at Offset of each Vertex. Tightly packed floats are
+	// the common case and are read without conversion
+	template<u32 N>
+	static void ReadAttribute(const GltfAccessor& Accessor, std::vector<Vertex>& Vertices, size_t Offset)
+	{
+		u8* Destination = reinterpret_cast<u8*>(Vertices.data()) + Offset;
+		if (Accessor.Data && Accessor.ComponentType == Gltf::Float)
+		{
+			for (size_t i = 0; i < Vertices.size(); ++i)
+			{
+				memcpy(Destination + i * sizeof(Vertex), Accessor.Data + i * Accessor.Stride, N * sizeof(f32));
+			}
+			return;
+		}
+
+		for (size_t i = 0; i < Vertices.size(); ++i)
+		{
+			f32 Values[N];
+			for (u32 c = 0; c < N; ++c)
+			{
+				Values[c] = ReadComponent(Accessor, i, c);
+			}
+			memcpy(Destination + i * sizeof(Vertex), Values, sizeof(Values));
+		}
+	}
+
+	template<typename T>
+	static u32 ReadIndices(const GltfAccessor& Accessor, u32* Indices)
+	{
+		u32 Max = 0;
+		for (size_t i = 0; i < Accessor.Count; ++i)
+		{
+			T Index;
+			memcpy(&Index, Accessor.Data + i * Accessor.Stride, sizeof(T));
+			Indices[i] = Index;
+			Max		   = std::max<u32>(Max, Index);
+		}
+		return Max;
+	}
+
+	static bool ReadIndices(const GltfAccessor& Accessor, size_t NumVertices, std::vector<u32>& Indices)
+	{
+		if (Accessor.NumComponents != 1 || !Accessor.Data)
+		{
+			return false;
+		}
+
+		Indices.resize(Accessor.Count);
+		u32 Max = 0;
+		switch (Accessor.ComponentType)
+		{
+		case Gltf::UnsignedByte:
+			Max = ReadIndices<u8>(Accessor, Indices.data());
+			break;
+		case Gltf::UnsignedShort:
+			Max = ReadIndices<u16>(Accessor, Indices.data());
+			break;
+		case Gltf::UnsignedInt:
+			Max = ReadIndices<u32>(Accessor, Indices.data());
+			break;
+		default:
+			return false;
+		}
+		return Accessor.Count == 0 || Max < NumVertices;
+	}
+
+	// Turns strips and fans into lists and drops degenerate triangles of strips
+	static void ToTriangleList(u32 Mode, std::vector<u32>& Indices)
+	{
+		if (Mode == Gltf::Triangles)
+		{
+			Indices.resize(Indices.size() / 3 * 3);
+			return;
+		}
+
+		std::vector<u32> List;
+		List.reserve(Indices.size() >= 3 ? (Indices.size() - 2) * 3 : 0);
+		for (size_t i = 2; i < Indices.size(); ++i)
+		{
+			u32 a = Mode == Gltf::TriangleFan ? Indices[0] : Indices[i - 2];
+			u32 b = Indices[i - 1];
+			u32 c = Indices[i];
+			if (Mode == Gltf::TriangleStrip && (i % 2) == 1)
+			{
+				std::swap(a, b);
+			}
+			if (a != b && b != c && a != c)
+			{
+				List.insert(List.end(), { a, b, c });
+			}
+		}
+		Indices = std::move(List);
+	}
+
+	static bool ConvertPrimitive(const GltfDocument& Document, const json& Primitive, GltfMesh& Mesh)
+	{
+		const json& Attributes = GetObject(Primitive, "attributes");
+		const u32	Mode	   = Primitive.value("mode", Gltf::Triangles);
+		if (!Attributes.contains("POSITION"))
+		{
+			return false;
+		}
+
+		GltfAccessor Positions, Normals, TexCoords;
+		if (!GetAccessor(Document, GetIndex(Attributes, "POSITION"), Positions) || Positions.NumComponents != 3)
+		{
+			return false;
+		}
+		const bool HasNormals	= Attributes.contains("NORMAL");
+		const bool HasTexCoords = Attributes.contains("TEXCOORD_0");
+		if (HasNormals && (!GetAccessor(Document, GetIndex(Attributes, "NORMAL"), Normals) || Normals.NumComponents != 3 || Normals.Count != Positions.Count))
+		{
+			return false;
+		}
+		if (HasTexCoords &&
+			(!GetAccessor(Document, GetIndex(Attributes, "TEXCOORD_0"), TexCoords) || TexCoords.NumComponents != 2 || TexCoords.Count != Positions.Count))
+		{
+			return false;
+		}
+
+		Mesh.Vertices.resize(Positions.Count);
+		ReadAttribute<3>(Positions, Mesh.Vertices, offsetof(Vertex, Position));
+		if (HasNormals)
+		{
+			ReadAttribute<3>(Normals, Mesh.Vertices, offsetof(Vertex, Normal));
+		}
+		if (HasTexCoords)
+		{
+			ReadAttribute<2>(TexCoords, Mesh.Vertices, offsetof(Vertex, TextureCoord));
+		}
+
+		if (Primitive.contains("indices"))
+		{
+			GltfAccessor Indices;
+			if (!GetAccessor(Document, GetIndex(Primitive, "indices"), Indices) || !ReadIndices(Indices, Positions.Count, Mesh.Indices))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			Mesh.Indices.resize(Positions.Count);
+			std::iota(Mesh.Indices.begin(), Mesh.Indices.end(), 0u);
+		}
+		ToTriangleList(Mode, Mesh.Indices);
+
+		// Flat normals need a vertex per corner, like aiProcess_GenNormals
+		if (!HasNormals)
+		{
+			using namespace DirectX;
+
+			std::vector<Vertex> Corners(Mesh.Indices.size());
+			for (size_t i = 0; i < Mesh.Indices.size(); i += 3)
+			{
+				Corners[i + 0] = Mesh.Vertices[Mesh.Indices[i + 0]];
+				Corners[i + 1] = Mesh.Vertices[Mesh.Indices[i + 1]];
+				Corners[i + 2] = Mesh.Vertices[Mesh.Indices[i + 2]];
+
+				XMVECTOR A = XMLoadFloat3(&Corners[i + 0].Position);
+				XMVECTOR B = XMLoadFloat3(&Corners[i + 1].Position);
+				XMVECTOR C = XMLoadFloat3(&Corners[i + 2].Position);
+				XMFLOAT3 Normal;
+				XMStoreFloat3(&Normal, XMVector3Normalize(XMVector3Cross(B - A, C - A)));
+				Corners[i + 0].Normal = Corners[i + 1].Normal = Corners[i + 2].Normal = Normal;
+			}
+			Mesh.Vertices = std::move(Corners);
+			std::iota(Mesh.Indices.begin(), Mesh.Indices.end(), 0u);
+		}
+
+		// Left handed, z negated and the winding reversed
+		for (Vertex& Vertex : Mesh.Vertices)
+		{
+			Vertex.Position.z = -Vertex.Position.z;
+			Vertex.Normal.z	  = -Vertex.Normal.z;
+		}
+		for (size_t i = 0; i < Mesh.Indices.size(); i += 3)
+		{
+			std::swap(Mesh.Indices[i + 1], Mesh.Indices[i + 2]);
+		}
+		return !Mesh.Indices.empty();
+	}
+
+	static bool ReadImages(const GltfDocument& Document, const std::filesystem::path& Path, std::vector<GltfImage>& Images)
+	{
+		const json& Json = Document.Json;
+
+		// Base color and emissive textures hold colors, everything else (normals, metallic/roughness, occlusion) is linear
+		std::vector<bool> sRGB(GetArray(Json, "images").size());
+		const json&		  Textures = GetArray(Json, "textures");
+		for (const json& Material : GetArray(Json, "materials"))
+		{
+			const json* Colors[] = {
+				Material.contains("pbrMetallicRoughness") ? &Material["pbrMetallicRoughness"] : nullptr,
+				&Material,
+			};
+			const char* Names[] = { "baseColorTexture", "emissiveTexture" };
+			for (size_t i = 0; i < std::size(Names); ++i)
+			{
+				if (!Colors[i] || !Colors[i]->contains(Names[i]))
+				{
+					continue;
+				}
+				size_t Texture = (*Colors[i])[Names[i]].value("index", size_t(SIZE_MAX));
+				size_t Source  = Texture < Textures.size() ? Textures[Texture].value("source", size_t(SIZE_MAX)) : SIZE_MAX;
+				if (Source < sRGB.size())
+				{
+					sRGB[Source] = true;
+				}
+			}
+		}
+
+		const json& JsonImages = GetArray(Json, "images");
+		for (size_t i = 0; i < JsonImages.size(); ++i)
+		{
+			const json& JsonImage = JsonImages[i];
+			GltfImage&	Image	  = Images.emplace_back();
+			Image.Name			  = JsonImage.value("name", std::string());
+			Image.sRGB			  = sRGB[i];
+
+			std::string MimeType = JsonImage.value("mimeType", std::string());
+			std::string Uri		 = JsonImage.value("uri", std::string());
+			if (JsonImage.contains("bufferView"))
+			{
+				Span<const u8> View;
+				size_t		   Stride;
+				if (!GetBufferView(Document, GetIndex(JsonImage, "bufferView"), View, Stride))
+				{
+					return false;
+				}
+				Image.Data.assign(View.begin(), View.end());
+			}
+			else if (std::string_view Base64 = GetDataUri(Uri); !Base64.empty())
+			{
+				MimeType = Uri.substr(5, Uri.find(';') - 5);
+				if (!DecodeBase64(Base64, Image.Data))
+				{
+					return false;
+				}
+			}
+			else if (!Uri.empty())
+			{
+				Image.Path		= ResolveUri(Path, Uri);
+				Image.Extension = Image.Path.extension().string();
+				continue;
+			}
+			// image/png, image/jpeg and whatever extensions allow (e.g. image/webp)
+			Image.Extension = MimeType == "image/jpeg" ? ".jpg" : "." + MimeType.substr(MimeType.find('/') + 1);
+		}
+		return true;
+	}
+
+	static bool ParseDocument(const std::filesystem::path& Path, std::vector<GltfMesh>& Meshes, std::vector<GltfImage>& Images, GltfParseStats* Stats)
+	{
+		i64 Start = Stopwatch::GetTimestamp();
+
+		GltfDocument Document;
+		if (!ReadDocument(Path, Document))
+		{
+			return false;
+		}
+
+		// Compressed buffer views can not be read in place. Quantized accessors (KHR_mesh_quantization) are read like any other
+		for (const json& Extension : GetArray(Document.Json, "extensionsRequired"))
+		{
+			if (Extension == "KHR_draco_mesh_compression" || Extension == "EXT_meshopt_compression")
+			{
+				KAGUYA_LOG(Asset, Warn, "{} requires {}, which is not supported", Path.filename().string(), Extension.get<std::string>());
+				return false;
+			}
+		}
+
+		std::vector<GltfPrimitive> Primitives;
+		std::vector<std::string>   Names;
+		const json&				   JsonMeshes = GetArray(Document.Json, "meshes");
+		for (size_t m = 0; m < JsonMeshes.size(); ++m)
+		{
+			Names.push_back(JsonMeshes[m].value("name", std::string()));
+			for (const json& Primitive : GetArray(JsonMeshes[m], "primitives"))
+			{
+				const u32 Mode = Primitive.value("mode", Gltf::Triangles);
+				if (Mode == Gltf::Triangles || Mode == Gltf::TriangleStrip || Mode == Gltf::TriangleFan)
+				{
+					Primitives.push_back({ &Primitive, m });
+				}
+			}
+		}
+
+		i64 ReadEnd = Stopwatch::GetTimestamp();
+
+		Meshes.clear();
+		Meshes.resize(Primitives.size());
+		std::atomic<bool> Valid = true;
+		ParallelFor(
+			Process::GetThreadPool(),
+			Primitives.size(),
+			[&](size_t i)
+			{
+				// Must not escape into the thread pool
+				try
+				{
+					Meshes[i].Name = Names[Primitives[i].Mesh];
+					if (!ConvertPrimitive(Document, *Primitives[i].Primitive, Meshes[i]))
+					{
+						Valid = false;
+					}
+				}
+				catch (const json::exception& Exception)
+				{
+					KAGUYA_LOG(Asset, Warn, "{}: primitive {} is not valid glTF: {}", Path.filename().string(), i, Exception.what());
+					Valid = false;
+				}
+			});
+		if (!Valid || Meshes.empty())
+		{
+			return false;
+		}
+
+		Images.clear();
+		if (!ReadImages(Document, Path, Images))
+		{
+			return false;
+		}
+
+		if (Stats)
+		{
+			Stats->SizeInBytes	 = Document.SizeInBytes;
+			Stats->NumPrimitives = static_cast<u32>(Meshes.size());
+			Stats->NumVertices	 = 0;
+			Stats->NumTriangles	 = 0;
+			for (const GltfMesh& Mesh : Meshes)
+			{
+				Stats->NumVertices += Mesh.Vertices.size();
+				Stats->NumTriangles += Mesh.Indices.size() / 3;
+			}
+			Stats->NumImages	= static_cast<u32>(Images.size());
+			Stats->ReadTicks	= ReadEnd - Start;
+			Stats->ConvertTicks = Stopwatch::GetTimestamp() - ReadEnd;
+		}
+		return true;
+	}
+
+	bool GltfParser::Parse(
+		const std::filesystem::path& Path,
+		std::vector<GltfMesh>&		 Meshes,
+		std::vector<GltfImage>&		 Images,
+		GltfParseStats*				 Stats /*= nullptr*/)
+	{
+		// Members of the wrong type throw from nlohmann::json, files that cannot be mapped from MemoryMappedFile
+		try
+		{
+			return ParseDocument(Path, Meshes, Images, Stats);
+		}
+		catch (const json::exception& Exception)
+		{
+			KAGUYA_LOG(Asset, Warn, "{} is not valid glTF: {}", Path.filename().string(), Exception.what());
+		}
+		catch (const ExceptionIO& Exception)
+		{
+			KAGUYA_LOG(Asset, Warn, "Failed to read {}: {}", Path.filename().string(), Exception.what());
+		}
+		return false;
+	}
+
+	std::vector<std::filesystem::path> GltfParser::GetDependencies(const std::filesystem::path& Path)
+	{
+		MemoryMappedFile File(Path);
+		json			 Json;
+		Span<const u8>	 BinChunk;
+		if (!ReadJson(File, Json, BinChunk))
+		{
+			return {};
+		}
+
+		std::vector<std::filesystem::path> Dependencies;
+		for (const char* Array : { "buffers", "images" })
+		{
+			for (const json& Element : GetArray(Json, Array))
+			{
+				// Parse rejects elements that are not objects and uris that are not strings
+				auto Iterator = Element.find("uri");
+				if (Iterator == Element.end() || !Iterator->is_string())
+				{
+					continue;
+				}
+				const std::string& Uri = Iterator->get_ref<const std::string&>();
+				if (!Uri.empty() && GetDataUri(Uri).empty())
+				{
+					Dependencies.push_back(ResolveUri(Path, Uri));
+				}
+			}
+		}
+		return Dependencies;
+	}
+} // namespace Asset
@@ -0,0 +1,56 @@
+#pragma once
+#include "System/System.h"
+#include "Core/World/Vertex.h"
+
+namespace Asset
+{
+	// A triangle primitive in the layout assimp produces with aiProcess_ConvertToLeftHanded: z negated and the winding
+	// reversed. glTF texture coordinates already start at the top left, so they are unchanged
+	struct GltfMesh
+	{
+		std::string			Name; // Of the glTF mesh, its primitives share it
+		std::vector<Vertex> Vertices;
+		std::vector<u32>	Indices;
+	};
+
+	// An image of the file, either embedded (Data) or next to it (Path)
+	struct GltfImage
+	{
+		std::string			  Name;
+		std::string			  Extension; // Of the file or of the MIME type of embedded data, e.g. ".png"
+		std::vector<u8>		  Data;
+		std::filesystem::path Path;
+		bool				  sRGB = false; // Used as a base color or emissive texture
+	};
+
+	struct GltfParseStats
+	{
+		u64 SizeInBytes	  = 0; // The file and its external buffers
+		u32 NumPrimitives = 0;
+		u64 NumVertices	  = 0;
+		u64 NumTriangles  = 0;
+		u32 NumImages	  = 0;
+
+		// Stopwatch ticks
+		i64 ReadTicks	 = 0; // Mapping the file and buffers and parsing the JSON
+		i64 ConvertTicks = 0; // Reading the accessors of every primitive
+	};
+
+	// Reads glTF 2.0 files (.gltf with external or data URI buffers, and .glb) without assimp. Buffers are mapped and the
+	// accessors of every primitive are read straight into Vertex and index arrays, primitives are converted in parallel.
+	// Only POSITION, NORMAL and TEXCOORD_0 are read, node transforms are not applied (neither does the assimp path).
+	// Primitives without normals get flat ones, points and lines are skipped
+	class GltfParser
+	{
+	public:
+		// Part of the cache key of cooked glTF files, bump it whenever the output changes
+		static constexpr u8 Version = 1;
+
+		// Returns false if the file or one of its buffers could not be read or is malformed, or uses something that is not
+		// supported (e.g. sparse accessors or Draco compression)
+		static bool Parse(const std::filesystem::path& Path, std::vector<GltfMesh>& Meshes, std::vector<GltfImage>& Images, GltfParseStats* Stats = nullptr);
+
+		// Files the glTF references (buffers and images), they are part of its cache key. Empty if everything is embedded
+		static std::vector<std::filesystem::path> GetDependencies(const std::filesystem::path& Path);
+	};
+} // namespace Asset
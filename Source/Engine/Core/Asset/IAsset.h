@@ -38,7 +38,7 @@ namespace Asset
 
 		AssetType Type	  : 16;
 		u64		  State	  : 1;
-		u64		  Version : 15;
+		u64		  Version : 15; // Bumped by the registry whenever it destroys the asset, stale copies stop resolving
 		u64		  Id	  : 32;
 	};
 
@@ -0,0 +1,1842 @@
+#include "ImageDecoder.h"
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+
+namespace Asset
+{
+	// Rows handed out per ParallelFor index
+	constexpr size_t RowBlockSize = 32;
+
+	// Calls Function(Row) for every row of an image, blocks of rows in parallel
+	template<typename TFunction>
+	static void ForEachRow(size_t NumRows, TFunction&& Function)
+	{
+		ParallelFor(
+			Process::GetThreadPool(),
+			(NumRows + RowBlockSize - 1) / RowBlockSize,
+			[&](size_t Block)
+			{
+				const size_t Last = std::min((Block + 1) * RowBlockSize, NumRows);
+				for (size_t Row = Block * RowBlockSize; Row < Last; ++Row)
+				{
+					Function(Row);
+				}
+			});
+	}
+
+	static u32 ReadBigEndian16(const u8* Data)
+	{
+		return (u32(Data[0]) << 8) | u32(Data[1]);
+	}
+
+	static u32 ReadBigEndian32(const u8* Data)
+	{
+		return (u32(Data[0]) << 24) | (u32(Data[1]) << 16) | (u32(Data[2]) << 8) | u32(Data[3]);
+	}
+
+	static u32 ReadLittleEndian16(const u8* Data)
+	{
+		return u32(Data[0]) | (u32(Data[1]) << 8);
+	}
+
+	// Images are allocated before anything is decoded, a corrupt header must not ask for terabytes
+	static bool IsValidSize(u32 Width, u32 Height)
+	{
+		return Width > 0 && Height > 0 && Width <= 65536 && Height <= 65536;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+	// DEFLATE (RFC 1951) in a zlib stream (RFC 1950), as PNG stores its pixels
+
+	// Canonical Huffman code of DEFLATE. Codes of up to FastBits bits are resolved with one lookup, longer ones bit by bit
+	class InflateHuffman
+	{
+	public:
+		static constexpr u32 FastBits = 10;
+
+		// Returns false if the lengths over-subscribe the code
+		bool Build(const u8* Lengths, u32 NumSymbols)
+		{
+			Counts.fill(0);
+			Fast.fill(0);
+			for (u32 Symbol = 0; Symbol < NumSymbols; ++Symbol)
+			{
+				Counts[Lengths[Symbol]]++;
+			}
+			Counts[0] = 0;
+
+			i32 Left = 1;
+			for (u32 Length = 1; Length < 16; ++Length)
+			{
+				Left = (Left << 1) - Counts[Length];
+				if (Left < 0)
+				{
+					return false;
+				}
+			}
+
+			// Symbols sorted by code, and the first code of every length
+			std::array<u16, 16> Offsets = {};
+			std::array<u32, 16> Codes	= {};
+			for (u32 Length = 1, Code = 0; Length < 16; ++Length)
+			{
+				Offsets[Length] = static_cast<u16>(Offsets[Length - 1] + Counts[Length - 1]);
+				Code			= (Code + Counts[Length - 1]) << 1;
+				Codes[Length]	= Code;
+			}
+			for (u32 Symbol = 0; Symbol < NumSymbols; ++Symbol)
+			{
+				const u32 Length = Lengths[Symbol];
+				if (Length == 0)
+				{
+					continue;
+				}
+				Symbols[Offsets[Length]++] = static_cast<u16>(Symbol);
+
+				// DEFLATE sends codes most significant bit first into a least significant bit first stream
+				const u32 Code = Codes[Length]++;
+				if (Length <= FastBits)
+				{
+					u32 Reversed = 0;
+					for (u32 Bit = 0; Bit < Length; ++Bit)
+					{
+						Reversed |= ((Code >> Bit) & 1) << (Length - 1 - Bit);
+					}
+					for (u32 Index = Reversed; Index < Fast.size(); Index += 1u << Length)
+					{
+						Fast[Index] = static_cast<u16>((Symbol << 4) | Length);
+					}
+				}
+			}
+			return true;
+		}
+
+		std::array<u16, 1 << FastBits> Fast;	// (Symbol << 4) | Length, 0 if the code is longer than FastBits
+		std::array<u16, 16>			   Counts;	// Number of codes of every length
+		std::array<u16, 288>		   Symbols; // Ordered by code
+	};
+
+	class InflateStream
+	{
+	public:
+		InflateStream(Span<const u8> Data)
+			: Data(Data)
+		{
+		}
+
+		// Inflates the whole stream into Output, ExpectedSize is a hint for the first allocation
+		bool Inflate(std::vector<u8>& Output, size_t ExpectedSize)
+		{
+			Output.resize(std::max<size_t>(ExpectedSize, 1024));
+			Size = 0;
+
+			bool Final = false;
+			while (!Final)
+			{
+				Final	 = GetBits(1);
+				u32 Type = GetBits(2);
+				bool Ok	 = false;
+				if (Type == 0)
+				{
+					Ok = CopyStored(Output);
+				}
+				else if (Type == 1)
+				{
+					static const std::pair<InflateHuffman, InflateHuffman> Fixed = []
+					{
+						std::array<u8, 288 + 32> Lengths;
+						std::fill_n(Lengths.begin(), 144, u8(8));
+						std::fill_n(Lengths.begin() + 144, 112, u8(9));
+						std::fill_n(Lengths.begin() + 256, 24, u8(7));
+						std::fill_n(Lengths.begin() + 280, 8, u8(8));
+						std::fill_n(Lengths.begin() + 288, 32, u8(5));
+
+						std::pair<InflateHuffman, InflateHuffman> Codes;
+						Codes.first.Build(Lengths.data(), 288);
+						Codes.second.Build(Lengths.data() + 288, 32);
+						return Codes;
+					}();
+					Ok = InflateBlock(Output, Fixed.first, Fixed.second);
+				}
+				else if (Type == 2)
+				{
+					Ok = InflateDynamic(Output);
+				}
+				if (!Ok || IsOverrun())
+				{
+					return false;
+				}
+			}
+			Output.resize(Size);
+			return true;
+		}
+
+	private:
+		void Refill()
+		{
+			while (Count <= 56)
+			{
+				// Past the end zeros are shifted in, IsOverrun tells whether they were used
+				u64 Byte = Position < Data.size() ? Data[Position] : 0;
+				Position++;
+				Buffer |= Byte << Count;
+				Count += 8;
+			}
+		}
+
+		u32 GetBits(u32 NumBits)
+		{
+			if (Count < NumBits)
+			{
+				Refill();
+			}
+			u32 Value = static_cast<u32>(Buffer & ((u64(1) << NumBits) - 1));
+			Buffer >>= NumBits;
+			Count -= NumBits;
+			return Value;
+		}
+
+		[[nodiscard]] bool IsOverrun() const noexcept { return Position * 8 - Count > Data.size() * 8; }
+
+		i32 Decode(const InflateHuffman& Huffman)
+		{
+			if (Count < 16)
+			{
+				Refill();
+			}
+			if (u32 Entry = Huffman.Fast[Buffer & ((1u << InflateHuffman::FastBits) - 1)]; Entry != 0)
+			{
+				Buffer >>= Entry & 15;
+				Count -= Entry & 15;
+				return static_cast<i32>(Entry >> 4);
+			}
+
+			// Canonical decoding one bit at a time, codes of a length are consecutive
+			i32 Code  = 0;
+			i32 First = 0;
+			i32 Index = 0;
+			for (u32 Length = 1; Length < 16; ++Length)
+			{
+				Code |= GetBits(1);
+				const i32 NumCodes = Huffman.Counts[Length];
+				if (Code - NumCodes < First)
+				{
+					return Huffman.Symbols[Index + (Code - First)];
+				}
+				Index += NumCodes;
+				First = (First + NumCodes) << 1;
+				Code <<= 1;
+			}
+			return -1;
+		}
+
+		void Reserve(std::vector<u8>& Output, size_t NumBytes)
+		{
+			if (Size + NumBytes > Output.size())
+			{
+				Output.resize(std::max(Output.size() * 2, Size + NumBytes));
+			}
+		}
+
+		bool CopyStored(std::vector<u8>& Output)
+		{
+			// Back to the byte the bit buffer has reached
+			GetBits(Count % 8);
+			Position -= Count / 8;
+			Buffer = 0;
+			Count  = 0;
+			if (Position + 4 > Data.size())
+			{
+				return false;
+			}
+
+			const u32 Length = ReadLittleEndian16(&Data[Position]);
+			if ((Length ^ 0xFFFF) != ReadLittleEndian16(&Data[Position + 2]) || Position + 4 + Length > Data.size())
+			{
+				return false;
+			}
+			Reserve(Output, Length);
+			std::memcpy(Output.data() + Size, &Data[Position + 4], Length);
+			Size += Length;
+			Position += 4 + Length;
+			return true;
+		}
+
+		bool InflateDynamic(std::vector<u8>& Output)
+		{
+			static constexpr u8 Order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+			const u32 NumLiterals	= GetBits(5) + 257;
+			const u32 NumDistances	= GetBits(5) + 1;
+			const u32 NumCodeLength = GetBits(4) + 4;
+			if (NumLiterals > 286 || NumDistances > 30)
+			{
+				return false;
+			}
+
+			std::array<u8, 19> CodeLengths = {};
+			for (u32 i = 0; i < NumCodeLength; ++i)
+			{
+				CodeLengths[Order[i]] = static_cast<u8>(GetBits(3));
+			}
+			InflateHuffman CodeLengthCode;
+			if (!CodeLengthCode.Build(CodeLengths.data(), 19))
+			{
+				return false;
+			}
+
+			// Literal/length and distance code lengths are one sequence, repeats may cross from one to the other
+			std::array<u8, 286 + 30> Lengths = {};
+			for (u32 i = 0; i < NumLiterals + NumDistances;)
+			{
+				const i32 Symbol = Decode(CodeLengthCode);
+				if (Symbol < 0)
+				{
+					return false;
+				}
+				if (Symbol < 16)
+				{
+					Lengths[i++] = static_cast<u8>(Symbol);
+					continue;
+				}
+
+				u8	Value  = 0;
+				u32 Repeat = 0;
+				if (Symbol == 16)
+				{
+					if (i == 0)
+					{
+						return false;
+					}
+					Value  = Lengths[i - 1];
+					Repeat = 3 + GetBits(2);
+				}
+				else if (Symbol == 17)
+				{
+					Repeat = 3 + GetBits(3);
+				}
+				else
+				{
+					Repeat = 11 + GetBits(7);
+				}
+				if (i + Repeat > NumLiterals + NumDistances)
+				{
+					return false;
+				}
+				std::fill_n(Lengths.begin() + i, Repeat, Value);
+				i += Repeat;
+			}
+
+			InflateHuffman LiteralCode;
+			InflateHuffman DistanceCode;
+			if (Lengths[256] == 0 || !LiteralCode.Build(Lengths.data(), NumLiterals) ||
+				!DistanceCode.Build(Lengths.data() + NumLiterals, NumDistances))
+			{
+				return false;
+			}
+			return InflateBlock(Output, LiteralCode, DistanceCode);
+		}
+
+		bool InflateBlock(std::vector<u8>& Output, const InflateHuffman& LiteralCode, const InflateHuffman& DistanceCode)
+		{
+			static constexpr u16 LengthBase[29]	   = { 3,  4,  5,  6,  7,  8,  9,  10, 11,	13,	 15,  17,  19,	23, 27,
+													   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+			static constexpr u8	 LengthExtra[29]   = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+													   2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+			static constexpr u16 DistanceBase[30]  = { 1,	2,	 3,	  4,	5,	  7,	9,	  13,	17,	  25,
+													   33,	49,	 65,  97,	129,  193,	257,  385,	513,  769,
+													   1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+			static constexpr u8	 DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+													   6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+			for (;;)
+			{
+				const i32 Symbol = Decode(LiteralCode);
+				if (Symbol < 256)
+				{
+					if (Symbol < 0)
+					{
+						return false;
+					}
+					Reserve(Output, 1);
+					Output[Size++] = static_cast<u8>(Symbol);
+					continue;
+				}
+				if (Symbol == 256)
+				{
+					return true;
+				}
+				if (Symbol > 285)
+				{
+					return false;
+				}
+
+				const u32 Length		 = LengthBase[Symbol - 257] + GetBits(LengthExtra[Symbol - 257]);
+				const i32 DistanceSymbol = Decode(DistanceCode);
+				if (DistanceSymbol < 0 || DistanceSymbol > 29)
+				{
+					return false;
+				}
+				const u32 Distance = DistanceBase[DistanceSymbol] + GetBits(DistanceExtra[DistanceSymbol]);
+				if (Distance > Size || IsOverrun())
+				{
+					return false;
+				}
+
+				Reserve(Output, Length);
+				u8*		  Destination = Output.data() + Size;
+				const u8* Source	  = Destination - Distance;
+				if (Distance >= Length)
+				{
+					std::memcpy(Destination, Source, Length);
+				}
+				else
+				{
+					// Overlapping copies repeat the last Distance bytes
+					for (u32 i = 0; i < Length; ++i)
+					{
+						Destination[i] = Source[i];
+					}
+				}
+				Size += Length;
+			}
+		}
+
+		Span<const u8> Data;
+		size_t		   Position = 0;
+		u64			   Buffer	= 0;
+		u32			   Count	= 0;
+		size_t		   Size		= 0; // Of the output
+	};
+
+	static bool ZlibDecompress(Span<const u8> Data, std::vector<u8>& Output, size_t ExpectedSize)
+	{
+		// Deflate, no preset dictionary, the header check sums to a multiple of 31
+		if (Data.size() < 2 || (Data[0] & 0x0F) != 8 || (Data[1] & 0x20) != 0 || (Data[0] * 256 + Data[1]) % 31 != 0)
+		{
+			return false;
+		}
+		InflateStream Stream(Span<const u8>(Data.data() + 2, Data.size() - 2));
+		return Stream.Inflate(Output, ExpectedSize);
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+	// PNG
+
+	static const char* DecodePng(Span<const u8> Data, DecodedImage& Image)
+	{
+		u32 Width = 0, Height = 0, BitDepth = 0, ColorType = 0, Interlace = 0;
+
+		std::vector<u8>					 Compressed;
+		std::vector<std::array<u8, 4>>	 Palette;
+		std::array<u32, 3>				 Key	= {};
+		bool							 HasKey = false;
+		for (size_t Position = 8; Position + 12 <= Data.size();)
+		{
+			const u32 Length = ReadBigEndian32(&Data[Position]);
+			const u8* Chunk	 = &Data[Position + 8];
+			if (Length > Data.size() - Position - 12)
+			{
+				return "a chunk is truncated";
+			}
+
+			const std::string_view Type(reinterpret_cast<const char*>(&Data[Position + 4]), 4);
+			if (Type == "IHDR" && Length >= 13)
+			{
+				Width	  = ReadBigEndian32(Chunk);
+				Height	  = ReadBigEndian32(Chunk + 4);
+				BitDepth  = Chunk[8];
+				ColorType = Chunk[9];
+				Interlace = Chunk[12];
+				if (Chunk[10] != 0 || Chunk[11] != 0 || Interlace > 1)
+				{
+					return "unknown compression, filter or interlace method";
+				}
+			}
+			else if (Type == "PLTE")
+			{
+				Palette.resize(std::min<u32>(Length / 3, 256));
+				for (size_t i = 0; i < Palette.size(); ++i)
+				{
+					Palette[i] = { Chunk[i * 3 + 0], Chunk[i * 3 + 1], Chunk[i * 3 + 2], 255 };
+				}
+			}
+			else if (Type == "tRNS")
+			{
+				if (ColorType == 3)
+				{
+					for (size_t i = 0; i < std::min<size_t>(Length, Palette.size()); ++i)
+					{
+						Palette[i][3] = Chunk[i];
+					}
+				}
+				else if (ColorType == 0 && Length >= 2)
+				{
+					Key[0] = ReadBigEndian16(Chunk);
+					HasKey = true;
+				}
+				else if (ColorType == 2 && Length >= 6)
+				{
+					Key	   = { ReadBigEndian16(Chunk), ReadBigEndian16(Chunk + 2), ReadBigEndian16(Chunk + 4) };
+					HasKey = true;
+				}
+			}
+			else if (Type == "IDAT")
+			{
+				Compressed.insert(Compressed.end(), Chunk, Chunk + Length);
+			}
+			else if (Type == "IEND")
+			{
+				break;
+			}
+			Position += 12 + Length;
+		}
+
+		u32 NumChannels = 0;
+		switch (ColorType)
+		{
+		case 0:
+			NumChannels = BitDepth == 1 || BitDepth == 2 || BitDepth == 4 || BitDepth == 8 || BitDepth == 16 ? 1 : 0;
+			break;
+		case 2:
+			NumChannels = BitDepth == 8 || BitDepth == 16 ? 3 : 0;
+			break;
+		case 3:
+			NumChannels = (BitDepth == 1 || BitDepth == 2 || BitDepth == 4 || BitDepth == 8) && !Palette.empty() ? 1 : 0;
+			break;
+		case 4:
+			NumChannels = BitDepth == 8 || BitDepth == 16 ? 2 : 0;
+			break;
+		case 6:
+			NumChannels = BitDepth == 8 || BitDepth == 16 ? 4 : 0;
+			break;
+		}
+		if (!IsValidSize(Width, Height) || NumChannels == 0)
+		{
+			return "invalid header";
+		}
+
+		// Adam7 passes, a non interlaced image is a single pass over every pixel
+		struct Pass
+		{
+			u32	   X, Y, StepX, StepY;
+			u32	   Width, Height;
+			size_t RowSize; // Without the filter byte
+			size_t Offset;
+		};
+		static constexpr u32 Adam7[7][4] = { { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+											 { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+
+
+		const u32		  BitsPerPixel = NumChannels * BitDepth;
+		std::vector<Pass> Passes;
+		size_t			  RawSize = 0;
+		for (u32 p = 0; p < (Interlace ? 7u : 1u); ++p)
+		{
+			Pass Pass	 = {};
+			Pass.X		 = Interlace ? Adam7[p][0] : 0;
+			Pass.Y		 = Interlace ? Adam7[p][1] : 0;
+			Pass.StepX	 = Interlace ? Adam7[p][2] : 1;
+			Pass.StepY	 = Interlace ? Adam7[p][3] : 1;
+			Pass.Width	 = Width > Pass.X ? (Width - Pass.X + Pass.StepX - 1) / Pass.StepX : 0;
+			Pass.Height	 = Height > Pass.Y ? (Height - Pass.Y + Pass.StepY - 1) / Pass.StepY : 0;
+			Pass.RowSize = (size_t(Pass.Width) * BitsPerPixel + 7) / 8;
+			Pass.Offset	 = RawSize;
+			if (Pass.Width > 0 && Pass.Height > 0)
+			{
+				RawSize += (Pass.RowSize + 1) * Pass.Height;
+				Passes.push_back(Pass);
+			}
+		}
+
+		std::vector<u8> Raw;
+		if (!ZlibDecompress(Compressed, Raw, RawSize) || Raw.size() < RawSize)
+		{
+			return "the image data is corrupt";
+		}
+
+		// Filters reference the row above, so rows are unfiltered in order
+		const size_t FilterStride = std::max(BitsPerPixel / 8, 1u);
+		for (const Pass& Pass : Passes)
+		{
+			std::vector<u8> Zeros(Pass.RowSize);
+			const u8*		Previous = Zeros.data();
+			for (u32 y = 0; y < Pass.Height; ++y)
+			{
+				u8*		 Row	= &Raw[Pass.Offset + y * (Pass.RowSize + 1)];
+				const u8 Filter = Row[0];
+				Row++;
+				switch (Filter)
+				{
+				case 0:
+					break;
+				case 1:
+					for (size_t x = FilterStride; x < Pass.RowSize; ++x)
+					{
+						Row[x] += Row[x - FilterStride];
+					}
+					break;
+				case 2:
+					for (size_t x = 0; x < Pass.RowSize; ++x)
+					{
+						Row[x] += Previous[x];
+					}
+					break;
+				case 3:
+					for (size_t x = 0; x < Pass.RowSize; ++x)
+					{
+						const u32 Left = x >= FilterStride ? Row[x - FilterStride] : 0;
+						Row[x] += static_cast<u8>((Left + Previous[x]) / 2);
+					}
+					break;
+				case 4:
+					for (size_t x = 0; x < Pass.RowSize; ++x)
+					{
+						const i32 a = x >= FilterStride ? Row[x - FilterStride] : 0;
+						const i32 b = Previous[x];
+						const i32 c = x >= FilterStride ? Previous[x - FilterStride] : 0;
+						const i32 p = a + b - c;
+						const i32 pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+						Row[x] += static_cast<u8>(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+					}
+					break;
+				default:
+					return "unknown filter type";
+				}
+				Previous = Row;
+			}
+		}
+
+		Image.Width	  = Width;
+		Image.Height  = Height;
+		Image.IsFloat = false;
+		Image.Pixels.resize(size_t(Width) * Height * 4);
+
+		// Samples keep their bit depth until the end so tRNS keys compare exactly
+		const u32 MaxValue = (1u << BitDepth) - 1;
+		auto	  ToByte   = [&](u32 Value) -> u8
+		{
+			return static_cast<u8>(BitDepth == 16 ? (Value * 255 + 32895) >> 16 : (BitDepth == 8 ? Value : Value * 255 / MaxValue));
+		};
+		for (const Pass& Pass : Passes)
+		{
+			ForEachRow(
+				Pass.Height,
+				[&](size_t y)
+				{
+					const u8* Row	  = &Raw[Pass.Offset + y * (Pass.RowSize + 1) + 1];
+					auto	  GetSample = [&](size_t Index) -> u32
+					{
+						if (BitDepth == 16)
+						{
+							return ReadBigEndian16(Row + Index * 2);
+						}
+						if (BitDepth == 8)
+						{
+							return Row[Index];
+						}
+						const size_t Bit = Index * BitDepth;
+						return (Row[Bit / 8] >> (8 - BitDepth - Bit % 8)) & MaxValue;
+					};
+
+					u8* Destination = &Image.Pixels[((Pass.Y + y * Pass.StepY) * size_t(Width) + Pass.X) * 4];
+
+					// The common 8 bit RGB(A) rows of non interlaced images only need copying
+					if (BitDepth == 8 && Pass.StepX == 1 && ColorType == 6)
+					{
+						std::memcpy(Destination, Row, Pass.RowSize);
+						return;
+					}
+					if (BitDepth == 8 && Pass.StepX == 1 && ColorType == 2 && !HasKey)
+					{
+						for (size_t x = 0; x < Pass.Width; ++x, Destination += 4, Row += 3)
+						{
+							std::memcpy(Destination, Row, 3);
+							Destination[3] = 255;
+						}
+						return;
+					}
+
+					for (size_t x = 0; x < Pass.Width; ++x, Destination += Pass.StepX * 4)
+					{
+						const size_t Index = x * NumChannels;
+						switch (ColorType)
+						{
+						case 0:
+						{
+							const u32 Gray = GetSample(Index);
+							const u8  Byte = ToByte(Gray);
+							Destination[0] = Destination[1] = Destination[2] = Byte;
+							Destination[3]									  = HasKey && Gray == Key[0] ? 0 : 255;
+							break;
+						}
+						case 2:
+						{
+							const u32 r = GetSample(Index), g = GetSample(Index + 1), b = GetSample(Index + 2);
+							Destination[0] = ToByte(r);
+							Destination[1] = ToByte(g);
+							Destination[2] = ToByte(b);
+							Destination[3] = HasKey && r == Key[0] && g == Key[1] && b == Key[2] ? 0 : 255;
+							break;
+						}
+						case 3:
+						{
+							// Indices past the palette are black, as libpng decodes them
+							const u32 Entry = GetSample(Index);
+							const std::array<u8, 4> Color = Entry < Palette.size() ? Palette[Entry] : std::array<u8, 4>{ 0, 0, 0, 255 };
+							std::memcpy(Destination, Color.data(), 4);
+							break;
+						}
+						case 4:
+							Destination[0] = Destination[1] = Destination[2] = ToByte(GetSample(Index));
+							Destination[3]									  = ToByte(GetSample(Index + 1));
+							break;
+						case 6:
+							for (size_t c = 0; c < 4; ++c)
+							{
+								Destination[c] = ToByte(GetSample(Index + c));
+							}
+							break;
+						}
+					}
+				});
+		}
+		return nullptr;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+	// JPEG, baseline and extended sequential Huffman coding (ITU T.81)
+
+	// Natural (row major) index of every coefficient in zig-zag order, with padding for runs past the end of a block
+	static constexpr u8 ZigZag[64 + 16] = { 0,	1,	8,	16, 9,	2,	3,	10, 17, 24, 32, 25, 18, 11, 4,	5,	12, 19, 26, 33,
+											40, 48, 41, 34, 27, 20, 13, 6,	7,	14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36,
+											29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54,
+											47, 55, 62, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63 };
+
+	struct JpegHuffman
+	{
+		static constexpr u32 FastBits = 9;
+
+		// Without codes, until a DHT segment defines the table
+		JpegHuffman()
+		{
+			Fast.fill(0);
+			MaxCode.fill(-1);
+			Offsets.fill(0);
+			Values.fill(0);
+		}
+
+		// Returns false if there are more codes of a length than fit in it
+		[[nodiscard]] bool Build(const u8* Counts, const u8* SymbolValues)
+		{
+			Fast.fill(0);
+			MaxCode.fill(-1);
+			u32 Code  = 0;
+			u32 Index = 0;
+			for (u32 Length = 1; Length <= 16; ++Length)
+			{
+				Offsets[Length] = static_cast<i32>(Index) - static_cast<i32>(Code);
+				if (Code + Counts[Length - 1] > (1u << Length))
+				{
+					return false;
+				}
+				for (u32 i = 0; i < Counts[Length - 1]; ++i, ++Code, ++Index)
+				{
+					Values[Index] = SymbolValues[Index];
+					if (Length <= FastBits)
+					{
+						const u32 First = Code << (FastBits - Length);
+						for (u32 Fill = 0; Fill < (1u << (FastBits - Length)); ++Fill)
+						{
+							Fast[First + Fill] = static_cast<u16>((Length << 8) | Values[Index]);
+						}
+					}
+				}
+				MaxCode[Length] = Counts[Length - 1] > 0 ? static_cast<i32>(Code) - 1 : -1;
+				Code <<= 1;
+			}
+			return true;
+		}
+
+		std::array<u16, 1 << FastBits> Fast;	// (Length << 8) | Value, 0 if the code is longer than FastBits
+		std::array<i32, 17>			   MaxCode; // Largest code of every length, -1 if there is none
+		std::array<i32, 17>			   Offsets; // Index of a code's value minus the code
+		std::array<u8, 256>			   Values;
+	};
+
+	// Entropy coded data, most significant bit first. Stuffed zero bytes are skipped, a marker ends the data and zeros are
+	// read after it
+	class JpegBitReader
+	{
+	public:
+		JpegBitReader(Span<const u8> Data, size_t Position)
+			: Data(Data)
+			, Position(Position)
+		{
+		}
+
+		u32 GetBits(u32 NumBits)
+		{
+			Refill();
+			u32 Value = Buffer >> (32 - NumBits);
+			Buffer <<= NumBits;
+			Count -= NumBits;
+			return Value;
+		}
+
+		// The value of an NumBits bit magnitude category, F.12 of the standard
+		i32 Receive(u32 NumBits)
+		{
+			if (NumBits == 0)
+			{
+				return 0;
+			}
+			i32 Value = static_cast<i32>(GetBits(NumBits));
+			return Value < (1 << (NumBits - 1)) ? Value - (1 << NumBits) + 1 : Value;
+		}
+
+		i32 Decode(const JpegHuffman& Huffman)
+		{
+			Refill();
+			if (u32 Entry = Huffman.Fast[Buffer >> (32 - JpegHuffman::FastBits)]; Entry != 0)
+			{
+				Buffer <<= Entry >> 8;
+				Count -= Entry >> 8;
+				return Entry & 0xFF;
+			}
+			for (u32 Length = JpegHuffman::FastBits + 1; Length <= 16; ++Length)
+			{
+				const i32 Code = static_cast<i32>(Buffer >> (32 - Length));
+				if (Code <= Huffman.MaxCode[Length])
+				{
+					Buffer <<= Length;
+					Count -= Length;
+					return Huffman.Values[(Code + Huffman.Offsets[Length]) & 0xFF];
+				}
+			}
+			return -1;
+		}
+
+		// Skips the restart marker that has to follow, returns false if there is none
+		bool Restart()
+		{
+			Buffer = 0;
+			Count  = 0;
+			Marker = false;
+			while (Position + 1 < Data.size() && Data[Position] == 0xFF && Data[Position + 1] == 0xFF)
+			{
+				Position++;
+			}
+			if (Position + 1 < Data.size() && Data[Position] == 0xFF && Data[Position + 1] >= 0xD0 && Data[Position + 1] <= 0xD7)
+			{
+				Position += 2;
+				return true;
+			}
+			return false;
+		}
+
+		// Position of the marker that ended the data
+		[[nodiscard]] size_t GetPosition() const noexcept { return Position; }
+
+	private:
+		void Refill()
+		{
+			while (Count <= 24)
+			{
+				u32 Byte = 0;
+				if (!Marker && Position < Data.size())
+				{
+					Byte = Data[Position];
+					if (Byte != 0xFF)
+					{
+						Position++;
+					}
+					else if (Position + 1 < Data.size() && Data[Position + 1] == 0x00)
+					{
+						Position += 2;
+					}
+					else
+					{
+						Marker = true;
+						Byte   = 0;
+					}
+				}
+				Buffer |= Byte << (24 - Count);
+				Count += 8;
+			}
+		}
+
+		Span<const u8> Data;
+		size_t		   Position;
+		u32			   Buffer = 0;
+		i32			   Count  = 0;
+		bool		   Marker = false;
+	};
+
+	struct JpegComponent
+	{
+		u32				   Id;
+		u32				   SamplingX, SamplingY;
+		u32				   QuantTable;
+		std::array<u16, 64> Quant;		 // Natural order, latched by the first scan of the component
+		u32				   BlocksX, BlocksY; // Padded to whole MCUs
+		u32				   Width, Height;	 // Of the subsampled component
+		std::vector<i16>   Coefficients;	 // 64 per block, natural order
+		std::vector<u8>	   Samples;			 // BlocksX * 8 by BlocksY * 8
+		i32				   DcPrediction = 0;
+		u32				   DcTable = 0, AcTable = 0;
+	};
+
+	// Inverse DCT of one block with the accurate integer algorithm of the IJG library (jidctint.c), so the output matches
+	// libjpeg's default method. Sums are 64 bit so corrupt coefficients cannot overflow them
+	static void InverseDct(const i16* Coefficients, const u16* Quant, u8* Output, size_t Pitch)
+	{
+		constexpr i64 ConstBits = 13;
+		constexpr i64 Pass1Bits = 2;
+
+		constexpr i64 Fix_0_298631336 = 2446;
+		constexpr i64 Fix_0_390180644 = 3196;
+		constexpr i64 Fix_0_541196100 = 4433;
+		constexpr i64 Fix_0_765366865 = 6270;
+		constexpr i64 Fix_0_899976223 = 7373;
+		constexpr i64 Fix_1_175875602 = 9633;
+		constexpr i64 Fix_1_501321110 = 12299;
+		constexpr i64 Fix_1_847759065 = 15137;
+		constexpr i64 Fix_1_961570560 = 16069;
+		constexpr i64 Fix_2_053119869 = 16819;
+		constexpr i64 Fix_2_562915447 = 20995;
+		constexpr i64 Fix_3_072711026 = 25172;
+
+		// Even and odd halves of the 1D transform of s0..s7, results end up in the 4 pairs of sums and differences
+		struct Butterfly
+		{
+			i64 Even[4];
+			i64 Odd[4];
+		};
+		auto Transform = [](i64 s0, i64 s1, i64 s2, i64 s3, i64 s4, i64 s5, i64 s6, i64 s7)
+		{
+			i64 z1	 = (s2 + s6) * Fix_0_541196100;
+			i64 tmp2 = z1 + s6 * -Fix_1_847759065;
+			i64 tmp3 = z1 + s2 * Fix_0_765366865;
+			i64 tmp0 = (s0 + s4) * (1 << ConstBits);
+			i64 tmp1 = (s0 - s4) * (1 << ConstBits);
+
+			Butterfly Result;
+			Result.Even[0] = tmp0 + tmp3;
+			Result.Even[3] = tmp0 - tmp3;
+			Result.Even[1] = tmp1 + tmp2;
+			Result.Even[2] = tmp1 - tmp2;
+
+			tmp0	= s7;
+			tmp1	= s5;
+			tmp2	= s3;
+			tmp3	= s1;
+			z1		= tmp0 + tmp3;
+			i64 z2	= tmp1 + tmp2;
+			i64 z3	= tmp0 + tmp2;
+			i64 z4	= tmp1 + tmp3;
+			i64 z5	= (z3 + z4) * Fix_1_175875602;
+			tmp0 *= Fix_0_298631336;
+			tmp1 *= Fix_2_053119869;
+			tmp2 *= Fix_3_072711026;
+			tmp3 *= Fix_1_501321110;
+			z1 *= -Fix_0_899976223;
+			z2 *= -Fix_2_562915447;
+			z3 = z3 * -Fix_1_961570560 + z5;
+			z4 = z4 * -Fix_0_390180644 + z5;
+
+			Result.Odd[0] = tmp3 + z1 + z4;
+			Result.Odd[1] = tmp2 + z2 + z3;
+			Result.Odd[2] = tmp1 + z2 + z4;
+			Result.Odd[3] = tmp0 + z1 + z3;
+			return Result;
+		};
+
+		i64 Workspace[64];
+		for (size_t x = 0; x < 8; ++x)
+		{
+			auto In = [&](size_t y)
+			{
+				return static_cast<i64>(Coefficients[y * 8 + x]) * Quant[y * 8 + x];
+			};
+
+			Butterfly b		= Transform(In(0), In(1), In(2), In(3), In(4), In(5), In(6), In(7));
+			constexpr i64 Shift = ConstBits - Pass1Bits;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				Workspace[i * 8 + x]	   = (b.Even[i] + b.Odd[i] + (1 << (Shift - 1))) >> Shift;
+				Workspace[(7 - i) * 8 + x] = (b.Even[i] - b.Odd[i] + (1 << (Shift - 1))) >> Shift;
+			}
+		}
+
+		for (size_t y = 0; y < 8; ++y)
+		{
+			const i64* In	  = &Workspace[y * 8];
+			Butterfly  b	  = Transform(In[0], In[1], In[2], In[3], In[4], In[5], In[6], In[7]);
+			u8*		   Out	  = Output + y * Pitch;
+			constexpr i64 Shift = ConstBits + Pass1Bits + 3;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				Out[i]	   = static_cast<u8>(std::clamp<i64>(((b.Even[i] + b.Odd[i] + (1 << (Shift - 1))) >> Shift) + 128, 0, 255));
+				Out[7 - i] = static_cast<u8>(std::clamp<i64>(((b.Even[i] - b.Odd[i] + (1 << (Shift - 1))) >> Shift) + 128, 0, 255));
+			}
+		}
+	}
+
+	// A row of a component upsampled to the width of the image, the way libjpeg's default (fancy) upsampling does it:
+	// a triangle filter for 2x horizontal and 2x2 subsampling, replication otherwise
+	static void UpsampleRow(const JpegComponent& Component, u32 MaxSamplingX, u32 MaxSamplingY, u32 Width, u32 y, u8* Output)
+	{
+		const u32 FactorX = MaxSamplingX / Component.SamplingX;
+		const u32 FactorY = MaxSamplingY / Component.SamplingY;
+		const u32 Pitch	  = Component.BlocksX * 8;
+
+		if (FactorX == 1 && FactorY == 1)
+		{
+			std::memcpy(Output, &Component.Samples[size_t(y) * Pitch], Width);
+			return;
+		}
+
+		const u32 InWidth = Component.Width;
+		if (FactorX == 2 && FactorY == 1)
+		{
+			const u8* In = &Component.Samples[size_t(y) * Pitch];
+			for (u32 x = 0; x < InWidth; ++x)
+			{
+				const i32 Center = In[x] * 3;
+				const i32 Left	 = x > 0 ? In[x - 1] : -1;
+				const i32 Right	 = x + 1 < InWidth ? In[x + 1] : -1;
+				if (x * 2 < Width)
+				{
+					Output[x * 2] = static_cast<u8>(Left < 0 ? In[x] : (Center + Left + 1) >> 2);
+				}
+				if (x * 2 + 1 < Width)
+				{
+					Output[x * 2 + 1] = static_cast<u8>(Right < 0 ? In[x] : (Center + Right + 2) >> 2);
+				}
+			}
+			return;
+		}
+
+		if (FactorY == 2 && (FactorX == 1 || FactorX == 2))
+		{
+			// The nearer row weighs 3/4, the rows past the edges repeat the edge rows
+			const u32 Row	  = y / 2;
+			const u32 Other	  = y % 2 == 0 ? (Row > 0 ? Row - 1 : 0) : std::min(Row + 1, Component.Height - 1);
+			const u8* Near	  = &Component.Samples[size_t(Row) * Pitch];
+			const u8* Far	  = &Component.Samples[size_t(Other) * Pitch];
+			if (FactorX == 1)
+			{
+				const i32 Bias = y % 2 == 0 ? 1 : 2;
+				for (u32 x = 0; x < Width; ++x)
+				{
+					Output[x] = static_cast<u8>((Near[x] * 3 + Far[x] + Bias) >> 2);
+				}
+				return;
+			}
+
+			auto	  ColumnSum = [&](u32 x)
+			{
+				return Near[x] * 3 + Far[x];
+			};
+
+			for (u32 x = 0; x < InWidth; ++x)
+			{
+				const i32 This	= ColumnSum(x);
+				const i32 Left	= x > 0 ? ColumnSum(x - 1) : This;
+				const i32 Right = x + 1 < InWidth ? ColumnSum(x + 1) : This;
+				if (x * 2 < Width)
+				{
+					Output[x * 2] = static_cast<u8>((This * 3 + Left + 8) >> 4);
+				}
+				if (x * 2 + 1 < Width)
+				{
+					Output[x * 2 + 1] = static_cast<u8>((This * 3 + Right + 7) >> 4);
+				}
+			}
+			return;
+		}
+
+		const u8* In = &Component.Samples[size_t(y / FactorY) * Pitch];
+		for (u32 x = 0; x < Width; ++x)
+		{
+			Output[x] = In[x / FactorX];
+		}
+	}
+
+	static const char* DecodeJpeg(Span<const u8> Data, DecodedImage& Image)
+	{
+		std::array<std::array<u16, 64>, 4> QuantTables = {};
+		std::array<JpegHuffman, 4>		   DcTables;
+		std::array<JpegHuffman, 4>		   AcTables;
+		std::vector<JpegComponent>		   Components;
+		u32								   Width = 0, Height = 0;
+		u32								   MaxSamplingX = 1, MaxSamplingY = 1;
+		u32								   McusX = 0, McusY = 0;
+		u32								   RestartInterval = 0;
+		i32								   AdobeTransform  = -1; // Of an Adobe APP14 segment, 0 means RGB
+		bool							   Ended		   = false;
+
+		size_t Position = 2;
+		while (!Ended)
+		{
+			// Markers may be preceded by any number of fill bytes
+			while (Position < Data.size() && Data[Position] != 0xFF)
+			{
+				Position++;
+			}
+			while (Position < Data.size() && Data[Position] == 0xFF)
+			{
+				Position++;
+			}
+			if (Position >= Data.size())
+			{
+				break;
+			}
+
+			const u8 Marker = Data[Position++];
+			if (Marker == 0xD9)
+			{
+				break;
+			}
+			if (Marker == 0xD8 || (Marker >= 0xD0 && Marker <= 0xD7) || Marker == 0x01)
+			{
+				continue;
+			}
+			if (Position + 2 > Data.size())
+			{
+				return "a segment is truncated";
+			}
+			const u32 Length = ReadBigEndian16(&Data[Position]);
+			if (Length < 2 || Position + Length > Data.size())
+			{
+				return "a segment is truncated";
+			}
+			const u8* Segment = &Data[Position + 2];
+			const u8* End	  = &Data[Position + Length];
+			Position += Length;
+
+			switch (Marker)
+			{
+			case 0xC0: // Baseline
+			case 0xC1: // Extended sequential, Huffman
+			{
+				if (Length < 8 || Segment[0] != 8)
+				{
+					return "only 8 bit precision is supported";
+				}
+				Height = ReadBigEndian16(Segment + 1);
+				Width  = ReadBigEndian16(Segment + 3);
+
+				const u32 NumComponents = Segment[5];
+				if (NumComponents != 1 && NumComponents != 3)
+				{
+					return "only grayscale and 3 component images are supported";
+				}
+				if (!IsValidSize(Width, Height) || Length < 8 + NumComponents * 3)
+				{
+					return "invalid frame header";
+				}
+				Components.resize(NumComponents);
+				for (u32 i = 0; i < NumComponents; ++i)
+				{
+					JpegComponent& Component = Components[i];
+					Component.Id			 = Segment[6 + i * 3];
+					Component.SamplingX		 = Segment[7 + i * 3] >> 4;
+					Component.SamplingY		 = Segment[7 + i * 3] & 15;
+					Component.QuantTable	 = Segment[8 + i * 3];
+					if (Component.SamplingX < 1 || Component.SamplingX > 4 || Component.SamplingY < 1 || Component.SamplingY > 4 ||
+						Component.QuantTable > 3)
+					{
+						return "invalid frame header";
+					}
+					MaxSamplingX = std::max(MaxSamplingX, Component.SamplingX);
+					MaxSamplingY = std::max(MaxSamplingY, Component.SamplingY);
+				}
+
+				McusX = (Width + MaxSamplingX * 8 - 1) / (MaxSamplingX * 8);
+				McusY = (Height + MaxSamplingY * 8 - 1) / (MaxSamplingY * 8);
+				for (JpegComponent& Component : Components)
+				{
+					if (MaxSamplingX % Component.SamplingX != 0 || MaxSamplingY % Component.SamplingY != 0)
+					{
+						return "fractional subsampling is not supported";
+					}
+					Component.BlocksX = McusX * Component.SamplingX;
+					Component.BlocksY = McusY * Component.SamplingY;
+					Component.Width	  = (Width * Component.SamplingX + MaxSamplingX - 1) / MaxSamplingX;
+					Component.Height  = (Height * Component.SamplingY + MaxSamplingY - 1) / MaxSamplingY;
+					Component.Coefficients.assign(size_t(Component.BlocksX) * Component.BlocksY * 64, 0);
+				}
+				break;
+			}
+
+			case 0xC2:
+			case 0xC3:
+			case 0xC5:
+			case 0xC6:
+			case 0xC7:
+			case 0xC9:
+			case 0xCA:
+			case 0xCB:
+			case 0xCD:
+			case 0xCE:
+			case 0xCF:
+				return "progressive, lossless, hierarchical and arithmetic coded images are not supported";
+
+			case 0xC4: // Huffman tables
+				for (const u8* p = Segment; p + 17 <= End;)
+				{
+					const u32 Class = p[0] >> 4;
+					const u32 Index = p[0] & 15;
+					u32		  Total = 0;
+					for (u32 i = 0; i < 16; ++i)
+					{
+						Total += p[1 + i];
+					}
+					if (Class > 1 || Index > 3 || Total > 256 || p + 17 + Total > End ||
+						!(Class == 0 ? DcTables : AcTables)[Index].Build(p + 1, p + 17))
+					{
+						return "invalid Huffman table";
+					}
+					p += 17 + Total;
+				}
+				break;
+
+			case 0xDB: // Quantization tables
+				for (const u8* p = Segment; p < End;)
+				{
+					const u32 Precision = p[0] >> 4;
+					const u32 Index		= p[0] & 15;
+					if (Precision > 1 || Index > 3 || p + 1 + 64 * (Precision + 1) > End)
+					{
+						return "invalid quantization table";
+					}
+					for (u32 i = 0; i < 64; ++i)
+					{
+						QuantTables[Index][ZigZag[i]] = static_cast<u16>(Precision ? ReadBigEndian16(p + 1 + i * 2) : p[1 + i]);
+					}
+					p += 1 + 64 * (Precision + 1);
+				}
+				break;
+
+			case 0xDD: // Restart interval
+				if (Length < 4)
+				{
+					return "invalid restart interval";
+				}
+				RestartInterval = ReadBigEndian16(Segment);
+				break;
+
+			case 0xEE: // APP14, Adobe tells whether 3 components are YCbCr or RGB
+				if (Length >= 14 && std::memcmp(Segment, "Adobe", 5) == 0)
+				{
+					AdobeTransform = Segment[11];
+				}
+				break;
+
+			case 0xDA: // Start of scan, its entropy coded data follows the header
+			{
+				if (Components.empty())
+				{
+					return "a scan comes before the frame header";
+				}
+				const u32 NumScanComponents = Segment[0];
+				if (NumScanComponents < 1 || NumScanComponents > Components.size() || Length < 6 + NumScanComponents * 2)
+				{
+					return "invalid scan header";
+				}
+
+				std::vector<JpegComponent*> ScanComponents;
+				for (u32 i = 0; i < NumScanComponents; ++i)
+				{
+					auto Iterator = std::ranges::find(Components, u32(Segment[1 + i * 2]), &JpegComponent::Id);
+					if (Iterator == Components.end())
+					{
+						return "a scan references an unknown component";
+					}
+					Iterator->DcTable	   = Segment[2 + i * 2] >> 4;
+					Iterator->AcTable	   = Segment[2 + i * 2] & 15;
+					Iterator->DcPrediction = 0;
+					Iterator->Quant		   = QuantTables[Iterator->QuantTable];
+					if (Iterator->DcTable > 3 || Iterator->AcTable > 3)
+					{
+						return "invalid scan header";
+					}
+					ScanComponents.push_back(&*Iterator);
+				}
+
+				JpegBitReader Reader(Data, Position);
+				auto		  DecodeBlock = [&](JpegComponent& Component, u32 BlockX, u32 BlockY)
+				{
+					i16* Block = &Component.Coefficients[(size_t(BlockY) * Component.BlocksX + BlockX) * 64];
+
+					const i32 Category = Reader.Decode(DcTables[Component.DcTable]);
+					if (Category < 0 || Category > 11)
+					{
+						return false;
+					}
+					// Wraps like libjpeg's 16 bit coefficients, which keeps corrupt data from overflowing
+					Component.DcPrediction = static_cast<i16>(Component.DcPrediction + Reader.Receive(Category));
+					Block[0]			   = static_cast<i16>(Component.DcPrediction);
+
+					for (u32 k = 1; k < 64;)
+					{
+						const i32 RunSize = Reader.Decode(AcTables[Component.AcTable]);
+						if (RunSize < 0)
+						{
+							return false;
+						}
+						const u32 Run  = RunSize >> 4;
+						const u32 Size = RunSize & 15;
+						if (Size == 0)
+						{
+							if (Run != 15)
+							{
+								break; // End of block
+							}
+							k += 16;
+							continue;
+						}
+						k += Run;
+						if (k > 63)
+						{
+							return false;
+						}
+						Block[ZigZag[k++]] = static_cast<i16>(Reader.Receive(Size));
+					}
+					return true;
+				};
+
+				// A single component scan is not interleaved, its MCU is one block of the component's own size
+				const bool Interleaved = NumScanComponents > 1;
+				const u32  UnitsX	   = Interleaved ? McusX : (ScanComponents[0]->Width + 7) / 8;
+				const u32  UnitsY	   = Interleaved ? McusY : (ScanComponents[0]->Height + 7) / 8;
+				u32		   Unit		   = 0;
+				for (u32 UnitY = 0; UnitY < UnitsY; ++UnitY)
+				{
+					for (u32 UnitX = 0; UnitX < UnitsX; ++UnitX, ++Unit)
+					{
+						if (RestartInterval > 0 && Unit > 0 && Unit % RestartInterval == 0)
+						{
+							if (!Reader.Restart())
+							{
+								return "a restart marker is missing";
+							}
+							for (JpegComponent* Component : ScanComponents)
+							{
+								Component->DcPrediction = 0;
+							}
+						}
+
+						bool Ok = true;
+						if (!Interleaved)
+						{
+							Ok = DecodeBlock(*ScanComponents[0], UnitX, UnitY);
+						}
+						for (size_t c = 0; Interleaved && c < ScanComponents.size(); ++c)
+						{
+							JpegComponent& Component = *ScanComponents[c];
+							for (u32 y = 0; y < Component.SamplingY; ++y)
+							{
+								for (u32 x = 0; x < Component.SamplingX; ++x)
+								{
+									Ok &= DecodeBlock(Component, UnitX * Component.SamplingX + x, UnitY * Component.SamplingY + y);
+								}
+							}
+						}
+						if (!Ok)
+						{
+							return "the entropy coded data is corrupt";
+						}
+					}
+				}
+				Position = Reader.GetPosition();
+				break;
+			}
+
+			default: // APPn, comments and everything else that does not affect the pixels
+				break;
+			}
+		}
+		if (Components.empty())
+		{
+			return "there is no frame";
+		}
+
+		// Every block row of every component is transformed in parallel
+		std::vector<std::pair<JpegComponent*, u32>> BlockRows;
+		for (JpegComponent& Component : Components)
+		{
+			Component.Samples.resize(size_t(Component.BlocksX) * Component.BlocksY * 64);
+			for (u32 y = 0; y < Component.BlocksY; ++y)
+			{
+				BlockRows.emplace_back(&Component, y);
+			}
+		}
+		ParallelFor(
+			Process::GetThreadPool(),
+			BlockRows.size(),
+			[&](size_t i)
+			{
+				auto [Component, y] = BlockRows[i];
+				const size_t Pitch	= Component->BlocksX * 8;
+				for (u32 x = 0; x < Component->BlocksX; ++x)
+				{
+					InverseDct(
+						&Component->Coefficients[(size_t(y) * Component->BlocksX + x) * 64],
+						Component->Quant.data(),
+						&Component->Samples[size_t(y) * 8 * Pitch + x * 8],
+						Pitch);
+				}
+			});
+
+		// Adobe's transform flag, or component ids spelling RGB, mark images that are not YCbCr
+		const bool IsRgb = Components.size() == 3 &&
+						   (AdobeTransform == 0 || (Components[0].Id == 'R' && Components[1].Id == 'G' && Components[2].Id == 'B'));
+
+		Image.Width	  = Width;
+		Image.Height  = Height;
+		Image.IsFloat = false;
+		Image.Pixels.resize(size_t(Width) * Height * 4);
+		ForEachRow(
+			Height,
+			[&](size_t y)
+			{
+				std::vector<u8> Rows(size_t(Width) * Components.size());
+				for (size_t c = 0; c < Components.size(); ++c)
+				{
+					UpsampleRow(Components[c], MaxSamplingX, MaxSamplingY, Width, static_cast<u32>(y), &Rows[c * Width]);
+				}
+
+				u8* Destination = &Image.Pixels[y * Width * 4];
+				for (u32 x = 0; x < Width; ++x, Destination += 4)
+				{
+					if (Components.size() == 1)
+					{
+						Destination[0] = Destination[1] = Destination[2] = Rows[x];
+					}
+					else if (IsRgb)
+					{
+						Destination[0] = Rows[x];
+						Destination[1] = Rows[Width + x];
+						Destination[2] = Rows[Width * 2 + x];
+					}
+					else
+					{
+						// Fixed point YCbCr to RGB with the rounding of libjpeg's jdcolor.c
+						constexpr i32 Half = 1 << 15;
+						const i32	  Y	   = Rows[x];
+						const i32	  Cb   = Rows[Width + x] - 128;
+						const i32	  Cr   = Rows[Width * 2 + x] - 128;
+						Destination[0]	   = static_cast<u8>(std::clamp(Y + ((91881 * Cr + Half) >> 16), 0, 255));
+						Destination[1]	   = static_cast<u8>(std::clamp(Y + ((-22554 * Cb - 46802 * Cr + Half) >> 16), 0, 255));
+						Destination[2]	   = static_cast<u8>(std::clamp(Y + ((116130 * Cb + Half) >> 16), 0, 255));
+					}
+					Destination[3] = 255;
+				}
+			});
+		return nullptr;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+	// TGA
+
+	static const char* DecodeTga(Span<const u8> Data, DecodedImage& Image)
+	{
+		if (Data.size() < 18)
+		{
+			return "the header is truncated";
+		}
+		const u32 IdLength		 = Data[0];
+		const u32 ColorMapType	 = Data[1];
+		const u32 ImageType		 = Data[2];
+		const u32 ColorMapLength = ReadLittleEndian16(&Data[5]);
+		const u32 ColorMapDepth	 = Data[7];
+		const u32 Width			 = ReadLittleEndian16(&Data[12]);
+		const u32 Height		 = ReadLittleEndian16(&Data[14]);
+		const u32 Depth			 = Data[16];
+		const u32 Descriptor	 = Data[17];
+		const u32 AlphaBits		 = Descriptor & 15;
+
+		// 1 color mapped, 2 true color, 3 grayscale, + 8 for run length encoding
+		const u32 Type = ImageType & 7;
+		if ((ImageType & ~8u) < 1 || (ImageType & ~8u) > 3 || !IsValidSize(Width, Height))
+		{
+			return "unsupported image type";
+		}
+		if ((Type == 1 && (ColorMapType != 1 || Depth != 8)) || (Type == 2 && Depth != 15 && Depth != 16 && Depth != 24 && Depth != 32) ||
+			(Type == 3 && Depth != 8))
+		{
+			return "unsupported pixel depth";
+		}
+
+		// 15 and 16 bit colors are 5:5:5 BGR with an optional alpha bit, the others BGR(A) bytes
+		auto ToRgba = [&](const u8* Color, u32 ColorDepth, u8* Destination)
+		{
+			switch (ColorDepth)
+			{
+			case 8:
+				Destination[0] = Destination[1] = Destination[2] = Color[0];
+				Destination[3]									  = 255;
+				break;
+			case 15:
+			case 16:
+			{
+				const u32 Value = ReadLittleEndian16(Color);
+				auto	  Expand = [](u32 Channel)
+				{
+					return static_cast<u8>((Channel << 3) | (Channel >> 2));
+				};
+				Destination[0] = Expand((Value >> 10) & 31);
+				Destination[1] = Expand((Value >> 5) & 31);
+				Destination[2] = Expand(Value & 31);
+				Destination[3] = ColorDepth == 16 && AlphaBits > 0 && (Value & 0x8000) == 0 ? 0 : 255;
+				break;
+			}
+			case 24:
+			case 32:
+				Destination[0] = Color[2];
+				Destination[1] = Color[1];
+				Destination[2] = Color[0];
+				Destination[3] = ColorDepth == 32 ? Color[3] : 255;
+				break;
+			}
+		};
+
+		size_t Position = 18 + IdLength;
+
+		std::vector<std::array<u8, 4>> ColorMap;
+		if (ColorMapType == 1)
+		{
+			const u32 EntrySize = (ColorMapDepth + 7) / 8;
+			if ((ColorMapDepth != 15 && ColorMapDepth != 16 && ColorMapDepth != 24 && ColorMapDepth != 32) ||
+				Position + size_t(ColorMapLength) * EntrySize > Data.size())
+			{
+				return "invalid color map";
+			}
+			ColorMap.resize(ColorMapLength);
+			for (u32 i = 0; i < ColorMapLength; ++i)
+			{
+				ToRgba(&Data[Position + i * EntrySize], ColorMapDepth, ColorMap[i].data());
+			}
+			Position += size_t(ColorMapLength) * EntrySize;
+		}
+
+		// Run length packets may cross rows, so the pixels are expanded in order before they are converted
+		const size_t PixelSize = (Depth + 7) / 8;
+		const size_t Size	   = size_t(Width) * Height * PixelSize;
+		Span<const u8>	Pixels;
+		std::vector<u8> Expanded;
+		if (ImageType & 8)
+		{
+			Expanded.resize(Size);
+			for (size_t Offset = 0; Offset < Size;)
+			{
+				if (Position >= Data.size())
+				{
+					return "the pixels are truncated";
+				}
+				const u32	 Header = Data[Position++];
+				const size_t Count	= std::min<size_t>((Header & 0x7F) + 1, (Size - Offset) / PixelSize);
+				const size_t Bytes	= Header & 0x80 ? PixelSize : Count * PixelSize;
+				if (Position + Bytes > Data.size())
+				{
+					return "the pixels are truncated";
+				}
+				for (size_t i = 0; i < Count; ++i)
+				{
+					std::memcpy(&Expanded[Offset + i * PixelSize], &Data[Position + (Header & 0x80 ? 0 : i * PixelSize)], PixelSize);
+				}
+				Position += Bytes;
+				Offset += Count * PixelSize;
+			}
+			Pixels = Expanded;
+		}
+		else
+		{
+			if (Position + Size > Data.size())
+			{
+				return "the pixels are truncated";
+			}
+			Pixels = Span<const u8>(&Data[Position], Size);
+		}
+
+		Image.Width	  = Width;
+		Image.Height  = Height;
+		Image.IsFloat = false;
+		Image.Pixels.resize(size_t(Width) * Height * 4);
+
+		// Rows are stored bottom up unless bit 5 of the descriptor is set, bit 4 stores them right to left
+		const bool TopDown	  = (Descriptor & 0x20) != 0;
+		const bool RightToLeft = (Descriptor & 0x10) != 0;
+		std::atomic<bool> HasAlpha = false;
+		ForEachRow(
+			Height,
+			[&](size_t y)
+			{
+				const u8* Row		  = &Pixels[(TopDown ? y : Height - 1 - y) * Width * PixelSize];
+				u8*		  Destination = &Image.Pixels[y * Width * 4];
+				bool	  RowAlpha	  = false;
+				for (size_t x = 0; x < Width; ++x, Destination += 4)
+				{
+					const u8* Pixel = Row + (RightToLeft ? Width - 1 - x : x) * PixelSize;
+					if (Type == 1)
+					{
+						const std::array<u8, 4> Color = Pixel[0] < ColorMap.size() ? ColorMap[Pixel[0]] : std::array<u8, 4>{ 0, 0, 0, 255 };
+						std::memcpy(Destination, Color.data(), 4);
+					}
+					else
+					{
+						ToRgba(Pixel, Depth, Destination);
+					}
+					RowAlpha |= Destination[3] != 0;
+				}
+				if (RowAlpha)
+				{
+					HasAlpha = true;
+				}
+			});
+
+		// Many writers leave the alpha of 32 bit images at 0, DirectXTex reads those as opaque too
+		if (!HasAlpha)
+		{
+			ForEachRow(
+				Height,
+				[&](size_t y)
+				{
+					for (size_t x = 0; x < Width; ++x)
+					{
+						Image.Pixels[(y * Width + x) * 4 + 3] = 255;
+					}
+				});
+		}
+		return nullptr;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+	// Radiance HDR
+
+	static const char* DecodeHdr(Span<const u8> Data, DecodedImage& Image)
+	{
+		// Header lines up to an empty one, then the resolution line
+		size_t Position = 0;
+		auto   ReadLine = [&]
+		{
+			const size_t Begin = Position;
+			while (Position < Data.size() && Data[Position] != '\n')
+			{
+				Position++;
+			}
+			std::string_view Line(reinterpret_cast<const char*>(Data.data()) + Begin, Position - Begin);
+			Position = std::min(Position + 1, Data.size());
+			return Line;
+		};
+		for (std::string_view Line = ReadLine(); !Line.empty(); Line = ReadLine())
+		{
+			if (Line.starts_with("FORMAT=") && Line != "FORMAT=32-bit_rle_rgbe")
+			{
+				return "only the RGBE format is supported";
+			}
+			if (Position >= Data.size())
+			{
+				return "the header is truncated";
+			}
+		}
+
+		u32	   Width = 0, Height = 0;
+		char   Resolution[2][3] = {};
+		std::string Line(ReadLine());
+		if (std::sscanf(Line.c_str(), "%2s %u %2s %u", Resolution[0], &Height, Resolution[1], &Width) != 4 ||
+			std::string_view(Resolution[0]) != "-Y" || std::string_view(Resolution[1]) != "+X")
+		{
+			return "only the standard -Y +X orientation is supported";
+		}
+		if (!IsValidSize(Width, Height))
+		{
+			return "invalid resolution";
+		}
+
+		// Scanlines are variable length, they are expanded in order and converted in parallel
+		std::vector<u8> Rgbe(size_t(Width) * Height * 4);
+		for (u32 y = 0; y < Height; ++y)
+		{
+			u8* Row = &Rgbe[size_t(y) * Width * 4];
+			if (Width >= 8 && Width < 32768 && Position + 4 <= Data.size() && Data[Position] == 2 && Data[Position + 1] == 2 &&
+				(Data[Position + 2] & 0x80) == 0)
+			{
+				// Adaptive run length encoding, the four channels one after the other
+				if (ReadBigEndian16(&Data[Position + 2]) != Width)
+				{
+					return "a scanline has the wrong length";
+				}
+				Position += 4;
+				for (u32 Channel = 0; Channel < 4; ++Channel)
+				{
+					for (u32 x = 0; x < Width;)
+					{
+						if (Position >= Data.size())
+						{
+							return "the pixels are truncated";
+						}
+						u32 Count = Data[Position++];
+						if (Count > 128)
+						{
+							Count -= 128;
+							if (x + Count > Width || Position >= Data.size())
+							{
+								return "a run is too long";
+							}
+							for (u32 i = 0; i < Count; ++i)
+							{
+								Row[(x + i) * 4 + Channel] = Data[Position];
+							}
+							Position++;
+						}
+						else
+						{
+							if (Count == 0 || x + Count > Width || Position + Count > Data.size())
+							{
+								return "a run is too long";
+							}
+							for (u32 i = 0; i < Count; ++i)
+							{
+								Row[(x + i) * 4 + Channel] = Data[Position + i];
+							}
+							Position += Count;
+						}
+						x += Count;
+					}
+				}
+				continue;
+			}
+
+			// Flat pixels, (1, 1, 1, n) repeats the previous one n times (shifted by 8 bits for every consecutive run)
+			u32 Shift = 0;
+			for (u32 x = 0; x < Width;)
+			{
+				if (Position + 4 > Data.size())
+				{
+					return "the pixels are truncated";
+				}
+				const u8* Pixel = &Data[Position];
+				Position += 4;
+				if (Pixel[0] == 1 && Pixel[1] == 1 && Pixel[2] == 1)
+				{
+					const size_t Count = size_t(Pixel[3]) << Shift;
+					if (x == 0 || x + Count > Width)
+					{
+						return "a run is too long";
+					}
+					for (size_t i = 0; i < Count; ++i, ++x)
+					{
+						std::memcpy(&Row[x * 4], &Row[(x - 1) * 4], 4);
+					}
+					Shift += 8;
+				}
+				else
+				{
+					std::memcpy(&Row[x * 4], Pixel, 4);
+					Shift = 0;
+					x++;
+				}
+			}
+		}
+
+		Image.Width	  = Width;
+		Image.Height  = Height;
+		Image.IsFloat = true;
+		Image.Pixels.resize(size_t(Width) * Height * 16);
+		ForEachRow(
+			Height,
+			[&](size_t y)
+			{
+				const u8* Source	  = &Rgbe[y * Width * 4];
+				f32*	  Destination = reinterpret_cast<f32*>(&Image.Pixels[y * Width * 16]);
+				for (size_t x = 0; x < Width; ++x, Source += 4, Destination += 4)
+				{
+					// Mantissas are the lower ends of their intervals, the centers are the values Radiance means
+					const f32 Scale = Source[3] != 0 ? std::ldexp(1.0f, static_cast<i32>(Source[3]) - (128 + 8)) : 0.0f;
+					Destination[0]	= Source[3] != 0 ? (Source[0] + 0.5f) * Scale : 0.0f;
+					Destination[1]	= Source[3] != 0 ? (Source[1] + 0.5f) * Scale : 0.0f;
+					Destination[2]	= Source[3] != 0 ? (Source[2] + 0.5f) * Scale : 0.0f;
+					Destination[3]	= 1.0f;
+				}
+			});
+		return nullptr;
+	}
+
+	// ---------------------------------------------------------------------------------------------------------------------
+
+	bool ImageDecoder::SupportsExtension(const std::filesystem::path& Path)
+	{
+		std::string Extension = Path.extension().string();
+		std::ranges::transform(
+			Extension,
+			Extension.begin(),
+			[](char c)
+			{
+				return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+			});
+		return Extension == ".png" || Extension == ".jpg" || Extension == ".jpeg" || Extension == ".tga" || Extension == ".hdr";
+	}
+
+	bool ImageDecoder::Decode(const std::filesystem::path& Path, DecodedImage& Image, std::string* Error /*= nullptr*/)
+	{
+		std::ifstream Stream(Path, std::ios::binary);
+		if (!Stream)
+		{
+			if (Error)
+			{
+				*Error = "the file could not be opened";
+			}
+			return false;
+		}
+		std::vector<u8> Data(std::filesystem::file_size(Path));
+		if (!Stream.read(reinterpret_cast<char*>(Data.data()), static_cast<std::streamsize>(Data.size())))
+		{
+			if (Error)
+			{
+				*Error = "the file could not be read";
+			}
+			return false;
+		}
+		return Decode(Data, Image, Error);
+	}
+
+	bool ImageDecoder::Decode(Span<const u8> Data, DecodedImage& Image, std::string* Error /*= nullptr*/)
+	{
+		static constexpr u8 PngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+		const char* Result = nullptr;
+		if (Data.size() >= 8 && std::memcmp(Data.data(), PngSignature, 8) == 0)
+		{
+			Result = DecodePng(Data, Image);
+		}
+		else if (Data.size() >= 3 && Data[0] == 0xFF && Data[1] == 0xD8 && Data[2] == 0xFF)
+		{
+			Result = DecodeJpeg(Data, Image);
+		}
+		else if (Data.size() >= 2 && Data[0] == '#' && Data[1] == '?')
+		{
+			Result = DecodeHdr(Data, Image);
+		}
+		else
+		{
+			Result = DecodeTga(Data, Image);
+		}
+
+		if (Result)
+		{
+			Image = {};
+			if (Error)
+			{
+				*Error = Result;
+			}
+			return false;
+		}
+		return true;
+	}
+} // namespace Asset
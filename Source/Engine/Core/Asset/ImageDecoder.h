@@ -0,0 +1,37 @@
+#pragma once
+#include "System/System.h"
+
+namespace Asset
+{
+	// Pixels of a decoded image, rows top to bottom and tightly packed. RGBA8 for PNG, JPEG and TGA, RGBA32F for HDR
+	struct DecodedImage
+	{
+		u32				Width	= 0;
+		u32				Height	= 0;
+		bool			IsFloat = false;
+		std::vector<u8> Pixels;
+
+		[[nodiscard]] size_t GetPixelSize() const noexcept { return IsFloat ? 16 : 4; }
+		[[nodiscard]] size_t GetRowPitch() const noexcept { return Width * GetPixelSize(); }
+	};
+
+	// Decodes PNG, baseline JPEG, TGA and Radiance HDR files without WIC or DirectXTex, so textures can be cooked on any
+	// platform. Entropy decoding is serial (inflate and unfiltering, Huffman, RLE), everything after it (conversion to
+	// RGBA, IDCT, upsampling and color conversion) runs in parallel over blocks of rows.
+	//	PNG		Every color type and bit depth, interlaced or not. 16 bit channels are rounded to 8 bits
+	//	JPEG	Baseline and extended Huffman, 8 bit, grayscale, YCbCr or RGB with integer subsampling. Not progressive or CMYK
+	//	TGA		Color mapped, true color and grayscale, uncompressed or RLE
+	//	HDR		RGBE with flat or RLE scanlines in the standard -Y +X orientation
+	class ImageDecoder
+	{
+	public:
+		[[nodiscard]] static bool SupportsExtension(const std::filesystem::path& Path);
+
+		// Returns false if the file could not be read, is malformed or uses something that is not supported, Error says
+		// which. Uses ParallelFor, so it must not be called from a thread pool thread
+		static bool Decode(const std::filesystem::path& Path, DecodedImage& Image, std::string* Error = nullptr);
+
+		// Decodes the contents of a file, the format is told by its signature (TGA has none, it is the fallback)
+		static bool Decode(Span<const u8> Data, DecodedImage& Image, std::string* Error = nullptr);
+	};
+} // namespace Asset
@@ -0,0 +1,118 @@
+#include "ImportReport.h"
+#include "AssetImporter.h"
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+namespace Asset
+{
+	static f64 ToMilliseconds(i64 Ticks)
+	{
+		return static_cast<f64>(Ticks) * 1000.0 / static_cast<f64>(Stopwatch::Frequency);
+	}
+
+	static f64 GetMegabytesPerSecond(u64 SizeInBytes, i64 Ticks)
+	{
+		return static_cast<f64>(SizeInBytes) / 1e6 * static_cast<f64>(Stopwatch::Frequency) / static_cast<f64>(std::max<i64>(Ticks, 1));
+	}
+
+	void ImportReport::AddStage(std::string_view Name, i64 Ticks, u64 SizeInBytes /*= 0*/, bool Parallel /*= false*/)
+	{
+		auto Iterator = std::ranges::find(Stages, Name, &Stage::Name);
+		if (Iterator == Stages.end())
+		{
+			Iterator = Stages.insert(Stages.end(), Stage{ .Name = std::string(Name), .Parallel = Parallel });
+		}
+		Iterator->Ticks += Ticks;
+		Iterator->SizeInBytes += SizeInBytes;
+	}
+
+	void ImportReport::SetCounter(std::string_view Name, u64 Value)
+	{
+		auto Iterator = std::ranges::find(Counters, Name, &std::pair<std::string, u64>::first);
+		if (Iterator == Counters.end())
+		{
+			Counters.emplace_back(Name, Value);
+		}
+		else
+		{
+			Iterator->second = Value;
+		}
+	}
+
+	void ImportReport::Log() const
+	{
+		// Parallel stages overlap the stage that runs them, the others follow each other
+		i64 Ticks = 0;
+		for (const Stage& Stage : Stages)
+		{
+			Ticks += Stage.Parallel ? 0 : Stage.Ticks;
+		}
+
+		std::string Summary;
+		for (const auto& [Name, Value] : Counters)
+		{
+			Summary += std::format("{}{} {}", Summary.empty() ? "" : ", ", Value, Name);
+		}
+		KAGUYA_LOG(Asset, Info, "{} {} in {:.2f}ms ({})", Cooked ? "Imported" : "Mapped", Source.filename().string(), ToMilliseconds(Ticks), Summary);
+
+		for (const Stage& Stage : Stages)
+		{
+			if (Stage.SizeInBytes > 0)
+			{
+				KAGUYA_LOG(
+					Asset,
+					Info,
+					"  {}: {:.2f}ms{}, {:.2f} MiB at {:.0f} MB/s",
+					Stage.Name,
+					ToMilliseconds(Stage.Ticks),
+					Stage.Parallel ? " across threads" : "",
+					static_cast<f64>(Stage.SizeInBytes) / (1024.0 * 1024.0),
+					GetMegabytesPerSecond(Stage.SizeInBytes, Stage.Ticks));
+			}
+			else
+			{
+				KAGUYA_LOG(Asset, Info, "  {}: {:.2f}ms{}", Stage.Name, ToMilliseconds(Stage.Ticks), Stage.Parallel ? " across threads" : "");
+			}
+		}
+	}
+
+	void ImportReport::Append(const std::filesystem::path& Path) const
+	{
+		nlohmann::ordered_json Json;
+		Json["Source"] = Source.string();
+		Json["Cooked"] = Cooked;
+		Json["Time"]   = std::format("{:%FT%TZ}", std::chrono::floor<std::chrono::seconds>(Created));
+
+		i64 Ticks = 0;
+		for (const Stage& Stage : Stages)
+		{
+			Ticks += Stage.Parallel ? 0 : Stage.Ticks;
+
+			nlohmann::ordered_json JsonStage;
+			JsonStage["Name"]				= Stage.Name;
+			JsonStage["Milliseconds"]		= ToMilliseconds(Stage.Ticks);
+			JsonStage["SizeInBytes"]		= Stage.SizeInBytes;
+			JsonStage["MegabytesPerSecond"] = Stage.SizeInBytes > 0 ? GetMegabytesPerSecond(Stage.SizeInBytes, Stage.Ticks) : 0.0;
+			JsonStage["Parallel"]			= Stage.Parallel;
+			Json["Stages"].push_back(std::move(JsonStage));
+		}
+		Json["Milliseconds"] = ToMilliseconds(Ticks);
+
+		for (const auto& [Name, Value] : Counters)
+		{
+			Json["Counters"][Name] = Value;
+		}
+
+		// Loader threads finish imports concurrently
+		static std::mutex Mutex;
+		std::scoped_lock  Lock(Mutex);
+		std::ofstream	  Stream(Path, std::ios::app);
+		if (!Stream)
+		{
+			KAGUYA_LOG(Asset, Warn, "Could not write the import report to {}", Path.string());
+			return;
+		}
+		Stream << Json.dump() << '\n';
+	}
+} // namespace Asset
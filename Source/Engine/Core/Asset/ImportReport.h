@@ -0,0 +1,79 @@
+#pragma once
+#include "System/System.h"
+#include <chrono>
+
+namespace Asset
+{
+	// Where the time of one import went: the stages that ran, how long they took and how many bytes they went through.
+	// Logged through the Asset category and appended as a line of JSON to a report file, so import throughput can be
+	// tracked over time
+	class ImportReport
+	{
+	public:
+		static constexpr std::string_view FileName = "ImportReport.jsonl";
+
+		struct Stage
+		{
+			std::string Name;
+			i64			Ticks		= 0; // Stopwatch ticks
+			u64			SizeInBytes = 0; // Read or written by the stage, 0 if it has no meaningful size
+
+			// Accumulated over threads running the stage concurrently, part of the wall time of an enclosing stage
+			bool Parallel = false;
+		};
+
+		// Adds the lifetime of the scope it lives in to a stage of the report, if there is one
+		class ScopedStage
+		{
+		public:
+			ScopedStage(ImportReport* Report, std::string_view Name, u64 SizeInBytes = 0)
+				: Report(Report)
+				, Name(Name)
+				, SizeInBytes(SizeInBytes)
+				, Start(Stopwatch::GetTimestamp())
+			{
+			}
+			~ScopedStage()
+			{
+				if (Report)
+				{
+					Report->AddStage(Name, Stopwatch::GetTimestamp() - Start, SizeInBytes);
+				}
+			}
+
+			ScopedStage(const ScopedStage&)			   = delete;
+			ScopedStage& operator=(const ScopedStage&) = delete;
+
+			// For stages whose size is only known at their end
+			void SetSizeInBytes(u64 SizeInBytes) noexcept { this->SizeInBytes = SizeInBytes; }
+
+		private:
+			ImportReport*	 Report;
+			std::string_view Name;
+			u64				 SizeInBytes;
+			i64				 Start;
+		};
+
+		// Adds to the stage called Name, stages are reported in the order they were first added
+		void AddStage(std::string_view Name, i64 Ticks, u64 SizeInBytes = 0, bool Parallel = false);
+
+		// Counts of what was imported, e.g. meshes or triangles
+		void SetCounter(std::string_view Name, u64 Value);
+
+		[[nodiscard]] const std::vector<Stage>& GetStages() const noexcept { return Stages; }
+
+		// One line for the import and one for every stage
+		void Log() const;
+
+		// Appends the report as a single line of JSON, reports of concurrent imports do not interleave
+		void Append(const std::filesystem::path& Path) const;
+
+		std::filesystem::path Source;
+		bool				  Cooked = false; // The source was imported, rather than a cooked file mapped
+
+	private:
+		std::vector<Stage>						 Stages;
+		std::vector<std::pair<std::string, u64>> Counters;
+		std::chrono::system_clock::time_point	 Created = std::chrono::system_clock::now();
+	};
+} // namespace Asset
@@ -0,0 +1,250 @@
+#include "IndexCodec.h"
+
+namespace Asset
+{
+	// Code byte: high nibble is the edge FIFO slot that matched the triangle's first edge, EdgeMiss if none matched.
+	// A vertex nibble is VertexNext, a vertex FIFO slot in [1, VertexExplicit) or VertexExplicit.
+	// Edge hits code the third vertex in the low nibble, misses code the first vertex in the low nibble and
+	// the other two in an extra code byte
+	static constexpr u32 EdgeFifoSize	= 15;
+	static constexpr u32 EdgeMiss		= 15;
+	static constexpr u32 VertexFifoSize = 14;
+	static constexpr u32 VertexNext		= 0;
+	static constexpr u32 VertexExplicit = 15;
+
+	struct IndexCodecState
+	{
+		u32 Edges[EdgeFifoSize][2] = {};
+		u32 Vertices[VertexFifoSize] = {};
+		u32 EdgeOffset				 = 0;
+		u32 VertexOffset			 = 0;
+		u32 Next					 = 0;
+		u32 Last					 = 0;
+
+		void PushEdge(u32 a, u32 b)
+		{
+			Edges[EdgeOffset][0] = a;
+			Edges[EdgeOffset][1] = b;
+			EdgeOffset			 = (EdgeOffset + 1) % EdgeFifoSize;
+		}
+
+		void PushVertex(u32 v)
+		{
+			Vertices[VertexOffset] = v;
+			VertexOffset		   = (VertexOffset + 1) % VertexFifoSize;
+		}
+
+		// Slots are numbered from the most recent entry
+		u32 GetEdge(u32 Slot, u32 i) const { return Edges[(EdgeOffset + EdgeFifoSize - 1 - Slot) % EdgeFifoSize][i]; }
+		u32 GetVertex(u32 Slot) const { return Vertices[(VertexOffset + VertexFifoSize - 1 - Slot) % VertexFifoSize]; }
+	};
+
+	static void WriteVarint(std::vector<u8>& Data, u32 Value)
+	{
+		do
+		{
+			Data.push_back(static_cast<u8>((Value & 0x7f) | (Value > 0x7f ? 0x80 : 0)));
+			Value >>= 7;
+		} while (Value);
+	}
+
+	static u32 ZigZag(u32 Delta)
+	{
+		return (Delta << 1) ^ static_cast<u32>(static_cast<i32>(Delta) >> 31);
+	}
+
+	static u32 UnZigZag(u32 Value)
+	{
+		return (Value >> 1) ^ (0u - (Value & 1));
+	}
+
+	static u32 EncodeVertex(IndexCodecState& State, std::vector<u8>& Data, u32 v)
+	{
+		if (v == State.Next)
+		{
+			State.Next++;
+			State.PushVertex(v);
+			return VertexNext;
+		}
+		for (u32 Slot = 0; Slot < VertexFifoSize; ++Slot)
+		{
+			if (State.GetVertex(Slot) == v)
+			{
+				return 1 + Slot;
+			}
+		}
+
+		WriteVarint(Data, ZigZag(v - State.Last));
+		State.Last = v;
+		State.Next = std::max(State.Next, v + 1);
+		State.PushVertex(v);
+		return VertexExplicit;
+	}
+
+	void IndexCodec::Encode(Span<const u32> Indices, std::vector<u8>& Encoded)
+	{
+		const size_t NumTriangles = Indices.size() / 3;
+
+		IndexCodecState State;
+		std::vector<u8> Codes;
+		std::vector<u8> Data;
+		Codes.reserve(NumTriangles);
+		Data.reserve(NumTriangles);
+
+		for (size_t t = 0; t < NumTriangles; ++t)
+		{
+			const u32 Triangle[3] = { Indices[t * 3 + 0], Indices[t * 3 + 1], Indices[t * 3 + 2] };
+
+			// Adjacent triangles share an edge with opposite winding, so reversed edges are kept in the FIFO
+			u32 EdgeSlot = EdgeMiss, Rotation = 0;
+			for (u32 Slot = 0; Slot < EdgeFifoSize && EdgeSlot == EdgeMiss; ++Slot)
+			{
+				for (u32 r = 0; r < 3; ++r)
+				{
+					if (State.GetEdge(Slot, 0) == Triangle[r] && State.GetEdge(Slot, 1) == Triangle[(r + 1) % 3])
+					{
+						EdgeSlot = Slot;
+						Rotation = r;
+						break;
+					}
+				}
+			}
+
+			const u32 a = Triangle[Rotation], b = Triangle[(Rotation + 1) % 3], c = Triangle[(Rotation + 2) % 3];
+			if (EdgeSlot != EdgeMiss)
+			{
+				Codes.push_back(static_cast<u8>((EdgeSlot << 4) | EncodeVertex(State, Data, c)));
+				State.PushEdge(c, b);
+				State.PushEdge(a, c);
+			}
+			else
+			{
+				u32 CodeA = EncodeVertex(State, Data, a);
+				u32 CodeB = EncodeVertex(State, Data, b);
+				u32 CodeC = EncodeVertex(State, Data, c);
+				Codes.push_back(static_cast<u8>((EdgeMiss << 4) | CodeA));
+				Codes.push_back(static_cast<u8>((CodeB << 4) | CodeC));
+				State.PushEdge(b, a);
+				State.PushEdge(c, b);
+				State.PushEdge(a, c);
+			}
+		}
+
+		// [u32 NumTriangles][u32 CodeSize][Codes][Data]
+		const u32 Header[2] = { static_cast<u32>(NumTriangles), static_cast<u32>(Codes.size()) };
+		Encoded.resize(sizeof(Header));
+		memcpy(Encoded.data(), Header, sizeof(Header));
+		Encoded.insert(Encoded.end(), Codes.begin(), Codes.end());
+		Encoded.insert(Encoded.end(), Data.begin(), Data.end());
+	}
+
+	size_t IndexCodec::GetNumIndices(Span<const u8> Encoded)
+	{
+		u32 NumTriangles = 0;
+		if (Encoded.size() >= sizeof(u32))
+		{
+			memcpy(&NumTriangles, Encoded.data(), sizeof(u32));
+		}
+		return static_cast<size_t>(NumTriangles) * 3;
+	}
+
+	bool IndexCodec::Decode(Span<const u8> Encoded, u32* Indices, size_t NumIndices)
+	{
+		u32 Header[2];
+		if (Encoded.size() < sizeof(Header))
+		{
+			return false;
+		}
+		memcpy(Header, Encoded.data(), sizeof(Header));
+
+		const size_t NumTriangles = Header[0];
+		if (NumTriangles * 3 != NumIndices || Header[1] > Encoded.size() - sizeof(Header))
+		{
+			return false;
+		}
+
+		const u8* Code	  = Encoded.data() + sizeof(Header);
+		const u8* CodeEnd = Code + Header[1];
+		const u8* Data	  = CodeEnd;
+		const u8* DataEnd = Encoded.data() + Encoded.size();
+
+		IndexCodecState State;
+		bool			Valid = true;
+
+		auto DecodeVertex = [&](u32 VertexCode) -> u32
+		{
+			if (VertexCode == VertexNext)
+			{
+				u32 v = State.Next++;
+				State.PushVertex(v);
+				return v;
+			}
+			if (VertexCode != VertexExplicit)
+			{
+				return State.GetVertex(VertexCode - 1);
+			}
+
+			u32 Value = 0;
+			for (u32 Shift = 0; Shift < 35; Shift += 7)
+			{
+				if (Data == DataEnd)
+				{
+					Valid = false;
+					return 0;
+				}
+				u8 Byte = *Data++;
+				Value |= static_cast<u32>(Byte & 0x7f) << Shift;
+				if (!(Byte & 0x80))
+				{
+					break;
+				}
+			}
+
+			u32 v	   = State.Last + UnZigZag(Value);
+			State.Last = v;
+			State.Next = std::max(State.Next, v + 1);
+			State.PushVertex(v);
+			return v;
+		};
+
+		for (size_t t = 0; t < NumTriangles && Valid; ++t)
+		{
+			if (Code == CodeEnd)
+			{
+				return false;
+			}
+
+			u8	Byte	 = *Code++;
+			u32 EdgeSlot = Byte >> 4;
+			u32 a, b, c;
+			if (EdgeSlot != EdgeMiss)
+			{
+				a = State.GetEdge(EdgeSlot, 0);
+				b = State.GetEdge(EdgeSlot, 1);
+				c = DecodeVertex(Byte & 0xf);
+				State.PushEdge(c, b);
+				State.PushEdge(a, c);
+			}
+			else
+			{
+				if (Code == CodeEnd)
+				{
+					return false;
+				}
+
+				u8 Extra = *Code++;
+				a		 = DecodeVertex(Byte & 0xf);
+				b		 = DecodeVertex(Extra >> 4);
+				c		 = DecodeVertex(Extra & 0xf);
+				State.PushEdge(b, a);
+				State.PushEdge(c, b);
+				State.PushEdge(a, c);
+			}
+
+			Indices[t * 3 + 0] = a;
+			Indices[t * 3 + 1] = b;
+			Indices[t * 3 + 2] = c;
+		}
+		return Valid && Code == CodeEnd && Data == DataEnd;
+	}
+} // namespace Asset
@@ -0,0 +1,22 @@
+#pragma once
+#include "System/System.h"
+
+namespace Asset
+{
+	// Lossless triangle list compression in the style of meshoptimizer's index codec.
+	//
+	// Every triangle is coded relative to a FIFO of recently seen edges and a FIFO of recently seen vertices,
+	// a vertex is either the next unseen one, a FIFO hit or an explicit zigzag varint delta. Codes and varints are
+	// written to separate sections so both stay byte aligned and compress well with a general purpose compressor.
+	// Triangles may be rotated, winding is preserved.
+	class IndexCodec
+	{
+	public:
+		static void Encode(Span<const u32> Indices, std::vector<u8>& Encoded);
+
+		[[nodiscard]] static size_t GetNumIndices(Span<const u8> Encoded);
+
+		// Returns false if Encoded is malformed or does not hold exactly NumIndices indices
+		[[nodiscard]] static bool Decode(Span<const u8> Encoded, u32* Indices, size_t NumIndices);
+	};
+} // namespace Asset
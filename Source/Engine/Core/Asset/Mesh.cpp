@@ -1,28 +1,32 @@
 #include "Mesh.h"
+#include "Core/World/Components.h"
 
 namespace Asset
 {
 	void Mesh::ComputeBoundingBox()
 	{
 		DirectX::BoundingBox Box;
-		DirectX::BoundingBox::CreateFromPoints(Box, Vertices.size(), &Vertices[0].Position, sizeof(Vertex));
+		Span<const Vertex>	 Points = GetVertices();
+		DirectX::BoundingBox::CreateFromPoints(Box, Points.size(), &Points[0].Position, sizeof(Vertex));
 		BoundingBox.Center	= Math::Vec3f(Box.Center.x, Box.Center.y, Box.Center.z);
 		BoundingBox.Extents = Math::Vec3f(Box.Extents.x, Box.Extents.y, Box.Extents.z);
 	}
 
 	void Mesh::UpdateInfo()
 	{
-		assert(Vertices.size() <= size_t(std::numeric_limits<u32>::max()));
-		assert(Indices.size() <= size_t(std::numeric_limits<u32>::max()));
-		assert(Meshlets.size() <= size_t(std::numeric_limits<u32>::max()));
-		assert(UniqueVertexIndices.size() <= size_t(std::numeric_limits<u32>::max()));
-		assert(PrimitiveIndices.size() <= size_t(std::numeric_limits<u32>::max()));
+		assert(GetVertices().size() <= size_t(std::numeric_limits<u32>::max()));
+		assert(GetIndices().size() <= size_t(std::numeric_limits<u32>::max()));
+		assert(GetMeshlets().size() <= size_t(std::numeric_limits<u32>::max()));
+		assert(GetUniqueVertexIndices().size() <= size_t(std::numeric_limits<u32>::max()));
+		assert(GetPrimitiveIndices().size() <= size_t(std::numeric_limits<u32>::max()));
 
-		NumVertices		 = static_cast<u32>(Vertices.size());
-		NumIndices		 = static_cast<u32>(Indices.size());
-		NumMeshlets		 = static_cast<u32>(Meshlets.size());
-		NumVertexIndices = static_cast<u32>(UniqueVertexIndices.size());
-		NumPrimitives	 = static_cast<u32>(PrimitiveIndices.size());
+		NumVertices		 = static_cast<u32>(GetVertices().size());
+		NumIndices		 = static_cast<u32>(GetIndices().size());
+		NumMeshlets		 = static_cast<u32>(GetMeshlets().size());
+		NumVertexIndices = static_cast<u32>(GetUniqueVertexIndices().size());
+		NumPrimitives	 = static_cast<u32>(GetPrimitiveIndices().size());
+
+		IndexFormat = NumVertices <= std::numeric_limits<u16>::max() + 1u ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 	}
 
 	void Mesh::Release()
@@ -32,6 +36,56 @@ namespace Asset
 		decltype(Meshlets)().swap(Meshlets);
 		decltype(UniqueVertexIndices)().swap(UniqueVertexIndices);
 		decltype(PrimitiveIndices)().swap(PrimitiveIndices);
+		decltype(LodIndices)().swap(LodIndices);
+		decltype(CompressedVertices)().swap(CompressedVertices);
+		decltype(CompressedIndices)().swap(CompressedIndices);
+
+		MappedVertices			  = {};
+		MappedIndices			  = {};
+		MappedMeshlets			  = {};
+		MappedUniqueVertexIndices = {};
+		MappedPrimitiveIndices	  = {};
+		MappedLodIndices		  = {};
+		MappedFile.reset();
+	}
+
+	void Mesh::ReleaseResources(Mesh& Released)
+	{
+		Released.VertexResource			   = std::exchange(VertexResource, {});
+		Released.IndexResource			   = std::exchange(IndexResource, {});
+		Released.MeshletResource		   = std::exchange(MeshletResource, {});
+		Released.UniqueVertexIndexResource = std::exchange(UniqueVertexIndexResource, {});
+		Released.PrimitiveIndexResource	   = std::exchange(PrimitiveIndexResource, {});
+		Blas							   = {};
+		VertexView						   = {};
+		IndexView						   = {};
+	}
+
+	u64 Mesh::HashContent() const
+	{
+		u64	 ContentHash = Hash::Hash64(&IndexFormat, sizeof(IndexFormat));
+		auto HashStream	 = [&](auto Stream)
+		{
+			ContentHash = Hash::Combine(ContentHash, Stream.size());
+			ContentHash = Hash::Combine(ContentHash, Hash::Hash64(Stream.data(), Stream.size() * sizeof(Stream[0])));
+		};
+		HashStream(GetVertices());
+		HashStream(GetIndices());
+		HashStream(GetMeshlets());
+		HashStream(GetUniqueVertexIndices());
+		HashStream(GetPrimitiveIndices());
+		HashStream(GetLodIndices());
+		return ContentHash;
+	}
+
+	u64 Mesh::GetSizeInBytes() const noexcept
+	{
+		const u64 IndexSize = IndexFormat == DXGI_FORMAT_R16_UINT ? sizeof(u16) : sizeof(u32);
+		return GetVertices().size() * sizeof(Vertex) +
+			   (GetIndices().size() + GetLodIndices().size()) * IndexSize +
+			   GetMeshlets().size() * sizeof(DirectX::Meshlet) +
+			   GetUniqueVertexIndices().size() * sizeof(u8) +
+			   GetPrimitiveIndices().size() * sizeof(DirectX::MeshletTriangle);
 	}
 
 	void Mesh::SetVertices(std::vector<Vertex>&& Vertices)
@@ -64,4 +118,85 @@ namespace Asset
 		NumPrimitives		   = static_cast<u32>(this->PrimitiveIndices.size());
 	}
 
+	void Mesh::SetMeshletCullData(std::vector<DirectX::CullData>&& MeshletCullData)
+	{
+		this->MeshletCullData = std::move(MeshletCullData);
+	}
+
+	void Mesh::SetLods(std::vector<MeshLod>&& Lods, std::vector<u32>&& LodIndices)
+	{
+		this->Lods		 = std::move(Lods);
+		this->LodIndices = std::move(LodIndices);
+	}
+
+	void Mesh::SetMappedStreams(
+		std::shared_ptr<MemoryMappedFile>	 MappedFile,
+		Span<const Vertex>					 Vertices,
+		Span<const u32>						 Indices,
+		Span<const DirectX::Meshlet>		 Meshlets,
+		Span<const u8>						 UniqueVertexIndices,
+		Span<const DirectX::MeshletTriangle> PrimitiveIndices,
+		Span<const u32>						 LodIndices)
+	{
+		this->MappedFile		  = std::move(MappedFile);
+		MappedVertices			  = Vertices;
+		MappedIndices			  = Indices;
+		MappedMeshlets			  = Meshlets;
+		MappedUniqueVertexIndices = UniqueVertexIndices;
+		MappedPrimitiveIndices	  = PrimitiveIndices;
+		MappedLodIndices		  = LodIndices;
+		UpdateInfo();
+	}
+
+	Span<const Vertex> Mesh::GetVertices() const noexcept
+	{
+		return MappedFile ? MappedVertices : Span<const Vertex>(Vertices);
+	}
+
+	Span<const u32> Mesh::GetIndices() const noexcept
+	{
+		return MappedFile ? MappedIndices : Span<const u32>(Indices);
+	}
+
+	Span<const DirectX::Meshlet> Mesh::GetMeshlets() const noexcept
+	{
+		return MappedFile ? MappedMeshlets : Span<const DirectX::Meshlet>(Meshlets);
+	}
+
+	Span<const u8> Mesh::GetUniqueVertexIndices() const noexcept
+	{
+		return MappedFile ? MappedUniqueVertexIndices : Span<const u8>(UniqueVertexIndices);
+	}
+
+	Span<const DirectX::MeshletTriangle> Mesh::GetPrimitiveIndices() const noexcept
+	{
+		return MappedFile ? MappedPrimitiveIndices : Span<const DirectX::MeshletTriangle>(PrimitiveIndices);
+	}
+
+	Span<const u32> Mesh::GetLodIndices() const noexcept
+	{
+		return MappedFile ? MappedLodIndices : Span<const u32>(LodIndices);
+	}
+
+	u32 Mesh::SelectLod(
+		const CameraComponent&	 Camera,
+		const Math::BoundingBox& Box,
+		f32						 ViewportHeight,
+		f32						 MaxPixelError,
+		f32						 Scale /*= 1.0f*/) const noexcept
+	{
+		// Errors are measured at the point of the box closest to the camera, approximated by its bounding sphere
+		const Math::Vec3f Eye(Camera.Transform.Position.x, Camera.Transform.Position.y, Camera.Transform.Position.z);
+		const f32		  Distance		  = std::max(Math::length(Box.Center - Eye) - Math::length(Box.Extents), Camera.NearZ);
+		const f32		  ProjectionScale = ViewportHeight / (2.0f * tanf(DirectX::XMConvertToRadians(Camera.FoVY) * 0.5f));
+		const f32		  PixelsPerUnit	  = Scale * ProjectionScale / Distance;
+
+		u32 Lod = 0;
+		for (u32 i = 0; i < static_cast<u32>(Lods.size()) && Lods[i].Error * PixelsPerUnit <= MaxPixelError; ++i)
+		{
+			Lod = i + 1;
+		}
+		return Lod;
+	}
+
 } // namespace Asset
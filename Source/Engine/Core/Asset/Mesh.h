@@ -3,8 +3,14 @@
 #include "Core/World/Vertex.h"
 #include "RHI/RHI.h"
 #include "Math/Math.h"
+#include "MeshOptimizer.h"
+#include "VertexCompression.h"
+#include "MeshSimplifier.h"
+#include "MeshletCulling.h"
 #include <DirectXMesh.h>
 
+struct CameraComponent;
+
 namespace Asset
 {
 	struct MeshImportOptions
@@ -18,6 +24,32 @@ namespace Asset
 
 		bool GenerateMeshlets = false;
 
+		// Vertices whose attributes fall into the same cell of a grid this fine are merged, 0 merges identical vertices only
+		f32 WeldEpsilon = 0.0f;
+
+		// Meshes with more triangles are split into spatially coherent clusters of at most this many, each of which becomes a
+		// mesh with its own bounding box and BLAS. 0 keeps meshes whole
+		u32 ClusterTriangles = 0;
+
+		// Reorder triangles and vertices for the post-transform cache and vertex fetch, optionally for overdraw as well
+		bool OptimizeVertexCache = false;
+		bool OptimizeOverdraw	 = false;
+
+		// Store vertices quantized in the cooked file (16 instead of 32 bytes), they are decoded when loaded
+		bool CompressVertices = false;
+		// Store indices with IndexCodec in the cooked file, they are decoded when loaded
+		bool CompressIndices = false;
+
+		// Number of coarser levels of detail to generate, every level keeps LodRatio of the previous level's triangles
+		// unless its accumulated error would exceed LodMaxError (relative to the bounding box diagonal) first
+		u32 NumLods		= 0;
+		f32 LodRatio	= 0.5f;
+		f32 LodMaxError = 0.01f;
+
+		// Frustum culls the meshlets and clusters of every cooked mesh from a few fixed views and logs how much is rejected,
+		// for AssetCooker --benchmark-culling. Does not change the cooked file, meshes read from the cache are not culled
+		bool BenchmarkCulling = false;
+
 		Math::Vec3f			Translation	 = { 0.0f, 0.0f, 0.0f };
 		Math::Vec3f			Rotation	 = { 0.0f, 0.0f, 0.0f };
 		float				UniformScale = 1.0f;
@@ -33,16 +65,57 @@ namespace Asset
 
 		void Release();
 
+		// Moves the GPU resources into Released, which keeps them alive while the GPU may still use them. The mesh has to be
+		// uploaded again before it can be drawn
+		void ReleaseResources(Mesh& Released);
+
+		// Hash of everything that ends up in the GPU resources, meshes with equal hashes can draw with the same resources.
+		// Both have to be called before the streams are released
+		[[nodiscard]] u64 HashContent() const;
+		[[nodiscard]] u64 GetSizeInBytes() const noexcept;
+
 		void SetVertices(std::vector<Vertex>&& Vertices);
 		void SetIndices(std::vector<u32>&& Indices);
 		void SetMeshlets(std::vector<DirectX::Meshlet>&& Meshlets);
 		void SetUniqueVertexIndices(std::vector<u8>&& UniqueVertexIndices);
 		void SetPrimitiveIndices(std::vector<DirectX::MeshletTriangle>&& PrimitiveIndices);
+		void SetMeshletCullData(std::vector<DirectX::CullData>&& MeshletCullData);
+		void SetLods(std::vector<MeshLod>&& Lods, std::vector<u32>&& LodIndices);
+
+		// References the streams in place inside of a mapped cooked file instead of owning a copy of them
+		void SetMappedStreams(
+			std::shared_ptr<MemoryMappedFile>	  MappedFile,
+			Span<const Vertex>					  Vertices,
+			Span<const u32>						  Indices,
+			Span<const DirectX::Meshlet>		  Meshlets,
+			Span<const u8>						  UniqueVertexIndices,
+			Span<const DirectX::MeshletTriangle> PrimitiveIndices,
+			Span<const u32>						  LodIndices);
+
+		// Returns either the mapped or the owned streams, whichever the mesh was created with
+		[[nodiscard]] Span<const Vertex>					GetVertices() const noexcept;
+		[[nodiscard]] Span<const u32>						GetIndices() const noexcept;
+		[[nodiscard]] Span<const DirectX::Meshlet>			GetMeshlets() const noexcept;
+		[[nodiscard]] Span<const u8>						GetUniqueVertexIndices() const noexcept;
+		[[nodiscard]] Span<const DirectX::MeshletTriangle> GetPrimitiveIndices() const noexcept;
+		[[nodiscard]] Span<const u32>						GetLodIndices() const noexcept;
+
+		// Level of detail to draw an instance with world space bounding box Box and uniform Scale at, the coarsest level whose
+		// error projects to at most MaxPixelError pixels on a viewport ViewportHeight pixels high. 0 is the full detail mesh
+		[[nodiscard]] u32 SelectLod(
+			const CameraComponent&	 Camera,
+			const Math::BoundingBox& Box,
+			f32						 ViewportHeight,
+			f32						 MaxPixelError,
+			f32						 Scale = 1.0f) const noexcept;
 
 		MeshImportOptions Options;
 
 		std::string Name;
 
+		// Of the mesh in its cooked file, it is reloaded from there after an eviction
+		u32 ArchiveIndex = 0;
+
 		u32 NumVertices		 = 0;
 		u32 NumIndices		 = 0;
 		u32 NumMeshlets		 = 0;
@@ -54,9 +127,36 @@ namespace Asset
 		std::vector<DirectX::Meshlet>		  Meshlets;
 		std::vector<u8>						  UniqueVertexIndices;
 		std::vector<DirectX::MeshletTriangle> PrimitiveIndices;
+		std::vector<u32>					  LodIndices;
+
+		// Bounding sphere and normal cone of every meshlet, kept after the streams are released for culling
+		std::vector<DirectX::CullData> MeshletCullData;
+
+		// Levels 1 and up, kept after the streams are released for LOD selection. Their indices follow
+		// LOD 0's in IndexResource
+		std::vector<MeshLod> Lods;
+
+		// Only held between cooking and export
+		std::vector<CompressedVertex> CompressedVertices;
+		std::vector<u8>				  CompressedIndices;
+
+		// GPU index format, 16-bit whenever every index fits
+		DXGI_FORMAT IndexFormat = DXGI_FORMAT_R32_UINT;
+
+		// Cooked meshes view their streams straight out of the mapped .asset file,
+		// the mapping is shared between all meshes of the file and kept alive until the mesh is released after upload
+		std::shared_ptr<MemoryMappedFile>	 MappedFile;
+		Span<const Vertex>					 MappedVertices;
+		Span<const u32>						 MappedIndices;
+		Span<const DirectX::Meshlet>		 MappedMeshlets;
+		Span<const u8>						 MappedUniqueVertexIndices;
+		Span<const DirectX::MeshletTriangle> MappedPrimitiveIndices;
+		Span<const u32>						 MappedLodIndices;
 
 		Math::BoundingBox BoundingBox;
 
+		MeshOptimizationStats OptimizationStats;
+
 		RHI::D3D12Buffer			 VertexResource;
 		RHI::D3D12Buffer			 IndexResource;
 		RHI::D3D12Buffer			 MeshletResource;
@@ -0,0 +1,176 @@
+#include "MeshArchive.h"
+
+namespace Asset
+{
+	static Span<const u8> GetStreamData(const Mesh* Mesh, MeshStream Stream)
+	{
+		auto AsBytes = []<typename T>(Span<const T> Span)
+		{
+			return ::Span<const u8>(reinterpret_cast<const u8*>(Span.data()), Span.size() * sizeof(T));
+		};
+
+		switch (Stream)
+		{
+		case MeshStream::Vertices:
+			return Mesh->CompressedVertices.empty() ? AsBytes(Mesh->GetVertices()) : ::Span<const u8>();
+		case MeshStream::Indices:
+			return Mesh->CompressedIndices.empty() ? AsBytes(Mesh->GetIndices()) : ::Span<const u8>();
+		case MeshStream::Meshlets:
+			return AsBytes(Mesh->GetMeshlets());
+		case MeshStream::UniqueVertexIndices:
+			return AsBytes(Mesh->GetUniqueVertexIndices());
+		case MeshStream::PrimitiveIndices:
+			return AsBytes(Mesh->GetPrimitiveIndices());
+		case MeshStream::MeshletCullData:
+			return AsBytes(::Span<const DirectX::CullData>(Mesh->MeshletCullData));
+		case MeshStream::CompressedVertices:
+			return AsBytes(::Span<const CompressedVertex>(Mesh->CompressedVertices));
+		case MeshStream::CompressedIndices:
+			return Mesh->CompressedIndices;
+		case MeshStream::Lods:
+			return AsBytes(::Span<const MeshLod>(Mesh->Lods));
+		case MeshStream::LodIndices:
+			return AsBytes(Mesh->GetLodIndices());
+		}
+		return {};
+	}
+
+	void MeshArchive::Write(const std::filesystem::path& Path, const std::vector<Mesh*>& Meshes)
+	{
+		static constexpr u8 Padding[Alignment] = {};
+
+		std::vector<MeshArchiveEntry> Toc(Meshes.size());
+
+		// Lay out names first, then every stream of every mesh on an aligned boundary
+		u64 Offset = sizeof(MeshArchiveHeader) + Toc.size() * sizeof(MeshArchiveEntry);
+		for (size_t i = 0; i < Meshes.size(); ++i)
+		{
+			Toc[i].NameOffset		 = Offset;
+			Toc[i].NameLength		 = Meshes[i]->Name.size();
+			Toc[i].OptimizationStats = Meshes[i]->OptimizationStats;
+			Toc[i].BoundingBox		 = Meshes[i]->BoundingBox;
+			Offset += Toc[i].NameLength;
+		}
+		for (size_t i = 0; i < Meshes.size(); ++i)
+		{
+			for (size_t s = 0; s < NumMeshStreams; ++s)
+			{
+				Span<const u8> Data = GetStreamData(Meshes[i], static_cast<MeshStream>(s));
+
+				Offset				= AlignUp(Offset, Alignment);
+				Toc[i].Streams[s]	= {
+					  .Offset	   = Offset,
+					  .SizeInBytes = Data.size(),
+					  .Checksum	   = Hash::Hash64(Data.data(), Data.size()),
+				};
+				Offset += Data.size();
+			}
+		}
+
+		MeshArchiveHeader Header = {
+			.Magic		 = Magic,
+			.Version	 = Version,
+			.NumMeshes	 = Toc.size(),
+			.TocOffset	 = sizeof(MeshArchiveHeader),
+			.TocChecksum = Hash::Hash64(Toc.data(), Toc.size() * sizeof(MeshArchiveEntry)),
+		};
+
+		FileStream	 Stream(Path, FileMode::Create, FileAccess::Write);
+		BinaryWriter Writer(Stream);
+
+		u64 Position = 0;
+		auto Write	 = [&](const void* Data, u64 SizeInBytes)
+		{
+			Writer.Write(Data, SizeInBytes);
+			Position += SizeInBytes;
+		};
+
+		Write(&Header, sizeof(Header));
+		Write(Toc.data(), Toc.size() * sizeof(MeshArchiveEntry));
+		for (const auto& Mesh : Meshes)
+		{
+			Write(Mesh->Name.data(), Mesh->Name.size());
+		}
+		for (size_t i = 0; i < Meshes.size(); ++i)
+		{
+			for (size_t s = 0; s < NumMeshStreams; ++s)
+			{
+				Span<const u8> Data = GetStreamData(Meshes[i], static_cast<MeshStream>(s));
+
+				Write(Padding, Toc[i].Streams[s].Offset - Position);
+				Write(Data.data(), Data.size());
+			}
+		}
+	}
+
+	MeshArchive::MeshArchive(std::shared_ptr<MemoryMappedFile> File)
+		: File(std::move(File))
+	{
+		static constexpr MeshArchiveHeader NullHeader = {};
+
+		const u64 SizeInBytes = this->File->GetSizeInBytes();
+		const u8* BaseAddress = this->File->GetBaseAddress();
+
+		Header = &NullHeader;
+		if (SizeInBytes < sizeof(MeshArchiveHeader))
+		{
+			return;
+		}
+
+		const auto* FileHeader = reinterpret_cast<const MeshArchiveHeader*>(BaseAddress);
+		if (FileHeader->Magic != Magic || FileHeader->Version != Version)
+		{
+			return;
+		}
+
+		const u64 TocSizeInBytes = FileHeader->NumMeshes * sizeof(MeshArchiveEntry);
+		if (FileHeader->TocOffset > SizeInBytes || TocSizeInBytes > SizeInBytes - FileHeader->TocOffset)
+		{
+			return;
+		}
+
+		const auto* Toc = reinterpret_cast<const MeshArchiveEntry*>(BaseAddress + FileHeader->TocOffset);
+		if (Hash::Hash64(Toc, TocSizeInBytes) != FileHeader->TocChecksum)
+		{
+			return;
+		}
+
+		for (u64 i = 0; i < FileHeader->NumMeshes; ++i)
+		{
+			if (Toc[i].NameOffset > SizeInBytes || Toc[i].NameLength > SizeInBytes - Toc[i].NameOffset)
+			{
+				return;
+			}
+			for (const auto& Stream : Toc[i].Streams)
+			{
+				if (Stream.Offset > SizeInBytes || Stream.SizeInBytes > SizeInBytes - Stream.Offset || Stream.Offset % Alignment != 0)
+				{
+					return;
+				}
+			}
+		}
+
+		Header	= FileHeader;
+		Entries = Toc;
+		Valid	= true;
+	}
+
+	bool MeshArchive::ValidateMesh(u64 Index) const noexcept
+	{
+		assert(Valid && Index < GetNumMeshes());
+		for (const auto& Stream : Entries[Index].Streams)
+		{
+			if (Hash::Hash64(File->GetBaseAddress() + Stream.Offset, Stream.SizeInBytes) != Stream.Checksum)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::string_view MeshArchive::GetName(u64 Index) const noexcept
+	{
+		const MeshArchiveEntry& Entry = Entries[Index];
+		return { reinterpret_cast<const char*>(File->GetBaseAddress() + Entry.NameOffset), Entry.NameLength };
+	}
+} // namespace Asset
@@ -0,0 +1,94 @@
+#pragma once
+#include "Mesh.h"
+
+namespace Asset
+{
+	// Streams stored for every mesh of a cooked file
+	enum class MeshStream : u32
+	{
+		Vertices,
+		Indices,
+		Meshlets,
+		UniqueVertexIndices,
+		PrimitiveIndices,
+		MeshletCullData,
+		CompressedVertices, // Replaces Vertices when MeshImportOptions::CompressVertices is set
+		CompressedIndices,	// Replaces Indices when MeshImportOptions::CompressIndices is set
+		Lods,				// MeshLod table of the levels after LOD 0
+		LodIndices,			// Indices of every level after LOD 0, concatenated
+		NumStreams
+	};
+
+	inline constexpr size_t NumMeshStreams = static_cast<size_t>(MeshStream::NumStreams);
+
+	struct MeshArchiveStream
+	{
+		u64 Offset;
+		u64 SizeInBytes;
+		u64 Checksum;
+	};
+
+	struct MeshArchiveEntry
+	{
+		u64					  NameOffset;
+		u64					  NameLength;
+		MeshArchiveStream	  Streams[NumMeshStreams];
+		MeshOptimizationStats OptimizationStats;
+		Math::BoundingBox	  BoundingBox; // Also the quantization box of CompressedVertices
+	};
+
+	struct MeshArchiveHeader
+	{
+		u32 Magic;
+		u32 Version;
+		u64 NumMeshes;
+		u64 TocOffset;
+		u64 TocChecksum;
+	};
+
+	// Cooked mesh container (.asset)
+	//
+	//	MeshArchiveHeader
+	//	MeshArchiveEntry[NumMeshes]	table of contents
+	//	char[]						mesh names
+	//	payloads					every stream starts on an Alignment boundary
+	//
+	// All offsets are relative to the beginning of the file, so any single mesh can be read
+	// (and verified against its checksums) without touching the payload of any other mesh.
+	class MeshArchive
+	{
+	public:
+		static constexpr u32 Magic	   = 0x48534D4B; // "KMSH"
+		static constexpr u32 Version   = 7;
+		static constexpr u64 Alignment = 64;
+
+		static void Write(const std::filesystem::path& Path, const std::vector<Mesh*>& Meshes);
+
+		explicit MeshArchive(std::shared_ptr<MemoryMappedFile> File);
+
+		// Header and table of contents are validated on construction, payload checksums are verified per mesh
+		[[nodiscard]] bool IsValid() const noexcept { return Valid; }
+		[[nodiscard]] bool ValidateMesh(u64 Index) const noexcept;
+
+		[[nodiscard]] u64			   GetNumMeshes() const noexcept { return Header->NumMeshes; }
+		[[nodiscard]] std::string_view GetName(u64 Index) const noexcept;
+
+		[[nodiscard]] const MeshOptimizationStats& GetOptimizationStats(u64 Index) const noexcept { return Entries[Index].OptimizationStats; }
+		[[nodiscard]] const Math::BoundingBox&	   GetBoundingBox(u64 Index) const noexcept { return Entries[Index].BoundingBox; }
+
+		template<typename T>
+		[[nodiscard]] Span<const T> GetStream(u64 Index, MeshStream Stream) const noexcept
+		{
+			const MeshArchiveStream& Desc = Entries[Index].Streams[static_cast<size_t>(Stream)];
+			return Span<const T>(reinterpret_cast<const T*>(File->GetBaseAddress() + Desc.Offset), Desc.SizeInBytes / sizeof(T));
+		}
+
+		[[nodiscard]] const std::shared_ptr<MemoryMappedFile>& GetFile() const noexcept { return File; }
+
+	private:
+		std::shared_ptr<MemoryMappedFile> File;
+		const MeshArchiveHeader*		  Header  = nullptr;
+		const MeshArchiveEntry*			  Entries = nullptr;
+		bool							  Valid	  = false;
+	};
+} // namespace Asset
@@ -0,0 +1,227 @@
+#include "MeshClusterer.h"
+#include <numeric>
+
+using namespace DirectX;
+
+namespace Asset
+{
+	// Triangles are processed in blocks so ParallelFor hands out a meaningful amount of work per index
+	constexpr size_t BlockSize = 16 * 1024;
+
+	std::vector<MeshCluster> MeshClusterer::Split(
+		Span<const Vertex> Vertices,
+		Span<const u32>	   Indices,
+		u32				   MaxTriangles,
+		MeshClusterStats*  Stats /*= nullptr*/)
+	{
+		const size_t NumTriangles = Indices.size() / 3;
+		if (MaxTriangles == 0 || NumTriangles <= MaxTriangles)
+		{
+			return {};
+		}
+
+		i64 Start = Stopwatch::GetTimestamp();
+
+		const size_t			 NumBlocks = (NumTriangles + BlockSize - 1) / BlockSize;
+		std::vector<Math::Vec3f> Centroids(NumTriangles);
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				const size_t Last = std::min((Block + 1) * BlockSize, NumTriangles);
+				for (size_t t = Block * BlockSize; t < Last; ++t)
+				{
+					const XMFLOAT3& a = Vertices[Indices[t * 3 + 0]].Position;
+					const XMFLOAT3& b = Vertices[Indices[t * 3 + 1]].Position;
+					const XMFLOAT3& c = Vertices[Indices[t * 3 + 2]].Position;
+					Centroids[t]	  = Math::Vec3f(a.x + b.x + c.x, a.y + b.y + c.y, a.z + b.z + c.z) / 3.0f;
+				}
+			});
+
+		// Triangles [Begin, End) of Order
+		struct Range
+		{
+			size_t Begin;
+			size_t End;
+		};
+
+		std::vector<u32> Order(NumTriangles);
+		std::iota(Order.begin(), Order.end(), 0);
+
+		// Every level halves the ranges that are still too large, ranges of a level are disjoint so they split in parallel
+		std::vector<Range> Leaves;
+		std::vector<Range> Pending = { { 0, NumTriangles } };
+		while (!Pending.empty())
+		{
+			std::vector<Range> Next(Pending.size() * 2);
+			ParallelFor(
+				Process::GetThreadPool(),
+				Pending.size(),
+				[&](size_t i)
+				{
+					const Range Current = Pending[i];
+
+					Math::Vec3f Min = Centroids[Order[Current.Begin]];
+					Math::Vec3f Max = Min;
+					for (size_t t = Current.Begin; t < Current.End; ++t)
+					{
+						const Math::Vec3f& Centroid = Centroids[Order[t]];
+						for (size_t Axis = 0; Axis < 3; ++Axis)
+						{
+							Min[Axis] = std::min(Min[Axis], Centroid[Axis]);
+							Max[Axis] = std::max(Max[Axis], Centroid[Axis]);
+						}
+					}
+
+					const Math::Vec3f Size = Max - Min;
+					const size_t	  Axis = Size.x >= Size.y && Size.x >= Size.z ? 0 : (Size.y >= Size.z ? 1 : 2);
+
+					// Ties are broken by index so the partition does not depend on the order of equal centroids
+					const size_t Middle = Current.Begin + (Current.End - Current.Begin) / 2;
+					std::nth_element(
+						Order.begin() + Current.Begin,
+						Order.begin() + Middle,
+						Order.begin() + Current.End,
+						[&](u32 a, u32 b)
+						{
+							return Centroids[a][Axis] < Centroids[b][Axis] || (Centroids[a][Axis] == Centroids[b][Axis] && a < b);
+						});
+
+					Next[i * 2 + 0] = { Current.Begin, Middle };
+					Next[i * 2 + 1] = { Middle, Current.End };
+				});
+
+			Pending.clear();
+			for (const Range& Child : Next)
+			{
+				(Child.End - Child.Begin > MaxTriangles ? Pending : Leaves).push_back(Child);
+			}
+		}
+
+		// In order of the tree, so neighbouring clusters are close to each other
+		std::ranges::sort(Leaves, {}, &Range::Begin);
+
+		std::vector<MeshCluster> Clusters(Leaves.size());
+		ParallelFor(
+			Process::GetThreadPool(),
+			Clusters.size(),
+			[&](size_t c)
+			{
+				const Range	 Leaf	 = Leaves[c];
+				MeshCluster& Cluster = Clusters[c];
+
+				// Triangles and vertices keep their original relative order, and with it whatever locality they had
+				std::sort(Order.begin() + Leaf.Begin, Order.begin() + Leaf.End);
+
+				std::vector<u32> Used;
+				Used.reserve((Leaf.End - Leaf.Begin) * 3);
+				for (size_t t = Leaf.Begin; t < Leaf.End; ++t)
+				{
+					Used.insert(Used.end(), &Indices[Order[t] * 3], &Indices[Order[t] * 3] + 3);
+				}
+				std::ranges::sort(Used);
+				Used.erase(std::unique(Used.begin(), Used.end()), Used.end());
+
+				Cluster.Vertices.reserve(Used.size());
+				for (u32 v : Used)
+				{
+					Cluster.Vertices.push_back(Vertices[v]);
+				}
+
+				Cluster.Indices.reserve((Leaf.End - Leaf.Begin) * 3);
+				for (size_t t = Leaf.Begin; t < Leaf.End; ++t)
+				{
+					for (size_t Corner = 0; Corner < 3; ++Corner)
+					{
+						auto Iterator = std::ranges::lower_bound(Used, Indices[Order[t] * 3 + Corner]);
+						Cluster.Indices.push_back(static_cast<u32>(Iterator - Used.begin()));
+					}
+				}
+			});
+
+		if (Stats)
+		{
+			Stats->NumTriangles		   = NumTriangles;
+			Stats->NumClusters		   = Clusters.size();
+			Stats->MinClusterTriangles = NumTriangles;
+			Stats->MaxClusterTriangles = 0;
+			for (const MeshCluster& Cluster : Clusters)
+			{
+				Stats->MinClusterTriangles = std::min<u64>(Stats->MinClusterTriangles, Cluster.Indices.size() / 3);
+				Stats->MaxClusterTriangles = std::max<u64>(Stats->MaxClusterTriangles, Cluster.Indices.size() / 3);
+			}
+			Stats->Ticks = Stopwatch::GetTimestamp() - Start;
+		}
+		return Clusters;
+	}
+
+	MeshClusterCullStats MeshClusterer::Benchmark(Span<const Math::BoundingBox> Boxes, Span<const u64> NumTriangles)
+	{
+		static constexpr XMFLOAT3 Directions[] = {
+			{ +1.0f, 0.0f, 0.0f },
+			{ -1.0f, 0.0f, 0.0f },
+			{ 0.0f, +1.0f, 0.0f },
+			{ 0.0f, -1.0f, 0.0f },
+			{ 0.0f, 0.0f, +1.0f },
+			{ 0.0f, 0.0f, -1.0f },
+		};
+
+		MeshClusterCullStats Stats;
+		if (Boxes.empty())
+		{
+			return Stats;
+		}
+
+		Math::Vec3f Min = Boxes[0].Center - Boxes[0].Extents;
+		Math::Vec3f Max = Boxes[0].Center + Boxes[0].Extents;
+		for (const Math::BoundingBox& Box : Boxes)
+		{
+			for (size_t Axis = 0; Axis < 3; ++Axis)
+			{
+				Min[Axis] = std::min(Min[Axis], Box.Center[Axis] - Box.Extents[Axis]);
+				Max[Axis] = std::max(Max[Axis], Box.Center[Axis] + Box.Extents[Axis]);
+			}
+		}
+
+		const Math::Vec3f Center = (Min + Max) * 0.5f;
+		const f32		  Radius = std::max(Math::length(Max - Center), 1e-3f);
+		XMVECTOR		  Origin = XMVectorSet(Center.x, Center.y, Center.z, 1.0f);
+
+		auto CountCulled = [&](FXMMATRIX View, CXMMATRIX Projection)
+		{
+			XMFLOAT4X4 ViewProjection;
+			XMStoreFloat4x4(&ViewProjection, View * Projection);
+			Math::Frustum Frustum(ViewProjection);
+
+			u64 NumCulled = 0;
+			for (size_t i = 0; i < Boxes.size(); ++i)
+			{
+				if (Frustum.Contains(Boxes[i]) == ContainmentType::Disjoint)
+				{
+					NumCulled += NumTriangles[i];
+				}
+			}
+			return NumCulled;
+		};
+
+		for (const XMFLOAT3& Direction : Directions)
+		{
+			XMVECTOR Forward = XMLoadFloat3(&Direction);
+			XMVECTOR Up		 = std::abs(Direction.y) > 0.0f ? XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f) : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+
+			// 90 degree views out of the center cover every direction once, like the faces of a cube map
+			Stats.NumCulledInside += CountCulled(
+				XMMatrixLookToLH(Origin, Forward, Up),
+				XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.001f * Radius, 4.0f * Radius));
+
+			// 60 degree views from just outside of the bounding sphere, the mesh covers most of the view
+			Stats.NumCulledOutside += CountCulled(
+				XMMatrixLookAtLH(Origin + Forward * (1.5f * Radius), Origin, Up),
+				XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 1.0f, 0.01f * Radius, 4.0f * Radius));
+
+			Stats.NumTriangles += std::accumulate(NumTriangles.begin(), NumTriangles.end(), u64(0));
+		}
+		return Stats;
+	}
+} // namespace Asset
@@ -0,0 +1,70 @@
+#pragma once
+#include "System/System.h"
+#include "Core/World/Vertex.h"
+#include "Math/Math.h"
+
+namespace Asset
+{
+	// A spatially coherent part of a mesh, its vertices are the ones its triangles reference in their original order
+	struct MeshCluster
+	{
+		std::vector<Vertex> Vertices;
+		std::vector<u32>	Indices;
+	};
+
+	struct MeshClusterStats
+	{
+		u64 NumTriangles		= 0;
+		u64 NumClusters			= 0;
+		u64 MinClusterTriangles = 0;
+		u64 MaxClusterTriangles = 0;
+		i64 Ticks				= 0; // Stopwatch ticks
+
+		MeshClusterStats& operator+=(const MeshClusterStats& Other)
+		{
+			MinClusterTriangles = NumClusters > 0 ? std::min(MinClusterTriangles, Other.MinClusterTriangles) : Other.MinClusterTriangles;
+			MaxClusterTriangles = std::max(MaxClusterTriangles, Other.MaxClusterTriangles);
+			NumTriangles += Other.NumTriangles;
+			NumClusters += Other.NumClusters;
+			Ticks += Other.Ticks;
+			return *this;
+		}
+	};
+
+	// Triangles that survive frustum culling of the cluster bounding boxes, from views inside and outside of the clusters.
+	// The bounding box of the whole mesh is never culled from either, so every culled triangle is due to the split
+	struct MeshClusterCullStats
+	{
+		u64 NumTriangles	 = 0; // Summed over the six views of either kind
+		u64 NumCulledInside	 = 0;
+		u64 NumCulledOutside = 0;
+
+		MeshClusterCullStats& operator+=(const MeshClusterCullStats& Other)
+		{
+			NumTriangles += Other.NumTriangles;
+			NumCulledInside += Other.NumCulledInside;
+			NumCulledOutside += Other.NumCulledOutside;
+			return *this;
+		}
+	};
+
+	// Splits meshes that are too large to cull or build a BLAS for as a whole. Triangles are partitioned recursively at the
+	// median of their centroids along the longest axis of the centroid bounds until every part has at most MaxTriangles,
+	// so clusters end up with between half of MaxTriangles and MaxTriangles triangles and compact bounding boxes.
+	// The partitions of every level are split in parallel and the clusters extracted in parallel
+	class MeshClusterer
+	{
+	public:
+		// Returns the clusters in a deterministic order, empty if the mesh has at most MaxTriangles triangles (or MaxTriangles
+		// is 0). Uses ParallelFor, so it must not be called from a thread pool thread
+		static std::vector<MeshCluster> Split(
+			Span<const Vertex> Vertices,
+			Span<const u32>	   Indices,
+			u32				   MaxTriangles,
+			MeshClusterStats*  Stats = nullptr);
+
+		// Frustum culls the clusters of one mesh from six views out of the center of their bounds and six views from just
+		// outside of them, NumTriangles[i] is the triangle count of the cluster bounded by Boxes[i]
+		[[nodiscard]] static MeshClusterCullStats Benchmark(Span<const Math::BoundingBox> Boxes, Span<const u64> NumTriangles);
+	};
+} // namespace Asset
@@ -0,0 +1,203 @@
+#include "MeshOptimizer.h"
+#include <DirectXMesh.h>
+
+using namespace DirectX;
+
+namespace Asset
+{
+	MeshOptimizationStats MeshOptimizer::Optimize(std::vector<Vertex>& Vertices, std::vector<u32>& Indices, bool OptimizeOverdraw)
+	{
+		MeshOptimizationStats Stats = {};
+
+		size_t NumFaces = Indices.size() / 3;
+		ComputeVertexCacheMissRate(Indices.data(), NumFaces, Vertices.size(), CacheSize, Stats.AcmrBefore, Stats.AtvrBefore);
+		Stats.AcmrAfter = Stats.AcmrBefore;
+		Stats.AtvrAfter = Stats.AtvrBefore;
+
+		std::vector<u32> Optimized = Indices;
+		if (!OptimizeFaces(Optimized))
+		{
+			return Stats;
+		}
+		NumFaces = Optimized.size() / 3;
+
+		if (OptimizeOverdraw)
+		{
+			MeshOptimizer::OptimizeOverdraw(Vertices, Optimized);
+		}
+
+		std::vector<u32>	VertexRemap(Vertices.size());
+		std::vector<u32>	FinalIndices(Optimized.size());
+		std::vector<Vertex> FinalVertices(Vertices.size());
+		size_t				TrailingUnused = 0;
+		if (FAILED(OptimizeVertices(Optimized.data(), NumFaces, Vertices.size(), VertexRemap.data(), &TrailingUnused)) ||
+			FAILED(FinalizeIB(Optimized.data(), NumFaces, VertexRemap.data(), Vertices.size(), FinalIndices.data())) ||
+			FAILED(FinalizeVB(Vertices.data(), sizeof(Vertex), Vertices.size(), nullptr, 0, VertexRemap.data(), FinalVertices.data())))
+		{
+			return Stats;
+		}
+		FinalVertices.resize(Vertices.size() - TrailingUnused);
+
+		Vertices = std::move(FinalVertices);
+		Indices	 = std::move(FinalIndices);
+		ComputeVertexCacheMissRate(Indices.data(), NumFaces, Vertices.size(), CacheSize, Stats.AcmrAfter, Stats.AtvrAfter);
+		return Stats;
+	}
+
+	bool MeshOptimizer::OptimizeFaces(std::vector<u32>& Indices)
+	{
+		const size_t	 NumFaces = Indices.size() / 3;
+		std::vector<u32> FaceRemap(NumFaces);
+		std::vector<u32> Optimized(Indices.size());
+		if (FAILED(OptimizeFacesLRU(Indices.data(), NumFaces, FaceRemap.data())) ||
+			FAILED(ReorderIB(Indices.data(), NumFaces, FaceRemap.data(), Optimized.data())))
+		{
+			return false;
+		}
+
+		// Degenerate faces are remapped to the end as unused
+		const size_t NumUsedFaces = std::ranges::count_if(
+			FaceRemap,
+			[](u32 Face)
+			{
+				return Face != UNUSED32;
+			});
+		Optimized.resize(NumUsedFaces * 3);
+		Indices = std::move(Optimized);
+		return true;
+	}
+
+	// Sander, Nehab, Barczak: Fast Triangle Reordering for Vertex Locality and Reduced Overdraw.
+	// The cache optimized order is cut into clusters at points where the cache is cold anyway, clusters are then
+	// sorted so that the ones facing away from the mesh center (likely occluders) are drawn first
+	void MeshOptimizer::OptimizeOverdraw(const std::vector<Vertex>& Vertices, std::vector<u32>& Indices)
+	{
+		const size_t NumFaces = Indices.size() / 3;
+		if (NumFaces == 0)
+		{
+			return;
+		}
+
+		// FIFO cache simulation, a vertex is resident if it was transformed within the last CacheSize misses
+		std::vector<u32> CacheTimestamps(Vertices.size(), 0);
+		u32				 Timestamp	  = CacheSize + 1;
+		auto			 SimulateFace = [&](size_t Face)
+		{
+			u32 Misses = 0;
+			for (size_t i = 0; i < 3; ++i)
+			{
+				u32 Index = Indices[Face * 3 + i];
+				if (Timestamp - CacheTimestamps[Index] > CacheSize)
+				{
+					CacheTimestamps[Index] = Timestamp++;
+					++Misses;
+				}
+			}
+			return Misses;
+		};
+		auto FlushCache = [&]()
+		{
+			Timestamp += CacheSize + 1;
+		};
+
+		// Hard boundaries, every vertex of the face missed so the cache was effectively flushed
+		std::vector<size_t> HardBoundaries;
+		for (size_t f = 0; f < NumFaces; ++f)
+		{
+			if (u32 Misses = SimulateFace(f); f == 0 || Misses == 3)
+			{
+				HardBoundaries.push_back(f);
+			}
+		}
+		HardBoundaries.push_back(NumFaces);
+
+		// Soft boundaries, split a hard cluster once the ACMR of the current piece is within the threshold of the whole cluster
+		std::vector<size_t> Clusters;
+		for (size_t h = 0; h + 1 < HardBoundaries.size(); ++h)
+		{
+			const size_t Start = HardBoundaries[h];
+			const size_t End   = HardBoundaries[h + 1];
+
+			FlushCache();
+			u32 ClusterMisses = 0;
+			for (size_t f = Start; f < End; ++f)
+			{
+				ClusterMisses += SimulateFace(f);
+			}
+			const f32 Threshold = OverdrawThreshold * static_cast<f32>(ClusterMisses) / static_cast<f32>(End - Start);
+
+			FlushCache();
+			Clusters.push_back(Start);
+			u32	   Misses	  = 0;
+			size_t PieceStart = Start;
+			for (size_t f = Start; f + 1 < End; ++f)
+			{
+				Misses += SimulateFace(f);
+				if (static_cast<f32>(Misses) / static_cast<f32>(f + 1 - PieceStart) <= Threshold)
+				{
+					Clusters.push_back(f + 1);
+					PieceStart = f + 1;
+					Misses	   = 0;
+					FlushCache();
+				}
+			}
+		}
+		Clusters.push_back(NumFaces);
+
+		auto Load = [&](size_t Face, size_t i)
+		{
+			return XMLoadFloat3(&Vertices[Indices[Face * 3 + i]].Position);
+		};
+
+		// Area weighted centroid and normal of every cluster
+		const size_t		  NumClusters = Clusters.size() - 1;
+		std::vector<XMFLOAT3> Centroids(NumClusters);
+		std::vector<XMFLOAT3> Normals(NumClusters);
+		XMVECTOR			  MeshCentroid = XMVectorZero();
+		f32					  MeshArea	   = 0.0f;
+		for (size_t c = 0; c < NumClusters; ++c)
+		{
+			XMVECTOR Centroid = XMVectorZero();
+			XMVECTOR Normal	  = XMVectorZero();
+			f32		 Area	  = 0.0f;
+			for (size_t f = Clusters[c]; f < Clusters[c + 1]; ++f)
+			{
+				XMVECTOR P0 = Load(f, 0), P1 = Load(f, 1), P2 = Load(f, 2);
+				XMVECTOR N	= XMVector3Cross(P1 - P0, P2 - P0);
+				f32		 A	= XMVectorGetX(XMVector3Length(N));
+
+				Centroid += (P0 + P1 + P2) * (A / 3.0f);
+				Normal += N;
+				Area += A;
+			}
+
+			MeshCentroid += Centroid;
+			MeshArea += Area;
+			XMStoreFloat3(&Centroids[c], Area > 0.0f ? Centroid / Area : Load(Clusters[c], 0));
+			XMStoreFloat3(&Normals[c], XMVector3Normalize(Normal));
+		}
+		MeshCentroid = MeshArea > 0.0f ? MeshCentroid / MeshArea : XMVectorZero();
+
+		std::vector<f32>	Keys(NumClusters);
+		std::vector<size_t> Order(NumClusters);
+		for (size_t c = 0; c < NumClusters; ++c)
+		{
+			Keys[c]	 = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&Centroids[c]) - MeshCentroid, XMLoadFloat3(&Normals[c])));
+			Order[c] = c;
+		}
+		std::ranges::stable_sort(
+			Order,
+			[&](size_t a, size_t b)
+			{
+				return Keys[a] > Keys[b];
+			});
+
+		std::vector<u32> Sorted;
+		Sorted.reserve(Indices.size());
+		for (size_t c : Order)
+		{
+			Sorted.insert(Sorted.end(), Indices.begin() + Clusters[c] * 3, Indices.begin() + Clusters[c + 1] * 3);
+		}
+		Indices = std::move(Sorted);
+	}
+} // namespace Asset
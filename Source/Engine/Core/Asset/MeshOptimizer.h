@@ -0,0 +1,36 @@
+#pragma once
+#include "System/System.h"
+#include "Core/World/Vertex.h"
+
+namespace Asset
+{
+	// Average cache miss ratio (misses per triangle) and average transform to vertex ratio (misses per vertex)
+	// of a 16 entry FIFO post-transform cache, before and after optimization
+	struct MeshOptimizationStats
+	{
+		f32 AcmrBefore = 0.0f;
+		f32 AtvrBefore = 0.0f;
+		f32 AcmrAfter  = 0.0f;
+		f32 AtvrAfter  = 0.0f;
+	};
+
+	class MeshOptimizer
+	{
+	public:
+		static constexpr u32 CacheSize = 16;
+
+		// Overdraw optimization may raise ACMR by at most this factor in exchange for a front-to-back triangle order
+		static constexpr f32 OverdrawThreshold = 1.05f;
+
+		// Reorders triangles for the post-transform vertex cache (Forsyth-style LRU), optionally regroups them to reduce
+		// overdraw and finally reorders vertices by first use for fetch locality, unreferenced vertices are dropped
+		static MeshOptimizationStats Optimize(std::vector<Vertex>& Vertices, std::vector<u32>& Indices, bool OptimizeOverdraw);
+
+		// Reorders triangles for the post-transform cache only and drops degenerate ones, vertices stay in place.
+		// Returns false if Indices could not be optimized, they are left untouched in that case
+		static bool OptimizeFaces(std::vector<u32>& Indices);
+
+	private:
+		static void OptimizeOverdraw(const std::vector<Vertex>& Vertices, std::vector<u32>& Indices);
+	};
+} // namespace Asset
@@ -0,0 +1,338 @@
+#include "MeshSimplifier.h"
+#include <numeric>
+
+using namespace DirectX;
+
+namespace Asset
+{
+	// Sum of the squared distances to the planes of the triangles around a vertex. Planes are weighted by triangle area
+	// and the error is normalized by the total weight so it is a squared distance in mesh units
+	struct Quadric
+	{
+		f64 A00 = 0.0, A11 = 0.0, A22 = 0.0, A01 = 0.0, A02 = 0.0, A12 = 0.0;
+		f64 B0 = 0.0, B1 = 0.0, B2 = 0.0;
+		f64 C = 0.0;
+		f64 W = 0.0;
+
+		void AddPlane(f64 a, f64 b, f64 c, f64 d, f64 Weight)
+		{
+			A00 += Weight * a * a;
+			A11 += Weight * b * b;
+			A22 += Weight * c * c;
+			A01 += Weight * a * b;
+			A02 += Weight * a * c;
+			A12 += Weight * b * c;
+			B0 += Weight * a * d;
+			B1 += Weight * b * d;
+			B2 += Weight * c * d;
+			C += Weight * d * d;
+			W += Weight;
+		}
+
+		void Add(const Quadric& Other)
+		{
+			A00 += Other.A00;
+			A11 += Other.A11;
+			A22 += Other.A22;
+			A01 += Other.A01;
+			A02 += Other.A02;
+			A12 += Other.A12;
+			B0 += Other.B0;
+			B1 += Other.B1;
+			B2 += Other.B2;
+			C += Other.C;
+			W += Other.W;
+		}
+
+		[[nodiscard]] f64 Evaluate(const XMFLOAT3& Point) const
+		{
+			const f64 x = Point.x, y = Point.y, z = Point.z;
+			const f64 r = A00 * x * x + A11 * y * y + A22 * z * z +
+						  2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+						  2.0 * (B0 * x + B1 * y + B2 * z) +
+						  C;
+			return W > 0.0 ? std::abs(r) / W : 0.0;
+		}
+	};
+
+	struct EdgeCollapse
+	{
+		f64 Cost;
+		f32 Distance; // Largest distance of To to the planes merged into it, see Simplify
+		u32 From;
+		u32 To;
+	};
+
+	static f32 DistanceToPlane(const XMFLOAT4& Plane, const XMFLOAT3& Point)
+	{
+		return std::abs(Plane.x * Point.x + Plane.y * Point.y + Plane.z * Point.z + Plane.w);
+	}
+
+	f32 MeshSimplifier::Simplify(
+		Span<const Vertex>		 Vertices,
+		Span<const u32>			 Indices,
+		size_t					 TargetNumIndices,
+		f32						 MaxError,
+		std::vector<u32>&		 Result,
+		MeshSimplificationStats* Stats /*= nullptr*/)
+	{
+		const u32 NumVertices = static_cast<u32>(Vertices.size());
+		Result.assign(Indices.begin(), Indices.end());
+
+		auto Position = [&](u32 v) -> const XMFLOAT3&
+		{
+			return Vertices[v].Position;
+		};
+
+		// Vertices that only differ in normal or texture coordinate are one vertex for topology and quadrics
+		std::vector<u32> Canonical(NumVertices);
+		{
+			auto Key = [&](u32 v)
+			{
+				const XMFLOAT3& p = Position(v);
+				return std::tie(p.x, p.y, p.z);
+			};
+
+			std::vector<u32> Order(NumVertices);
+			std::iota(Order.begin(), Order.end(), 0u);
+			std::ranges::sort(
+				Order,
+				[&](u32 a, u32 b)
+				{
+					return Key(a) < Key(b);
+				});
+			for (size_t i = 0; i < Order.size(); ++i)
+			{
+				Canonical[Order[i]] = i > 0 && Key(Order[i]) == Key(Order[i - 1]) ? Canonical[Order[i - 1]] : Order[i];
+			}
+		}
+
+		// Moving a seam (a position referenced through more than one vertex) or an open border would tear or shrink the
+		// surface, only the remaining vertices are collapsed
+		std::vector<u8> Locked(NumVertices, 0);
+		{
+			std::vector<u32> Wedges(NumVertices, UINT32_MAX);
+			for (u32 v : Result)
+			{
+				u32& Wedge = Wedges[Canonical[v]];
+				if (Wedge == UINT32_MAX)
+				{
+					Wedge = v;
+				}
+				else if (Wedge != v)
+				{
+					Locked[Canonical[v]] = 1;
+				}
+			}
+
+			std::vector<u64> Edges;
+			Edges.reserve(Result.size());
+			for (size_t i = 0; i < Result.size(); i += 3)
+			{
+				for (size_t e = 0; e < 3; ++e)
+				{
+					u64 a = Canonical[Result[i + e]], b = Canonical[Result[i + (e + 1) % 3]];
+					Edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+				}
+			}
+			std::ranges::sort(Edges);
+			for (size_t i = 0, j = 0; i < Edges.size(); i = j)
+			{
+				while (j < Edges.size() && Edges[j] == Edges[i])
+				{
+					++j;
+				}
+				if (j - i == 1)
+				{
+					Locked[Edges[i] >> 32]				= 1;
+					Locked[Edges[i] & 0xffffffffull] = 1;
+				}
+			}
+		}
+
+		// Quadrics order the collapses, the planes around every vertex measure their error: the largest distance of the
+		// vertex a collapse keeps to any input triangle merged into it (Ronfard and Rossignac). The quadric error is an
+		// area-weighted mean over the same planes and would understate the deviation of a few steep triangles
+		std::vector<Quadric>		  Quadrics(NumVertices);
+		std::vector<XMFLOAT4>		  Planes;
+		std::vector<std::vector<u32>> VertexPlanes(NumVertices);
+		std::vector<f32>			  VertexErrors(NumVertices, 0.0f);
+		for (size_t i = 0; i < Result.size(); i += 3)
+		{
+			XMVECTOR P0 = XMLoadFloat3(&Position(Result[i + 0]));
+			XMVECTOR P1 = XMLoadFloat3(&Position(Result[i + 1]));
+			XMVECTOR P2 = XMLoadFloat3(&Position(Result[i + 2]));
+			XMVECTOR N	= XMVector3Cross(P1 - P0, P2 - P0);
+			f32		 L	= XMVectorGetX(XMVector3Length(N));
+			if (L == 0.0f)
+			{
+				continue;
+			}
+
+			XMFLOAT3 Normal;
+			XMStoreFloat3(&Normal, N / L);
+			const f64 d = -XMVectorGetX(XMVector3Dot(N / L, P0));
+			for (size_t k = 0; k < 3; ++k)
+			{
+				Quadrics[Canonical[Result[i + k]]].AddPlane(Normal.x, Normal.y, Normal.z, d, 0.5 * L);
+				VertexPlanes[Canonical[Result[i + k]]].push_back(static_cast<u32>(Planes.size()));
+			}
+			Planes.push_back(XMFLOAT4(Normal.x, Normal.y, Normal.z, static_cast<f32>(d)));
+		}
+
+		// A collapse is rejected if it turns any of the remaining triangles around From over
+		std::vector<u32> TriangleOffsets(NumVertices + 1);
+		std::vector<u32> Triangles;
+		auto			 Flips = [&](u32 From, u32 To)
+		{
+			XMVECTOR Target = XMLoadFloat3(&Position(To));
+			for (u32 i = TriangleOffsets[From]; i < TriangleOffsets[From + 1]; ++i)
+			{
+				const u32* Triangle = &Result[Triangles[i] * 3];
+				if (Triangle[0] == To || Triangle[1] == To || Triangle[2] == To)
+				{
+					continue;
+				}
+
+				const u32 k		 = Triangle[0] == From ? 0 : Triangle[1] == From ? 1 : 2;
+				XMVECTOR  P0	 = XMLoadFloat3(&Position(From));
+				XMVECTOR  P1	 = XMLoadFloat3(&Position(Triangle[(k + 1) % 3]));
+				XMVECTOR  P2	 = XMLoadFloat3(&Position(Triangle[(k + 2) % 3]));
+				XMVECTOR  Before = XMVector3Cross(P1 - P0, P2 - P0);
+				XMVECTOR  After	 = XMVector3Cross(P1 - Target, P2 - Target);
+				if (XMVectorGetX(XMVector3Dot(Before, After)) <= 0.0f)
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+
+		f32						  Error = 0.0f;
+		std::vector<u32>		  Remap(NumVertices);
+		std::vector<u8>			  Touched(NumVertices);
+		std::vector<EdgeCollapse> Collapses;
+		while (Result.size() > TargetNumIndices)
+		{
+			// Triangles around every vertex
+			std::ranges::fill(TriangleOffsets, 0u);
+			for (u32 v : Result)
+			{
+				++TriangleOffsets[v + 1];
+			}
+			std::partial_sum(TriangleOffsets.begin(), TriangleOffsets.end(), TriangleOffsets.begin());
+			Triangles.resize(Result.size());
+			{
+				std::vector<u32> Cursors(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+				for (size_t i = 0; i < Result.size(); ++i)
+				{
+					Triangles[Cursors[Result[i]]++] = static_cast<u32>(i / 3);
+				}
+			}
+
+			// Every half-edge proposes moving its first vertex onto its second, interior edges are seen in both directions
+			Collapses.clear();
+			for (size_t i = 0; i < Result.size(); i += 3)
+			{
+				for (size_t e = 0; e < 3; ++e)
+				{
+					u32 From = Result[i + e], To = Result[i + (e + 1) % 3];
+					if (Locked[Canonical[From]] || Canonical[From] == Canonical[To])
+					{
+						continue;
+					}
+
+					// To does not move, only the planes of From are new to it
+					f32 Distance = VertexErrors[Canonical[To]];
+					for (u32 Plane : VertexPlanes[Canonical[From]])
+					{
+						Distance = std::max(Distance, DistanceToPlane(Planes[Plane], Position(To)));
+					}
+					if (Distance > MaxError)
+					{
+						continue;
+					}
+
+					Quadric Q = Quadrics[Canonical[From]];
+					Q.Add(Quadrics[Canonical[To]]);
+					Collapses.push_back({ Q.Evaluate(Position(To)), Distance, From, To });
+				}
+			}
+			std::ranges::sort(
+				Collapses,
+				[](const EdgeCollapse& a, const EdgeCollapse& b)
+				{
+					return a.Cost < b.Cost;
+				});
+
+			// Cheapest first, a collapse touches the triangles around From so those vertices sit out the rest of the pass
+			std::ranges::fill(Touched, u8(0));
+			std::iota(Remap.begin(), Remap.end(), 0u);
+			const size_t TargetNumTriangles = TargetNumIndices / 3;
+			size_t		 NumTriangles		= Result.size() / 3;
+			u32			 NumCollapses		= 0;
+			for (const EdgeCollapse& Collapse : Collapses)
+			{
+				if (NumTriangles <= TargetNumTriangles)
+				{
+					break;
+				}
+				if (Touched[Collapse.From] || Touched[Collapse.To] || Flips(Collapse.From, Collapse.To))
+				{
+					continue;
+				}
+
+				for (u32 i = TriangleOffsets[Collapse.From]; i < TriangleOffsets[Collapse.From + 1]; ++i)
+				{
+					const u32* Triangle = &Result[Triangles[i] * 3];
+					if (Triangle[0] == Collapse.To || Triangle[1] == Collapse.To || Triangle[2] == Collapse.To)
+					{
+						--NumTriangles;
+					}
+					Touched[Triangle[0]] = Touched[Triangle[1]] = Touched[Triangle[2]] = 1;
+				}
+
+				Remap[Collapse.From] = Collapse.To;
+				Quadrics[Canonical[Collapse.To]].Add(Quadrics[Canonical[Collapse.From]]);
+
+				std::vector<u32>& ToPlanes	 = VertexPlanes[Canonical[Collapse.To]];
+				std::vector<u32>& FromPlanes = VertexPlanes[Canonical[Collapse.From]];
+				ToPlanes.insert(ToPlanes.end(), FromPlanes.begin(), FromPlanes.end());
+				std::ranges::sort(ToPlanes);
+				ToPlanes.erase(std::unique(ToPlanes.begin(), ToPlanes.end()), ToPlanes.end());
+				FromPlanes = {};
+
+				// Wedges of a seam share the planes of their position but may each be collapsed onto in one pass
+				VertexErrors[Canonical[Collapse.To]] = std::max(VertexErrors[Canonical[Collapse.To]], Collapse.Distance);
+				Error								 = std::max(Error, Collapse.Distance);
+				++NumCollapses;
+			}
+
+			if (NumCollapses == 0)
+			{
+				break;
+			}
+
+			size_t Count = 0;
+			for (size_t i = 0; i < Result.size(); i += 3)
+			{
+				u32 a = Remap[Result[i + 0]], b = Remap[Result[i + 1]], c = Remap[Result[i + 2]];
+				if (a != b && b != c && a != c)
+				{
+					Result[Count++] = a;
+					Result[Count++] = b;
+					Result[Count++] = c;
+				}
+			}
+			Result.resize(Count);
+
+			if (Stats)
+			{
+				Stats->NumPasses++;
+				Stats->NumCollapses += NumCollapses;
+			}
+		}
+
+		return Error;
+	}
+} // namespace Asset
@@ -0,0 +1,39 @@
+#pragma once
+#include "System/System.h"
+#include "Core/World/Vertex.h"
+
+namespace Asset
+{
+	// A coarser level of detail of a mesh, it indexes the same vertices as the full detail mesh
+	struct MeshLod
+	{
+		u32 IndexOffset; // Into the concatenated LOD indices
+		u32 NumIndices;
+		f32 Error; // Largest distance of its vertices to the full detail triangles they replace, in mesh units
+	};
+
+	struct MeshSimplificationStats
+	{
+		u32 NumPasses	 = 0;
+		u32 NumCollapses = 0;
+	};
+
+	class MeshSimplifier
+	{
+	public:
+		static constexpr u32 MaxLods = 8;
+
+		// Quadric error (Garland-Heckbert) half-edge collapse towards TargetNumIndices, collapses whose error stays
+		// within MaxError are performed cheapest first in passes of independent edges until the target is reached. The
+		// error of a collapse is the largest distance of the vertex it keeps to the planes of the input triangles merged
+		// into it. Vertices are never moved or created so the result indexes the input vertex buffer. Seams and borders
+		// are kept in place. Returns the largest error (distance in mesh units) of any performed collapse
+		static f32 Simplify(
+			Span<const Vertex>		 Vertices,
+			Span<const u32>			 Indices,
+			size_t					 TargetNumIndices,
+			f32						 MaxError,
+			std::vector<u32>&		 Result,
+			MeshSimplificationStats* Stats = nullptr);
+	};
+} // namespace Asset
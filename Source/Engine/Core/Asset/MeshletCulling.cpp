@@ -0,0 +1,101 @@
+#include "MeshletCulling.h"
+#include <DirectXPackedVector.h>
+
+using namespace DirectX;
+
+namespace Asset
+{
+	void MeshletCulling::Cull(
+		Span<const DirectX::CullData> CullData,
+		const XMFLOAT4X4&			  World,
+		const Math::Frustum&		  Frustum,
+		const XMFLOAT3&				  CameraPosition,
+		std::vector<u32>&			  Visible,
+		MeshletCullStats&			  Stats)
+	{
+		const i64 Start = Stopwatch::GetTimestamp();
+
+		XMMATRIX Matrix = XMLoadFloat4x4(&World);
+		XMVECTOR Eye	= XMLoadFloat3(&CameraPosition);
+		f32		 Scale	= std::max({
+			 XMVectorGetX(XMVector3Length(Matrix.r[0])),
+			 XMVectorGetX(XMVector3Length(Matrix.r[1])),
+			 XMVectorGetX(XMVector3Length(Matrix.r[2])),
+		 });
+
+		for (u32 i = 0; i < static_cast<u32>(CullData.size()); ++i)
+		{
+			const DirectX::CullData& Data = CullData[i];
+
+			XMVECTOR Center = XMVector3TransformCoord(XMLoadFloat3(&Data.BoundingSphere.Center), Matrix);
+			f32		 Radius = Data.BoundingSphere.Radius * Scale;
+
+			XMFLOAT3 WorldCenter;
+			XMStoreFloat3(&WorldCenter, Center);
+			if (!Frustum.Intersects(Math::Vec3f(WorldCenter.x, WorldCenter.y, WorldCenter.z), Radius))
+			{
+				Stats.NumFrustumCulled++;
+				continue;
+			}
+
+			// Cone axis and cutoff are unorm packed, the axis remapped from [-1, 1]. A cutoff of 1 marks a degenerate cone.
+			// The meshlet faces away if the view direction from the cone apex is within the cone around -axis
+			if ((Data.NormalCone.v >> 24) != 0xff)
+			{
+				XMVECTOR Cone = PackedVector::XMLoadUByteN4(&Data.NormalCone);
+				XMVECTOR Axis = XMVector3Normalize(XMVector3TransformNormal(Cone * 2.0f - XMVectorSplatOne(), Matrix));
+				XMVECTOR Apex = Center - Axis * (Data.ApexOffset * Scale);
+				XMVECTOR View = XMVector3Normalize(Eye - Apex);
+				if (XMVectorGetX(XMVector3Dot(View, -Axis)) > XMVectorGetW(Cone))
+				{
+					Stats.NumConeCulled++;
+					continue;
+				}
+			}
+
+			Visible.push_back(i);
+		}
+
+		Stats.NumMeshlets += CullData.size();
+		Stats.Ticks += Stopwatch::GetTimestamp() - Start;
+	}
+
+	MeshletCullStats MeshletCulling::Benchmark(Span<const DirectX::CullData> CullData, const Math::BoundingBox& BoundingBox)
+	{
+		static constexpr XMFLOAT3 Directions[] = {
+			{ +1.0f, 0.0f, 0.0f },
+			{ -1.0f, 0.0f, 0.0f },
+			{ 0.0f, +1.0f, 0.0f },
+			{ 0.0f, -1.0f, 0.0f },
+			{ 0.0f, 0.0f, +1.0f },
+			{ 0.0f, 0.0f, -1.0f },
+		};
+
+		XMFLOAT4X4 Identity;
+		XMStoreFloat4x4(&Identity, XMMatrixIdentity());
+
+		// 60 degree views from just outside of the bounding sphere, the mesh covers most of the view so frustum culling
+		// only rejects the meshlets near the silhouette
+		const f32		 Radius = std::max(Math::length(BoundingBox.Extents), 1e-3f);
+		XMVECTOR		 Target = XMVectorSet(BoundingBox.Center.x, BoundingBox.Center.y, BoundingBox.Center.z, 1.0f);
+		MeshletCullStats Stats;
+		std::vector<u32> Visible;
+		Visible.reserve(CullData.size());
+		for (const XMFLOAT3& Direction : Directions)
+		{
+			XMVECTOR Eye  = Target + XMLoadFloat3(&Direction) * (1.5f * Radius);
+			XMVECTOR Up	  = std::abs(Direction.y) > 0.0f ? XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f) : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+			XMMATRIX View = XMMatrixLookAtLH(Eye, Target, Up);
+			XMMATRIX Proj = XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 1.0f, 0.01f * Radius, 4.0f * Radius);
+
+			XMFLOAT4X4 ViewProjection;
+			XMStoreFloat4x4(&ViewProjection, View * Proj);
+			XMFLOAT3 CameraPosition;
+			XMStoreFloat3(&CameraPosition, Eye);
+
+			Visible.clear();
+			Cull(CullData, Identity, Math::Frustum(ViewProjection), CameraPosition, Visible, Stats);
+		}
+		return Stats;
+	}
+} // namespace Asset
@@ -0,0 +1,42 @@
+#pragma once
+#include "System/System.h"
+#include "Math/Math.h"
+#include <DirectXMesh.h>
+
+namespace Asset
+{
+	struct MeshletCullStats
+	{
+		u64 NumMeshlets		 = 0;
+		u64 NumFrustumCulled = 0;
+		u64 NumConeCulled	 = 0;
+		i64 Ticks			 = 0;
+
+		MeshletCullStats& operator+=(const MeshletCullStats& Other)
+		{
+			NumMeshlets += Other.NumMeshlets;
+			NumFrustumCulled += Other.NumFrustumCulled;
+			NumConeCulled += Other.NumConeCulled;
+			Ticks += Other.Ticks;
+			return *this;
+		}
+	};
+
+	class MeshletCulling
+	{
+	public:
+		// Appends the index of every meshlet that is inside of Frustum (world space, built from a view projection matrix) and
+		// has at least one triangle that may face CameraPosition to Visible. World places the mesh, its scale must be uniform
+		// for the normal cones to stay exact
+		static void Cull(
+			Span<const DirectX::CullData> CullData,
+			const DirectX::XMFLOAT4X4&	  World,
+			const Math::Frustum&		  Frustum,
+			const DirectX::XMFLOAT3&	  CameraPosition,
+			std::vector<u32>&			  Visible,
+			MeshletCullStats&			  Stats);
+
+		// Culls the meshlets of a mesh from six views around its bounding box, one along every axis looking at the center
+		[[nodiscard]] static MeshletCullStats Benchmark(Span<const DirectX::CullData> CullData, const Math::BoundingBox& BoundingBox);
+	};
+} // namespace Asset
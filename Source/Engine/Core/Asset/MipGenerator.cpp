@@ -0,0 +1,301 @@
+#include "MipGenerator.h"
+#include <DirectXMath.h>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace Asset
+{
+	// Rows of a mip handed out per ParallelFor index, the rows of the level above they share are filtered once per block
+	constexpr size_t MipRowBlockSize = 16;
+
+	// Kaiser window of the usual mip filter (as in NVTT), Width is in texels of the mip
+	constexpr f64 KaiserWidth = 3.0;
+	constexpr f64 KaiserAlpha = 4.0;
+
+	// Points every source texel is sampled at when it is weighed, so a box that covers part of a texel weighs that part
+	constexpr u32 FilterSamples = 8;
+
+	// The source texels one texel of a mip is made of along an axis, consecutive and inside the source
+	struct FilterTaps
+	{
+		u32 First;
+		u32 Count;
+		u32 Offset; // Of their weights in AxisFilter::Weights
+	};
+
+	struct AxisFilter
+	{
+		std::vector<FilterTaps> Taps; // Per texel of the mip
+		std::vector<f32>		Weights;
+	};
+
+	static f64 BesselI0(f64 x)
+	{
+		f64 Sum	 = 1.0;
+		f64 Term = 1.0;
+		for (u32 k = 1; k < 64 && Term > Sum * 1e-12; ++k)
+		{
+			const f64 Half = x / (2.0 * k);
+			Term *= Half * Half;
+			Sum += Term;
+		}
+		return Sum;
+	}
+
+	// x is the distance from the center of the mip texel, in texels of the mip
+	static f64 EvaluateFilter(MipFilter Filter, f64 x)
+	{
+		switch (Filter)
+		{
+		case MipFilter::Box:
+			return std::abs(x) <= 0.5 ? 1.0 : 0.0;
+		case MipFilter::Kaiser:
+		{
+			const f64 t = x / (KaiserWidth * 0.5);
+			if (std::abs(t) >= 1.0)
+			{
+				return 0.0;
+			}
+			const f64 Sinc = std::abs(x) < 1e-6 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+			return Sinc * BesselI0(KaiserAlpha * std::sqrt(1.0 - t * t)) / BesselI0(KaiserAlpha);
+		}
+		}
+		return 0.0;
+	}
+
+	static AxisFilter BuildFilter(MipFilter Filter, u32 SourceSize, u32 Size)
+	{
+		const f64 Scale	 = static_cast<f64>(SourceSize) / static_cast<f64>(Size);
+		const f64 Radius = (Filter == MipFilter::Kaiser ? KaiserWidth * 0.5 : 0.5) * Scale;
+
+		AxisFilter Result;
+		Result.Taps.resize(Size);
+		std::vector<f64> Weights;
+		for (u32 i = 0; i < Size; ++i)
+		{
+			const f64 Center = (i + 0.5) * Scale;
+			const i64 Begin	 = static_cast<i64>(std::floor(Center - Radius));
+			const i64 End	 = static_cast<i64>(std::ceil(Center + Radius));
+
+			// Texels past the edges are the edge texels
+			const i64 First = std::clamp<i64>(Begin, 0, SourceSize - 1);
+			const i64 Last	= std::clamp<i64>(End - 1, 0, SourceSize - 1);
+			Weights.assign(Last - First + 1, 0.0);
+			f64 Sum = 0.0;
+			for (i64 j = Begin; j < End; ++j)
+			{
+				f64 Weight = 0.0;
+				for (u32 s = 0; s < FilterSamples; ++s)
+				{
+					const f64 Position = static_cast<f64>(j) + (s + 0.5) / FilterSamples;
+					Weight += EvaluateFilter(Filter, (Position - Center) / Scale);
+				}
+				Weights[std::clamp<i64>(j, First, Last) - First] += Weight;
+				Sum += Weight;
+			}
+
+			Result.Taps[i] = { static_cast<u32>(First), static_cast<u32>(Weights.size()), static_cast<u32>(Result.Weights.size()) };
+			for (f64 Weight : Weights)
+			{
+				Result.Weights.push_back(static_cast<f32>(Weight / Sum));
+			}
+		}
+		return Result;
+	}
+
+	static f32 SrgbToLinear(f32 Value)
+	{
+		return Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	// Buckets of linear values EncodeSrgb starts its search from
+	constexpr u32 SrgbEncodeBuckets = 4096;
+
+	struct SrgbTables
+	{
+		std::array<f32, 256>			  ToLinear;	  // Of every 8 bit sRGB value
+		std::array<f32, 255>			  Thresholds; // Linear value halfway between every two consecutive 8 bit sRGB values
+		std::array<u8, SrgbEncodeBuckets> Codes;	  // 8 bit sRGB value of the bottom of every bucket
+	};
+
+	static const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables Tables = []
+		{
+			SrgbTables Tables;
+			for (u32 i = 0; i < 256; ++i)
+			{
+				Tables.ToLinear[i] = SrgbToLinear(static_cast<f32>(i) / 255.0f);
+			}
+			for (u32 i = 0; i < 255; ++i)
+			{
+				Tables.Thresholds[i] = SrgbToLinear((static_cast<f32>(i) + 0.5f) / 255.0f);
+			}
+			u32 Code = 0;
+			for (u32 i = 0; i < SrgbEncodeBuckets; ++i)
+			{
+				while (Code < 255 && static_cast<f32>(i) / SrgbEncodeBuckets >= Tables.Thresholds[Code])
+				{
+					Code++;
+				}
+				Tables.Codes[i] = static_cast<u8>(Code);
+			}
+			return Tables;
+		}();
+		return Tables;
+	}
+
+	// Rounds a linear value in [0, 1] to the nearest 8 bit sRGB value without pow: a linear value encodes to the number of
+	// thresholds it is not below. The buckets are narrower than the narrowest step between thresholds (next to 0), so
+	// at most one of them is above the start
+	static u8 EncodeSrgb(const SrgbTables& Tables, f32 Linear)
+	{
+		u32 Code = Tables.Codes[std::min(static_cast<u32>(Linear * SrgbEncodeBuckets), SrgbEncodeBuckets - 1)];
+		while (Code < 255 && Linear >= Tables.Thresholds[Code])
+		{
+			Code++;
+		}
+		return static_cast<u8>(Code);
+	}
+
+	u32 MipGenerator::GetNumLevels(u32 Width, u32 Height)
+	{
+		u32 NumLevels = 1;
+		while (Width > 1 || Height > 1)
+		{
+			Width  = std::max(Width / 2, 1u);
+			Height = std::max(Height / 2, 1u);
+			NumLevels++;
+		}
+		return NumLevels;
+	}
+
+	void MipGenerator::Generate(const DecodedImage& Base, bool sRGB, MipFilter Filter, std::vector<DecodedImage>& Mips)
+	{
+		using namespace DirectX;
+
+		Mips.clear();
+		if (Base.Width == 0 || Base.Height == 0)
+		{
+			return;
+		}
+
+		const SrgbTables&	 Srgb = GetSrgbTables();
+		std::array<f32, 256> UnormToFloat;
+		for (u32 i = 0; i < 256; ++i)
+		{
+			UnormToFloat[i] = static_cast<f32>(i) / 255.0f;
+		}
+		const std::array<f32, 256>& ColorToLinear = sRGB ? Srgb.ToLinear : UnormToFloat;
+
+		// Linear texels of the level the next mip is filtered from, empty for the base level which is read as it is
+		std::vector<XMFLOAT4A> Source;
+		u32					   SourceWidth	= Base.Width;
+		u32					   SourceHeight = Base.Height;
+		const u32			   NumLevels	= GetNumLevels(Base.Width, Base.Height);
+		for (u32 Level = 1; Level < NumLevels; ++Level)
+		{
+			const u32		 Width		= std::max(SourceWidth / 2, 1u);
+			const u32		 Height		= std::max(SourceHeight / 2, 1u);
+			const AxisFilter Horizontal = BuildFilter(Filter, SourceWidth, Width);
+			const AxisFilter Vertical	= BuildFilter(Filter, SourceHeight, Height);
+
+			DecodedImage& Mip = Mips.emplace_back();
+			Mip.Width		  = Width;
+			Mip.Height		  = Height;
+			Mip.IsFloat		  = Base.IsFloat;
+			Mip.Pixels.resize(Mip.GetRowPitch() * Height);
+
+			std::vector<XMFLOAT4A> Destination(size_t(Width) * Height);
+			ParallelFor(
+				Process::GetThreadPool(),
+				(Height + MipRowBlockSize - 1) / MipRowBlockSize,
+				[&](size_t Block)
+				{
+					const u32 FirstRow	= static_cast<u32>(Block * MipRowBlockSize);
+					const u32 EndRow	= std::min(static_cast<u32>(FirstRow + MipRowBlockSize), Height);
+					const u32 FirstTap	= Vertical.Taps[FirstRow].First;
+					const u32 EndTap	= Vertical.Taps[EndRow - 1].First + Vertical.Taps[EndRow - 1].Count;
+
+					// Source rows of the block filtered horizontally, to the width of the mip
+					std::vector<XMFLOAT4A> Rows(size_t(EndTap - FirstTap) * Width);
+					std::vector<XMFLOAT4A> Converted(Source.empty() ? SourceWidth : 0);
+					for (u32 y = FirstTap; y < EndTap; ++y)
+					{
+						const XMFLOAT4A* Row = nullptr;
+						if (!Source.empty())
+						{
+							Row = &Source[size_t(y) * SourceWidth];
+						}
+						else
+						{
+							const u8* Pixels = &Base.Pixels[y * Base.GetRowPitch()];
+							for (u32 x = 0; x < SourceWidth; ++x)
+							{
+								if (Base.IsFloat)
+								{
+									XMStoreFloat4A(&Converted[x], XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(Pixels + x * 16)));
+								}
+								else
+								{
+									const u8* Pixel = Pixels + x * 4;
+									Converted[x]	= { ColorToLinear[Pixel[0]], ColorToLinear[Pixel[1]], ColorToLinear[Pixel[2]], UnormToFloat[Pixel[3]] };
+								}
+							}
+							Row = Converted.data();
+						}
+
+						XMFLOAT4A* Filtered = &Rows[size_t(y - FirstTap) * Width];
+						for (u32 x = 0; x < Width; ++x)
+						{
+							const FilterTaps& Taps	 = Horizontal.Taps[x];
+							const f32*		  Weight = &Horizontal.Weights[Taps.Offset];
+							XMVECTOR		  Sum	 = XMVectorZero();
+							for (u32 t = 0; t < Taps.Count; ++t)
+							{
+								Sum = XMVectorMultiplyAdd(XMLoadFloat4A(&Row[Taps.First + t]), XMVectorReplicate(Weight[t]), Sum);
+							}
+							XMStoreFloat4A(&Filtered[x], Sum);
+						}
+					}
+
+					for (u32 y = FirstRow; y < EndRow; ++y)
+					{
+						const FilterTaps& Taps	 = Vertical.Taps[y];
+						const f32*		  Weight = &Vertical.Weights[Taps.Offset];
+						u8*				  Pixels = &Mip.Pixels[y * Mip.GetRowPitch()];
+						for (u32 x = 0; x < Width; ++x)
+						{
+							XMVECTOR Sum = XMVectorZero();
+							for (u32 t = 0; t < Taps.Count; ++t)
+							{
+								const XMFLOAT4A& Texel = Rows[size_t(Taps.First + t - FirstTap) * Width + x];
+								Sum					   = XMVectorMultiplyAdd(XMLoadFloat4A(&Texel), XMVectorReplicate(Weight[t]), Sum);
+							}
+							Sum = Base.IsFloat ? XMVectorMax(Sum, XMVectorZero()) : XMVectorSaturate(Sum);
+							XMStoreFloat4A(&Destination[size_t(y) * Width + x], Sum);
+
+							if (Base.IsFloat)
+							{
+								XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(Pixels + x * 16), Sum);
+								continue;
+							}
+							const XMFLOAT4A& Texel = Destination[size_t(y) * Width + x];
+							u8*				 Pixel = Pixels + x * 4;
+							const f32		 Color[3] = { Texel.x, Texel.y, Texel.z };
+							for (u32 c = 0; c < 3; ++c)
+							{
+								Pixel[c] = sRGB ? EncodeSrgb(Srgb, Color[c]) : static_cast<u8>(Color[c] * 255.0f + 0.5f);
+							}
+							Pixel[3] = static_cast<u8>(Texel.w * 255.0f + 0.5f);
+						}
+					}
+				});
+
+			Source		 = std::move(Destination);
+			SourceWidth	 = Width;
+			SourceHeight = Height;
+		}
+	}
+} // namespace Asset
@@ -0,0 +1,29 @@
+#pragma once
+#include "ImageDecoder.h"
+
+namespace Asset
+{
+	// How a mip is filtered from the level above it
+	enum class MipFilter : u8
+	{
+		Box,   // Average of the texels it covers
+		Kaiser // Kaiser windowed sinc 3 texels of the mip wide, sharper than Box
+	};
+
+	// Generates the mip chain of decoded images without DirectXTex. Every level is filtered from the previous one in
+	// linear space: sRGB color channels are converted to linear light before filtering and back after it, alpha is always
+	// linear. The filter is separable, every block of rows of a mip filters the rows of the level above it it needs
+	// horizontally and then sums them vertically, blocks in parallel with 4 channel SIMD (XMVECTOR) accumulation. Mips are
+	// half the size of the level above, rounded down, until both sides are 1. Edges are clamped
+	class MipGenerator
+	{
+	public:
+		// Of a full chain, including the base level
+		[[nodiscard]] static u32 GetNumLevels(u32 Width, u32 Height);
+
+		// Replaces Mips with every level below Base, in the format of Base. LDR results are clamped to [0, 1] and HDR ones
+		// to positive values, Kaiser's negative lobes could make them overshoot. Uses ParallelFor, so it must not be called
+		// from a thread pool thread
+		static void Generate(const DecodedImage& Base, bool sRGB, MipFilter Filter, std::vector<DecodedImage>& Mips);
+	};
+} // namespace Asset
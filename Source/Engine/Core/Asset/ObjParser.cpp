@@ -0,0 +1,602 @@
+#include "ObjParser.h"
+#include <charconv>
+#include <limits>
+#include <unordered_map>
+
+namespace Asset
+{
+	// Indices are 0-based once resolved, relative ones (negative in the file) are relative to the chunk's first element
+	// until the chunks are merged
+	struct ObjCorner
+	{
+		static constexpr i32 None = INT32_MIN;
+
+		i32 Position;
+		i32 TexCoord;
+		i32 Normal;
+
+		bool operator==(const ObjCorner&) const = default;
+	};
+
+	struct ObjCornerHash
+	{
+		size_t operator()(const ObjCorner& Corner) const noexcept
+		{
+			u64 Seed = static_cast<u32>(Corner.Position) * 0x9E3779B97F4A7C15ull;
+			Seed ^= (static_cast<u32>(Corner.TexCoord) + (Seed << 6) + (Seed >> 2)) * 0xC2B2AE3D27D4EB4Full;
+			Seed ^= (static_cast<u32>(Corner.Normal) + (Seed << 6) + (Seed >> 2)) * 0x165667B19E3779F9ull;
+			return static_cast<size_t>(Seed ^ (Seed >> 29));
+		}
+	};
+
+	// An o/g or usemtl line, takes effect from Triangle on
+	struct ObjGroupChange
+	{
+		u32			Triangle;
+		bool		Object;
+		std::string Name;
+	};
+
+	struct ObjChunk
+	{
+		std::string_view Text;
+
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT2> TexCoords;
+		std::vector<DirectX::XMFLOAT3> Normals;
+		std::vector<ObjCorner>		   Corners; // 3 per triangle
+
+		// Corners with relative indices and which of their attributes are (1 position, 2 texcoord, 4 normal)
+		std::vector<std::pair<u32, u8>> RelativeCorners;
+		std::vector<ObjGroupChange>		Changes;
+
+		u64	 FirstPosition = 0;
+		u64	 FirstTexCoord = 0;
+		u64	 FirstNormal   = 0;
+		bool Valid		   = true;
+	};
+
+	// Triangles [FirstTriangle, FirstTriangle + NumTriangles) of a chunk belong to a mesh
+	struct ObjRun
+	{
+		u32 Chunk;
+		u32 FirstTriangle;
+		u32 NumTriangles;
+	};
+
+	static bool IsSpace(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	static bool IsDigit(char c) noexcept
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	static const char* SkipSpaces(const char* p, const char* End) noexcept
+	{
+		while (p < End && IsSpace(*p))
+		{
+			++p;
+		}
+		return p;
+	}
+
+	// A mantissa below 2^53 and a power of ten up to 1e22 are both exact in double, so scaling them rounds only once. Everything
+	// else (long mantissas, large exponents, inf/nan) goes through std::from_chars
+	static const char* ParseFloat(const char* p, const char* End, f32& Value) noexcept
+	{
+		static constexpr f64 Powers[] = { 1e0,	1e1,  1e2,	1e3,  1e4,	1e5,  1e6,	1e7,  1e8,	1e9,  1e10, 1e11,
+										  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		const char* Start	 = p;
+		bool		Negative = false;
+		if (p < End && (*p == '-' || *p == '+'))
+		{
+			Negative = *p++ == '-';
+		}
+
+		u64	 Mantissa  = 0;
+		i32	 Exponent  = 0;
+		i32	 NumDigits = 0; // Significant ones
+		bool Truncated = false;
+		bool AnyDigits = false;
+		for (; p < End && IsDigit(*p); ++p)
+		{
+			AnyDigits = true;
+			if (NumDigits < 19)
+			{
+				Mantissa = Mantissa * 10 + (*p - '0');
+				NumDigits += Mantissa != 0;
+			}
+			else
+			{
+				Exponent++;
+				Truncated = true;
+			}
+		}
+		if (p < End && *p == '.')
+		{
+			for (++p; p < End && IsDigit(*p); ++p)
+			{
+				AnyDigits = true;
+				if (NumDigits < 19)
+				{
+					Mantissa = Mantissa * 10 + (*p - '0');
+					NumDigits += Mantissa != 0;
+					Exponent--;
+				}
+				else
+				{
+					Truncated = true;
+				}
+			}
+		}
+		if (AnyDigits && p < End && (*p == 'e' || *p == 'E'))
+		{
+			const char* q			= p + 1;
+			bool		NegativeExp = false;
+			if (q < End && (*q == '-' || *q == '+'))
+			{
+				NegativeExp = *q++ == '-';
+			}
+			if (q < End && IsDigit(*q))
+			{
+				i32 Value = 0;
+				for (; q < End && IsDigit(*q); ++q)
+				{
+					Value = std::min(Value * 10 + (*q - '0'), 100000);
+				}
+				Exponent += NegativeExp ? -Value : Value;
+				p = q;
+			}
+		}
+
+		if (AnyDigits && !Truncated && Mantissa <= (1ull << 53) && Exponent >= -22 && Exponent <= 22)
+		{
+			f64 Result = static_cast<f64>(Mantissa);
+			Result	   = Exponent < 0 ? Result / Powers[-Exponent] : Result * Powers[Exponent];
+			Value	   = static_cast<f32>(Negative ? -Result : Result);
+			return p;
+		}
+
+		// from_chars does not take a leading '+'
+		const char* First  = Start < End && *Start == '+' ? Start + 1 : Start;
+		auto [Ptr, Error] = std::from_chars(First, End, Value);
+		if (Error == std::errc::result_out_of_range)
+		{
+			// Saturate like strtof, the magnitude is about 10^(NumDigits + Exponent)
+			const bool Overflow = NumDigits + Exponent > 0;
+			Value				= Overflow ? std::numeric_limits<f32>::infinity() : 0.0f;
+			Value				= Negative ? -Value : Value;
+			return Ptr;
+		}
+		return Error == std::errc() ? Ptr : nullptr;
+	}
+
+	static const char* ParseInteger(const char* p, const char* End, i64& Value) noexcept
+	{
+		bool Negative = false;
+		if (p < End && (*p == '-' || *p == '+'))
+		{
+			Negative = *p++ == '-';
+		}
+		if (p >= End || !IsDigit(*p))
+		{
+			return nullptr;
+		}
+
+		Value = 0;
+		for (; p < End && IsDigit(*p); ++p)
+		{
+			Value = std::min<i64>(Value * 10 + (*p - '0'), INT32_MAX);
+		}
+		Value = Negative ? -Value : Value;
+		return p;
+	}
+
+	template<size_t N>
+	static const char* ParseFloats(const char* p, const char* End, f32 (&Values)[N]) noexcept
+	{
+		for (size_t i = 0; i < N && p; ++i)
+		{
+			p = ParseFloat(SkipSpaces(p, End), End, Values[i]);
+		}
+		return p;
+	}
+
+	static bool StartsWith(const char* p, const char* End, std::string_view Keyword) noexcept
+	{
+		return static_cast<size_t>(End - p) > Keyword.size() && std::string_view(p, Keyword.size()) == Keyword &&
+			   IsSpace(p[Keyword.size()]);
+	}
+
+	static std::string_view ParseName(const char* p, const char* End) noexcept
+	{
+		p				 = SkipSpaces(p, End);
+		const char* Last = End;
+		while (Last > p && IsSpace(Last[-1]))
+		{
+			--Last;
+		}
+		return { p, static_cast<size_t>(Last - p) };
+	}
+
+	static void ParseChunk(ObjChunk& Chunk)
+	{
+		std::vector<ObjCorner> Polygon;
+		std::vector<u8>		   PolygonMasks;
+
+		const char* p	= Chunk.Text.data();
+		const char* End = p + Chunk.Text.size();
+		while (p < End && Chunk.Valid)
+		{
+			const char* LineEnd = static_cast<const char*>(memchr(p, '\n', End - p));
+			LineEnd				= LineEnd ? LineEnd : End;
+
+			const char* Line = SkipSpaces(p, LineEnd);
+			p				 = LineEnd + 1;
+			if (Line == LineEnd)
+			{
+				continue;
+			}
+
+			if (Line[0] == 'v' && Line + 1 < LineEnd && IsSpace(Line[1]))
+			{
+				f32 Values[3];
+				Chunk.Valid = ParseFloats(Line + 1, LineEnd, Values) != nullptr;
+				Chunk.Positions.push_back({ Values[0], Values[1], Values[2] });
+			}
+			else if (StartsWith(Line, LineEnd, "vt"))
+			{
+				// The second coordinate is optional
+				f32			Values[2] = {};
+				const char* Next	  = ParseFloat(SkipSpaces(Line + 2, LineEnd), LineEnd, Values[0]);
+				Chunk.Valid			  = Next != nullptr;
+				if (Next && SkipSpaces(Next, LineEnd) != LineEnd)
+				{
+					Chunk.Valid = ParseFloat(SkipSpaces(Next, LineEnd), LineEnd, Values[1]) != nullptr;
+				}
+				Chunk.TexCoords.push_back({ Values[0], Values[1] });
+			}
+			else if (StartsWith(Line, LineEnd, "vn"))
+			{
+				f32 Values[3];
+				Chunk.Valid = ParseFloats(Line + 2, LineEnd, Values) != nullptr;
+				Chunk.Normals.push_back({ Values[0], Values[1], Values[2] });
+			}
+			else if (Line[0] == 'f' && Line + 1 < LineEnd && IsSpace(Line[1]))
+			{
+				Polygon.clear();
+				PolygonMasks.clear();
+
+				const char* q = SkipSpaces(Line + 1, LineEnd);
+				while (q < LineEnd && Chunk.Valid)
+				{
+					// v, v/vt, v//vn or v/vt/vn
+					i64		  Indices[3] = { 0, 0, 0 };
+					for (u32 Attribute = 0; Attribute < 3 && q; ++Attribute)
+					{
+						if (Attribute > 0)
+						{
+							if (q >= LineEnd || *q != '/')
+							{
+								break;
+							}
+							++q;
+							if (q < LineEnd && *q == '/')
+							{
+								continue;
+							}
+						}
+						q = ParseInteger(q, LineEnd, Indices[Attribute]);
+					}
+					if (!q || Indices[0] == 0)
+					{
+						Chunk.Valid = false;
+						break;
+					}
+
+					u8	 Mask	 = 0;
+					auto Resolve = [&](i64 Index, size_t NumLocal, u8 Bit) -> i32
+					{
+						if (Index == 0)
+						{
+							return ObjCorner::None;
+						}
+						if (Index > 0)
+						{
+							return static_cast<i32>(Index - 1);
+						}
+						Mask |= Bit;
+						return static_cast<i32>(static_cast<i64>(NumLocal) + Index);
+					};
+					Polygon.push_back({
+						.Position = Resolve(Indices[0], Chunk.Positions.size(), 1),
+						.TexCoord = Resolve(Indices[1], Chunk.TexCoords.size(), 2),
+						.Normal	  = Resolve(Indices[2], Chunk.Normals.size(), 4),
+					});
+					PolygonMasks.push_back(Mask);
+					q = SkipSpaces(q, LineEnd);
+				}
+
+				// Fan, polygons are expected to be convex
+				for (size_t i = 2; i < Polygon.size() && Chunk.Valid; ++i)
+				{
+					for (size_t Corner : { size_t(0), i - 1, i })
+					{
+						if (PolygonMasks[Corner])
+						{
+							Chunk.RelativeCorners.emplace_back(static_cast<u32>(Chunk.Corners.size()), PolygonMasks[Corner]);
+						}
+						Chunk.Corners.push_back(Polygon[Corner]);
+					}
+				}
+			}
+			else if ((Line[0] == 'o' || Line[0] == 'g') && (Line + 1 == LineEnd || IsSpace(Line[1])))
+			{
+				Chunk.Changes.push_back({ static_cast<u32>(Chunk.Corners.size() / 3), true, std::string(ParseName(Line + 1, LineEnd)) });
+			}
+			else if (StartsWith(Line, LineEnd, "usemtl"))
+			{
+				Chunk.Changes.push_back({ static_cast<u32>(Chunk.Corners.size() / 3), false, std::string(ParseName(Line + 6, LineEnd)) });
+			}
+		}
+	}
+
+	// Welds the corners of a mesh's triangles, flips it into the left handed layout
+	static void WeldMesh(
+		const std::vector<ObjChunk>&				  Chunks,
+		const std::vector<ObjRun>&					  Runs,
+		const std::vector<DirectX::XMFLOAT3>&		  Positions,
+		const std::vector<DirectX::XMFLOAT2>&		  TexCoords,
+		const std::vector<DirectX::XMFLOAT3>&		  Normals,
+		ObjMesh&									  Mesh)
+	{
+		using namespace DirectX;
+
+		size_t NumCorners = 0;
+		for (const ObjRun& Run : Runs)
+		{
+			NumCorners += static_cast<size_t>(Run.NumTriangles) * 3;
+		}
+		Mesh.Indices.reserve(NumCorners);
+
+		std::unordered_map<ObjCorner, u32, ObjCornerHash> Welded;
+		Welded.reserve(NumCorners / 2);
+
+		auto Emit = [&](const ObjCorner& Corner, const XMFLOAT3* FlatNormal) -> u32
+		{
+			Vertex& Result	  = Mesh.Vertices.emplace_back();
+			Result.Position	  = Positions[Corner.Position];
+			Result.Position.z = -Result.Position.z;
+			if (Corner.TexCoord != ObjCorner::None)
+			{
+				Result.TextureCoord = { TexCoords[Corner.TexCoord].x, 1.0f - TexCoords[Corner.TexCoord].y };
+			}
+			Result.Normal	= FlatNormal ? *FlatNormal : Normals[Corner.Normal];
+			Result.Normal.z = -Result.Normal.z;
+
+			return static_cast<u32>(Mesh.Vertices.size() - 1);
+		};
+
+		for (const ObjRun& Run : Runs)
+		{
+			const ObjCorner* Corners = Chunks[Run.Chunk].Corners.data() + static_cast<size_t>(Run.FirstTriangle) * 3;
+			for (u32 Triangle = 0; Triangle < Run.NumTriangles; ++Triangle, Corners += 3)
+			{
+				// Faces without normals are flat shaded, assimp's aiProcess_GenNormals does the same
+				XMFLOAT3 FlatNormal = {};
+				if (Corners[0].Normal == ObjCorner::None || Corners[1].Normal == ObjCorner::None || Corners[2].Normal == ObjCorner::None)
+				{
+					XMVECTOR A = XMLoadFloat3(&Positions[Corners[0].Position]);
+					XMVECTOR B = XMLoadFloat3(&Positions[Corners[1].Position]);
+					XMVECTOR C = XMLoadFloat3(&Positions[Corners[2].Position]);
+					XMStoreFloat3(&FlatNormal, XMVector3Normalize(XMVector3Cross(B - A, C - A)));
+				}
+
+				u32 Indices[3];
+				for (u32 i = 0; i < 3; ++i)
+				{
+					if (Corners[i].Normal == ObjCorner::None)
+					{
+						Indices[i] = Emit(Corners[i], &FlatNormal);
+					}
+					else if (auto [Iterator, Inserted] = Welded.try_emplace(Corners[i], 0); Inserted)
+					{
+						Iterator->second = Indices[i] = Emit(Corners[i], nullptr);
+					}
+					else
+					{
+						Indices[i] = Iterator->second;
+					}
+				}
+
+				// Reversed winding
+				Mesh.Indices.push_back(Indices[0]);
+				Mesh.Indices.push_back(Indices[2]);
+				Mesh.Indices.push_back(Indices[1]);
+			}
+		}
+	}
+
+	bool ObjParser::Parse(const std::filesystem::path& Path, std::vector<ObjMesh>& Meshes, ObjParseStats* Stats /*= nullptr*/)
+	{
+		MemoryMappedFile File(Path);
+		if (!File.IsValid())
+		{
+			return false;
+		}
+		return Parse(std::string_view(reinterpret_cast<const char*>(File.GetBaseAddress()), File.GetSizeInBytes()), Meshes, Stats);
+	}
+
+	bool ObjParser::Parse(std::string_view Text, std::vector<ObjMesh>& Meshes, ObjParseStats* Stats /*= nullptr*/)
+	{
+		constexpr size_t MinChunkSize = 1024 * 1024;
+
+		i64 Start = Stopwatch::GetTimestamp();
+
+		// A few chunks per thread so uneven ones balance out, every chunk ends after a newline
+		const size_t NumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		const size_t NumChunks	= std::clamp<size_t>(Text.size() / MinChunkSize, 1, NumThreads * 4);
+
+		std::vector<ObjChunk> Chunks;
+		Chunks.reserve(NumChunks);
+		size_t Offset = 0;
+		for (size_t i = 1; i <= NumChunks && Offset < Text.size(); ++i)
+		{
+			size_t ChunkEnd = i == NumChunks ? Text.size() : std::max(Text.size() * i / NumChunks, Offset);
+			ChunkEnd		= std::min(Text.find('\n', ChunkEnd), Text.size());
+			ChunkEnd		= std::min(ChunkEnd + 1, Text.size());
+			Chunks.emplace_back().Text = Text.substr(Offset, ChunkEnd - Offset);
+			Offset					   = ChunkEnd;
+		}
+
+		ParallelFor(
+			Process::GetThreadPool(),
+			Chunks.size(),
+			[&](size_t i)
+			{
+				ParseChunk(Chunks[i]);
+			});
+
+		i64 ParseEnd = Stopwatch::GetTimestamp();
+
+		u64 NumPositions = 0, NumTexCoords = 0, NumNormals = 0, NumTriangles = 0;
+		for (ObjChunk& Chunk : Chunks)
+		{
+			if (!Chunk.Valid)
+			{
+				return false;
+			}
+			Chunk.FirstPosition = NumPositions;
+			Chunk.FirstTexCoord = NumTexCoords;
+			Chunk.FirstNormal	= NumNormals;
+			NumPositions += Chunk.Positions.size();
+			NumTexCoords += Chunk.TexCoords.size();
+			NumNormals += Chunk.Normals.size();
+			NumTriangles += Chunk.Corners.size() / 3;
+		}
+		if (NumPositions > INT32_MAX || NumTexCoords > INT32_MAX || NumNormals > INT32_MAX)
+		{
+			return false;
+		}
+
+		std::vector<DirectX::XMFLOAT3> Positions(NumPositions);
+		std::vector<DirectX::XMFLOAT2> TexCoords(NumTexCoords);
+		std::vector<DirectX::XMFLOAT3> Normals(NumNormals);
+		std::atomic<bool>			   Valid = true;
+		ParallelFor(
+			Process::GetThreadPool(),
+			Chunks.size(),
+			[&](size_t i)
+			{
+				ObjChunk& Chunk = Chunks[i];
+				std::ranges::copy(Chunk.Positions, Positions.begin() + Chunk.FirstPosition);
+				std::ranges::copy(Chunk.TexCoords, TexCoords.begin() + Chunk.FirstTexCoord);
+				std::ranges::copy(Chunk.Normals, Normals.begin() + Chunk.FirstNormal);
+				decltype(Chunk.Positions)().swap(Chunk.Positions);
+				decltype(Chunk.TexCoords)().swap(Chunk.TexCoords);
+				decltype(Chunk.Normals)().swap(Chunk.Normals);
+
+				for (auto [Corner, Mask] : Chunk.RelativeCorners)
+				{
+					ObjCorner& Resolved = Chunk.Corners[Corner];
+					Resolved.Position += Mask & 1 ? static_cast<i32>(Chunk.FirstPosition) : 0;
+					Resolved.TexCoord += Mask & 2 ? static_cast<i32>(Chunk.FirstTexCoord) : 0;
+					Resolved.Normal += Mask & 4 ? static_cast<i32>(Chunk.FirstNormal) : 0;
+				}
+
+				auto InRange = [](i32 Index, u64 Count, bool Optional)
+				{
+					return (Optional && Index == ObjCorner::None) || (Index >= 0 && static_cast<u64>(Index) < Count);
+				};
+				for (const ObjCorner& Corner : Chunk.Corners)
+				{
+					if (!InRange(Corner.Position, NumPositions, false) || !InRange(Corner.TexCoord, NumTexCoords, true) ||
+						!InRange(Corner.Normal, NumNormals, true))
+					{
+						Valid = false;
+						return;
+					}
+				}
+			});
+		if (!Valid)
+		{
+			return false;
+		}
+
+		// Runs of triangles per (object, material), meshes in order of their first triangle
+		std::vector<std::vector<ObjRun>>		MeshRuns;
+		std::vector<std::string>				MeshNames;
+		std::unordered_map<std::string, size_t> MeshIndices;
+		std::string								Object, Material;
+		size_t									Current = SIZE_MAX;
+		auto									Select	= [&]()
+		{
+			auto [Iterator, Inserted] = MeshIndices.try_emplace(Object + '\0' + Material, MeshRuns.size());
+			if (Inserted)
+			{
+				MeshRuns.emplace_back();
+				MeshNames.push_back(Object);
+			}
+			Current = Iterator->second;
+		};
+		for (u32 ChunkIndex = 0; ChunkIndex < Chunks.size(); ++ChunkIndex)
+		{
+			const ObjChunk& Chunk		 = Chunks[ChunkIndex];
+			const u32		ChunkEnd	 = static_cast<u32>(Chunk.Corners.size() / 3);
+			u32				RunTriangle = 0;
+			auto			CloseRun	 = [&](u32 End)
+			{
+				if (End > RunTriangle)
+				{
+					if (Current == SIZE_MAX)
+					{
+						Select();
+					}
+					MeshRuns[Current].push_back({ ChunkIndex, RunTriangle, End - RunTriangle });
+				}
+				RunTriangle = End;
+			};
+			for (const ObjGroupChange& Change : Chunk.Changes)
+			{
+				CloseRun(Change.Triangle);
+				(Change.Object ? Object : Material) = Change.Name;
+				Current								= SIZE_MAX;
+			}
+			CloseRun(ChunkEnd);
+		}
+
+		i64 MergeEnd = Stopwatch::GetTimestamp();
+
+		Meshes.clear();
+		Meshes.resize(MeshRuns.size());
+		ParallelFor(
+			Process::GetThreadPool(),
+			Meshes.size(),
+			[&](size_t i)
+			{
+				Meshes[i].Name = MeshNames[i];
+				WeldMesh(Chunks, MeshRuns[i], Positions, TexCoords, Normals, Meshes[i]);
+			});
+
+		if (Stats)
+		{
+			Stats->SizeInBytes	= Text.size();
+			Stats->NumChunks	= static_cast<u32>(Chunks.size());
+			Stats->NumPositions = NumPositions;
+			Stats->NumTriangles = NumTriangles;
+			Stats->NumVertices	= 0;
+			for (const ObjMesh& Mesh : Meshes)
+			{
+				Stats->NumVertices += Mesh.Vertices.size();
+			}
+			Stats->ParseTicks = ParseEnd - Start;
+			Stats->MergeTicks = MergeEnd - ParseEnd;
+			Stats->WeldTicks  = Stopwatch::GetTimestamp() - MergeEnd;
+		}
+		return !Meshes.empty();
+	}
+} // namespace Asset
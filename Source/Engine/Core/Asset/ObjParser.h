@@ -0,0 +1,45 @@
+#pragma once
+#include "System/System.h"
+#include "Core/World/Vertex.h"
+
+namespace Asset
+{
+	// A mesh in the layout assimp produces with aiProcess_ConvertToLeftHanded: z negated, v flipped and the winding reversed
+	struct ObjMesh
+	{
+		std::string			Name; // Of the object or group, empty if there was none
+		std::vector<Vertex> Vertices;
+		std::vector<u32>	Indices;
+	};
+
+	struct ObjParseStats
+	{
+		u64 SizeInBytes	 = 0;
+		u32 NumChunks	 = 0;
+		u64 NumPositions = 0;
+		u64 NumTriangles = 0;
+		u64 NumVertices	 = 0; // After welding
+
+		// Stopwatch ticks
+		i64 ParseTicks = 0; // Mapping and parsing the chunks
+		i64 MergeTicks = 0; // Resolving indices and grouping triangles into meshes
+		i64 WeldTicks  = 0;
+	};
+
+	// Reads Wavefront OBJ files without assimp. The file is mapped and split into line aligned chunks that are parsed in
+	// parallel. Polygons are triangulated as fans and grouped into one mesh per object (o or g) and material (usemtl).
+	// Corners that reference the same position, texture coordinate and normal are welded into one vertex, corners without
+	// a normal get the flat normal of their face. Lines, points, material libraries and everything else are skipped
+	class ObjParser
+	{
+	public:
+		// Part of the cache key of cooked OBJ files, bump it whenever the output changes
+		static constexpr u8 Version = 1;
+
+		// Returns false if the file could not be mapped or is malformed (e.g. an index out of range)
+		static bool Parse(const std::filesystem::path& Path, std::vector<ObjMesh>& Meshes, ObjParseStats* Stats = nullptr);
+
+		// Parses Text as a whole file would be
+		static bool Parse(std::string_view Text, std::vector<ObjMesh>& Meshes, ObjParseStats* Stats = nullptr);
+	};
+} // namespace Asset
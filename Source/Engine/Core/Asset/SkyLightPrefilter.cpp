@@ -0,0 +1,464 @@
+#include "SkyLightPrefilter.h"
+#include "SkyLightSampler.h"
+#include <cmath>
+#include <numbers>
+
+namespace Asset
+{
+	constexpr f64 Pi = std::numbers::pi;
+
+	// Rows handed out per ParallelFor index
+	constexpr u32 PrefilterRowBlockSize = 16;
+
+	// Texels of the image averaged per texel of the faces, along each axis, at most
+	constexpr u32 MaxSupersampling = 4;
+
+	// Convolution of every band of the spherical harmonics with the clamped cosine lobe (Ramamoorthi and Hanrahan 2001)
+	constexpr f32 CosineLobeBands[] = { static_cast<f32>(Pi), static_cast<f32>(2.0 * Pi / 3.0), static_cast<f32>(Pi / 4.0) };
+
+	// The radiance of a cubemap and its box filtered mips, what the GGX samples are read from
+	struct RadianceLevel
+	{
+		u32										Size = 0;
+		std::array<std::vector<Math::Vec3f>, 6>	Faces;
+	};
+
+	// Of a direction of unit length, bands 0 to 2
+	static void EvaluateBasis(const Math::Vec3f& d, f32 (&Basis)[SkyIrradiance::NumCoefficients])
+	{
+		Basis[0] = 0.282095f;
+		Basis[1] = 0.488603f * d.y;
+		Basis[2] = 0.488603f * d.z;
+		Basis[3] = 0.488603f * d.x;
+		Basis[4] = 1.092548f * d.x * d.y;
+		Basis[5] = 1.092548f * d.y * d.z;
+		Basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+		Basis[7] = 1.092548f * d.x * d.z;
+		Basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+	}
+
+	Math::Vec3f SkyIrradiance::Evaluate(const Math::Vec3f& Normal, u32 Order /*= 3*/) const
+	{
+		f32 Basis[NumCoefficients];
+		EvaluateBasis(Math::normalize(Normal), Basis);
+
+		Math::Vec3f Irradiance;
+		for (u32 i = 0; i < std::min(Order * Order, NumCoefficients); ++i)
+		{
+			Irradiance = Irradiance + Coefficients[i] * Basis[i];
+		}
+		return Irradiance;
+	}
+
+	// Texels are RGBA32F, NaNs, infinities and negative values of broken HDRIs are black
+	static Math::Vec3f LoadTexel(const u8* Texels, size_t RowPitch, u32 x, u32 y)
+	{
+		const f32* Texel = reinterpret_cast<const f32*>(Texels + y * RowPitch) + x * 4;
+		auto	   Clean = [](f32 Value)
+		{
+			return std::isfinite(Value) ? std::max(Value, 0.0f) : 0.0f;
+		};
+		return Math::Vec3f(Clean(Texel[0]), Clean(Texel[1]), Clean(Texel[2]));
+	}
+
+	// Bilinear, wrapping around horizontally and clamped at the poles
+	static Math::Vec3f SampleLatLong(const u8* Texels, u32 Width, u32 Height, size_t RowPitch, Math::Vec2f Uv)
+	{
+		const f32 x	 = Uv.x * Width - 0.5f;
+		const f32 y	 = std::clamp(Uv.y * Height - 0.5f, 0.0f, static_cast<f32>(Height - 1));
+		const f32 Fx = std::floor(x);
+		const u32 x0 = static_cast<u32>((static_cast<i64>(Fx) % Width + Width) % Width);
+		const u32 x1 = (x0 + 1) % Width;
+		const u32 y0 = static_cast<u32>(y);
+		const u32 y1 = std::min(y0 + 1, Height - 1);
+		const f32 tx = x - Fx;
+		const f32 ty = y - static_cast<f32>(y0);
+
+		const Math::Vec3f Top	 = LoadTexel(Texels, RowPitch, x0, y0) * (1.0f - tx) + LoadTexel(Texels, RowPitch, x1, y0) * tx;
+		const Math::Vec3f Bottom = LoadTexel(Texels, RowPitch, x0, y1) * (1.0f - tx) + LoadTexel(Texels, RowPitch, x1, y1) * tx;
+		return Top * (1.0f - ty) + Bottom * ty;
+	}
+
+	// Face of the cubemap a direction points through and where, the inverse of FaceUvToDirection
+	static u32 DirectionToFaceUv(const Math::Vec3f& d, Math::Vec2f& Uv)
+	{
+		const f32 ax = std::abs(d.x);
+		const f32 ay = std::abs(d.y);
+		const f32 az = std::abs(d.z);
+
+		u32 Face;
+		f32 s, t, Major;
+		if (ax >= ay && ax >= az)
+		{
+			Face  = d.x >= 0.0f ? 0 : 1;
+			s	  = d.x >= 0.0f ? -d.z : d.z;
+			t	  = -d.y;
+			Major = ax;
+		}
+		else if (ay >= az)
+		{
+			Face  = d.y >= 0.0f ? 2 : 3;
+			s	  = d.x;
+			t	  = d.y >= 0.0f ? d.z : -d.z;
+			Major = ay;
+		}
+		else
+		{
+			Face  = d.z >= 0.0f ? 4 : 5;
+			s	  = d.z >= 0.0f ? d.x : -d.x;
+			t	  = -d.y;
+			Major = az;
+		}
+		Major = std::max(Major, 1e-30f);
+		Uv	  = Math::Vec2f((s / Major + 1.0f) * 0.5f, (t / Major + 1.0f) * 0.5f);
+		return Face;
+	}
+
+	// Bilinear inside the face, clamped at its edges
+	static Math::Vec3f SampleFace(const std::vector<Math::Vec3f>& Texels, u32 Size, Math::Vec2f Uv)
+	{
+		const f32 x	 = std::clamp(Uv.x * Size - 0.5f, 0.0f, static_cast<f32>(Size - 1));
+		const f32 y	 = std::clamp(Uv.y * Size - 0.5f, 0.0f, static_cast<f32>(Size - 1));
+		const u32 x0 = static_cast<u32>(x);
+		const u32 y0 = static_cast<u32>(y);
+		const u32 x1 = std::min(x0 + 1, Size - 1);
+		const u32 y1 = std::min(y0 + 1, Size - 1);
+		const f32 tx = x - static_cast<f32>(x0);
+		const f32 ty = y - static_cast<f32>(y0);
+
+		const Math::Vec3f Top	 = Texels[size_t(y0) * Size + x0] * (1.0f - tx) + Texels[size_t(y0) * Size + x1] * tx;
+		const Math::Vec3f Bottom = Texels[size_t(y1) * Size + x0] * (1.0f - tx) + Texels[size_t(y1) * Size + x1] * tx;
+		return Top * (1.0f - ty) + Bottom * ty;
+	}
+
+	// Trilinear between the levels around Lod
+	static Math::Vec3f SampleCube(const std::vector<RadianceLevel>& Levels, const Math::Vec3f& Direction, f32 Lod)
+	{
+		Math::Vec2f Uv;
+		const u32	Face = DirectionToFaceUv(Direction, Uv);
+
+		const f32 Level	= std::clamp(Lod, 0.0f, static_cast<f32>(Levels.size() - 1));
+		const u32 Low	= static_cast<u32>(Level);
+		const f32 t		= Level - static_cast<f32>(Low);
+
+		const Math::Vec3f Radiance = SampleFace(Levels[Low].Faces[Face], Levels[Low].Size, Uv);
+		if (t <= 0.0f || Low + 1 >= Levels.size())
+		{
+			return Radiance;
+		}
+		return Radiance * (1.0f - t) + SampleFace(Levels[Low + 1].Faces[Face], Levels[Low + 1].Size, Uv) * t;
+	}
+
+	static f32 RadicalInverse(u32 Bits)
+	{
+		Bits = (Bits << 16u) | (Bits >> 16u);
+		Bits = ((Bits & 0x55555555u) << 1u) | ((Bits & 0xAAAAAAAAu) >> 1u);
+		Bits = ((Bits & 0x33333333u) << 2u) | ((Bits & 0xCCCCCCCCu) >> 2u);
+		Bits = ((Bits & 0x0F0F0F0Fu) << 4u) | ((Bits & 0xF0F0F0F0u) >> 4u);
+		Bits = ((Bits & 0x00FF00FFu) << 8u) | ((Bits & 0xFF00FF00u) >> 8u);
+		return static_cast<f32>(Bits) * 0x1p-32f;
+	}
+
+	// A light direction of the GGX lobe around +Z, the same for every texel of a level
+	struct GgxSample
+	{
+		Math::Vec3f Direction;
+		f32			NdotL;
+		f32			Lod; // Level of the radiance whose texels cover the solid angle the sample stands for
+	};
+
+	// Hammersley points importance sampled by the distribution of normals, reflected about them (Karis 2013, filtered
+	// importance sampling from GPU Gems 3 20.4)
+	static std::vector<GgxSample> GetGgxSamples(f32 Roughness, u32 BaseSize)
+	{
+		const f64 Alpha		 = std::max(static_cast<f64>(Roughness) * Roughness, 1e-6);
+		const f64 Alpha2	 = Alpha * Alpha;
+		const f64 TexelAngle = 4.0 * Pi / (6.0 * BaseSize * BaseSize);
+		const u32 NumSamples = SkyLightPrefilter::NumSamples;
+
+		std::vector<GgxSample> Samples;
+		for (u32 i = 0; i < NumSamples; ++i)
+		{
+			const f64 Phi	   = 2.0 * Pi * (i + 0.5) / NumSamples;
+			const f64 u		   = RadicalInverse(i);
+			const f64 CosTheta = std::sqrt((1.0 - u) / (1.0 + (Alpha2 - 1.0) * u));
+			const f64 SinTheta = std::sqrt(1.0 - CosTheta * CosTheta);
+
+			// V = N = +Z: L = 2 (V . H) H - V
+			const f64 NdotL = 2.0 * CosTheta * CosTheta - 1.0;
+			if (NdotL <= 0.0)
+			{
+				continue;
+			}
+			const Math::Vec3f Direction(
+				static_cast<f32>(2.0 * CosTheta * SinTheta * std::cos(Phi)),
+				static_cast<f32>(2.0 * CosTheta * SinTheta * std::sin(Phi)),
+				static_cast<f32>(NdotL));
+
+			// pdf(L) = D(H) (N . H) / (4 (V . H)) = D(H) / 4
+			const f64 Denominator = CosTheta * CosTheta * (Alpha2 - 1.0) + 1.0;
+			const f64 Pdf		  = Alpha2 / (Pi * Denominator * Denominator) / 4.0;
+			const f64 SampleAngle = 1.0 / (NumSamples * Pdf);
+			const f64 Lod		  = std::max(0.5 * std::log2(SampleAngle / TexelAngle) + 1.0, 0.0);
+			Samples.push_back({ Direction, static_cast<f32>(NdotL), static_cast<f32>(Lod) });
+		}
+		return Samples;
+	}
+
+	u32 SkyLightPrefilter::GetFaceSize(u32 Width)
+	{
+		u32 Size = 1;
+		while (Size * 2 <= std::min(Width / 4, MaxFaceSize))
+		{
+			Size *= 2;
+		}
+		return Size;
+	}
+
+	f32 SkyLightPrefilter::GetRoughness(u32 Level, u32 NumLevels)
+	{
+		return NumLevels > 1 ? static_cast<f32>(Level) / static_cast<f32>(NumLevels - 1) : 0.0f;
+	}
+
+	Math::Vec3f SkyLightPrefilter::FaceUvToDirection(u32 Face, Math::Vec2f Uv)
+	{
+		const f32 s = 2.0f * Uv.x - 1.0f;
+		const f32 t = 2.0f * Uv.y - 1.0f;
+		switch (Face)
+		{
+		case 0:
+			return Math::Vec3f(1.0f, -t, -s);
+		case 1:
+			return Math::Vec3f(-1.0f, -t, s);
+		case 2:
+			return Math::Vec3f(s, 1.0f, t);
+		case 3:
+			return Math::Vec3f(s, -1.0f, -t);
+		case 4:
+			return Math::Vec3f(s, -t, 1.0f);
+		default:
+			return Math::Vec3f(-s, -t, -1.0f);
+		}
+	}
+
+	// Calls Function(Face, y) for every row of the faces of a level, blocks of rows of every face in parallel
+	template<typename TFunction>
+	static void ForEachFaceRow(u32 Size, TFunction&& Function)
+	{
+		const u32 BlocksPerFace = (Size + PrefilterRowBlockSize - 1) / PrefilterRowBlockSize;
+		ParallelFor(
+			Process::GetThreadPool(),
+			size_t(BlocksPerFace) * SkyLightPrefilter::NumFaces,
+			[&](size_t Block)
+			{
+				const u32 Face	= static_cast<u32>(Block / BlocksPerFace);
+				const u32 First = static_cast<u32>(Block % BlocksPerFace) * PrefilterRowBlockSize;
+				for (u32 y = First; y < std::min(First + PrefilterRowBlockSize, Size); ++y)
+				{
+					Function(Face, y);
+				}
+			});
+	}
+
+	static void StoreTexel(DecodedImage& Image, u32 x, u32 y, const Math::Vec3f& Radiance)
+	{
+		f32* Texel = reinterpret_cast<f32*>(&Image.Pixels[y * Image.GetRowPitch()]) + x * 4;
+		Texel[0]   = Radiance.x;
+		Texel[1]   = Radiance.y;
+		Texel[2]   = Radiance.z;
+		Texel[3]   = 1.0f;
+	}
+
+	static DecodedImage CreateFace(u32 Size)
+	{
+		DecodedImage Face;
+		Face.Width	 = Size;
+		Face.Height	 = Size;
+		Face.IsFloat = true;
+		Face.Pixels.resize(Face.GetRowPitch() * Size);
+		return Face;
+	}
+
+	void SkyLightPrefilter::ConvertToCubemap(
+		const u8*							Texels,
+		u32									Width,
+		u32									Height,
+		size_t								RowPitch,
+		u32									FaceSize,
+		std::array<DecodedImage, NumFaces>&	Faces)
+	{
+		for (DecodedImage& Face : Faces)
+		{
+			Face = CreateFace(FaceSize);
+		}
+
+		// Texels of the faces are about as wide as those of the image at the equator, 4 faces go around it
+		const u32 Supersampling = std::clamp((Width + 4 * FaceSize - 1) / (4 * FaceSize), 1u, MaxSupersampling);
+		const f32 Scale			= 1.0f / static_cast<f32>(Supersampling * Supersampling);
+		ForEachFaceRow(
+			FaceSize,
+			[&](u32 Face, u32 y)
+			{
+				for (u32 x = 0; x < FaceSize; ++x)
+				{
+					Math::Vec3f Radiance;
+					for (u32 j = 0; j < Supersampling; ++j)
+					{
+						for (u32 i = 0; i < Supersampling; ++i)
+						{
+							const Math::Vec2f FaceUv(
+								(x + (i + 0.5f) / Supersampling) / FaceSize,
+								(y + (j + 0.5f) / Supersampling) / FaceSize);
+							const Math::Vec2f Uv = SkyLightSampler::DirectionToUv(FaceUvToDirection(Face, FaceUv));
+							Radiance			 = Radiance + SampleLatLong(Texels, Width, Height, RowPitch, Uv);
+						}
+					}
+					StoreTexel(Faces[Face], x, y, Radiance * Scale);
+				}
+			});
+	}
+
+	void SkyLightPrefilter::Prefilter(
+		const std::array<DecodedImage, NumFaces>&		 Faces,
+		u32												 NumLevels,
+		std::array<std::vector<DecodedImage>, NumFaces>& Mips)
+	{
+		const u32 BaseSize = Faces[0].Width;
+		for (std::vector<DecodedImage>& FaceMips : Mips)
+		{
+			FaceMips.clear();
+			for (u32 Level = 1; Level < NumLevels; ++Level)
+			{
+				FaceMips.push_back(CreateFace(std::max(BaseSize >> Level, 1u)));
+			}
+		}
+		if (NumLevels <= 1)
+		{
+			return;
+		}
+
+		// Box filtered down to 1 texel, wide lobes read coarse levels rather than many texels of the base level
+		std::vector<RadianceLevel> Radiance(1);
+		Radiance[0].Size = BaseSize;
+		for (u32 Face = 0; Face < NumFaces; ++Face)
+		{
+			std::vector<Math::Vec3f>& Texels = Radiance[0].Faces[Face];
+			Texels.resize(size_t(BaseSize) * BaseSize);
+			for (u32 y = 0; y < BaseSize; ++y)
+			{
+				for (u32 x = 0; x < BaseSize; ++x)
+				{
+					Texels[size_t(y) * BaseSize + x] = LoadTexel(Faces[Face].Pixels.data(), Faces[Face].GetRowPitch(), x, y);
+				}
+			}
+		}
+		while (Radiance.back().Size > 1)
+		{
+			const RadianceLevel& Source = Radiance.back();
+			RadianceLevel		 Level;
+			Level.Size = Source.Size / 2;
+			for (u32 Face = 0; Face < NumFaces; ++Face)
+			{
+				const std::vector<Math::Vec3f>& From = Source.Faces[Face];
+				std::vector<Math::Vec3f>&		To	 = Level.Faces[Face];
+				To.resize(size_t(Level.Size) * Level.Size);
+				for (u32 y = 0; y < Level.Size; ++y)
+				{
+					for (u32 x = 0; x < Level.Size; ++x)
+					{
+						const size_t Top	= size_t(2 * y) * Source.Size + 2 * x;
+						const size_t Bottom = Top + Source.Size;
+
+						To[size_t(y) * Level.Size + x] = (From[Top] + From[Top + 1] + From[Bottom] + From[Bottom + 1]) * 0.25f;
+					}
+				}
+			}
+			Radiance.push_back(std::move(Level));
+		}
+
+		for (u32 Level = 1; Level < NumLevels; ++Level)
+		{
+			const u32					 Size	 = Mips[0][Level - 1].Width;
+			const std::vector<GgxSample> Samples = GetGgxSamples(GetRoughness(Level, NumLevels), BaseSize);
+			ForEachFaceRow(
+				Size,
+				[&](u32 Face, u32 y)
+				{
+					for (u32 x = 0; x < Size; ++x)
+					{
+						const Math::Vec3f N			= Math::normalize(FaceUvToDirection(Face, Math::Vec2f((x + 0.5f) / Size, (y + 0.5f) / Size)));
+						const Math::Vec3f Up		= std::abs(N.y) < 0.999f ? Math::Vec3f(0.0f, 1.0f, 0.0f) : Math::Vec3f(1.0f, 0.0f, 0.0f);
+						const Math::Vec3f Tangent	= Math::normalize(Math::cross(Up, N));
+						const Math::Vec3f Bitangent	= Math::cross(N, Tangent);
+
+						Math::Vec3f Sum;
+						f32			Weight = 0.0f;
+						for (const GgxSample& Sample : Samples)
+						{
+							const Math::Vec3f L	= Tangent * Sample.Direction.x + Bitangent * Sample.Direction.y + N * Sample.Direction.z;
+							Sum					= Sum + SampleCube(Radiance, L, Sample.Lod) * Sample.NdotL;
+							Weight += Sample.NdotL;
+						}
+						StoreTexel(Mips[Face][Level - 1], x, y, Weight > 0.0f ? Sum / Weight : Sum);
+					}
+				});
+		}
+	}
+
+	SkyIrradiance SkyLightPrefilter::ProjectIrradiance(const u8* Texels, u32 Width, u32 Height, size_t RowPitch)
+	{
+		// Summed per block of rows in double, then over the blocks in order so the result does not depend on scheduling
+		using BlockSums = std::array<f64, SkyIrradiance::NumCoefficients * 3>;
+
+		const u32			   NumBlocks = (Height + PrefilterRowBlockSize - 1) / PrefilterRowBlockSize;
+		std::vector<BlockSums> Sums(NumBlocks);
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				BlockSums& Sum	 = Sums[Block];
+				const u32  First = static_cast<u32>(Block) * PrefilterRowBlockSize;
+				Sum.fill(0.0);
+				for (u32 y = First; y < std::min(First + PrefilterRowBlockSize, Height); ++y)
+				{
+					// Every texel of a row covers the same solid angle
+					const f64 SolidAngle = 2.0 * Pi / Width * (std::cos(Pi * y / Height) - std::cos(Pi * (y + 1) / Height));
+					for (u32 x = 0; x < Width; ++x)
+					{
+						const Math::Vec3f Direction = SkyLightSampler::UvToDirection(Math::Vec2f((x + 0.5f) / Width, (y + 0.5f) / Height));
+						const Math::Vec3f Radiance	= LoadTexel(Texels, RowPitch, x, y);
+
+						f32 Basis[SkyIrradiance::NumCoefficients];
+						EvaluateBasis(Direction, Basis);
+						for (u32 i = 0; i < SkyIrradiance::NumCoefficients; ++i)
+						{
+							const f64 Weight = Basis[i] * SolidAngle;
+							Sum[i * 3 + 0] += Radiance.x * Weight;
+							Sum[i * 3 + 1] += Radiance.y * Weight;
+							Sum[i * 3 + 2] += Radiance.z * Weight;
+						}
+					}
+				}
+			});
+
+		SkyIrradiance Irradiance;
+		for (u32 i = 0; i < SkyIrradiance::NumCoefficients; ++i)
+		{
+			f64 Total[3] = {};
+			for (const BlockSums& Sum : Sums)
+			{
+				for (u32 c = 0; c < 3; ++c)
+				{
+					Total[c] += Sum[i * 3 + c];
+				}
+			}
+			const f64 Band			   = CosineLobeBands[i == 0 ? 0 : (i < 4 ? 1 : 2)];
+			Irradiance.Coefficients[i] = Math::Vec3f(
+				static_cast<f32>(Total[0] * Band),
+				static_cast<f32>(Total[1] * Band),
+				static_cast<f32>(Total[2] * Band));
+		}
+		return Irradiance;
+	}
+} // namespace Asset
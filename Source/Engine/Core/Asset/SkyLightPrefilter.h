@@ -0,0 +1,69 @@
+#pragma once
+#include "ImageDecoder.h"
+#include "Math/Math.h"
+#include <array>
+
+namespace Asset
+{
+	// Irradiance of a sky light as real spherical harmonics of order 3 (bands 0 to 2), already convolved with the clamped
+	// cosine lobe: evaluating them at a normal gives the irradiance arriving at a surface facing it. The first 4
+	// coefficients alone are the order 2 projection
+	struct SkyIrradiance
+	{
+		static constexpr u32 NumCoefficients = 9;
+
+		[[nodiscard]] Math::Vec3f Evaluate(const Math::Vec3f& Normal, u32 Order = 3) const;
+
+		std::array<Math::Vec3f, NumCoefficients> Coefficients; // RGB
+	};
+
+	// Turns a latitude-longitude HDR sky light (in the convention of SkyLightSampler) into a cubemap whose mips are
+	// prefiltered for GGX reflections of rising roughness, and projects its irradiance to spherical harmonics, so neither
+	// is filtered per sample when rendering. Faces are in D3D order (+X, -X, +Y, -Y, +Z, -Z), RGBA32F. Every step runs in
+	// parallel over blocks of rows
+	class SkyLightPrefilter
+	{
+	public:
+		static constexpr u32 NumFaces = 6;
+
+		// 6 RGBA32F faces of 1024 take 96 MiB before their mips
+		static constexpr u32 MaxFaceSize = 1024;
+
+		// GGX samples per texel of the prefiltered levels, each one read from the level of the cubemap that matches the
+		// solid angle it stands for (filtered importance sampling), so few are needed
+		static constexpr u32 NumSamples = 64;
+
+		// Power of two no larger than MaxFaceSize or a quarter of Width, the faces keep the resolution of the image at the
+		// equator
+		[[nodiscard]] static u32 GetFaceSize(u32 Width);
+
+		// Roughness a level is prefiltered for, rising linearly from 0 at the base level to 1 at the last one
+		[[nodiscard]] static f32 GetRoughness(u32 Level, u32 NumLevels);
+
+		// Direction through Uv ([0, 1] over the face) of a face, not normalized
+		[[nodiscard]] static Math::Vec3f FaceUvToDirection(u32 Face, Math::Vec2f Uv);
+
+		// Texels are RGBA32F, rows RowPitch bytes apart. Replaces Faces with the base level of the cubemap, bilinearly
+		// sampled from the image (supersampled where a texel of the faces covers more than one of the image). Uses
+		// ParallelFor, so it must not be called from a thread pool thread
+		static void ConvertToCubemap(
+			const u8*							Texels,
+			u32									Width,
+			u32									Height,
+			size_t								RowPitch,
+			u32									FaceSize,
+			std::array<DecodedImage, NumFaces>&	Faces);
+
+		// Replaces Mips with the levels 1 to NumLevels - 1 of every face, each the radiance of the base level Faces
+		// convolved with the GGX lobe of GetRoughness around the direction of the texel (N = V = R, as in Karis 2013).
+		// Uses ParallelFor, so it must not be called from a thread pool thread
+		static void Prefilter(
+			const std::array<DecodedImage, NumFaces>&		 Faces,
+			u32												 NumLevels,
+			std::array<std::vector<DecodedImage>, NumFaces>& Mips);
+
+		// Projects the radiance of every texel of the image, weighted by its solid angle. Uses ParallelFor, so it must not
+		// be called from a thread pool thread
+		[[nodiscard]] static SkyIrradiance ProjectIrradiance(const u8* Texels, u32 Width, u32 Height, size_t RowPitch);
+	};
+} // namespace Asset
@@ -0,0 +1,458 @@
+#include "SkyLightSampler.h"
+#include <cmath>
+#include <fstream>
+#include <numbers>
+#include <random>
+
+namespace Asset
+{
+	constexpr f64 Pi = std::numbers::pi;
+
+	// Rows handed out per ParallelFor index
+	constexpr size_t SkyRowBlockSize = 16;
+
+	struct SkyLightHeader
+	{
+		u32 Magic;
+		u32 Version;
+		u32 Width;
+		u32 Height;
+		f32 Integral;
+		u32 Padding;
+		u64 Checksum; // Of the tables that follow
+	};
+
+	static f32 GetLuminance(const f32* Texel)
+	{
+		const f32 Luminance = 0.2126f * Texel[0] + 0.7152f * Texel[1] + 0.0722f * Texel[2];
+
+		// NaNs and infinities of broken HDRIs would poison every CDF they are summed into
+		return std::isfinite(Luminance) ? std::max(Luminance, 0.0f) : 0.0f;
+	}
+
+	// Index of the interval of Cdf (NumValues + 1 entries rising from 0 to 1) that contains u, the last one whose start
+	// is not above u
+	static u32 FindInterval(const f32* Cdf, u32 NumValues, f32 u)
+	{
+		const f32* Upper = std::upper_bound(Cdf, Cdf + NumValues + 1, u);
+		return static_cast<u32>(std::clamp<std::ptrdiff_t>(Upper - Cdf - 1, 0, NumValues - 1));
+	}
+
+	// Fills the NumValues + 1 entries of Cdf from a piecewise constant function, returns the integral of the function over
+	// [0, 1]. A function that is 0 everywhere gets a uniform CDF
+	static f32 BuildCdf(const f32* Function, u32 NumValues, f32* Cdf)
+	{
+		// Summed in double, single precision loses the tail of a row of thousands of texels
+		f64 Sum = 0.0;
+		Cdf[0]	= 0.0f;
+		for (u32 i = 0; i < NumValues; ++i)
+		{
+			Sum += Function[i];
+			Cdf[i + 1] = static_cast<f32>(Sum);
+		}
+
+		if (Sum <= 0.0)
+		{
+			for (u32 i = 1; i <= NumValues; ++i)
+			{
+				Cdf[i] = static_cast<f32>(i) / static_cast<f32>(NumValues);
+			}
+			return 0.0f;
+		}
+		for (u32 i = 1; i <= NumValues; ++i)
+		{
+			Cdf[i] = static_cast<f32>(Cdf[i] / Sum);
+		}
+		Cdf[NumValues] = 1.0f;
+		return static_cast<f32>(Sum / NumValues);
+	}
+
+	Math::Vec3f SkyLightSampler::UvToDirection(Math::Vec2f Uv)
+	{
+		const f64 Phi	   = 2.0 * Pi * (Uv.x - 0.5);
+		const f64 Theta	   = Pi * Uv.y;
+		const f64 SinTheta = std::sin(Theta);
+		return Math::Vec3f(
+			static_cast<f32>(SinTheta * std::sin(Phi)),
+			static_cast<f32>(std::cos(Theta)),
+			static_cast<f32>(SinTheta * std::cos(Phi)));
+	}
+
+	Math::Vec2f SkyLightSampler::DirectionToUv(const Math::Vec3f& Direction)
+	{
+		// atan2 rather than acos(y), which loses theta next to the poles where y is close to 1
+		const f64 Phi	= std::atan2(Direction.x, Direction.z);
+		const f64 Theta = std::atan2(std::sqrt(f64(Direction.x) * Direction.x + f64(Direction.z) * Direction.z), f64(Direction.y));
+		return Math::Vec2f(static_cast<f32>(Phi / (2.0 * Pi) + 0.5), static_cast<f32>(Theta / Pi));
+	}
+
+	void SkyLightSampler::Build(const u8* Texels, u32 Width, u32 Height, size_t RowPitch)
+	{
+		this->Width	 = Width;
+		this->Height = Height;
+		Weights.resize(size_t(Width) * Height);
+		RowIntegrals.resize(Height);
+		MarginalCdf.resize(size_t(Height) + 1);
+		ConditionalCdfs.resize(size_t(Width + 1) * Height);
+
+		auto ForEachRow = [&](auto&& Function)
+		{
+			ParallelFor(
+				Process::GetThreadPool(),
+				(Height + SkyRowBlockSize - 1) / SkyRowBlockSize,
+				[&](size_t Block)
+				{
+					const u32 Last = static_cast<u32>(std::min((Block + 1) * SkyRowBlockSize, size_t(Height)));
+					for (u32 y = static_cast<u32>(Block * SkyRowBlockSize); y < Last; ++y)
+					{
+						Function(y);
+					}
+				});
+		};
+
+		// sin(theta) at the center of the row is the solid angle of its texels, up to a constant
+		auto SinTheta = [&](u32 y)
+		{
+			return static_cast<f32>(std::sin(Pi * (y + 0.5) / Height));
+		};
+
+		std::atomic<bool> HasLight = false;
+		ForEachRow(
+			[&](u32 y)
+			{
+				const f32* Row		= reinterpret_cast<const f32*>(Texels + y * RowPitch);
+				f32*	   Weight	= &Weights[size_t(y) * Width];
+				const f32  Scale	= SinTheta(y);
+				bool	   RowLight = false;
+				for (u32 x = 0; x < Width; ++x)
+				{
+					Weight[x] = GetLuminance(Row + x * 4) * Scale;
+					RowLight |= Weight[x] > 0.0f;
+				}
+				if (RowLight)
+				{
+					HasLight = true;
+				}
+			});
+
+		// A black sky is sampled uniformly over the sphere rather than not at all
+		ForEachRow(
+			[&](u32 y)
+			{
+				f32* Weight = &Weights[size_t(y) * Width];
+				if (!HasLight)
+				{
+					std::fill_n(Weight, Width, SinTheta(y));
+				}
+				RowIntegrals[y] = BuildCdf(Weight, Width, &ConditionalCdfs[size_t(y) * (Width + 1)]);
+			});
+
+		Integral = BuildCdf(RowIntegrals.data(), Height, MarginalCdf.data());
+	}
+
+	u64 SkyLightSampler::GetSizeInBytes() const noexcept
+	{
+		return (Weights.size() + RowIntegrals.size() + MarginalCdf.size() + ConditionalCdfs.size()) * sizeof(f32);
+	}
+
+	SkyLightSample SkyLightSampler::Sample(Math::Vec2f u) const
+	{
+		SkyLightSample Sample;
+		if (!IsValid() || Integral <= 0.0f)
+		{
+			return Sample;
+		}
+
+		// Row, then the column within it, each continuous: the offset inside the interval is where u falls in it
+		const u32 y	 = FindInterval(MarginalCdf.data(), Height, u.y);
+		const f32 dv = (u.y - MarginalCdf[y]) / std::max(MarginalCdf[y + 1] - MarginalCdf[y], 1e-30f);
+
+		const f32* Cdf = &ConditionalCdfs[size_t(y) * (Width + 1)];
+		const u32  x   = FindInterval(Cdf, Width, u.x);
+		const f32  du  = (u.x - Cdf[x]) / std::max(Cdf[x + 1] - Cdf[x], 1e-30f);
+
+		Sample.Uv = Math::Vec2f(
+			std::min((x + std::clamp(du, 0.0f, 1.0f)) / Width, std::nextafter(1.0f, 0.0f)),
+			std::min((y + std::clamp(dv, 0.0f, 1.0f)) / Height, std::nextafter(1.0f, 0.0f)));
+		Sample.Direction = UvToDirection(Sample.Uv);
+
+		// The density of the texel over the image, divided by the Jacobian of the mapping to the sphere
+		const f64 SinTheta = std::sin(Pi * Sample.Uv.y);
+		const f64 PdfUv	   = Weights[size_t(y) * Width + x] / Integral;
+		Sample.Pdf		   = SinTheta > 0.0 ? static_cast<f32>(PdfUv / (2.0 * Pi * Pi * SinTheta)) : 0.0f;
+		return Sample;
+	}
+
+	f32 SkyLightSampler::PdfUv(Math::Vec2f Uv) const
+	{
+		const u32 x = std::min(static_cast<u32>(std::max(Uv.x, 0.0f) * Width), Width - 1);
+		const u32 y = std::min(static_cast<u32>(std::max(Uv.y, 0.0f) * Height), Height - 1);
+		return Weights[size_t(y) * Width + x] / Integral;
+	}
+
+	f32 SkyLightSampler::Pdf(const Math::Vec3f& Direction) const
+	{
+		if (!IsValid() || Integral <= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		const Math::Vec2f Uv	   = DirectionToUv(Direction);
+		const f64		  SinTheta = std::sin(Pi * Uv.y);
+		return SinTheta > 0.0 ? static_cast<f32>(PdfUv(Uv) / (2.0 * Pi * Pi * SinTheta)) : 0.0f;
+	}
+
+	bool SkyLightSampler::Save(const std::filesystem::path& Path) const
+	{
+		const std::vector<f32>* Tables[] = { &Weights, &RowIntegrals, &MarginalCdf, &ConditionalCdfs };
+
+		u64 Checksum = 0;
+		for (const std::vector<f32>* Table : Tables)
+		{
+			Checksum = Hash::Combine(Checksum, Hash::Hash64(Table->data(), Table->size() * sizeof(f32)));
+		}
+		const SkyLightHeader Header = {
+			.Magic	  = Magic,
+			.Version  = Version,
+			.Width	  = Width,
+			.Height	  = Height,
+			.Integral = Integral,
+			.Padding  = 0,
+			.Checksum = Checksum,
+		};
+
+		std::ofstream Stream(Path, std::ios::binary);
+		Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		for (const std::vector<f32>* Table : Tables)
+		{
+			Stream.write(reinterpret_cast<const char*>(Table->data()), static_cast<std::streamsize>(Table->size() * sizeof(f32)));
+		}
+		return Stream.good();
+	}
+
+	bool SkyLightSampler::Load(const std::filesystem::path& Path)
+	{
+		*this = {};
+
+		std::ifstream  Stream(Path, std::ios::binary);
+		SkyLightHeader Header = {};
+		if (!Stream.read(reinterpret_cast<char*>(&Header), sizeof(Header)) || Header.Magic != Magic || Header.Version != Version ||
+			Header.Width == 0 || Header.Height == 0 || Header.Width > 65536 || Header.Height > 65536)
+		{
+			return false;
+		}
+
+		SkyLightSampler Loaded;
+		Loaded.Width	= Header.Width;
+		Loaded.Height	= Header.Height;
+		Loaded.Integral = Header.Integral;
+		Loaded.Weights.resize(size_t(Header.Width) * Header.Height);
+		Loaded.RowIntegrals.resize(Header.Height);
+		Loaded.MarginalCdf.resize(size_t(Header.Height) + 1);
+		Loaded.ConditionalCdfs.resize(size_t(Header.Width + 1) * Header.Height);
+
+		u64 Checksum = 0;
+		for (std::vector<f32>* Table : { &Loaded.Weights, &Loaded.RowIntegrals, &Loaded.MarginalCdf, &Loaded.ConditionalCdfs })
+		{
+			if (!Stream.read(reinterpret_cast<char*>(Table->data()), static_cast<std::streamsize>(Table->size() * sizeof(f32))))
+			{
+				return false;
+			}
+			Checksum = Hash::Combine(Checksum, Hash::Hash64(Table->data(), Table->size() * sizeof(f32)));
+		}
+		if (Checksum != Header.Checksum)
+		{
+			return false;
+		}
+
+		*this = std::move(Loaded);
+		return true;
+	}
+
+	// Regularized upper incomplete gamma function Q(a, x), Numerical Recipes 6.2: the series below a + 1 and the
+	// continued fraction above
+	static f64 GammaQ(f64 a, f64 x)
+	{
+		if (x <= 0.0)
+		{
+			return 1.0;
+		}
+		const f64 LogPrefix = a * std::log(x) - x - std::lgamma(a);
+		if (x < a + 1.0)
+		{
+			f64 Term = 1.0 / a;
+			f64 Sum	 = Term;
+			for (u32 n = 1; n < 1000 && std::abs(Term) > std::abs(Sum) * 1e-15; ++n)
+			{
+				Term *= x / (a + n);
+				Sum += Term;
+			}
+			return 1.0 - Sum * std::exp(LogPrefix);
+		}
+
+		// Modified Lentz's method
+		constexpr f64 Tiny = 1e-300;
+		f64			  b	   = x + 1.0 - a;
+		f64			  c	   = 1.0 / Tiny;
+		f64			  d	   = 1.0 / b;
+		f64			  h	   = d;
+		for (u32 i = 1; i < 1000; ++i)
+		{
+			const f64 an = -static_cast<f64>(i) * (i - a);
+			b += 2.0;
+			d = an * d + b;
+			d = std::abs(d) < Tiny ? Tiny : d;
+			c = b + an / c;
+			c = std::abs(c) < Tiny ? Tiny : c;
+			d = 1.0 / d;
+			const f64 Delta = d * c;
+			h *= Delta;
+			if (std::abs(Delta - 1.0) < 1e-15)
+			{
+				break;
+			}
+		}
+		return std::exp(LogPrefix) * h;
+	}
+
+	SkyLightSamplerStats SkyLightSampler::Test(const u8* Texels, size_t RowPitch, u32 NumSamples, u64 Seed /*= 0*/) const
+	{
+		SkyLightSamplerStats Stats;
+		if (!IsValid() || Integral <= 0.0f || NumSamples == 0)
+		{
+			return Stats;
+		}
+		Stats.NumSamples = NumSamples;
+
+		std::mt19937_64 Random(Seed);
+		auto			Uniform = [&]
+		{
+			return static_cast<f32>(Random() >> 40) * 0x1p-24f;
+		};
+		auto Luminance = [&](Math::Vec2f Uv)
+		{
+			const u32 x = std::min(static_cast<u32>(Uv.x * Width), Width - 1);
+			const u32 y = std::min(static_cast<u32>(Uv.y * Height), Height - 1);
+			return static_cast<f64>(GetLuminance(reinterpret_cast<const f32*>(Texels + y * RowPitch) + x * 4));
+		};
+
+		// Samples binned over the image, the bins are no finer than the texels
+		const u32		 BinsX = std::min(Width, 64u);
+		const u32		 BinsY = std::min(Height, 32u);
+		std::vector<u32> Observed(size_t(BinsX) * BinsY);
+
+		// The estimates of the integral of the luminance over the sphere, importance sampled and uniform
+		f64 Sum = 0.0, SumOfSquares = 0.0;
+		for (u32 i = 0; i < NumSamples; ++i)
+		{
+			const Math::Vec2f	 u	   = { Uniform(), Uniform() };
+			const SkyLightSample Drawn = Sample(u);
+			if (Drawn.Pdf <= 0.0f)
+			{
+				continue;
+			}
+
+			const f32 Other = Pdf(Drawn.Direction);
+			Stats.NumPdfMismatches += std::abs(Other - Drawn.Pdf) > 1e-3f * Drawn.Pdf;
+
+			const u32 x = std::min(static_cast<u32>(Drawn.Uv.x * BinsX), BinsX - 1);
+			const u32 y = std::min(static_cast<u32>(Drawn.Uv.y * BinsY), BinsY - 1);
+			Observed[size_t(y) * BinsX + x]++;
+
+			const f64 Estimate = Luminance(Drawn.Uv) / Drawn.Pdf;
+			Sum += Estimate;
+			SumOfSquares += Estimate * Estimate;
+		}
+		const f64 ImportanceVariance = SumOfSquares / NumSamples - (Sum / NumSamples) * (Sum / NumSamples);
+
+		// Uniform directions over the sphere: z = 1 - 2 u, the PDF integral and the uniform estimate come from the same ones
+		Sum = SumOfSquares = 0.0;
+		f64 PdfSum		   = 0.0;
+		for (u32 i = 0; i < NumSamples; ++i)
+		{
+			const f64		  CosTheta = 1.0 - 2.0 * Uniform();
+			const f64		  SinTheta = std::sqrt(std::max(0.0, 1.0 - CosTheta * CosTheta));
+			const f64		  Phi	   = 2.0 * Pi * Uniform();
+			const Math::Vec3f Direction(
+				static_cast<f32>(SinTheta * std::cos(Phi)),
+				static_cast<f32>(CosTheta),
+				static_cast<f32>(SinTheta * std::sin(Phi)));
+			PdfSum += Pdf(Direction);
+
+			const f64 Estimate = Luminance(DirectionToUv(Direction)) * 4.0 * Pi;
+			Sum += Estimate;
+			SumOfSquares += Estimate * Estimate;
+		}
+		const f64 UniformVariance = SumOfSquares / NumSamples - (Sum / NumSamples) * (Sum / NumSamples);
+		Stats.PdfIntegral		  = PdfSum * 4.0 * Pi / NumSamples;
+		Stats.VarianceReduction	  = ImportanceVariance > 0.0 ? UniformVariance / ImportanceVariance : std::numeric_limits<f64>::infinity();
+
+		// Expected count of every bin: the probability of the texels in it, split by overlap where texels straddle bins
+		std::vector<f64> Expected(Observed.size());
+		auto			 Spread = [](u32 Texel, u32 NumTexels, u32 NumBins, auto&& Function)
+		{
+			const f64 Begin = static_cast<f64>(Texel) * NumBins / NumTexels;
+			const f64 End	= static_cast<f64>(Texel + 1) * NumBins / NumTexels;
+			for (u32 Bin = static_cast<u32>(Begin); Bin < std::min(static_cast<u32>(std::ceil(End)), NumBins); ++Bin)
+			{
+				const f64 Overlap = std::min(End, Bin + 1.0) - std::max(Begin, static_cast<f64>(Bin));
+				if (Overlap > 0.0)
+				{
+					Function(Bin, Overlap / (End - Begin));
+				}
+			}
+		};
+		const f64 Normalization = static_cast<f64>(Integral) * Width * Height;
+		for (u32 y = 0; y < Height; ++y)
+		{
+			for (u32 x = 0; x < Width; ++x)
+			{
+				const f64 Probability = Weights[size_t(y) * Width + x] / Normalization;
+				if (Probability <= 0.0)
+				{
+					continue;
+				}
+				Spread(
+					y,
+					Height,
+					BinsY,
+					[&](u32 BinY, f64 FractionY)
+					{
+						Spread(
+							x,
+							Width,
+							BinsX,
+							[&](u32 BinX, f64 FractionX)
+							{
+								Expected[size_t(BinY) * BinsX + BinX] += Probability * FractionX * FractionY * NumSamples;
+							});
+					});
+			}
+		}
+
+		// Bins expected to get fewer than 5 samples are pooled, the chi-square approximation does not hold for them
+		f64 PooledObserved = 0.0, PooledExpected = 0.0;
+		u32 NumBins		   = 0;
+		for (size_t i = 0; i < Expected.size(); ++i)
+		{
+			if (Expected[i] < 5.0)
+			{
+				PooledObserved += Observed[i];
+				PooledExpected += Expected[i];
+				continue;
+			}
+			const f64 Difference = Observed[i] - Expected[i];
+			Stats.ChiSquare += Difference * Difference / Expected[i];
+			NumBins++;
+		}
+		if (PooledExpected > 0.0)
+		{
+			const f64 Difference = PooledObserved - PooledExpected;
+			Stats.ChiSquare += Difference * Difference / PooledExpected;
+			NumBins++;
+		}
+		Stats.DegreesOfFreedom = std::max(NumBins, 2u) - 1;
+		Stats.PValue		   = GammaQ(Stats.DegreesOfFreedom * 0.5, Stats.ChiSquare * 0.5);
+		return Stats;
+	}
+} // namespace Asset
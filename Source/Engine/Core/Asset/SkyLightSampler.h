@@ -0,0 +1,84 @@
+#pragma once
+#include "System/System.h"
+#include "Math/Math.h"
+
+namespace Asset
+{
+	struct SkyLightSample
+	{
+		Math::Vec3f Direction;
+		Math::Vec2f Uv;			 // In the latitude-longitude image
+		f32			Pdf = 0.0f; // Per steradian, 0 if nothing can be sampled
+	};
+
+	// Results of SkyLightSampler::Test
+	struct SkyLightSamplerStats
+	{
+		u32 NumSamples		  = 0;
+		f64 PdfIntegral		  = 0.0; // Of Pdf over the sphere (Monte Carlo), 1 if the PDF is normalized
+		u32 NumPdfMismatches  = 0;	 // Samples whose PDF differs from Pdf of their direction by more than 0.1%
+		f64 ChiSquare		  = 0.0; // Of the samples binned over the image against the counts the PDF expects
+		u32 DegreesOfFreedom  = 0;
+		f64 PValue			  = 0.0; // Chance of a larger ChiSquare if the samples follow the PDF, tiny if they do not
+		f64 VarianceReduction = 0.0; // Variance of the luminance estimate of uniform sphere sampling over that of Sample
+	};
+
+	// Importance sampling of a latitude-longitude (equirectangular) sky light on the CPU. A 2D piecewise constant
+	// distribution over the texels of the image (Pharr et al., PBRT 13.6.7): the marginal distribution picks a row and the
+	// conditional distribution of that row picks a column. Texels are weighted by luminance * sin(theta), the solid angle
+	// they cover, so directions are drawn in proportion to the light arriving from them. Rows are built in parallel.
+	//
+	// u maps to the longitude phi = 2 pi (u - 0.5) and v to the polar angle theta = pi v from +Y, the center of the image
+	// is +Z and u grows towards +X: Direction = (sin(theta) sin(phi), cos(theta), sin(theta) cos(phi))
+	class SkyLightSampler
+	{
+	public:
+		// Tables cooked next to the texture
+		static constexpr std::string_view CookedExtension = ".sky";
+
+		// Tables are built from the largest mip no wider than this, a finer distribution hardly reduces variance further
+		static constexpr u32 MaxWidth = 2048;
+
+		static constexpr u32 Magic	 = 0x594B534B; // "KSKY"
+		static constexpr u32 Version = 1;
+
+		[[nodiscard]] static Math::Vec3f UvToDirection(Math::Vec2f Uv);
+		[[nodiscard]] static Math::Vec2f DirectionToUv(const Math::Vec3f& Direction);
+
+		// Texels are RGBA32F, rows RowPitch bytes apart. An image without light is sampled uniformly over the sphere. Uses
+		// ParallelFor, so it must not be called from a thread pool thread
+		void Build(const u8* Texels, u32 Width, u32 Height, size_t RowPitch);
+
+		[[nodiscard]] bool IsValid() const noexcept { return Width > 0 && Height > 0; }
+		[[nodiscard]] u32  GetWidth() const noexcept { return Width; }
+		[[nodiscard]] u32  GetHeight() const noexcept { return Height; }
+		[[nodiscard]] u64  GetSizeInBytes() const noexcept;
+
+		// Draws a direction from two uniform numbers in [0, 1)
+		[[nodiscard]] SkyLightSample Sample(Math::Vec2f u) const;
+
+		// Per steradian, of the direction Sample would have drawn
+		[[nodiscard]] f32 Pdf(const Math::Vec3f& Direction) const;
+
+		bool Save(const std::filesystem::path& Path) const;
+
+		// Returns false and leaves the sampler empty if the file is missing, corrupt or of another version
+		bool Load(const std::filesystem::path& Path);
+
+		// Statistical checks against the image the tables were built from, see SkyLightSamplerStats. Deterministic for a
+		// given Seed
+		[[nodiscard]] SkyLightSamplerStats Test(const u8* Texels, size_t RowPitch, u32 NumSamples, u64 Seed = 0) const;
+
+	private:
+		// Of the texel, per unit area of the image
+		[[nodiscard]] f32 PdfUv(Math::Vec2f Uv) const;
+
+		u32				 Width	  = 0;
+		u32				 Height	  = 0;
+		f32				 Integral = 0.0f; // Of the weights over the image, the normalization of the PDF
+		std::vector<f32> Weights;		  // Width * Height, luminance * sin(theta)
+		std::vector<f32> RowIntegrals;	  // Height, the marginal function
+		std::vector<f32> MarginalCdf;	  // Height + 1
+		std::vector<f32> ConditionalCdfs; // Height * (Width + 1)
+	};
+} // namespace Asset
@@ -153,6 +153,23 @@ namespace Asset
 		TexImage.Release();
 	}
 
+	void Texture::ReleaseResources(Texture& Released)
+	{
+		Released.DxTexture = std::exchange(DxTexture, {});
+		Released.Srv	   = std::exchange(Srv, {});
+	}
+
+	u64 Texture::HashContent() const
+	{
+		const DirectX::TexMetadata& Metadata = TexImage.GetMetadata();
+
+		u64 ContentHash = Hash::Hash64(&Metadata, sizeof(Metadata));
+		ContentHash		= Hash::Combine(ContentHash, Options.sRGB);
+		ContentHash		= Hash::Combine(ContentHash, IsCubemap);
+		ContentHash		= Hash::Combine(ContentHash, Hash::Hash64(TexImage.GetPixels(), TexImage.GetPixelsSize()));
+		return ContentHash;
+	}
+
 	void Texture::SaveToDDS(RHI::D3D12Texture& Texture, const std::filesystem::path& Path)
 	{
 		RHI::D3D12LinkedDevice*	  Device = Texture.GetParentLinkedDevice();
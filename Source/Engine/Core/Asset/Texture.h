@@ -2,7 +2,10 @@
 #include "IAsset.h"
 #include "Math/Math.h"
 #include "RHI/RHI.h"
-#include <DirectXTex.h>
+#include "MipGenerator.h"
+#include "SkyLightPrefilter.h"
+#include "SkyLightSampler.h"
+#include "TextureCompressor.h"
 
 namespace Asset
 {
@@ -10,8 +13,18 @@ namespace Asset
 	{
 		std::filesystem::path Path;
 
-		bool sRGB		  = false;
-		bool GenerateMips = true;
+		bool	  sRGB		   = false;
+		bool	  GenerateMips = true;
+		MipFilter Filter	   = MipFilter::Box; // Of the generated mips, PNG/JPEG/TGA/HDR sources only (see MipGenerator)
+
+		// Turns HDR latitude-longitude images into cubemaps, whose mips are prefiltered for GGX reflections rather than
+		// downsampled, and projects their irradiance to spherical harmonics (see SkyLightPrefilter)
+		bool ConvertToCubemap = false;
+
+		// Block compresses the texture, see TextureCompressor
+		bool		   Compress = false;
+		TextureUsage   Usage	= TextureUsage::Color;
+		TextureQuality Quality	= TextureQuality::Normal;
 	};
 
 	class Texture : public IAsset
@@ -23,11 +36,30 @@ namespace Asset
 
 		void Release();
 
+		// Moves the GPU texture and its view into Released, which keeps them alive while the GPU may still use them. The
+		// texture has to be uploaded again before it can be drawn
+		void ReleaseResources(Texture& Released);
+
+		// Hash of the image and everything else that ends up in the GPU texture, textures with equal hashes can be drawn with
+		// the same one. Has to be called before the image is released
+		[[nodiscard]] u64 HashContent() const;
+		[[nodiscard]] u64 GetSizeInBytes() const noexcept { return TexImage.GetPixelsSize(); }
+
 		TextureImportOptions Options;
 
 		Math::Vec2i Extent;
 		bool		IsCubemap = false;
 
+		// Of the cook that produced the image, empty if it was read from a cooked file
+		TextureCompressionStats CompressionStats;
+
+		// Importance sampling tables of HDR latitude-longitude images (sky lights), empty for other textures. Outlives the
+		// image, it is not released once the texture is uploaded
+		SkyLightSampler SkySampler;
+
+		// Of sky lights converted to cubemaps
+		std::optional<SkyIrradiance> Irradiance;
+
 		std::string			  Name;
 		DirectX::ScratchImage TexImage;
 
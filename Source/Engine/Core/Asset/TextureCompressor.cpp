@@ -0,0 +1,198 @@
+#include "TextureCompressor.h"
+#include <cmath>
+
+namespace Asset
+{
+	// Rows of texels encoded by one ParallelFor index, a multiple of the block height
+	constexpr size_t BandHeight = 64;
+
+	DXGI_FORMAT TextureCompressor::GetFormat(const DirectX::ScratchImage& Image, TextureUsage Usage, TextureQuality Quality)
+	{
+		const DirectX::TexMetadata& Metadata = Image.GetMetadata();
+		if (Image.GetImageCount() == 0 || DirectX::IsCompressed(Metadata.format) ||
+			DirectX::FormatDataType(Metadata.format) == DirectX::FORMAT_TYPE_FLOAT)
+		{
+			return DXGI_FORMAT_UNKNOWN;
+		}
+		// D3D12 only creates block compressed textures whose top mip is made of whole blocks
+		if (Metadata.width % 4 != 0 || Metadata.height % 4 != 0)
+		{
+			return DXGI_FORMAT_UNKNOWN;
+		}
+
+		switch (Usage)
+		{
+		case TextureUsage::Normal:
+			return DXGI_FORMAT_BC5_UNORM;
+		case TextureUsage::Mask:
+			return DXGI_FORMAT_BC4_UNORM;
+		case TextureUsage::Color:
+			if (Quality == TextureQuality::Fast)
+			{
+				return Image.IsAlphaAllOpaque() ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+			}
+			return DXGI_FORMAT_BC7_UNORM;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	std::string_view TextureCompressor::GetFormatName(DXGI_FORMAT Format)
+	{
+		switch (Format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+			return "BC1";
+		case DXGI_FORMAT_BC3_UNORM:
+			return "BC3";
+		case DXGI_FORMAT_BC4_UNORM:
+			return "BC4";
+		case DXGI_FORMAT_BC5_UNORM:
+			return "BC5";
+		case DXGI_FORMAT_BC7_UNORM:
+			return "BC7";
+		case DXGI_FORMAT_UNKNOWN:
+			return "Uncompressed";
+		default:
+			return "Other";
+		}
+	}
+
+	// Mean squared error over the channels Format keeps, averaged over the top mip of every item
+	static f64 ComputePsnr(const DirectX::ScratchImage& Image, const DirectX::ScratchImage& Compressed, DXGI_FORMAT Format)
+	{
+		bool Channels[4] = { true, true, true, true };
+		switch (Format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+			Channels[3] = false;
+			break;
+		case DXGI_FORMAT_BC4_UNORM:
+			Channels[1] = Channels[2] = Channels[3] = false;
+			break;
+		case DXGI_FORMAT_BC5_UNORM:
+			Channels[2] = Channels[3] = false;
+			break;
+		default:
+			break;
+		}
+
+		const DirectX::TexMetadata& Metadata = Image.GetMetadata();
+		f64							Mse		 = 0.0;
+		size_t						NumItems = 0;
+		for (size_t Item = 0; Item < Metadata.arraySize; ++Item)
+		{
+			f32 Total		  = 0.0f;
+			f32 PerChannel[4] = {};
+			if (FAILED(DirectX::ComputeMSE(*Image.GetImage(0, Item, 0), *Compressed.GetImage(0, Item, 0), Total, PerChannel)))
+			{
+				continue;
+			}
+
+			f64	   Sum		   = 0.0;
+			size_t NumChannels = 0;
+			for (size_t c = 0; c < 4; ++c)
+			{
+				Sum += Channels[c] ? PerChannel[c] : 0.0;
+				NumChannels += Channels[c];
+			}
+			Mse += Sum / static_cast<f64>(NumChannels);
+			NumItems++;
+		}
+		if (NumItems == 0)
+		{
+			return 0.0;
+		}
+
+		// Lossless blocks are capped rather than infinite
+		Mse /= static_cast<f64>(NumItems);
+		return Mse > 1e-10 ? 10.0 * std::log10(1.0 / Mse) : 100.0;
+	}
+
+	bool TextureCompressor::Compress(
+		const DirectX::ScratchImage& Image,
+		TextureUsage				 Usage,
+		TextureQuality				 Quality,
+		DirectX::ScratchImage&		 Compressed,
+		TextureCompressionStats*	 Stats /*= nullptr*/)
+	{
+		const DXGI_FORMAT Format = GetFormat(Image, Usage, Quality);
+		if (Format == DXGI_FORMAT_UNKNOWN)
+		{
+			return false;
+		}
+
+		i64 Start = Stopwatch::GetTimestamp();
+
+		DirectX::TexMetadata Metadata = Image.GetMetadata();
+		Metadata.format				  = Format;
+		if (FAILED(Compressed.Initialize(Metadata)))
+		{
+			return false;
+		}
+
+		// The texels are encoded as they are stored, sRGB textures get an sRGB view of the same UNORM blocks so the encoder
+		// minimizes the error where it is visible
+		DirectX::TEX_COMPRESS_FLAGS Flags = DirectX::TEX_COMPRESS_DEFAULT;
+		if (Format == DXGI_FORMAT_BC7_UNORM && Quality == TextureQuality::High)
+		{
+			Flags |= DirectX::TEX_COMPRESS_BC7_USE_3SUBSETS;
+		}
+
+		// Every band of every mip of every item, the larger mips have most of them
+		struct Band
+		{
+			size_t Image;
+			size_t Row;
+		};
+		std::vector<Band> Bands;
+		for (size_t i = 0; i < Image.GetImageCount(); ++i)
+		{
+			for (size_t Row = 0; Row < Image.GetImages()[i].height; Row += BandHeight)
+			{
+				Bands.push_back({ i, Row });
+			}
+		}
+
+		std::atomic<bool> Failed = false;
+		ParallelFor(
+			Process::GetThreadPool(),
+			Bands.size(),
+			[&](size_t b)
+			{
+				const DirectX::Image& Source	  = Image.GetImages()[Bands[b].Image];
+				const DirectX::Image& Destination = Compressed.GetImages()[Bands[b].Image];
+
+				DirectX::Image Slice = Source;
+				Slice.height		 = std::min(BandHeight, Source.height - Bands[b].Row);
+				Slice.slicePitch	 = Slice.rowPitch * Slice.height;
+				Slice.pixels		 = Source.pixels + Bands[b].Row * Source.rowPitch;
+
+				DirectX::ScratchImage Blocks;
+				if (FAILED(DirectX::Compress(Slice, Format, Flags, DirectX::TEX_THRESHOLD_DEFAULT, Blocks)))
+				{
+					Failed = true;
+					return;
+				}
+
+				// A row of blocks has the same pitch in the band as in the whole image
+				const DirectX::Image& Encoded = *Blocks.GetImage(0, 0, 0);
+				std::memcpy(Destination.pixels + (Bands[b].Row / 4) * Destination.rowPitch, Encoded.pixels, Encoded.slicePitch);
+			});
+
+		if (Failed)
+		{
+			Compressed.Release();
+			return false;
+		}
+
+		if (Stats)
+		{
+			Stats->Format				 = Format;
+			Stats->SizeInBytes			 = Image.GetPixelsSize();
+			Stats->CompressedSizeInBytes = Compressed.GetPixelsSize();
+			Stats->Ticks				 = Stopwatch::GetTimestamp() - Start;
+			Stats->Psnr					 = ComputePsnr(Image, Compressed, Format);
+		}
+		return true;
+	}
+} // namespace Asset
@@ -0,0 +1,55 @@
+#pragma once
+#include "System/System.h"
+#include <DirectXTex.h>
+
+namespace Asset
+{
+	// What the texels of a texture mean, picks its block compression format
+	enum class TextureUsage : u8
+	{
+		Color,	// Albedo, emissive, ...
+		Normal, // Tangent space normal map
+		Mask	// Single channel, e.g. roughness or occlusion
+	};
+
+	enum class TextureQuality : u8
+	{
+		Fast,	// BC1/BC3 instead of BC7 for color
+		Normal,
+		High	// BC7 also tries its 3 subset modes, several times slower
+	};
+
+	struct TextureCompressionStats
+	{
+		DXGI_FORMAT Format				  = DXGI_FORMAT_UNKNOWN; // UNKNOWN if the image was left as it is
+		u64			SizeInBytes			  = 0;					 // Of the image with every mip, before compression
+		u64			CompressedSizeInBytes = 0;
+		f64			Psnr				  = 0.0; // dB over the channels the format keeps, of the top mip of every item
+		i64			Ticks				  = 0;	 // Stopwatch ticks, not including the PSNR
+	};
+
+	// Block compresses decoded textures. Every image is split into bands of block rows that are encoded in parallel by
+	// DirectXTex's encoders, which work on 4x4 blocks of XMVECTORs. The format follows from the usage of the texture:
+	//	Color	BC7, or BC1 (opaque) / BC3 with TextureQuality::Fast
+	//	Normal	BC5, tangent space x and y, z has to be reconstructed by the shader
+	//	Mask	BC4, the red channel
+	// Float images (HDR) and images that are already compressed are left as they are
+	class TextureCompressor
+	{
+	public:
+		// DXGI_FORMAT_UNKNOWN if Image should not be compressed
+		[[nodiscard]] static DXGI_FORMAT GetFormat(const DirectX::ScratchImage& Image, TextureUsage Usage, TextureQuality Quality);
+
+		// "BC1" to "BC7" for the formats GetFormat returns, "Uncompressed" for DXGI_FORMAT_UNKNOWN
+		[[nodiscard]] static std::string_view GetFormatName(DXGI_FORMAT Format);
+
+		// Returns false and leaves Compressed empty if Image is not compressed. Uses ParallelFor, so it must not be called
+		// from a thread pool thread
+		static bool Compress(
+			const DirectX::ScratchImage& Image,
+			TextureUsage				 Usage,
+			TextureQuality				 Quality,
+			DirectX::ScratchImage&		 Compressed,
+			TextureCompressionStats*	 Stats = nullptr);
+	};
+} // namespace Asset
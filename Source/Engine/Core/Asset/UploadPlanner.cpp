@@ -0,0 +1,73 @@
+#include "UploadPlanner.h"
+
+namespace Asset
+{
+	UploadPlan UploadPlanner::Plan(Span<const UploadRequest> Requests, const UploadPlannerOptions& Options /*= {}*/)
+	{
+		UploadPlan Plan;
+		Plan.Placements.reserve(Requests.size());
+
+		std::vector<u64> Capacities;
+		u64				 BatchCapacity = 0;
+		UploadBatch		 Batch		   = {};
+
+		auto CloseBatch = [&]()
+		{
+			Batch.NumPages = static_cast<u32>(Plan.PageSizes.size()) - Batch.FirstPage;
+			Plan.Batches.push_back(Batch);
+			Batch			   = {};
+			Batch.FirstRequest = static_cast<u32>(Plan.Placements.size());
+			Batch.FirstPage	   = static_cast<u32>(Plan.PageSizes.size());
+			BatchCapacity	   = 0;
+		};
+
+		for (const UploadRequest& Request : Requests)
+		{
+			assert(Request.Alignment > 0 && (Request.Alignment & (Request.Alignment - 1)) == 0);
+
+			UploadPlacement Placement = { UINT32_MAX, 0 };
+			if (Request.SizeInBytes <= Options.PageSize)
+			{
+				for (u32 Page = Batch.FirstPage; Page < Plan.PageSizes.size(); ++Page)
+				{
+					u64 Offset = AlignUp(Plan.PageSizes[Page], Request.Alignment);
+					if (Offset + Request.SizeInBytes <= Capacities[Page])
+					{
+						Placement = { Page, Offset };
+						break;
+					}
+				}
+			}
+
+			if (Placement.Page == UINT32_MAX)
+			{
+				u64 Capacity = std::max(Request.SizeInBytes, Options.PageSize);
+				if (Batch.NumRequests > 0 && BatchCapacity + Capacity > Options.MaxBatchSizeInBytes)
+				{
+					CloseBatch();
+				}
+
+				Placement = { static_cast<u32>(Plan.PageSizes.size()), 0 };
+				Plan.PageSizes.push_back(0);
+				Capacities.push_back(Capacity);
+				BatchCapacity += Capacity;
+			}
+
+			Plan.PageSizes[Placement.Page] = Placement.Offset + Request.SizeInBytes;
+			Plan.Placements.push_back(Placement);
+			Plan.SizeInBytes += Request.SizeInBytes;
+			Batch.NumRequests++;
+			Batch.SizeInBytes += Request.SizeInBytes;
+		}
+		if (Batch.NumRequests > 0)
+		{
+			CloseBatch();
+		}
+
+		for (u64 PageSize : Plan.PageSizes)
+		{
+			Plan.StagingSizeInBytes += PageSize;
+		}
+		return Plan;
+	}
+} // namespace Asset
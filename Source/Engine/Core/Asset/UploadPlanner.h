@@ -0,0 +1,58 @@
+#pragma once
+#include "System/System.h"
+#include "Math/Math.h"
+
+namespace Asset
+{
+	struct UploadPlannerOptions
+	{
+		// Requests larger than a page get a page of their own
+		u64 PageSize = 64 * 1024 * 1024;
+		// Staging memory of one submission, a batch is closed before a new page would exceed it
+		u64 MaxBatchSizeInBytes = 256 * 1024 * 1024;
+	};
+
+	// SizeInBytes of staging memory at an offset aligned to Alignment (a power of two)
+	struct UploadRequest
+	{
+		u64 SizeInBytes;
+		u64 Alignment;
+	};
+
+	struct UploadPlacement
+	{
+		u32 Page;
+		u64 Offset;
+	};
+
+	// Requests [FirstRequest, FirstRequest + NumRequests) are staged in pages [FirstPage, FirstPage + NumPages) and
+	// submitted together
+	struct UploadBatch
+	{
+		u32 FirstRequest;
+		u32 NumRequests;
+		u32 FirstPage;
+		u32 NumPages;
+		u64 SizeInBytes; // Of the requests, without alignment padding
+	};
+
+	struct UploadPlan
+	{
+		std::vector<UploadPlacement> Placements; // One per request
+		std::vector<u64>			 PageSizes;	 // Trimmed to what was placed in them
+		std::vector<UploadBatch>	 Batches;
+
+		u64 SizeInBytes		   = 0;
+		u64 StagingSizeInBytes = 0;
+	};
+
+	// Packs the staging copies of many assets into few large pages instead of one staging resource per copy. Knows
+	// nothing about the GPU, D3D12AssetUploader executes the plan
+	class UploadPlanner
+	{
+	public:
+		// Requests are placed first fit into the pages of the open batch, in order, so every batch covers a contiguous range
+		// of requests
+		static UploadPlan Plan(Span<const UploadRequest> Requests, const UploadPlannerOptions& Options = {});
+	};
+} // namespace Asset
@@ -0,0 +1,157 @@
+#include "VertexCompression.h"
+#include <DirectXPackedVector.h>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace Asset
+{
+	static constexpr f32 UnormScale = 65535.0f;
+	static constexpr f32 SnormScale = 32767.0f;
+
+	static XMFLOAT2 OctahedralWrap(XMFLOAT2 v)
+	{
+		return { (1.0f - std::abs(v.y)) * (v.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(v.x)) * (v.y >= 0.0f ? 1.0f : -1.0f) };
+	}
+
+	static XMFLOAT2 OctahedralEncode(const XMFLOAT3& v)
+	{
+		f32 Sum = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+		if (Sum == 0.0f)
+		{
+			return { 0.0f, 0.0f };
+		}
+
+		XMFLOAT2 p = { v.x / Sum, v.y / Sum };
+		return v.z < 0.0f ? OctahedralWrap(p) : p;
+	}
+
+	static XMFLOAT3 OctahedralDecode(XMFLOAT2 p)
+	{
+		XMFLOAT3 v = { p.x, p.y, 1.0f - std::abs(p.x) - std::abs(p.y) };
+		if (v.z < 0.0f)
+		{
+			XMFLOAT2 Wrapped = OctahedralWrap({ v.x, v.y });
+			v.x				 = Wrapped.x;
+			v.y				 = Wrapped.y;
+		}
+		XMStoreFloat3(&v, XMVector3Normalize(XMLoadFloat3(&v)));
+		return v;
+	}
+
+	static u16 QuantizeUnorm(f32 v)
+	{
+		return static_cast<u16>(std::clamp(v, 0.0f, 1.0f) * UnormScale + 0.5f);
+	}
+
+	static i16 QuantizeSnorm(f32 v)
+	{
+		return static_cast<i16>(std::round(std::clamp(v, -1.0f, 1.0f) * SnormScale));
+	}
+
+	void VertexCompression::Encode(Span<const Vertex> Vertices, const Math::BoundingBox& BoundingBox, std::vector<CompressedVertex>& CompressedVertices)
+	{
+		const Math::Vec3f Min	= BoundingBox.Center - BoundingBox.Extents;
+		const Math::Vec3f Scale = {
+			BoundingBox.Extents.x > 0.0f ? 0.5f / BoundingBox.Extents.x : 0.0f,
+			BoundingBox.Extents.y > 0.0f ? 0.5f / BoundingBox.Extents.y : 0.0f,
+			BoundingBox.Extents.z > 0.0f ? 0.5f / BoundingBox.Extents.z : 0.0f,
+		};
+
+		CompressedVertices.resize(Vertices.size());
+		for (size_t i = 0; i < Vertices.size(); ++i)
+		{
+			const Vertex&	  Source = Vertices[i];
+			CompressedVertex& Dest	 = CompressedVertices[i];
+
+			Dest.Position[0] = QuantizeUnorm((Source.Position.x - Min.x) * Scale.x);
+			Dest.Position[1] = QuantizeUnorm((Source.Position.y - Min.y) * Scale.y);
+			Dest.Position[2] = QuantizeUnorm((Source.Position.z - Min.z) * Scale.z);
+			Dest.Padding	 = 0;
+
+			XMFLOAT2 Normal = OctahedralEncode(Source.Normal);
+			Dest.Normal[0]	= QuantizeSnorm(Normal.x);
+			Dest.Normal[1]	= QuantizeSnorm(Normal.y);
+
+			Dest.TextureCoord[0] = XMConvertFloatToHalf(Source.TextureCoord.x);
+			Dest.TextureCoord[1] = XMConvertFloatToHalf(Source.TextureCoord.y);
+		}
+	}
+
+	void VertexCompression::Decode(Span<const CompressedVertex> CompressedVertices, const Math::BoundingBox& BoundingBox, Vertex* Vertices)
+	{
+		const Math::Vec3f Min	= BoundingBox.Center - BoundingBox.Extents;
+		const Math::Vec3f Scale = BoundingBox.Extents * (2.0f / UnormScale);
+
+		for (size_t i = 0; i < CompressedVertices.size(); ++i)
+		{
+			const CompressedVertex& Source = CompressedVertices[i];
+			Vertex&					Dest   = Vertices[i];
+
+			Dest.Position = {
+				Min.x + static_cast<f32>(Source.Position[0]) * Scale.x,
+				Min.y + static_cast<f32>(Source.Position[1]) * Scale.y,
+				Min.z + static_cast<f32>(Source.Position[2]) * Scale.z,
+			};
+			Dest.Normal = OctahedralDecode({
+				std::max(static_cast<f32>(Source.Normal[0]) / SnormScale, -1.0f),
+				std::max(static_cast<f32>(Source.Normal[1]) / SnormScale, -1.0f),
+			});
+			Dest.TextureCoord = {
+				XMConvertHalfToFloat(Source.TextureCoord[0]),
+				XMConvertHalfToFloat(Source.TextureCoord[1]),
+			};
+		}
+	}
+
+	VertexCompressionError VertexCompression::GetErrorBound(const Math::BoundingBox& BoundingBox)
+	{
+		const f32 MaxExtent = std::max({ BoundingBox.Extents.x, BoundingBox.Extents.y, BoundingBox.Extents.z });
+
+		VertexCompressionError Error;
+		// Half a quantization step of the largest axis
+		Error.Position = MaxExtent / UnormScale;
+		// Half a step on both octahedral components, the octahedral map stretches directions by at most a factor of two
+		Error.Normal = XMConvertToDegrees(2.0f * (0.5f / SnormScale) * 2.0f);
+		// Round to nearest with an 11 bit significand
+		Error.TextureCoord = 1.0f / 2048.0f;
+		return Error;
+	}
+
+	VertexCompressionError VertexCompression::Measure(
+		Span<const Vertex>			 Vertices,
+		Span<const CompressedVertex> CompressedVertices,
+		const Math::BoundingBox&	 BoundingBox)
+	{
+		std::vector<Vertex> Decoded(CompressedVertices.size());
+		Decode(CompressedVertices, BoundingBox, Decoded.data());
+
+		VertexCompressionError Error;
+		for (size_t i = 0; i < Vertices.size(); ++i)
+		{
+			const Vertex& a = Vertices[i];
+			const Vertex& b = Decoded[i];
+
+			Error.Position = std::max({ Error.Position,
+										std::abs(a.Position.x - b.Position.x),
+										std::abs(a.Position.y - b.Position.y),
+										std::abs(a.Position.z - b.Position.z) });
+
+			XMVECTOR Normal = XMVector3Normalize(XMLoadFloat3(&a.Normal));
+			if (!XMVector3Equal(Normal, XMVectorZero()))
+			{
+				f32 Angle	 = XMVectorGetX(XMVector3AngleBetweenNormals(Normal, XMLoadFloat3(&b.Normal)));
+				Error.Normal = std::max(Error.Normal, XMConvertToDegrees(Angle));
+			}
+
+			auto Relative = [](f32 Value, f32 Decoded)
+			{
+				return std::abs(Value - Decoded) / std::max(std::abs(Value), 1.0f);
+			};
+			Error.TextureCoord = std::max({ Error.TextureCoord,
+											Relative(a.TextureCoord.x, b.TextureCoord.x),
+											Relative(a.TextureCoord.y, b.TextureCoord.y) });
+		}
+		return Error;
+	}
+} // namespace Asset
@@ -0,0 +1,47 @@
+#pragma once
+#include "System/System.h"
+#include "Math/Math.h"
+#include "Core/World/Vertex.h"
+
+namespace Asset
+{
+	// 16 byte encoding of Vertex:
+	//	Position		16-bit unorm per axis, relative to the mesh bounding box
+	//	Normal			octahedral, 16-bit snorm per component (matches OctahedralVector in Math.hlsli)
+	//	TextureCoord	half precision
+	struct CompressedVertex
+	{
+		u16 Position[3];
+		u16 Padding;
+		i16 Normal[2];
+		u16 TextureCoord[2];
+	};
+	static_assert(sizeof(CompressedVertex) == 16);
+
+	// Maximum error of a decoded vertex, Position in world units, Normal in degrees,
+	// TextureCoord relative to the magnitude of the coordinate
+	struct VertexCompressionError
+	{
+		f32 Position	 = 0.0f;
+		f32 Normal		 = 0.0f;
+		f32 TextureCoord = 0.0f;
+	};
+
+	class VertexCompression
+	{
+	public:
+		// Positions are quantized relative to BoundingBox, which must contain every vertex and is needed to decode
+		static void Encode(Span<const Vertex> Vertices, const Math::BoundingBox& BoundingBox, std::vector<CompressedVertex>& CompressedVertices);
+
+		static void Decode(Span<const CompressedVertex> CompressedVertices, const Math::BoundingBox& BoundingBox, Vertex* Vertices);
+
+		// Analytic bound for any mesh within BoundingBox
+		[[nodiscard]] static VertexCompressionError GetErrorBound(const Math::BoundingBox& BoundingBox);
+
+		// Largest error actually introduced by the encoding
+		[[nodiscard]] static VertexCompressionError Measure(
+			Span<const Vertex>			 Vertices,
+			Span<const CompressedVertex> CompressedVertices,
+			const Math::BoundingBox&	 BoundingBox);
+	};
+} // namespace Asset
@@ -0,0 +1,210 @@
+#include "VertexWelder.h"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <memory>
+
+namespace Asset
+{
+	using VertexKey = std::array<u32, 8>;
+
+	// Vertices are processed in blocks so ParallelFor hands out a meaningful amount of work per index
+	constexpr size_t BlockSize = 16 * 1024;
+
+	constexpr u32 EmptySlot = UINT32_MAX;
+
+	static VertexKey Quantize(const Vertex& Vertex, f32 InverseEpsilon) noexcept
+	{
+		const f32 Values[8] = { Vertex.Position.x,	   Vertex.Position.y, Vertex.Position.z, Vertex.TextureCoord.x,
+								Vertex.TextureCoord.y, Vertex.Normal.x,	  Vertex.Normal.y,	 Vertex.Normal.z };
+
+		VertexKey Key;
+		for (size_t i = 0; i < Key.size(); ++i)
+		{
+			// Cells beyond the range of i32 (and NaNs) fall back to exact comparison
+			const f32 Cell = std::floor(Values[i] * InverseEpsilon + 0.5f);
+			if (InverseEpsilon > 0.0f && std::abs(Cell) < 2e9f)
+			{
+				Key[i] = static_cast<u32>(static_cast<i32>(Cell));
+			}
+			else
+			{
+				// + 0.0f turns -0 into 0
+				Key[i] = std::bit_cast<u32>(Values[i] + 0.0f);
+			}
+		}
+		return Key;
+	}
+
+	static u64 HashKey(const VertexKey& Key) noexcept
+	{
+		u64 Seed = 0x9E3779B97F4A7C15ull;
+		for (u32 Value : Key)
+		{
+			Seed = (Seed ^ Value) * 0xFF51AFD7ED558CCDull;
+			Seed ^= Seed >> 32;
+		}
+		return Seed;
+	}
+
+	VertexWeldStats VertexWelder::Weld(std::vector<Vertex>& Vertices, std::vector<u32>& Indices, f32 Epsilon /*= 0.0f*/)
+	{
+		VertexWeldStats Stats;
+		Stats.NumVerticesBefore = Vertices.size();
+		Stats.NumVerticesAfter	= Vertices.size();
+		if (Vertices.empty() || Vertices.size() >= EmptySlot)
+		{
+			return Stats;
+		}
+
+		i64 Start = Stopwatch::GetTimestamp();
+
+		const size_t NumVertices = Vertices.size();
+		const size_t NumBlocks	 = (NumVertices + BlockSize - 1) / BlockSize;
+		const f32	 Inverse	 = Epsilon > 0.0f ? 1.0f / Epsilon : 0.0f;
+
+		// At most half full so probe sequences stay short
+		const size_t TableSize = std::bit_ceil(NumVertices * 2);
+		const u64	 Mask	   = TableSize - 1;
+
+		std::vector<VertexKey>				 Keys(NumVertices);
+		std::vector<u64>					 Hashes(NumVertices);
+		std::unique_ptr<std::atomic<u32>[]> Table(new std::atomic<u32>[TableSize]);
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				const size_t First = Block * BlockSize;
+				const size_t Last  = std::min(First + BlockSize, NumVertices);
+				for (size_t i = First; i < Last; ++i)
+				{
+					Keys[i]	  = Quantize(Vertices[i], Inverse);
+					Hashes[i] = HashKey(Keys[i]);
+				}
+				// The table is twice as large, every block clears its share of it
+				for (size_t Slot = First * 2; Slot < std::min(Last * 2, TableSize); ++Slot)
+				{
+					Table[Slot].store(EmptySlot, std::memory_order_relaxed);
+				}
+				if (Block == NumBlocks - 1)
+				{
+					for (size_t Slot = Last * 2; Slot < TableSize; ++Slot)
+					{
+						Table[Slot].store(EmptySlot, std::memory_order_relaxed);
+					}
+				}
+			});
+
+		// A slot ends up holding the lowest index of the vertices equal to it, whichever thread got there first
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				const size_t Last = std::min((Block + 1) * BlockSize, NumVertices);
+				for (u32 i = static_cast<u32>(Block * BlockSize); i < Last; ++i)
+				{
+					for (u64 Slot = Hashes[i] & Mask;; Slot = (Slot + 1) & Mask)
+					{
+						u32	 Current  = Table[Slot].load(std::memory_order_relaxed);
+						bool Inserted = false;
+						bool Occupied = false;
+						while (!Inserted && !Occupied)
+						{
+							if (Current == EmptySlot || (Current > i && Keys[Current] == Keys[i]))
+							{
+								Inserted = Table[Slot].compare_exchange_weak(Current, i, std::memory_order_relaxed);
+							}
+							else
+							{
+								// Taken by another class, or by a lower index of this one
+								Occupied = Keys[Current] != Keys[i];
+								Inserted = !Occupied;
+							}
+						}
+						if (Inserted)
+						{
+							break;
+						}
+					}
+				}
+			});
+
+		// Representative of every vertex, and how many vertices of each block represent themselves
+		std::vector<u32> Remap(NumVertices);
+		std::vector<u32> BlockOffsets(NumBlocks + 1);
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				const size_t Last	   = std::min((Block + 1) * BlockSize, NumVertices);
+				u32			 NumUnique = 0;
+				for (size_t i = Block * BlockSize; i < Last; ++i)
+				{
+					u64 Slot = Hashes[i] & Mask;
+					while (Keys[Table[Slot].load(std::memory_order_relaxed)] != Keys[i])
+					{
+						Slot = (Slot + 1) & Mask;
+					}
+					Remap[i] = Table[Slot].load(std::memory_order_relaxed);
+					NumUnique += Remap[i] == i;
+				}
+				BlockOffsets[Block + 1] = NumUnique;
+			});
+		for (size_t Block = 0; Block < NumBlocks; ++Block)
+		{
+			BlockOffsets[Block + 1] += BlockOffsets[Block];
+		}
+
+		// Representatives keep their relative order, the others take the new index of theirs, which comes before them
+		std::vector<Vertex> Welded(BlockOffsets[NumBlocks]);
+		std::vector<u32>	NewIndices(NumVertices);
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				const size_t Last  = std::min((Block + 1) * BlockSize, NumVertices);
+				u32			 Index = BlockOffsets[Block];
+				for (size_t i = Block * BlockSize; i < Last; ++i)
+				{
+					if (Remap[i] == i)
+					{
+						NewIndices[i]	= Index;
+						Welded[Index++] = Vertices[i];
+					}
+				}
+			});
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumBlocks,
+			[&](size_t Block)
+			{
+				const size_t Last = std::min((Block + 1) * BlockSize, NumVertices);
+				for (size_t i = Block * BlockSize; i < Last; ++i)
+				{
+					Remap[i] = NewIndices[Remap[i]];
+				}
+			});
+
+		const size_t NumIndexBlocks = (Indices.size() + BlockSize - 1) / BlockSize;
+		ParallelFor(
+			Process::GetThreadPool(),
+			NumIndexBlocks,
+			[&](size_t Block)
+			{
+				const size_t Last = std::min((Block + 1) * BlockSize, Indices.size());
+				for (size_t i = Block * BlockSize; i < Last; ++i)
+				{
+					Indices[i] = Remap[Indices[i]];
+				}
+			});
+
+		Vertices			   = std::move(Welded);
+		Stats.NumVerticesAfter = Vertices.size();
+		Stats.Ticks			   = Stopwatch::GetTimestamp() - Start;
+		return Stats;
+	}
+} // namespace Asset
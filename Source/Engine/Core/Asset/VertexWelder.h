@@ -0,0 +1,30 @@
+#pragma once
+#include "System/System.h"
+#include "Core/World/Vertex.h"
+
+namespace Asset
+{
+	struct VertexWeldStats
+	{
+		u64 NumVerticesBefore = 0;
+		u64 NumVerticesAfter  = 0;
+		i64 Ticks			  = 0; // Stopwatch ticks
+
+		[[nodiscard]] f64 GetReductionRatio() const noexcept
+		{
+			return NumVerticesBefore > 0 ? 1.0 - static_cast<f64>(NumVerticesAfter) / static_cast<f64>(NumVerticesBefore) : 0.0;
+		}
+	};
+
+	// Merges vertices with identical attributes, what aiProcess_JoinIdenticalVertices does but in parallel. Every attribute
+	// is quantized to a grid of Epsilon (0 compares bit patterns, with -0 equal to 0) and vertices are inserted into a lock
+	// free open addressing table keyed on the quantized attributes. Each class of equal vertices is represented by its first
+	// vertex, so the result does not depend on scheduling and keeps the order of first use.
+	// Vertices closer than Epsilon that fall into neighbouring grid cells are not merged
+	class VertexWelder
+	{
+	public:
+		// Uses ParallelFor, so it must not be called from a thread pool thread
+		static VertexWeldStats Weld(std::vector<Vertex>& Vertices, std::vector<u32>& Indices, f32 Epsilon = 0.0f);
+	};
+} // namespace Asset
@@ -63,6 +63,9 @@ struct StaticMeshComponent
 	uint32_t		   HandleId = UINT32_MAX;
 	Asset::Mesh*	   Mesh		= nullptr;
 
+	// Of Mesh once it was acquired, out of view meshes are culled with it while they are evicted
+	std::optional<Math::BoundingBox> Bounds;
+
 	Material Material;
 };
 
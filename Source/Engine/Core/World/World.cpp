@@ -55,43 +55,67 @@ void World::Update(float DeltaTime)
 	UpdateScripts(DeltaTime);
 }
 
+void World::AcquireAssets(StaticMeshComponent& StaticMesh)
+{
+	auto Handle		= StaticMesh.Handle;
+	StaticMesh.Mesh = AssetManager->AcquireMesh(Handle);
+	if (StaticMesh.Mesh)
+	{
+		StaticMesh.Bounds = StaticMesh.Mesh->BoundingBox;
+	}
+
+	Handle		 = StaticMesh.Material.Albedo.Handle;
+	auto Texture = AssetManager->AcquireTexture(Handle);
+	if (Texture)
+	{
+		StaticMesh.Material.TextureIndices[0] = Texture->Srv.GetIndex();
+	}
+	else
+	{
+		// Not loaded yet or evicted, its descriptor is gone
+		StaticMesh.Material.TextureIndices[0] = -1;
+	}
+}
+
+void World::AcquireAssets(SkyLightComponent& SkyLight)
+{
+	auto Handle		 = SkyLight.Handle;
+	auto Texture	 = AssetManager->AcquireTexture(Handle);
+	SkyLight.Texture = Texture;
+	if (Texture)
+	{
+		SkyLight.SRVIndex = Texture->Srv.GetIndex();
+	}
+	else
+	{
+		SkyLight.SRVIndex = -1;
+	}
+}
+
 void World::ResolveComponentDependencies()
 {
-	// Refresh StaticMeshComponent
+	// Refresh the ids saved with the world, without acquiring the assets of components that are not drawn
+	auto& MeshRegistry	  = AssetManager->GetMeshRegistry();
+	auto& TextureRegistry = AssetManager->GetTextureRegistry();
 	Registry.view<StaticMeshComponent>().each(
-		[this](StaticMeshComponent& StaticMesh)
+		[&](StaticMeshComponent& StaticMesh)
 		{
+			if (MeshRegistry.GetAsset(StaticMesh.Handle))
 			{
-				auto Handle			= StaticMesh.Handle;
-				StaticMesh.Mesh		= AssetManager->GetMeshRegistry().GetValidAsset(Handle);
-				StaticMesh.HandleId = Handle.Id;
+				StaticMesh.HandleId = StaticMesh.Handle.Id;
 			}
-
+			if (TextureRegistry.GetAsset(StaticMesh.Material.Albedo.Handle))
 			{
-				auto Handle	 = StaticMesh.Material.Albedo.Handle;
-				auto Texture = AssetManager->GetTextureRegistry().GetValidAsset(Handle);
-				if (Texture)
-				{
-					StaticMesh.Material.Albedo.HandleId	  = Handle.Id;
-					StaticMesh.Material.TextureIndices[0] = Texture->Srv.GetIndex();
-				}
+				StaticMesh.Material.Albedo.HandleId = StaticMesh.Material.Albedo.Handle.Id;
 			}
 		});
 
 	Registry.view<SkyLightComponent>().each(
-		[this](SkyLightComponent& SkyLight)
+		[&](SkyLightComponent& SkyLight)
 		{
-			auto Handle		 = SkyLight.Handle;
-			auto Texture	 = AssetManager->GetTextureRegistry().GetValidAsset(Handle);
-			SkyLight.Texture = Texture;
-			if (Texture)
-			{
-				SkyLight.HandleId = Handle.Id;
-				SkyLight.SRVIndex = Texture->Srv.GetIndex();
-			}
-			else
+			if (TextureRegistry.GetAsset(SkyLight.Handle))
 			{
-				SkyLight.SRVIndex = -1;
+				SkyLight.HandleId = SkyLight.Handle.Id;
 			}
 		});
 }
@@ -47,6 +47,11 @@ public:
 
 	void Update(float DeltaTime);
 
+	// Resolves the assets a component is drawn with this frame. Only called for what is drawn, the assets of everything
+	// else go unused and are evicted once the residency budget is exceeded
+	void AcquireAssets(StaticMeshComponent& StaticMesh);
+	void AcquireAssets(SkyLightComponent& SkyLight);
+
 private:
 	void ResolveComponentDependencies();
 	void UpdateScripts(float DeltaTime);
@@ -46,19 +46,33 @@ void WorldArchive::Save(
 		AssetManager->GetTextureRegistry().EnumerateAsset(
 			[&](Asset::AssetHandle Handle, Asset::Texture* Resource)
 			{
-				std::filesystem::path AssetPath		   = relative(Resource->Options.Path, Process::ExecutableDirectory);
-				auto&				  JsonTexture	   = JsonTextures[AssetPath.string()];
-				JsonTexture["Options"]["sRGB"]		   = Resource->Options.sRGB;
-				JsonTexture["Options"]["GenerateMips"] = Resource->Options.GenerateMips;
+				std::filesystem::path AssetPath			   = relative(Resource->Options.Path, Process::ExecutableDirectory);
+				auto&				  JsonTexture		   = JsonTextures[AssetPath.string()];
+				JsonTexture["Options"]["sRGB"]			   = Resource->Options.sRGB;
+				JsonTexture["Options"]["GenerateMips"]	   = Resource->Options.GenerateMips;
+				JsonTexture["Options"]["Filter"]		   = Resource->Options.Filter;
+				JsonTexture["Options"]["Compress"]		   = Resource->Options.Compress;
+				JsonTexture["Options"]["Usage"]			   = Resource->Options.Usage;
+				JsonTexture["Options"]["Quality"]		   = Resource->Options.Quality;
+				JsonTexture["Options"]["ConvertToCubemap"] = Resource->Options.ConvertToCubemap;
 			});
 
 		auto& JsonMeshes = Json["Meshes"];
 		AssetManager->GetMeshRegistry().EnumerateAsset(
 			[&](Asset::AssetHandle Handle, Asset::Mesh* Resource)
 			{
-				std::filesystem::path AssetPath			= relative(Resource->Options.Path, Process::ExecutableDirectory);
-				auto&				  JsonMesh			= JsonMeshes[AssetPath.string()];
-				JsonMesh["Options"]["GenerateMeshlets"] = Resource->Options.GenerateMeshlets;
+				std::filesystem::path AssetPath			   = relative(Resource->Options.Path, Process::ExecutableDirectory);
+				auto&				  JsonMesh			   = JsonMeshes[AssetPath.string()];
+				JsonMesh["Options"]["GenerateMeshlets"]	   = Resource->Options.GenerateMeshlets;
+				JsonMesh["Options"]["WeldEpsilon"]		   = Resource->Options.WeldEpsilon;
+				JsonMesh["Options"]["ClusterTriangles"]	   = Resource->Options.ClusterTriangles;
+				JsonMesh["Options"]["OptimizeVertexCache"] = Resource->Options.OptimizeVertexCache;
+				JsonMesh["Options"]["OptimizeOverdraw"]	   = Resource->Options.OptimizeOverdraw;
+				JsonMesh["Options"]["CompressVertices"]	   = Resource->Options.CompressVertices;
+				JsonMesh["Options"]["CompressIndices"]	   = Resource->Options.CompressIndices;
+				JsonMesh["Options"]["NumLods"]			   = Resource->Options.NumLods;
+				JsonMesh["Options"]["LodRatio"]			   = Resource->Options.LodRatio;
+				JsonMesh["Options"]["LodMaxError"]		   = Resource->Options.LodMaxError;
 			});
 
 		auto& JsonCamera = Json["Camera"];
@@ -118,14 +132,90 @@ void JsonGetIfExists(const json::value_type& Json, const char* Key, T& RefValue)
 	}
 }
 
+static Asset::MeshImportOptions ParseMeshImportOptions(const std::string& Key, const json::value_type& Value)
+{
+	Asset::MeshImportOptions Options = {};
+	Options.Path					 = Process::ExecutableDirectory / Key;
+
+	if (Value.contains("Options"))
+	{
+		auto& JsonOptions = Value["Options"];
+		JsonGetIfExists<bool>(JsonOptions, "GenerateMeshlets", Options.GenerateMeshlets);
+		JsonGetIfExists<f32>(JsonOptions, "WeldEpsilon", Options.WeldEpsilon);
+		JsonGetIfExists<u32>(JsonOptions, "ClusterTriangles", Options.ClusterTriangles);
+		JsonGetIfExists<bool>(JsonOptions, "OptimizeVertexCache", Options.OptimizeVertexCache);
+		JsonGetIfExists<bool>(JsonOptions, "OptimizeOverdraw", Options.OptimizeOverdraw);
+		JsonGetIfExists<bool>(JsonOptions, "CompressVertices", Options.CompressVertices);
+		JsonGetIfExists<bool>(JsonOptions, "CompressIndices", Options.CompressIndices);
+		JsonGetIfExists<u32>(JsonOptions, "NumLods", Options.NumLods);
+		JsonGetIfExists<f32>(JsonOptions, "LodRatio", Options.LodRatio);
+		JsonGetIfExists<f32>(JsonOptions, "LodMaxError", Options.LodMaxError);
+	}
+	return Options;
+}
+
+static Asset::TextureImportOptions ParseTextureImportOptions(const std::string& Key, const json::value_type& Value)
+{
+	Asset::TextureImportOptions Options = {};
+	Options.Path						= Process::ExecutableDirectory / Key;
+
+	if (Value.contains("Options"))
+	{
+		auto& JsonOptions = Value["Options"];
+		JsonGetIfExists<bool>(JsonOptions, "sRGB", Options.sRGB);
+		JsonGetIfExists<bool>(JsonOptions, "GenerateMips", Options.GenerateMips);
+		JsonGetIfExists<Asset::MipFilter>(JsonOptions, "Filter", Options.Filter);
+		JsonGetIfExists<bool>(JsonOptions, "Compress", Options.Compress);
+		JsonGetIfExists<Asset::TextureUsage>(JsonOptions, "Usage", Options.Usage);
+		JsonGetIfExists<Asset::TextureQuality>(JsonOptions, "Quality", Options.Quality);
+		JsonGetIfExists<bool>(JsonOptions, "ConvertToCubemap", Options.ConvertToCubemap);
+	}
+	return Options;
+}
+
+std::vector<Asset::MeshImportOptions> WorldArchive::GetMeshImportOptions(const std::filesystem::path& Path)
+{
+	std::ifstream ifs(Path);
+	json		  Json;
+	ifs >> Json;
+
+	std::vector<Asset::MeshImportOptions> MeshImportOptions;
+	if (Json.contains("Meshes"))
+	{
+		const auto& JsonMeshes = Json["Meshes"];
+		for (auto iter = JsonMeshes.begin(); iter != JsonMeshes.end(); ++iter)
+		{
+			MeshImportOptions.push_back(ParseMeshImportOptions(iter.key(), iter.value()));
+		}
+	}
+	return MeshImportOptions;
+}
+
+std::vector<Asset::TextureImportOptions> WorldArchive::GetTextureImportOptions(const std::filesystem::path& Path)
+{
+	std::ifstream ifs(Path);
+	json		  Json;
+	ifs >> Json;
+
+	std::vector<Asset::TextureImportOptions> TextureImportOptions;
+	if (Json.contains("Textures"))
+	{
+		const auto& JsonTextures = Json["Textures"];
+		for (auto iter = JsonTextures.begin(); iter != JsonTextures.end(); ++iter)
+		{
+			TextureImportOptions.push_back(ParseTextureImportOptions(iter.key(), iter.value()));
+		}
+	}
+	return TextureImportOptions;
+}
+
 void WorldArchive::Load(
 	const std::filesystem::path& Path,
 	World*						 World,
 	CameraComponent*			 Camera,
 	Asset::AssetManager*		 AssetManager)
 {
-	AssetManager->GetTextureRegistry().DestroyAll();
-	AssetManager->GetMeshRegistry().DestroyAll();
+	AssetManager->DestroyAll();
 
 	std::ifstream ifs(Path);
 	json		  Json;
@@ -144,17 +234,7 @@ void WorldArchive::Load(
 		const auto& JsonTextures = Json["Textures"];
 		for (auto iter = JsonTextures.begin(); iter != JsonTextures.end(); ++iter)
 		{
-			Asset::TextureImportOptions Options = {};
-			Options.Path						= Process::ExecutableDirectory / iter.key();
-
-			if (auto& Value = iter.value(); Value.contains("Options"))
-			{
-				auto& JsonOptions = Value["Options"];
-				JsonGetIfExists<bool>(JsonOptions, "sRGB", Options.sRGB);
-				JsonGetIfExists<bool>(JsonOptions, "GenerateMips", Options.GenerateMips);
-			}
-
-			AssetManager->LoadTexture(Options);
+			AssetManager->LoadTextureAsync(ParseTextureImportOptions(iter.key(), iter.value()));
 		}
 	}
 
@@ -163,17 +243,7 @@ void WorldArchive::Load(
 		const auto& JsonMeshes = Json["Meshes"];
 		for (auto iter = JsonMeshes.begin(); iter != JsonMeshes.end(); ++iter)
 		{
-			Asset::MeshImportOptions Options = {};
-			Options.Path					 = Process::ExecutableDirectory / iter.key();
-
-			auto& Value = iter.value();
-			if (Value.contains("Options"))
-			{
-				auto& JsonOptions = Value["Options"];
-				JsonGetIfExists<bool>(JsonOptions, "GenerateMeshlets", Options.GenerateMeshlets);
-			}
-
-			AssetManager->LoadMesh(Options);
+			AssetManager->LoadMeshAsync(ParseMeshImportOptions(iter.key(), iter.value()));
 		}
 	}
 
@@ -199,6 +269,10 @@ void WorldArchive::Load(
 	{
 		World->Clear(false);
 
+		// Assets are recreated in the slots they were saved from, their versions carry on from before DestroyAll
+		auto& MeshRegistry	  = AssetManager->GetMeshRegistry();
+		auto& TextureRegistry = AssetManager->GetTextureRegistry();
+
 		const auto& JsonWorld = Json["World"];
 		for (const auto& JsonEntity : JsonWorld)
 		{
@@ -209,17 +283,22 @@ void WorldArchive::Load(
 			ComponentDeserializer<StaticMeshComponent>(JsonEntity, &Actor);
 			if (Actor.HasComponent<SkyLightComponent>())
 			{
-				auto& SkyLight		  = Actor.GetComponent<SkyLightComponent>();
-				SkyLight.Handle.Type  = Asset::AssetType::Texture;
-				SkyLight.Handle.State = false;
-				SkyLight.Handle.Id	  = SkyLight.HandleId;
+				auto& SkyLight			= Actor.GetComponent<SkyLightComponent>();
+				SkyLight.Handle.Type	= Asset::AssetType::Texture;
+				SkyLight.Handle.State	= false;
+				SkyLight.Handle.Id		= SkyLight.HandleId;
+				SkyLight.Handle.Version = TextureRegistry.GetSlotVersion(SkyLight.HandleId);
 			}
 			if (Actor.HasComponent<StaticMeshComponent>())
 			{
-				auto& StaticMesh		= Actor.GetComponent<StaticMeshComponent>();
-				StaticMesh.Handle.Type	= Asset::AssetType::Mesh;
-				StaticMesh.Handle.State = false;
-				StaticMesh.Handle.Id	= StaticMesh.HandleId;
+				auto& StaticMesh		  = Actor.GetComponent<StaticMeshComponent>();
+				StaticMesh.Handle.Type	  = Asset::AssetType::Mesh;
+				StaticMesh.Handle.State	  = false;
+				StaticMesh.Handle.Id	  = StaticMesh.HandleId;
+				StaticMesh.Handle.Version = MeshRegistry.GetSlotVersion(StaticMesh.HandleId);
+
+				auto& Albedo		  = StaticMesh.Material.Albedo;
+				Albedo.Handle.Version = TextureRegistry.GetSlotVersion(Albedo.HandleId);
 			}
 		}
 	}
@@ -7,6 +7,8 @@ class World;
 namespace Asset
 {
 	class AssetManager;
+	struct MeshImportOptions;
+	struct TextureImportOptions;
 }
 
 class WorldArchive
@@ -23,4 +25,10 @@ public:
 		World*						 World,
 		CameraComponent*			 Camera,
 		Asset::AssetManager*		 AssetManager);
+
+	// Import options of every mesh a world references, nothing is loaded
+	static std::vector<Asset::MeshImportOptions> GetMeshImportOptions(const std::filesystem::path& Path);
+
+	// Import options of every texture a world references, nothing is loaded
+	static std::vector<Asset::TextureImportOptions> GetTextureImportOptions(const std::filesystem::path& Path);
 };
@@ -85,7 +85,7 @@ inline void from_json(const json& Json, MaterialTexture& OutMaterialTexture)
 
 	OutMaterialTexture.Handle.Type	= Asset::AssetType::Texture;
 	OutMaterialTexture.Handle.State = false;
-	OutMaterialTexture.Handle.Id	= OutMaterialTexture.HandleId;
+	OutMaterialTexture.Handle.Id	= OutMaterialTexture.HandleId; // Versioned by WorldArchive::Load
 }
 
 inline void to_json(json& Json, const Material& InMaterial)
@@ -14,6 +14,9 @@ namespace Math
 
 		[[nodiscard]] ContainmentType Contains(const BoundingBox& Box) const noexcept;
 
+		// Conservative, spheres just outside of a corner are reported as intersecting
+		[[nodiscard]] bool Intersects(const Vec3f& Center, float Radius) const noexcept;
+
 		Plane Left;	  // -x
 		Plane Right;  // +x
 		Plane Bottom; // -y
@@ -107,4 +110,16 @@ namespace Math
 
 		return ContainmentType::Intersects;
 	}
+
+	inline bool Frustum::Intersects(const Vec3f& Center, float Radius) const noexcept
+	{
+		for (const Plane& Plane : { Left, Right, Bottom, Top, Near, Far })
+		{
+			if (dot(Plane.Normal, Center) - Plane.Offset < -Radius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 } // namespace Math
@@ -109,18 +109,9 @@ namespace RHI
 
 	void D3D12LinkedDevice::Upload(const std::vector<D3D12_SUBRESOURCE_DATA>& Subresources, ID3D12Resource* Resource)
 	{
-		const auto					NumSubresources = static_cast<UINT>(Subresources.size());
-		const UINT64				UploadSize		= GetRequiredIntermediateSize(Resource, 0, NumSubresources);
-		const D3D12_HEAP_PROPERTIES HeapProperties	= CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD, NodeMask, NodeMask);
-		const D3D12_RESOURCE_DESC	ResourceDesc	= CD3DX12_RESOURCE_DESC::Buffer(UploadSize);
-		Arc<ID3D12Resource>			UploadResource;
-		VERIFY_D3D12_API(GetDevice()->CreateCommittedResource(
-			&HeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&ResourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(UploadResource.ReleaseAndGetAddressOf())));
+		const auto			NumSubresources = static_cast<UINT>(Subresources.size());
+		const UINT64		UploadSize		= GetRequiredIntermediateSize(Resource, 0, NumSubresources);
+		Arc<ID3D12Resource> UploadResource	= CreateUploadBuffer(UploadSize);
 
 		UpdateSubresources(
 			UploadContext.GetGraphicsCommandList(),
@@ -136,17 +127,8 @@ namespace RHI
 
 	void D3D12LinkedDevice::Upload(const D3D12_SUBRESOURCE_DATA& Subresource, ID3D12Resource* Resource)
 	{
-		const UINT64				UploadSize	   = GetRequiredIntermediateSize(Resource, 0, 1);
-		const D3D12_HEAP_PROPERTIES HeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD, NodeMask, NodeMask);
-		const D3D12_RESOURCE_DESC	ResourceDesc   = CD3DX12_RESOURCE_DESC::Buffer(UploadSize);
-		Arc<ID3D12Resource>			UploadResource;
-		VERIFY_D3D12_API(GetDevice()->CreateCommittedResource(
-			&HeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&ResourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(UploadResource.ReleaseAndGetAddressOf())));
+		const UINT64		UploadSize	   = GetRequiredIntermediateSize(Resource, 0, 1);
+		Arc<ID3D12Resource> UploadResource = CreateUploadBuffer(UploadSize);
 
 		UpdateSubresources<1>(
 			UploadContext.GetGraphicsCommandList(),
@@ -170,6 +152,37 @@ namespace RHI
 		Upload(SubresourceData, Resource);
 	}
 
+	void D3D12LinkedDevice::Upload(
+		const std::vector<D3D12_SUBRESOURCE_DATA>& Subresources,
+		ID3D12Resource*							   Resource,
+		ID3D12Resource*							   Staging,
+		UINT64									   StagingOffset)
+	{
+		UpdateSubresources(
+			UploadContext.GetGraphicsCommandList(),
+			Resource,
+			Staging,
+			StagingOffset,
+			0,
+			static_cast<UINT>(Subresources.size()),
+			Subresources.data());
+	}
+
+	Arc<ID3D12Resource> D3D12LinkedDevice::CreateUploadBuffer(UINT64 SizeInBytes)
+	{
+		const D3D12_HEAP_PROPERTIES HeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD, NodeMask, NodeMask);
+		const D3D12_RESOURCE_DESC	ResourceDesc   = CD3DX12_RESOURCE_DESC::Buffer(SizeInBytes);
+		Arc<ID3D12Resource>			UploadResource;
+		VERIFY_D3D12_API(GetDevice()->CreateCommittedResource(
+			&HeapProperties,
+			D3D12_HEAP_FLAG_NONE,
+			&ResourceDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(UploadResource.ReleaseAndGetAddressOf())));
+		return UploadResource;
+	}
+
 	void D3D12LinkedDevice::ReleaseDescriptor(DeferredDeleteDescriptor Descriptor)
 	{
 		D3D12SyncHandle GraphicsSyncHandle = GraphicsQueue.GetSyncHandle();
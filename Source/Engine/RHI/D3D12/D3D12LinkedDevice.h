@@ -56,6 +56,11 @@ namespace RHI
 		void Upload(const std::vector<D3D12_SUBRESOURCE_DATA>& Subresources, ID3D12Resource* Resource);
 		void Upload(const D3D12_SUBRESOURCE_DATA& Subresource, ID3D12Resource* Resource);
 		void Upload(const void* Data, UINT64 SizeInBytes, ID3D12Resource* Resource);
+		// Stages through Staging at StagingOffset instead of a resource of its own, the caller keeps Staging alive until the
+		// upload has completed
+		void Upload(const std::vector<D3D12_SUBRESOURCE_DATA>& Subresources, ID3D12Resource* Resource, ID3D12Resource* Staging, UINT64 StagingOffset);
+
+		[[nodiscard]] Arc<ID3D12Resource> CreateUploadBuffer(UINT64 SizeInBytes);
 
 		void ReleaseDescriptor(DeferredDeleteDescriptor Descriptor);
 
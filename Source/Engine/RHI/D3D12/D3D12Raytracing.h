@@ -44,6 +44,7 @@ namespace RHI
 		[[nodiscard]] D3D12_GPU_VIRTUAL_ADDRESS GetAddress() const noexcept { return AccelerationStructure; }
 		[[nodiscard]] D3D12_GPU_VIRTUAL_ADDRESS GetVertexBufferAt(size_t GeometryIndex) const noexcept { return RaytracingGeometryDescs[GeometryIndex].Triangles.VertexBuffer.StartAddress; }
 		[[nodiscard]] D3D12_GPU_VIRTUAL_ADDRESS GetIndexBufferAt(size_t GeometryIndex) const noexcept { return RaytracingGeometryDescs[GeometryIndex].Triangles.IndexBuffer; }
+		[[nodiscard]] DXGI_FORMAT				GetIndexFormatAt(size_t GeometryIndex) const noexcept { return RaytracingGeometryDescs[GeometryIndex].Triangles.IndexFormat; }
 		[[nodiscard]] UINT64					GetBlasIndex() const noexcept { return BlasIndex; }
 
 		void AddGeometry(const D3D12_RAYTRACING_GEOMETRY_DESC& Desc);
@@ -5,3 +5,8 @@ u64 Hash::Hash64(const void* Object, size_t SizeInBytes)
 {
 	return CityHash64(static_cast<const char*>(Object), SizeInBytes);
 }
+
+u64 Hash::Combine(u64 Seed, u64 Value)
+{
+	return Hash128to64(uint128(Seed, Value));
+}
@@ -5,4 +5,7 @@ class Hash
 {
 public:
 	static u64 Hash64(const void* Object, size_t SizeInBytes);
+
+	// Order dependent combination of two hashes
+	static u64 Combine(u64 Seed, u64 Value);
 };
@@ -1,35 +1,45 @@
 ﻿#include "BinaryReader.h"
 #include "FileStream.h"
+#include "MemoryMappedFile.h"
 #include <cassert>
 
 BinaryReader::BinaryReader(FileStream& Stream)
-	: Stream(Stream)
 {
 	assert(Stream.CanRead());
-	BaseAddress = Stream.ReadAll();
-	Ptr			= BaseAddress.get();
-	Sentinel	= Ptr + Stream.GetSizeInBytes();
+	Buffer		= Stream.ReadAll();
+	BaseAddress = Buffer.get();
+	Ptr			= BaseAddress;
+	SizeInBytes = Stream.GetSizeInBytes();
+	Sentinel	= Ptr + SizeInBytes;
 }
 
-u8* BinaryReader::GetBaseAddress() const noexcept
+BinaryReader::BinaryReader(const MemoryMappedFile& File)
+	: BaseAddress(File.GetBaseAddress())
+	, Ptr(BaseAddress)
+	, Sentinel(BaseAddress + File.GetSizeInBytes())
+	, SizeInBytes(File.GetSizeInBytes())
 {
-	return BaseAddress.get();
 }
 
-u8* BinaryReader::GetPtr() const noexcept
+const u8* BinaryReader::GetBaseAddress() const noexcept
+{
+	return BaseAddress;
+}
+
+const u8* BinaryReader::GetPtr() const noexcept
 {
 	return Ptr;
 }
 
 usize BinaryReader::GetSizeInBytes() const noexcept
 {
-	return Stream.GetSizeInBytes();
+	return SizeInBytes;
 }
 
 void BinaryReader::Read(void* DstData, u64 SizeInBytes) const noexcept
 {
 	assert(Ptr + SizeInBytes <= Sentinel);
-	u8* SrcData = Ptr;
+	const u8* SrcData = Ptr;
 	Ptr += SizeInBytes;
 	std::memcpy(DstData, SrcData, SizeInBytes);
 }
@@ -40,10 +50,10 @@ u8 BinaryReader::ReadByte() const noexcept
 	return *Ptr++;
 }
 
-u8* BinaryReader::ReadBytes(u64 SizeInBytes) const noexcept
+const u8* BinaryReader::ReadBytes(u64 SizeInBytes) const noexcept
 {
 	assert(Ptr + SizeInBytes <= Sentinel);
-	u8* SrcData = Ptr;
+	const u8* SrcData = Ptr;
 	Ptr += SizeInBytes;
 	return SrcData;
 }
@@ -1,17 +1,21 @@
 ﻿#pragma once
 #include <memory>
 #include "Types.h"
+#include "Span.h"
 
 class FileStream;
+class MemoryMappedFile;
 
 class BinaryReader
 {
 public:
 	explicit BinaryReader(FileStream& Stream);
+	// Reads straight out of the mapped view, no intermediate copy of the file is made.
+	explicit BinaryReader(const MemoryMappedFile& File);
 
-	u8*	  GetBaseAddress() const noexcept;
-	u8*	  GetPtr() const noexcept;
-	usize GetSizeInBytes() const noexcept;
+	const u8* GetBaseAddress() const noexcept;
+	const u8* GetPtr() const noexcept;
+	usize	  GetSizeInBytes() const noexcept;
 
 	void Read(void* DstData, u64 SizeInBytes) const noexcept;
 
@@ -26,11 +30,21 @@ public:
 
 	u8 ReadByte() const noexcept;
 	// Lifetime of the returned pointer is tied to the BinaryReader for efficiency reasons.
-	u8* ReadBytes(u64 SizeInBytes) const noexcept;
+	const u8* ReadBytes(u64 SizeInBytes) const noexcept;
+
+	// Returns a view of NumElements elements at the current position without copying them.
+	// Lifetime of the returned view is tied to the BinaryReader's underlying storage.
+	template<typename T>
+	Span<const T> ReadSpan(u64 NumElements) const noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "typename T is not trivially copyable");
+		return Span<const T>(reinterpret_cast<const T*>(ReadBytes(NumElements * sizeof(T))), NumElements);
+	}
 
 private:
-	FileStream&			  Stream;
-	std::unique_ptr<u8[]> BaseAddress;
-	mutable u8*			  Ptr;
-	u8*					  Sentinel;
+	std::unique_ptr<u8[]> Buffer;
+	const u8*			  BaseAddress = nullptr;
+	mutable const u8*	  Ptr		  = nullptr;
+	const u8*			  Sentinel	  = nullptr;
+	usize				  SizeInBytes = 0;
 };
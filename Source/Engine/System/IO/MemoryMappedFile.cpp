@@ -0,0 +1,82 @@
+#include "MemoryMappedFile.h"
+#include "Exception.h"
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+MemoryMappedFile::MemoryMappedFile(std::filesystem::path Path)
+{
+	// Other readers may map the file at the same time, writers are kept out while it is open
+	ScopedFileHandle File(CreateFile(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+	if (!File)
+	{
+		DWORD Error = GetLastError();
+		if (Error == ERROR_FILE_NOT_FOUND)
+		{
+			throw ExceptionFileNotFound(__FILE__, __LINE__);
+		}
+		if (Error == ERROR_PATH_NOT_FOUND)
+		{
+			throw ExceptionPathNotFound(__FILE__, __LINE__);
+		}
+		throw ExceptionIO(__FILE__, __LINE__);
+	}
+
+	LARGE_INTEGER FileSize = {};
+	if (!GetFileSizeEx(File.Get(), &FileSize))
+	{
+		throw ExceptionIO(__FILE__, __LINE__);
+	}
+
+	// Empty files cannot be mapped
+	if (FileSize.QuadPart == 0)
+	{
+		return;
+	}
+
+	// The view keeps the mapping and the file alive, both handles are closed once it exists
+	HANDLE Mapping = CreateFileMapping(File.Get(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!Mapping)
+	{
+		throw ExceptionIO(__FILE__, __LINE__);
+	}
+	ScopedFileHandle MappingHandle(Mapping);
+
+	BaseAddress = static_cast<const u8*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!BaseAddress)
+	{
+		throw ExceptionIO(__FILE__, __LINE__);
+	}
+	SizeInBytes = FileSize.QuadPart;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	InternalDestroy();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& MemoryMappedFile) noexcept
+	: SizeInBytes(std::exchange(MemoryMappedFile.SizeInBytes, 0))
+	, BaseAddress(std::exchange(MemoryMappedFile.BaseAddress, nullptr))
+{
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& MemoryMappedFile) noexcept
+{
+	if (this != &MemoryMappedFile)
+	{
+		InternalDestroy();
+		SizeInBytes = std::exchange(MemoryMappedFile.SizeInBytes, 0);
+		BaseAddress = std::exchange(MemoryMappedFile.BaseAddress, nullptr);
+	}
+	return *this;
+}
+
+void MemoryMappedFile::InternalDestroy()
+{
+	if (BaseAddress)
+	{
+		UnmapViewOfFile(BaseAddress);
+		BaseAddress = nullptr;
+	}
+	SizeInBytes = 0;
+}
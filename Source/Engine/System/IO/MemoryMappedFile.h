@@ -0,0 +1,33 @@
+#pragma once
+#include <filesystem>
+#include "Types.h"
+#include "Platform.h"
+
+// Maps an entire file read-only into the address space of the process.
+// Pages are faulted in on first access, so only the regions that are actually touched become resident.
+// The file is opened with read sharing and closed once it is mapped, so any number of threads may map the same file.
+// Throws if the file cannot be opened or mapped, an empty file maps to an invalid view.
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile() noexcept = default;
+	explicit MemoryMappedFile(std::filesystem::path Path);
+	~MemoryMappedFile();
+
+	MemoryMappedFile(MemoryMappedFile&& MemoryMappedFile) noexcept;
+	MemoryMappedFile& operator=(MemoryMappedFile&& MemoryMappedFile) noexcept;
+
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	[[nodiscard]] const u8* GetBaseAddress() const noexcept { return BaseAddress; }
+	[[nodiscard]] u64		GetSizeInBytes() const noexcept { return SizeInBytes; }
+	[[nodiscard]] bool		IsValid() const noexcept { return BaseAddress != nullptr; }
+
+private:
+	void InternalDestroy();
+
+private:
+	u64		  SizeInBytes = 0;
+	const u8* BaseAddress = nullptr;
+};
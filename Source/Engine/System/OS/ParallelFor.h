@@ -0,0 +1,64 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "ThreadPool.h"
+#include "Sync/Event.h"
+
+// Invokes Function(Index) for every Index in [0, Count) using the thread pool, the calling thread participates
+// and the call returns once every index has been processed. Indices are handed out one at a time, so the function
+// should do a meaningful amount of work per index (a mesh, a chunk, a tile...)
+template<typename TFunction>
+void ParallelFor(ThreadPool& ThreadPool, size_t Count, TFunction&& Function)
+{
+	if (Count == 0)
+	{
+		return;
+	}
+
+	const size_t NumWorkers = std::min<size_t>(Count, std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+	if (NumWorkers == 0)
+	{
+		for (size_t i = 0; i < Count; ++i)
+		{
+			Function(i);
+		}
+		return;
+	}
+
+	struct ParallelForContext
+	{
+		TFunction*			Function;
+		size_t				Count;
+		std::atomic<size_t> Next;
+		std::atomic<size_t> NumParticipants;
+		Event				Done;
+
+		void Execute()
+		{
+			for (size_t i = Next.fetch_add(1, std::memory_order_relaxed); i < Count; i = Next.fetch_add(1, std::memory_order_relaxed))
+			{
+				(*Function)(i);
+			}
+			// Last participant out signals the caller, nothing may touch the context afterwards
+			if (NumParticipants.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Done.SetEvent();
+			}
+		}
+	} Context{ &Function, Count, 0, NumWorkers + 1 };
+	Context.Done.Create();
+
+	for (size_t i = 0; i < NumWorkers; ++i)
+	{
+		ThreadPool.QueueThreadpoolWork(
+			[](void* Context)
+			{
+				static_cast<ParallelForContext*>(Context)->Execute();
+			},
+			&Context);
+	}
+
+	Context.Execute();
+	(void)Context.Done.Wait();
+}
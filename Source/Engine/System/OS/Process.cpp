@@ -2,6 +2,7 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <shellapi.h>
+#include <Psapi.h>
 
 struct WorkEntry
 {
@@ -109,3 +110,13 @@ ThreadId Process::GetCurrentThreadId()
 {
 	return { ::GetCurrentThreadId() };
 }
+
+u64 Process::GetPeakWorkingSetSizeInBytes()
+{
+	PROCESS_MEMORY_COUNTERS Counters = {};
+	if (K32GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+	{
+		return Counters.PeakWorkingSetSize;
+	}
+	return 0;
+}
@@ -15,4 +15,7 @@ public:
 	static ThreadPool& GetThreadPool();
 
 	static ThreadId GetCurrentThreadId();
+
+	// Largest working set the process has had since it started
+	static u64 GetPeakWorkingSetSizeInBytes();
 };
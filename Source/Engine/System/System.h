@@ -11,8 +11,10 @@
 
 #include "OS/ThreadPool.h"
 #include "OS/Process.h"
+#include "OS/ParallelFor.h"
 
 #include "IO/FileStream.h"
+#include "IO/MemoryMappedFile.h"
 #include "IO/BinaryReader.h"
 #include "IO/BinaryWriter.h"
 #include "IO/File.h"